@@ -0,0 +1,44 @@
+# Carga mista para o gerador ppos-load: tarefas interativas com secao
+# critica curta e cochilos de cauda pesada, tarefas de lote de CPU, um
+# pipeline produtor/consumidor por fila de mensagens e leitores/escritores
+# de disco com tamanhos de pedido de cauda pesada.
+
+duration 3000
+seed 7
+disk 4096 hdd
+sem cache 1
+mqueue pipe 32 64
+
+# interativas: pouca CPU, disputa pelo semaforo, cochilos de Pareto
+class web 40 -5 slo 99 500
+  cpu exp 0.2
+  lock cache exp 0.05
+  sleep pareto 5 1.5
+end
+
+# lote: rajadas longas de CPU, sem SLO
+class batch 4 5
+  cpu uniform 20 60
+end
+
+# pipeline por fila de mensagens
+class produtor 2 0
+  cpu exp 0.5
+  send pipe
+end
+
+class consumidor 2 0 slo 99 500
+  recv pipe
+  cpu exp 0.5
+end
+
+# E/S de disco: pedidos de 1 a 64 blocos com cauda pesada
+class leitor 6 0 slo 99 3000
+  read pareto 1 1.2
+  sleep exp 10
+end
+
+class escritor 2 0 slo 99 5000
+  write pareto 2 1.5
+  sleep exp 50
+end
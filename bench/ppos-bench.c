@@ -0,0 +1,432 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Microbenchmarks do nucleo e do gerente de disco. Cada benchmark roda
+// varias vezes (com a mesma semente aleatoria) e a mediana, o minimo e o
+// maximo sao escritos em CSV ou JSON, para comparar versoes do sistema.
+//
+// Uso: ppos-bench [-f csv|json] [-o arquivo] [-r repeticoes] [-s semente]
+//                 [-q] [benchmark ...]
+//
+// -q reduz as iteracoes (verificacao rapida); sem nomes, roda todos. As
+// mensagens do nucleo (fim de tarefas) e as linhas do benchmark log vao
+// para /dev/null; para medir a escrita sem o anel, use PPOS_LOG=sync.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "ppos.h"
+#include "ppos_disk.h"
+#include "ppos_log.h"
+
+#define MAXRUNS    64		// repeticoes de cada benchmark
+#define MAXTASKS   1024		// tarefas auxiliares
+#define MAXPARAMS  8		// parametros de cada benchmark
+#define DISKBLOCKS 4096		// blocos do disco de teste
+#define BLOCKSIZE  512		// tamanho dos blocos
+#define READERS    8		// tarefas leitoras do benchmark de disco
+#define PRINTERS   4		// tarefas escritoras do benchmark de saida
+#define LINEMAX    1024		// maior linha do benchmark de saida
+
+// descricao de um benchmark
+typedef struct
+{
+  const char *name;             // nome do benchmark
+  const char *metric;           // grandeza medida
+  const char *unit;             // unidade
+  double (*run) (int param);    // executa uma vez e retorna a medida
+  int params[MAXPARAMS];        // parametros (-1 encerra a lista)
+} bench_t ;
+
+task_t tasks[MAXTASKS] ;
+semaphore_t sem[2] ;
+mqueue_t mq ;
+int iterations, msgSize, stop, quick = 0, diskReady = 0 ;
+long counter ;
+
+// relogio monotonico em ns
+unsigned long long now_ns ()
+{
+  struct timespec t ;
+
+  clock_gettime (CLOCK_MONOTONIC, &t) ;
+  return (unsigned long long) t.tv_sec * 1000000000ULL + t.tv_nsec ;
+}
+
+// iteracoes de um benchmark, reduzidas com -q
+int iters (int n)
+{
+  return quick ? (n / 20 > 0 ? n / 20 : 1) : n ;
+}
+
+// aguarda o fim das primeiras n tarefas auxiliares
+void join_all (int n)
+{
+  int i ;
+
+  for (i = 0; i < n; i++)
+    task_join (&tasks[i]) ;
+}
+
+// yield =======================================================================
+
+void yieldBody (void *arg)
+{
+  int i ;
+
+  for (i = 0; i < iterations; i++)
+    task_yield () ;
+  task_exit (0) ;
+}
+
+// duas tarefas cedem o processador alternadamente: custo de cada yield
+double bench_yield (int param)
+{
+  unsigned long long start ;
+
+  iterations = iters (20000) ;
+  start = now_ns () ;
+  task_create (&tasks[0], yieldBody, NULL) ;
+  task_create (&tasks[1], yieldBody, NULL) ;
+  join_all (2) ;
+  return (double) (now_ns () - start) / (2 * iterations) ;
+}
+
+// criacao de tarefas ==========================================================
+
+void emptyBody (void *arg)
+{
+  task_exit (0) ;
+}
+
+// cria lotes de tarefas vazias e aguarda seu fim: tarefas por segundo
+double bench_create (int param)
+{
+  unsigned long long start ;
+  int b, i, batches = iters (20) ;
+
+  start = now_ns () ;
+  for (b = 0; b < batches; b++)
+  {
+    for (i = 0; i < 100; i++)
+      task_create (&tasks[i], emptyBody, NULL) ;
+    join_all (100) ;
+  }
+  return batches * 100 * 1e9 / (now_ns () - start) ;
+}
+
+// semaforos ===================================================================
+
+void pingBody (void *arg)
+{
+  long me = (long) arg ;
+  int i ;
+
+  for (i = 0; i < iterations; i++)
+  {
+    sem_down (&sem[me]) ;
+    sem_up (&sem[!me]) ;
+  }
+  task_exit (0) ;
+}
+
+// duas tarefas trocam a vez por semaforos: tempo de ida e volta
+double bench_sem (int param)
+{
+  unsigned long long start ;
+
+  iterations = iters (20000) ;
+  sem_create (&sem[0], 1) ;
+  sem_create (&sem[1], 0) ;
+  start = now_ns () ;
+  task_create (&tasks[0], pingBody, (void *) 0L) ;
+  task_create (&tasks[1], pingBody, (void *) 1L) ;
+  join_all (2) ;
+  sem_destroy (&sem[0]) ;
+  sem_destroy (&sem[1]) ;
+  return (double) (now_ns () - start) / iterations ;
+}
+
+// filas de mensagens ==========================================================
+
+void sendBody (void *arg)
+{
+  char msg[msgSize] ;
+  int i ;
+
+  memset (msg, 1, msgSize) ;
+  for (i = 0; i < iterations; i++)
+    mqueue_send (&mq, msg) ;
+  task_exit (0) ;
+}
+
+void recvBody (void *arg)
+{
+  char msg[msgSize] ;
+  int i ;
+
+  for (i = 0; i < iterations; i++)
+    if (mqueue_recv (&mq, msg) == 0)
+      counter++ ;
+  task_exit (0) ;
+}
+
+// produtora e consumidora com fila de 16 mensagens de param bytes
+double bench_mqueue (int param)
+{
+  unsigned long long start ;
+
+  iterations = iters (20000) ;
+  msgSize = param ;
+  counter = 0 ;
+  mqueue_create (&mq, 16, msgSize) ;
+  start = now_ns () ;
+  task_create (&tasks[0], sendBody, NULL) ;
+  task_create (&tasks[1], recvBody, NULL) ;
+  join_all (2) ;
+  start = now_ns () - start ;
+  mqueue_destroy (&mq) ;
+  if (counter != iterations)
+    fprintf (stderr, "mqueue: %ld de %d mensagens recebidas\n", counter, iterations) ;
+  return iterations * 1e9 / start ;
+}
+
+// precisao do sono ============================================================
+
+// erro medio (us) do tempo dormido em relacao aos param ms pedidos a
+// task_sleep (negativo se acordou antes; o relogio tem resolucao de 1 tick)
+double bench_sleep (int param)
+{
+  unsigned long long start ;
+  double error = 0 ;
+  int i, n = iters (40) ;
+
+  for (i = 0; i < n; i++)
+  {
+    start = now_ns () ;
+    task_sleep (param) ;
+    error += (double) (now_ns () - start) - param * 1e6 ;
+  }
+  return error / 1000.0 / n ;
+}
+
+// custo de despacho ===========================================================
+
+void spinBody (void *arg)
+{
+  while (!stop)
+    task_yield () ;
+  task_exit (0) ;
+}
+
+// com param tarefas prontas cedendo o processador, custo de cada despacho
+// (escolha da proxima tarefa e trocas de contexto)
+double bench_dispatch (int param)
+{
+  unsigned long long start ;
+  int i, rounds = iters (param >= 100 ? 200 : 2000) ;
+
+  stop = 0 ;
+  for (i = 0; i < param; i++)
+    task_create (&tasks[i], spinBody, NULL) ;
+  task_yield () ;
+  start = now_ns () ;
+  for (i = 0; i < rounds; i++)
+    task_yield () ;
+  start = now_ns () - start ;
+  stop = 1 ;
+  join_all (param) ;
+  return (double) start / (rounds * (param + 1)) ;
+}
+
+// saida padrao ================================================================
+
+void printBody (void *arg)
+{
+  char line[LINEMAX] ;
+  int i ;
+
+  memset (line, 'x', msgSize - 1) ;
+  line[msgSize - 1] = '\0' ;
+  for (i = 0; i < iterations; i++)
+    printf ("%s\n", line) ;
+  task_exit (0) ;
+}
+
+// PRINTERS tarefas escrevem linhas de param bytes na saida padrao (com ou
+// sem o anel, conforme PPOS_LOG): linhas por segundo, incluindo a gravacao
+// final do anel
+double bench_log (int param)
+{
+  unsigned long long start ;
+  int i ;
+
+  iterations = iters (5000) ;
+  msgSize = param ;
+  start = now_ns () ;
+  for (i = 0; i < PRINTERS; i++)
+    task_create (&tasks[i], printBody, NULL) ;
+  join_all (PRINTERS) ;
+  log_flush () ;
+  return PRINTERS * iterations * 1e9 / (now_ns () - start) ;
+}
+
+// disco =======================================================================
+
+void readBody (void *arg)
+{
+  char buffer[BLOCKSIZE] ;
+  int i ;
+
+  for (i = 0; i < iterations; i++)
+    disk_dev_block_read (0, random () % DISKBLOCKS, buffer) ;
+  task_exit (0) ;
+}
+
+// READERS tarefas leem blocos aleatorios de um disco rigido (tempos
+// reduzidos) com a politica param: operacoes por segundo
+double bench_disk (int param)
+{
+  disk_config_t cfg ;
+  disk_sched_t sched ;
+  unsigned long long start ;
+  int i, numblocks, blocksize ;
+
+  if (!diskReady)
+  {
+    disk_config_init (&cfg) ;
+    strcpy (cfg.image, "bench-disk.dat") ;
+    cfg.numblocks = DISKBLOCKS ;
+    cfg.blocksize = BLOCKSIZE ;
+    cfg.seek_min_us = 200 ;
+    cfg.seek_max_us = 4000 ;
+    cfg.jitter_us = 200 ;
+    cfg.xfer_rate = 6400000 ;
+    if (disk_dev_config (0, &cfg) < 0 || disk_dev_mgr_init (0, &numblocks, &blocksize) < 0)
+    {
+      fprintf (stderr, "disk: erro na abertura do disco\n") ;
+      return 0 ;
+    }
+    diskReady = 1 ;
+  }
+  disk_dev_get_sched (0, &sched) ;
+  sched.policy = param ;
+  disk_dev_set_sched (0, &sched) ;
+
+  iterations = iters (40) ;
+  start = now_ns () ;
+  for (i = 0; i < READERS; i++)
+    task_create (&tasks[i], readBody, NULL) ;
+  join_all (READERS) ;
+  return READERS * iterations * 1e9 / (now_ns () - start) ;
+}
+
+// tabela de benchmarks ========================================================
+
+bench_t benches[] =
+{
+  { "yield",    "custo do task_yield",          "ns",         bench_yield,    { 0, -1 } },
+  { "create",   "criacao e fim de tarefas",     "tarefas/s",  bench_create,   { 0, -1 } },
+  { "sem",      "ida e volta por semaforos",    "ns",         bench_sem,      { 0, -1 } },
+  { "mqueue",   "mensagens de param bytes",     "msgs/s",     bench_mqueue,   { 4, 64, 1024, 4096, -1 } },
+  { "sleep",    "erro de task_sleep(param)",    "us",         bench_sleep,    { 1, 5, 10, -1 } },
+  { "dispatch", "despacho com param prontas",   "ns",         bench_dispatch, { 1, 10, 100, 1000, -1 } },
+  { "log",      "linhas de param bytes",        "linhas/s",   bench_log,      { 16, 128, 1024, -1 } },
+  { "disk",     "leituras com politica param",  "ops/s",      bench_disk,     { DISK_SCHED_FIFO, DISK_SCHED_DEADLINE, -1 } },
+  { NULL }
+} ;
+
+int cmp_double (const void *a, const void *b)
+{
+  double x = *(double *) a, y = *(double *) b ;
+
+  return (x > y) - (x < y) ;
+}
+
+int main (int argc, char *argv[])
+{
+  double values[MAXRUNS] ;
+  FILE *out = NULL ;
+  char *format = "csv", *file = NULL ;
+  int runs = 5, seed = 1, opt, b, p, r, a, selected, first = 1 ;
+
+  while ((opt = getopt (argc, argv, "f:o:r:s:q")) != -1)
+    switch (opt)
+    {
+      case 'f': format = optarg ; break ;
+      case 'o': file = optarg ; break ;
+      case 'r': runs = atoi (optarg) ; break ;
+      case 's': seed = atoi (optarg) ; break ;
+      case 'q': quick = 1 ; break ;
+      default:
+        fprintf (stderr, "uso: %s [-f csv|json] [-o arquivo] [-r repeticoes] [-s semente] "
+                 "[-q] [benchmark ...]\n", argv[0]) ;
+        exit (1) ;
+    }
+  if (runs < 1 || runs > MAXRUNS || (strcmp (format, "csv") && strcmp (format, "json")))
+  {
+    fprintf (stderr, "%s: repeticoes de 1 a %d, formato csv ou json\n", argv[0], MAXRUNS) ;
+    exit (1) ;
+  }
+
+  // resultados no arquivo ou na saida padrao original; mensagens descartadas
+  out = file ? fopen (file, "w") : fdopen (dup (1), "w") ;
+  if (!out || !freopen ("/dev/null", "w", stdout))
+  {
+    perror ("ppos-bench") ;
+    exit (1) ;
+  }
+
+  ppos_init () ;
+
+  if (!strcmp (format, "csv"))
+    fprintf (out, "benchmark,param,metric,unit,runs,median,min,max\n") ;
+  else
+    fprintf (out, "{\"benchmarks\":[\n") ;
+
+  for (b = 0; benches[b].name; b++)
+  {
+    // apenas os benchmarks pedidos
+    selected = (optind == argc) ;
+    for (a = optind; a < argc; a++)
+      if (!strcmp (argv[a], benches[b].name))
+        selected = 1 ;
+    if (!selected)
+      continue ;
+
+    for (p = 0; p < MAXPARAMS && benches[b].params[p] >= 0; p++)
+    {
+      for (r = 0; r < runs; r++)
+      {
+        srandom (seed) ;
+        values[r] = benches[b].run (benches[b].params[p]) ;
+      }
+      qsort (values, runs, sizeof (double), cmp_double) ;
+
+      if (!strcmp (format, "csv"))
+        fprintf (out, "%s,%d,%s,%s,%d,%.3f,%.3f,%.3f\n", benches[b].name,
+                 benches[b].params[p], benches[b].metric, benches[b].unit, runs,
+                 values[runs / 2], values[0], values[runs - 1]) ;
+      else
+        fprintf (out, "%s{\"benchmark\":\"%s\",\"param\":%d,\"metric\":\"%s\",\"unit\":\"%s\","
+                 "\"runs\":%d,\"median\":%.3f,\"min\":%.3f,\"max\":%.3f}", first ? "" : ",\n",
+                 benches[b].name, benches[b].params[p], benches[b].metric, benches[b].unit,
+                 runs, values[runs / 2], values[0], values[runs - 1]) ;
+      fflush (out) ;
+      first = 0 ;
+    }
+  }
+
+  if (strcmp (format, "csv"))
+    fprintf (out, "\n]}\n") ;
+  fclose (out) ;
+  if (diskReady)
+    unlink ("bench-disk.dat") ;
+
+  task_exit (0) ;
+
+  exit (0) ;
+}
@@ -0,0 +1,464 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Gerador de carga sintetica: cria populacoes de tarefas descritas em um
+// arquivo de especificacao, cada uma repetindo uma sequencia de passos
+// (rajadas de CPU, cochilos, secoes criticas, filas de mensagens e E/S de
+// disco) com duracoes sorteadas de distribuicoes, possivelmente de cauda
+// pesada. Cada repeticao da sequencia eh uma transacao; ao fim, mostra a
+// vazao e os percentis de latencia das transacoes de cada populacao e
+// confere os objetivos (SLO) declarados.
+//
+// Uso: ppos-load especificacao
+//
+// Formato da especificacao (uma diretiva por linha, # inicia comentario):
+//
+//   duration MS                 duracao da carga (padrao 2000 ms)
+//   seed N                      semente aleatoria (padrao 1)
+//   disk BLOCOS hdd|ssd         cria o disco 0 (hdd com tempos reduzidos)
+//   sem NOME VALOR              semaforo
+//   mqueue NOME MAX TAMANHO     fila de mensagens
+//   class NOME QTDE PRIO [slo PCT MS]
+//     PASSO ...                 passos de cada transacao
+//   end
+//
+// Passos: cpu DIST (ms de CPU), sleep DIST (ms), lock SEM DIST (secao
+// critica com DIST ms de CPU), down SEM, up SEM, send FILA, recv FILA,
+// read DIST e write DIST (blocos contiguos em posicao aleatoria).
+// Distribuicoes: VALOR, uniform A B, exp MEDIA, pareto MINIMO ALFA.
+//
+// Retorna 0 se todos os SLO foram atendidos, 2 se algum falhou e 1 em erro.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_disk.h"
+#include "ppos_lat.h"
+
+#define MAXCLASSES 16		// populacoes
+#define MAXSTEPS   16		// passos de uma transacao
+#define MAXRES     16		// semaforos e filas
+#define NAMESIZE   32
+#define BLOCKSIZE  512		// tamanho dos blocos do disco
+
+// distribuicoes
+#define DIST_CONST   0
+#define DIST_UNIFORM 1
+#define DIST_EXP     2
+#define DIST_PARETO  3
+
+// passos
+#define STEP_CPU   0
+#define STEP_SLEEP 1
+#define STEP_LOCK  2
+#define STEP_DOWN  3
+#define STEP_UP    4
+#define STEP_SEND  5
+#define STEP_RECV  6
+#define STEP_READ  7
+#define STEP_WRITE 8
+
+typedef struct
+{
+  int type ;			// DIST_*
+  double a, b ;			// parametros
+} dist_t ;
+
+typedef struct
+{
+  int op ;			// STEP_*
+  int res ;			// semaforo ou fila
+  dist_t dist ;			// duracao ou blocos
+} step_t ;
+
+typedef struct
+{
+  char name[NAMESIZE] ;
+  int count, prio ;		// tarefas e prioridade
+  double sloPct, sloMs ;	// objetivo: pct% das transacoes em ate sloMs
+  step_t steps[MAXSTEPS] ;
+  int nsteps ;
+  task_t *tasks ;
+  lat_hist_t hist ;		// latencia das transacoes (ns)
+} class_t ;
+
+typedef struct
+{
+  char name[NAMESIZE] ;
+  semaphore_t sem ;
+  mqueue_t mq ;
+  int size ;			// tamanho das mensagens (filas)
+} res_t ;
+
+class_t classes[MAXCLASSES] ;
+res_t sems[MAXRES], mqueues[MAXRES] ;
+int nclasses = 0, nsems = 0, nmqueues = 0 ;
+int duration = 2000, seed = 1, diskBlocks = 0, stop = 0 ;
+
+// relogio monotonico em ns
+unsigned long long now_ns ()
+{
+  struct timespec t ;
+
+  clock_gettime (CLOCK_MONOTONIC, &t) ;
+  return (unsigned long long) t.tv_sec * 1000000000ULL + t.tv_nsec ;
+}
+
+// sorteia um valor da distribuicao
+double sample (dist_t *d)
+{
+  double u = (random () + 1.0) / (RAND_MAX + 2.0) ;	// (0, 1)
+
+  switch (d->type)
+  {
+    case DIST_UNIFORM: return d->a + u * (d->b - d->a) ;
+    case DIST_EXP:     return -d->a * log (u) ;
+    case DIST_PARETO:  return d->a / pow (u, 1.0 / d->b) ;
+    default:           return d->a ;
+  }
+}
+
+// consome ms milissegundos de CPU (tempo de execucao da tarefa)
+void burn (double ms)
+{
+  task_stats_t st ;
+  unsigned long long target ;
+
+  task_stats (NULL, &st) ;
+  target = st.run_ns + (unsigned long long) (ms * 1e6) ;
+  while (st.run_ns < target)
+    task_stats (NULL, &st) ;
+}
+
+// le ou escreve blocos contiguos do disco em posicao aleatoria
+void disk_io (int type, double blocks, char *area)
+{
+  void *buffers[DISK_VEC_MAX] ;
+  int i, n = (int) (blocks + 0.5), first ;
+
+  if (n < 1)
+    n = 1 ;
+  if (n > DISK_VEC_MAX)
+    n = DISK_VEC_MAX ;
+  first = random () % (diskBlocks - n + 1) ;
+  for (i = 0; i < n; i++)
+    buffers[i] = area + i * BLOCKSIZE ;
+  if (type == STEP_READ)
+    disk_dev_block_readv (0, first, n, buffers) ;
+  else
+    disk_dev_block_writev (0, first, n, buffers) ;
+}
+
+// corpo das tarefas: repete as transacoes da populacao ate o fim da carga
+void body (void *arg)
+{
+  class_t *c = arg ;
+  char *msg, *area ;
+  unsigned long long start ;
+  step_t *s ;
+  int i, size = BLOCKSIZE ;
+
+  for (i = 0; i < nmqueues; i++)
+    if (mqueues[i].size > size)
+      size = mqueues[i].size ;
+  msg = malloc (size) ;
+  area = malloc (DISK_VEC_MAX * BLOCKSIZE) ;
+  memset (msg, 0, size) ;
+
+  while (!stop)
+  {
+    start = now_ns () ;
+    for (i = 0; i < c->nsteps; i++)
+    {
+      s = &c->steps[i] ;
+      switch (s->op)
+      {
+        case STEP_CPU:   burn (sample (&s->dist)) ; break ;
+        case STEP_SLEEP: task_sleep ((int) (sample (&s->dist) + 0.5)) ; break ;
+        case STEP_LOCK:
+          sem_down (&sems[s->res].sem) ;
+          burn (sample (&s->dist)) ;
+          sem_up (&sems[s->res].sem) ;
+          break ;
+        case STEP_DOWN:  sem_down (&sems[s->res].sem) ; break ;
+        case STEP_UP:    sem_up (&sems[s->res].sem) ; break ;
+        case STEP_SEND:  mqueue_send (&mqueues[s->res].mq, msg) ; break ;
+        case STEP_RECV:  mqueue_recv (&mqueues[s->res].mq, msg) ; break ;
+        default:         disk_io (s->op, sample (&s->dist), area) ; break ;
+      }
+    }
+    // transacoes concluidas depois do fim da carga nao sao contadas
+    if (!stop)
+      lat_record (&c->hist, now_ns () - start) ;
+  }
+  task_exit (0) ;
+}
+
+// leitura da especificacao ====================================================
+
+int line = 0 ;
+
+// termina com erro de sintaxe na linha corrente
+void syntax (char *msg)
+{
+  fprintf (stderr, "linha %d: %s\n", line, msg) ;
+  exit (1) ;
+}
+
+// proximo campo da linha (NULL se nao houver)
+char *field ()
+{
+  return strtok (NULL, " \t\n") ;
+}
+
+// proximo campo numerico da linha
+double number ()
+{
+  char *f = field (), *end ;
+  double v ;
+
+  if (!f)
+    syntax ("numero esperado") ;
+  v = strtod (f, &end) ;
+  if (*end)
+    syntax ("numero invalido") ;
+  return v ;
+}
+
+// recurso de nome name na tabela res
+int resource (res_t *res, int n)
+{
+  char *name = field () ;
+  int i ;
+
+  for (i = 0; name && i < n; i++)
+    if (!strcmp (res[i].name, name))
+      return i ;
+  syntax ("semaforo ou fila inexistente") ;
+  return -1 ;
+}
+
+// distribuicao no restante da linha
+void distribution (dist_t *d)
+{
+  char *f = field (), *end ;
+
+  if (!f)
+    syntax ("distribuicao esperada") ;
+  if (!strcmp (f, "uniform"))
+  {
+    d->type = DIST_UNIFORM ;
+    d->a = number () ;
+    d->b = number () ;
+  }
+  else if (!strcmp (f, "exp"))
+  {
+    d->type = DIST_EXP ;
+    d->a = number () ;
+  }
+  else if (!strcmp (f, "pareto"))
+  {
+    d->type = DIST_PARETO ;
+    d->a = number () ;
+    d->b = number () ;
+    if (d->b <= 0)
+      syntax ("alfa deve ser positivo") ;
+  }
+  else
+  {
+    d->type = DIST_CONST ;
+    d->a = strtod (f, &end) ;
+    if (*end)
+      syntax ("distribuicao invalida") ;
+  }
+}
+
+// le a especificacao
+void parse (char *file)
+{
+  static const char *ops[] = { "cpu", "sleep", "lock", "down", "up", "send", "recv", "read",
+                               "write", NULL } ;
+  char buffer[256], *f ;
+  class_t *c = NULL ;
+  step_t *s ;
+  FILE *in = fopen (file, "r") ;
+  int op ;
+
+  if (!in)
+  {
+    perror (file) ;
+    exit (1) ;
+  }
+  while (fgets (buffer, sizeof (buffer), in))
+  {
+    line++ ;
+    if ((f = strchr (buffer, '#')))
+      *f = 0 ;
+    if (!(f = strtok (buffer, " \t\n")))
+      continue ;
+
+    if (c && !strcmp (f, "end"))
+    {
+      if (!c->nsteps)
+        syntax ("populacao sem passos") ;
+      c = NULL ;
+    }
+    else if (c)
+    {
+      // passo da populacao corrente
+      for (op = 0; ops[op] && strcmp (ops[op], f); op++) ;
+      if (!ops[op] || c->nsteps == MAXSTEPS)
+        syntax ("passo invalido") ;
+      s = &c->steps[c->nsteps++] ;
+      s->op = op ;
+      if (op == STEP_LOCK || op == STEP_DOWN || op == STEP_UP)
+        s->res = resource (sems, nsems) ;
+      if (op == STEP_SEND || op == STEP_RECV)
+        s->res = resource (mqueues, nmqueues) ;
+      if (op == STEP_CPU || op == STEP_SLEEP || op == STEP_LOCK || op == STEP_READ ||
+          op == STEP_WRITE)
+        distribution (&s->dist) ;
+      if ((op == STEP_READ || op == STEP_WRITE) && !diskBlocks)
+        syntax ("E/S sem disco (diretiva disk)") ;
+    }
+    else if (!strcmp (f, "duration"))
+      duration = number () ;
+    else if (!strcmp (f, "seed"))
+      seed = number () ;
+    else if (!strcmp (f, "disk"))
+    {
+      disk_config_t cfg ;
+      int numblocks, blocksize ;
+
+      diskBlocks = number () ;
+      f = field () ;
+      disk_config_init (&cfg) ;
+      if (f && !strcmp (f, "ssd"))
+        disk_config_profile (&cfg, DISK_PROFILE_SSD) ;
+      else
+      {
+        cfg.seek_min_us = 200 ;
+        cfg.seek_max_us = 4000 ;
+        cfg.jitter_us = 200 ;
+        cfg.xfer_rate = 6400000 ;
+      }
+      strcpy (cfg.image, "load-disk.dat") ;
+      cfg.numblocks = diskBlocks ;
+      cfg.blocksize = BLOCKSIZE ;
+      if (diskBlocks < DISK_VEC_MAX || disk_dev_config (0, &cfg) < 0 ||
+          disk_dev_mgr_init (0, &numblocks, &blocksize) < 0)
+        syntax ("erro na criacao do disco") ;
+    }
+    else if (!strcmp (f, "sem") && nsems < MAXRES)
+    {
+      strncpy (sems[nsems].name, field () ? : "", NAMESIZE - 1) ;
+      sem_create (&sems[nsems++].sem, number ()) ;
+    }
+    else if (!strcmp (f, "mqueue") && nmqueues < MAXRES)
+    {
+      strncpy (mqueues[nmqueues].name, field () ? : "", NAMESIZE - 1) ;
+      op = number () ;
+      mqueues[nmqueues].size = number () ;
+      if (op < 1 || mqueues[nmqueues].size < 1)
+        syntax ("fila invalida") ;
+      mqueue_create (&mqueues[nmqueues].mq, op, mqueues[nmqueues].size) ;
+      nmqueues++ ;
+    }
+    else if (!strcmp (f, "class") && nclasses < MAXCLASSES)
+    {
+      c = &classes[nclasses++] ;
+      strncpy (c->name, field () ? : "", NAMESIZE - 1) ;
+      c->count = number () ;
+      c->prio = number () ;
+      if ((f = field ()))
+      {
+        if (strcmp (f, "slo"))
+          syntax ("slo esperado") ;
+        c->sloPct = number () ;
+        c->sloMs = number () ;
+      }
+      if (c->count < 1 || c->prio < -20 || c->prio > 20)
+        syntax ("populacao invalida") ;
+    }
+    else
+      syntax ("diretiva invalida") ;
+  }
+  if (c)
+    syntax ("populacao sem end") ;
+  fclose (in) ;
+}
+
+int main (int argc, char *argv[])
+{
+  ppos_stats_t sys ;
+  unsigned long long start, p ;
+  class_t *c ;
+  double elapsed ;
+  int i, j, met = 0, slos = 0 ;
+
+  if (argc != 2)
+  {
+    fprintf (stderr, "uso: %s especificacao\n", argv[0]) ;
+    exit (1) ;
+  }
+
+  ppos_init () ;
+  parse (argv[1]) ;
+  srandom (seed) ;
+
+  // cria as populacoes e deixa a carga correr
+  start = now_ns () ;
+  for (i = 0; i < nclasses; i++)
+  {
+    c = &classes[i] ;
+    c->tasks = malloc (c->count * sizeof (task_t)) ;
+    for (j = 0; j < c->count; j++)
+    {
+      task_create (&c->tasks[j], body, c) ;
+      task_setprio (&c->tasks[j], c->prio) ;
+    }
+  }
+  task_setprio (NULL, -20) ;
+  task_sleep (duration) ;
+  stop = 1 ;
+  elapsed = (now_ns () - start) / 1e9 ;
+
+  printf ("%-12s %6s %5s %10s %9s %9s %9s %9s %9s  %s\n", "populacao", "tarefas", "prio",
+          "transacoes", "tx/s", "p50 ms", "p99 ms", "p99.9 ms", "max ms", "SLO") ;
+  for (i = 0; i < nclasses; i++)
+  {
+    c = &classes[i] ;
+    printf ("%-12s %6d %5d %10llu %9.1f %9.2f %9.2f %9.2f %9.2f  ", c->name, c->count, c->prio,
+            c->hist.count, c->hist.count / elapsed, lat_percentile (&c->hist, 50) / 1e6,
+            lat_percentile (&c->hist, 99) / 1e6, lat_percentile (&c->hist, 99.9) / 1e6,
+            c->hist.max / 1e6) ;
+    if (c->sloPct > 0)
+    {
+      slos++ ;
+      p = lat_percentile (&c->hist, c->sloPct) ;
+      if (c->hist.count && p <= c->sloMs * 1e6)
+        met++ ;
+      printf ("p%g <= %g ms: %s", c->sloPct, c->sloMs,
+              c->hist.count && p <= c->sloMs * 1e6 ? "ok" : "FALHOU") ;
+    }
+    else
+      printf ("-") ;
+    printf ("\n") ;
+  }
+
+  ppos_stats (&sys, NULL, 0) ;
+  printf ("%.2f s, %u tarefas, %llu trocas de contexto, %llu preempcoes; "
+          "SLO atendidos: %d de %d\n", elapsed, sys.tasks, sys.switches, sys.preemptions, met,
+          slos) ;
+
+  if (diskBlocks)
+    unlink ("load-disk.dat") ;
+
+  // as tarefas ainda bloqueadas em filas e semaforos terminam com o processo
+  exit (met == slos ? 0 : 2) ;
+}
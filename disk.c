@@ -15,6 +15,21 @@
 // O conteúdo do disco simulado é armazenado em um arquivo no sistema operacional
 // subjacente, sendo portanto preservado de uma execução para outra.
 //
+// A geometria (tamanho de bloco, imagem) e o modelo de tempo de acesso (curva
+// de busca, latência rotacional, taxa de transferência, cache de trilhas ou
+// perfil SSD) podem ser ajustados antes da inicialização com disk_config()
+// ou pela variável de ambiente PPOS_DISK (veja disk.h).
+//
+// Podem ser simulados até DISK_MAX_DEVICES discos, cada um com sua imagem,
+// seu timer e sua configuração; o sinal SIGUSR1 de conclusão informa o número
+// do disco em si_value (veja disk.h).
+//
+// Além da simulação por timer, um disco pode usar o backend nativo: as
+// operações são feitas com preadv/pwritev sobre o arquivo ou dispositivo de
+// blocos por um conjunto de threads auxiliares, com várias operações em
+// andamento ao mesmo tempo. As threads não tocam nas estruturas do núcleo:
+// apenas registram a conclusão e geram o SIGUSR1.
+//
 // Atencao: deve ser usado o flag de ligacao -lrt, para ligar com a 
 // biblioteca POSIX de tempo real, pois o disco simulado usa timers POSIX.
 
@@ -27,74 +42,278 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 #include <time.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <pthread.h>
 #include "disk.h"
 
-// parâmetros de operação do disco simulado
-#define DISK_NAME       "disk.dat"	// arquivo com o conteúdo do disco
+// parâmetros de operação padrão do disco simulado (perfil HDD)
+#define DISK_NAME       "disk.dat"	// arquivo com o conteúdo do disco 0
+#define DISK_NAME_DEV   "disk%d.dat"	// arquivo com o conteúdo dos demais discos
 #define DISK_BLOCK_SIZE  64		// tamanho de cada bloco, em bytes
-#define DISK_DELAY_MIN   30		// atraso minimo, em milisegundos
-#define DISK_DELAY_MAX  300		// atraso maximo, em milisegundos
+#define DISK_SEEK_MIN    28000		// busca minima, em microsegundos
+#define DISK_SEEK_MAX   298000		// busca de curso completo, em microsegundos
+#define DISK_JITTER      27000		// fator aleatorio maximo, em microsegundos
+#define DISK_XFER_RATE   32000		// taxa de transferencia, em bytes/s
+#define DISK_TRACK_BLOCKS   16		// blocos por trilha
+#define DISK_CACHE_US     1000		// atendimento pelo cache de trilhas, em us
+
+// parâmetros padrão do perfil SSD
+#define SSD_LATENCY        100		// latencia por operacao, em microsegundos
+#define SSD_JITTER          20		// fator aleatorio maximo, em microsegundos
+#define SSD_XFER_RATE  200000000	// taxa de transferencia, em bytes/s
+
+// parâmetros padrão do backend nativo
+#define NATIVE_THREADS       4		// threads auxiliares de E/S
+#define NATIVE_QDEPTH       32		// operacoes simultaneas
+
+#define DISK_BLOCK_MAX  (1 << 20)	// maior tamanho de bloco aceito
+#define DISK_THREADS_MAX    64		// maior numero de threads auxiliares
 
 //#define DEBUG_DISK 1			// para depurar a operação do disco
 
 /**********************************************************************/
 
+// operacao de leitura/escrita na fila de um disco
+typedef struct {
+  int cmd ;			// DISK_CMD_READV ou DISK_CMD_WRITEV
+  int block ;			// bloco inicial
+  int nblocks ;			// numero de blocos
+  struct iovec vec[DISK_VEC_MAX] ; // buffers da operacao
+  int tag ;			// identificador informado por disk_dev_queue
+  int queued ;			// 1 = conclusao deve ser coletada (disk_dev_reap)
+  int busy ;			// posicao ocupada
+} disk_op_t ;
+
+// conclusao de operacao aguardando coleta
+typedef struct {
+  int tag ;			// identificador da operacao
+  int result ;			// 0 (sucesso) ou -1 (erro)
+} disk_done_t ;
+
 // estrutura com os dados internos do disco (estado inicial desconhecido)
 typedef struct {
   int status ;			// estado do disco
+  int dev ;			// numero do disco
   char *filename ;		// nome do arquivo que simula o disco
   int fd ;			// descritor do arquivo que simula o disco
   int numblocks ;		// numero de blocos do disco
   int blocksize ;		// tamanho dos blocos em bytes
-  char *buffer ;		// buffer da proxima operacao (read/write)
+  struct iovec vec[DISK_VEC_MAX] ; // buffers da proxima operacao (read/write)
+  int nblocks ;			// numero de blocos da proxima operacao
   int prev_block ;		// bloco da ultima operacao
   int next_block ;		// bloco da proxima operacao
-  int delay_min, delay_max ;	// tempos de acesso mínimo e máximo
+  int delay_min, delay_max ;	// tempos de acesso mínimo e máximo (ms)
+  int delay_block ;		// tempo de transferencia por bloco (ms)
+  disk_config_t config ;	// geometria e modelo de tempo do disco
+  int *cache ;			// trilhas presentes no cache (-1 = vazio)
+  unsigned int *cache_age ;	// instante do ultimo uso de cada trilha
+  unsigned int cache_clock ;	// relogio logico do cache (LRU)
+  unsigned int cache_hits ;	// leituras atendidas pelo cache de trilhas
+  unsigned int cache_misses ;	// leituras que moveram a cabeca (com cache)
+  int configured ;		// config ja foi definida por disk_config()
   timer_t           timer ;	// timer que simula o tempo de acesso
   struct itimerspec delay ;	// struct do timer de tempo de acesso
   struct sigevent   sigev ;	// evento associado ao timer
-  struct sigaction  signal ;	// tratador de sinal do timer
+  int depth ;			// operacoes aceitas ao mesmo tempo
+  int outstanding ;		// operacoes em andamento ou nao coletadas
+  int tag, queued ;		// operacao pendente da simulacao (ver disk_op_t)
+  disk_done_t done[DISK_QDEPTH_MAX] ; // conclusoes a coletar (fila circular)
+  int done_head, done_count ;	// inicio e tamanho da fila de conclusoes
+  pthread_mutex_t lock ;	// protege as filas de operacoes e conclusoes
+  disk_op_t ops[DISK_QDEPTH_MAX] ; // operacoes do backend nativo
+  int pending[DISK_QDEPTH_MAX] ; // operacoes aguardando uma thread (circular)
+  int pending_head, pending_count ; // inicio e tamanho da fila de pendentes
+  pthread_cond_t work ;		// threads aguardam operacoes pendentes
+  unsigned int rand_state ;	// gerador aleatorio do modo de simulacao
+  unsigned long long due ;	// termino da operacao no tempo virtual (ns)
 } disk_t ;
 
 // should be static to avoid clash with "disk" variables in other files
-static disk_t disk ;			// hard disk structure
+static disk_t disks[DISK_MAX_DEVICES] ;	// hard disk structures
+static struct sigaction disk_signal ;	// tratador de sinal dos timers
+static int disk_signal_set = 0 ;	// tratador de sinal ja registrado
+
+// modo de simulacao em tempo virtual (disk_sim_start)
+static int disk_sim = 0 ;			// tempo virtual ligado
+static unsigned int disk_sim_seed ;		// semente dos geradores dos discos
+static unsigned long long (*disk_sim_clock) (void) ; // relogio virtual (ns)
+
+/**********************************************************************/
+
+// raiz quadrada inteira (evita ligar com a libm)
+static long disk_isqrt (long x)
+{
+  long r = 0, b = 1L << 30 ;
+
+  while (b > x)
+    b >>= 2 ;
+  while (b)
+  {
+    if (x >= r + b)
+    {
+      x -= r + b ;
+      r = (r >> 1) + b ;
+    }
+    else
+      r >>= 1 ;
+    b >>= 2 ;
+  }
+  return r ;
+}
+
+/**********************************************************************/
+
+// tempo de transferencia de nblocks blocos, em microsegundos
+static long disk_xfer_us (disk_t *disk, int nblocks)
+{
+  return ((long long) nblocks * disk->config.blocksize * 1000000
+          / disk->config.xfer_rate) ;
+}
+
+/**********************************************************************/
+
+// verifica se todos os blocos da proxima operacao estao no cache de trilhas;
+// se atualiza != 0, carrega as trilhas da operacao no cache (LRU)
+static int disk_cache_lookup (disk_t *disk, int atualiza)
+{
+  int track, last, i, victim, hit = 1 ;
+
+  if (disk->config.cache_tracks <= 0)
+    return 0 ;
+
+  last = (disk->next_block + disk->nblocks - 1) / disk->config.track_blocks ;
+  for (track = disk->next_block / disk->config.track_blocks; track <= last; track++)
+  {
+    victim = 0 ;
+    for (i = 0; i < disk->config.cache_tracks; i++)
+    {
+      if (disk->cache[i] == track)
+        break ;
+      if (disk->cache_age[i] < disk->cache_age[victim])
+        victim = i ;
+    }
+    if (i == disk->config.cache_tracks)
+    {
+      hit = 0 ;
+      if (!atualiza)
+        continue ;
+      i = victim ;
+      disk->cache[i] = track ;
+    }
+    if (atualiza)
+      disk->cache_age[i] = ++disk->cache_clock ;
+  }
+  return hit ;
+}
+
+/**********************************************************************/
+
+// fator aleatorio do tempo de atendimento; no modo de simulacao, cada disco
+// usa seu proprio gerador, para que a sequencia dependa apenas da semente
+static long disk_random (disk_t *disk)
+{
+  if (disk_sim)
+    return rand_r (&disk->rand_state) ;
+  return random () ;
+}
+
+/**********************************************************************/
+
+// calcula o tempo de atendimento da proxima operacao, em microsegundos
+static long disk_service_us (disk_t *disk)
+{
+  disk_config_t *cfg = &disk->config ;
+  long dist, time_us ;
+
+  if (cfg->profile == DISK_PROFILE_SSD)
+  {
+    // latencia uniforme, independente da posicao do bloco
+    time_us = cfg->latency_us ;
+  }
+  else if (disk->status == DISK_STATUS_READ && disk_cache_lookup (disk, 0))
+  {
+    // leitura atendida pelo cache de trilhas: nao move a cabeca
+    time_us = cfg->cache_us ;
+    disk->cache_hits++ ;
+  }
+  else
+  {
+    if (disk->status == DISK_STATUS_READ && cfg->cache_tracks > 0)
+      disk->cache_misses++ ;
+
+    // tempo de busca proporcional a distancia entre o proximo bloco a ler
+    // (next_block) e a ultima leitura (prev_block), linear ou raiz quadrada
+    dist = abs (disk->next_block - disk->prev_block) ;
+    if (cfg->seek_curve == DISK_SEEK_SQRT)
+      time_us = (long) (cfg->seek_max_us - cfg->seek_min_us)
+              * disk_isqrt (dist * 1000000 / disk->numblocks) / 1000 ;
+    else
+      time_us = (long) (cfg->seek_max_us - cfg->seek_min_us)
+              * dist / disk->numblocks ;
+    time_us += cfg->seek_min_us ;
+
+    // latencia rotacional: espera o setor passar sob a cabeca
+    if (cfg->rpm > 0)
+      time_us += disk_random (disk) % (60000000L / cfg->rpm) ;
+
+    // a cabeca termina no ultimo bloco transferido
+    disk->prev_block = disk->next_block + disk->nblocks - 1 ;
+  }
+
+  // somado a um pequeno fator aleatorio e ao tempo de transferencia
+  if (cfg->jitter_us > 0)
+    time_us += disk_random (disk) % cfg->jitter_us ;
+  time_us += disk_xfer_us (disk, disk->nblocks) ;
+
+  // operacoes passam pelo cache de trilhas do disco
+  disk_cache_lookup (disk, 1) ;
+
+  return (time_us > 0 ? time_us : 1) ;
+}
 
 /**********************************************************************/
 
 // arma o timer que simula o tempo de acesso ao disco;
 // ao disparar, ele gera um sinal SIGIO
-static void disk_settimer ()
+static void disk_settimer (disk_t *disk)
 {
-  int time_ms ;
+  long time_us ;
 
-  // tempo no intervalo [DISK_DELAY_MIN ... DISK_DELAY_MAX], proporcional a
-  // distancia entre o proximo bloco a ler (next_block) e a ultima leitura
-  // (prev_block), somado a um pequeno fator aleatorio
-  time_ms = abs (disk.next_block - disk.prev_block)
-          * (disk.delay_max - disk.delay_min) / disk.numblocks
-          + disk.delay_min
-          + random () % (disk.delay_max - disk.delay_min) / 10 ;
+  #ifdef DEBUG_DISK
+  int prev = disk->prev_block ;
+  #endif
+
+  time_us = disk_service_us (disk) ;
 
   #ifdef DEBUG_DISK
-  printf ("DISK: [%d->%d, %d]\n", disk.prev_block, disk.next_block, time_ms) ;
+  printf ("DISK%d: [%d->%d (%d), %ld us]\n", disk->dev, prev, disk->next_block,
+          disk->nblocks, time_us) ;
   #endif
 
+  // tempo virtual: a operacao termina quando o nucleo chegar a esse instante
+  if (disk_sim)
+  {
+    disk->due = disk_sim_clock () + time_us * 1000ULL ;
+    return ;
+  }
+
   // primeiro disparo, em nano-segundos,
-  disk.delay.it_value.tv_nsec = time_ms * 1000000 ;
+  disk->delay.it_value.tv_nsec = (time_us % 1000000) * 1000 ;
 
   // primeiro disparo, em segundos
-  disk.delay.it_value.tv_sec  = time_ms / 1000 ;
+  disk->delay.it_value.tv_sec  = time_us / 1000000 ;
 
   // proximos disparos nao ocorrem (disparo unico)
-  disk.delay.it_interval.tv_nsec = 0 ;
-  disk.delay.it_interval.tv_sec  = 0 ;
+  disk->delay.it_interval.tv_nsec = 0 ;
+  disk->delay.it_interval.tv_sec  = 0 ;
 
   // arma o timer
-  if (timer_settime(disk.timer, 0, &disk.delay, NULL) == -1)
+  if (timer_settime(disk->timer, 0, &disk->delay, NULL) == -1)
   {
      perror("DISK:");
      exit(1);
@@ -106,26 +325,78 @@ static void disk_settimer ()
 
 /**********************************************************************/
 
-// trata o sinal SIGIO do timer que simula o tempo de acesso ao disco
-static void disk_sighandle (int sig)
+// Protecao das filas de um disco: no processo do nucleo, o mutex eh tomado
+// com SIGALRM, SIGUSR1 e SIGIO bloqueados, para que nenhum tratador de sinal
+// (nem a preempcao de tarefas) ocorra enquanto o mutex estiver ocupado.
+
+static void disk_lock (disk_t *disk, sigset_t *old)
 {
-  #ifdef DEBUG_DISK
-  printf ("DISK: signal %d received\n", sig) ;
-  #endif
+  sigset_t set ;
+
+  sigemptyset (&set) ;
+  sigaddset (&set, SIGALRM) ;
+  sigaddset (&set, SIGUSR1) ;
+  sigaddset (&set, SIGIO) ;
+  pthread_sigmask (SIG_BLOCK, &set, old) ;
+  pthread_mutex_lock (&disk->lock) ;
+}
+
+static void disk_unlock (disk_t *disk, sigset_t *old)
+{
+  pthread_mutex_unlock (&disk->lock) ;
+  pthread_sigmask (SIG_SETMASK, old, NULL) ;
+}
+
+/**********************************************************************/
+
+// registra a conclusao de uma operacao (com o mutex do disco tomado):
+// operacoes enviadas por disk_dev_queue aguardam coleta, as demais saem
+static void disk_done (disk_t *disk, int queued, int tag, int result)
+{
+  disk_done_t *done ;
+
+  if (queued)
+  {
+    done = &disk->done[(disk->done_head + disk->done_count) % DISK_QDEPTH_MAX] ;
+    done->tag = tag ;
+    done->result = result ;
+    disk->done_count++ ;
+  }
+  else
+    disk->outstanding-- ;
+}
+
+/**********************************************************************/
+
+// gera um sinal SIGUSR1 para o "kernel" do usuario, indicando o disco
+static void disk_notify (disk_t *disk)
+{
+  union sigval value ;
+
+  value.sival_int = disk->dev ;
+  sigqueue (getpid (), SIGUSR1, value) ;
+}
+
+/**********************************************************************/
+
+// realiza a operacao pendente de um disco cujo timer disparou
+static void disk_complete (disk_t *disk)
+{
+  ssize_t bytes = -1 ;
 
   // verificar qual a operacao pendente e realiza-la
-  switch (disk.status)
+  switch (disk->status)
   {
     case DISK_STATUS_READ:
       // faz a leitura previamente agendada
-      lseek (disk.fd, disk.next_block * disk.blocksize, SEEK_SET) ;
-      read  (disk.fd, disk.buffer, disk.blocksize) ;
+      lseek (disk->fd, (off_t) disk->next_block * disk->blocksize, SEEK_SET) ;
+      bytes = readv (disk->fd, disk->vec, disk->nblocks) ;
       break ;
 
     case DISK_STATUS_WRITE:
       // faz a escrita previamente agendada
-      lseek (disk.fd, disk.next_block * disk.blocksize, SEEK_SET) ;
-      write (disk.fd, disk.buffer, disk.blocksize) ;
+      lseek (disk->fd, (off_t) disk->next_block * disk->blocksize, SEEK_SET) ;
+      bytes = writev (disk->fd, disk->vec, disk->nblocks) ;
       break ;
 
     default:
@@ -134,64 +405,514 @@ static void disk_sighandle (int sig)
       exit(1);
   }
 
-  // guarda numero de bloco da ultima operacao
-  disk.prev_block = disk.next_block ;
+  // disco se torna ocioso novamente; o nucleo nunca tem o mutex tomado
+  // aqui, pois ele bloqueia SIGIO enquanto o segura
+  disk->status = DISK_STATUS_IDLE ;
+  pthread_mutex_lock (&disk->lock) ;
+  disk_done (disk, disk->queued, disk->tag,
+             (bytes == (ssize_t) disk->nblocks * disk->blocksize) ? 0 : -1) ;
+  pthread_mutex_unlock (&disk->lock) ;
 
-  // disco se torna ocioso novamente
-  disk.status = DISK_STATUS_IDLE ;
+  disk_notify (disk) ;
+}
 
-  // gerar um sinal SIGUSR1 para o "kernel" do usuario
-  raise (SIGUSR1) ;
+/**********************************************************************/
+
+// thread auxiliar do backend nativo: executa as operacoes pendentes
+static void *disk_worker (void *arg)
+{
+  disk_t *disk = arg ;
+  disk_op_t *op ;
+  struct timespec delay ;
+  ssize_t bytes ;
+  off_t offset ;
+  int slot, result ;
+
+  while (1)
+  {
+    // aguarda uma operacao pendente
+    pthread_mutex_lock (&disk->lock) ;
+    while (!disk->pending_count)
+      pthread_cond_wait (&disk->work, &disk->lock) ;
+    slot = disk->pending[disk->pending_head] ;
+    disk->pending_head = (disk->pending_head + 1) % DISK_QDEPTH_MAX ;
+    disk->pending_count-- ;
+    pthread_mutex_unlock (&disk->lock) ;
+
+    op = &disk->ops[slot] ;
+
+    // latencia artificial, para testes
+    if (disk->config.latency_us > 0)
+    {
+      delay.tv_sec = disk->config.latency_us / 1000000 ;
+      delay.tv_nsec = (disk->config.latency_us % 1000000) * 1000L ;
+      nanosleep (&delay, NULL) ;
+    }
+
+    offset = (off_t) op->block * disk->blocksize ;
+    if (op->cmd == DISK_CMD_READV)
+      bytes = preadv (disk->fd, op->vec, op->nblocks, offset) ;
+    else
+      bytes = pwritev (disk->fd, op->vec, op->nblocks, offset) ;
+    result = (bytes == (ssize_t) op->nblocks * disk->blocksize) ? 0 : -1 ;
+
+    #ifdef DEBUG_DISK
+    printf ("DISK%d: native %d [%d (%d)] done: %d\n", disk->dev, op->cmd,
+            op->block, op->nblocks, result) ;
+    #endif
+
+    // registra a conclusao e libera a posicao da operacao
+    pthread_mutex_lock (&disk->lock) ;
+    disk_done (disk, op->queued, op->tag, result) ;
+    op->busy = 0 ;
+    pthread_mutex_unlock (&disk->lock) ;
+
+    disk_notify (disk) ;
+  }
+
+  return NULL ;
+}
+
+/**********************************************************************/
+
+// trata o sinal SIGIO dos timers que simulam o tempo de acesso aos discos
+static void disk_sighandle (int sig, siginfo_t *info, void *context)
+{
+  struct itimerspec left ;
+  disk_t *disk ;
+  int dev ;
+
+  #ifdef DEBUG_DISK
+  printf ("DISK: signal %d received (disk %d)\n", sig, info->si_value.sival_int) ;
+  #endif
+
+  // sinais SIGIO de timers diferentes podem se fundir em um so; por isso
+  // todos os discos ocupados cujo timer ja venceu sao atendidos
+  for (dev = 0; dev < DISK_MAX_DEVICES; dev++)
+  {
+    disk = &disks[dev] ;
+    if (disk->config.backend != DISK_BACKEND_SIM)
+      continue ;
+    if (disk->status != DISK_STATUS_READ && disk->status != DISK_STATUS_WRITE)
+      continue ;
+    if (timer_gettime (disk->timer, &left) == 0 &&
+        (left.it_value.tv_sec || left.it_value.tv_nsec))
+      continue ;
+    disk_complete (disk) ;
+  }
+}
+
+/**********************************************************************/
+
+// liga o modo de simulacao em tempo virtual
+void disk_sim_start (unsigned int seed, unsigned long long (*clock) (void))
+{
+  disk_sim = 1 ;
+  disk_sim_seed = seed ;
+  disk_sim_clock = clock ;
+}
+
+// instante virtual da proxima conclusao
+int disk_sim_next (unsigned long long *due)
+{
+  disk_t *disk ;
+  int dev, i, found = 0 ;
+
+  if (!disk_sim || !due)
+    return -1 ;
+
+  for (dev = 0; dev < DISK_MAX_DEVICES; dev++)
+  {
+    disk = &disks[dev] ;
+    if (disk->status == DISK_STATUS_UNKNOWN)
+      continue ;
+    if (disk->config.backend == DISK_BACKEND_NATIVE)
+    {
+      // conclusao em tempo real: nao ha para onde avancar o relogio
+      for (i = 0; i < DISK_QDEPTH_MAX; i++)
+        if (disk->ops[i].busy)
+        {
+          *due = disk_sim_clock () ;
+          return 0 ;
+        }
+      continue ;
+    }
+    if (disk->status != DISK_STATUS_READ && disk->status != DISK_STATUS_WRITE)
+      continue ;
+    if (!found || disk->due < *due)
+      *due = disk->due ;
+    found = 1 ;
+  }
+  return (found ? 0 : -1) ;
+}
+
+// conclui as operacoes vencidas no tempo virtual
+int disk_sim_run (unsigned long long now)
+{
+  disk_t *disk ;
+  int dev, count = 0 ;
+
+  if (!disk_sim)
+    return 0 ;
+
+  for (dev = 0; dev < DISK_MAX_DEVICES; dev++)
+  {
+    disk = &disks[dev] ;
+    if (disk->config.backend != DISK_BACKEND_SIM)
+      continue ;
+    if (disk->status != DISK_STATUS_READ && disk->status != DISK_STATUS_WRITE)
+      continue ;
+    if (disk->due > now)
+      continue ;
+    disk_complete (disk) ;
+    count++ ;
+  }
+  return count ;
 }
 
 /**********************************************************************/
 
-// inicializa o disco virtual
+// preenche a configuracao com os parametros padrao de um perfil
+void disk_config_profile (disk_config_t *cfg, int profile)
+{
+  cfg->profile = profile ;
+  cfg->seek_curve = DISK_SEEK_LINEAR ;
+  cfg->rpm = 0 ;
+  cfg->track_blocks = DISK_TRACK_BLOCKS ;
+  cfg->cache_tracks = 0 ;
+  cfg->cache_us = DISK_CACHE_US ;
+
+  if (profile == DISK_PROFILE_SSD)
+  {
+    cfg->seek_min_us = cfg->seek_max_us = 0 ;
+    cfg->latency_us = SSD_LATENCY ;
+    cfg->jitter_us = SSD_JITTER ;
+    cfg->xfer_rate = SSD_XFER_RATE ;
+  }
+  else
+  {
+    cfg->seek_min_us = DISK_SEEK_MIN ;
+    cfg->seek_max_us = DISK_SEEK_MAX ;
+    cfg->latency_us = 0 ;
+    cfg->jitter_us = DISK_JITTER ;
+    cfg->xfer_rate = DISK_XFER_RATE ;
+  }
+}
+
+/**********************************************************************/
+
+// preenche a configuracao com os parametros padrao do disco simulado
+void disk_config_init (disk_config_t *cfg)
+{
+  memset (cfg, 0, sizeof (disk_config_t)) ;
+  strncpy (cfg->image, DISK_NAME, DISK_PATH_MAX - 1) ;
+  cfg->blocksize = DISK_BLOCK_SIZE ;
+  cfg->numblocks = 0 ;
+  cfg->backend = DISK_BACKEND_SIM ;
+  cfg->threads = NATIVE_THREADS ;
+  cfg->qdepth = NATIVE_QDEPTH ;
+  cfg->sync = 1 ;
+  disk_config_profile (cfg, DISK_PROFILE_HDD) ;
+}
+
+/**********************************************************************/
+
+// verifica se uma configuracao eh valida
+static int disk_config_check (const disk_config_t *cfg)
+{
+  if (cfg->image[0] == 0)
+    return -1 ;
+  if (cfg->blocksize < 1 || cfg->blocksize > DISK_BLOCK_MAX)
+    return -1 ;
+  if (cfg->numblocks < 0 || cfg->xfer_rate <= 0 || cfg->track_blocks <= 0)
+    return -1 ;
+  if (cfg->seek_min_us < 0 || cfg->seek_max_us < cfg->seek_min_us)
+    return -1 ;
+  if (cfg->latency_us < 0 || cfg->jitter_us < 0 || cfg->cache_us < 0)
+    return -1 ;
+  if (cfg->rpm < 0 || cfg->cache_tracks < 0)
+    return -1 ;
+  if (cfg->backend != DISK_BACKEND_SIM && cfg->backend != DISK_BACKEND_NATIVE)
+    return -1 ;
+  if (cfg->threads < 1 || cfg->threads > DISK_THREADS_MAX)
+    return -1 ;
+  if (cfg->qdepth < 1 || cfg->qdepth > DISK_QDEPTH_MAX)
+    return -1 ;
+  return 0 ;
+}
+
+/**********************************************************************/
+
+// ajusta um parametro da configuracao a partir de um par nome=valor
+static int disk_config_param (disk_config_t *cfg, char *name, char *value)
+{
+  if (!strcmp (name, "image"))
+    strncpy (cfg->image, value, DISK_PATH_MAX - 1) ;
+  else if (!strcmp (name, "profile"))
+    ; // tratado antes dos demais parametros
+  else if (!strcmp (name, "seek_curve"))
+    cfg->seek_curve = strcmp (value, "sqrt") ? DISK_SEEK_LINEAR : DISK_SEEK_SQRT ;
+  else if (!strcmp (name, "blocksize"))
+    cfg->blocksize = atoi (value) ;
+  else if (!strcmp (name, "numblocks"))
+    cfg->numblocks = atoi (value) ;
+  else if (!strcmp (name, "seek_min_us"))
+    cfg->seek_min_us = atoi (value) ;
+  else if (!strcmp (name, "seek_max_us"))
+    cfg->seek_max_us = atoi (value) ;
+  else if (!strcmp (name, "rpm"))
+    cfg->rpm = atoi (value) ;
+  else if (!strcmp (name, "xfer_rate"))
+    cfg->xfer_rate = atol (value) ;
+  else if (!strcmp (name, "track_blocks"))
+    cfg->track_blocks = atoi (value) ;
+  else if (!strcmp (name, "cache_tracks"))
+    cfg->cache_tracks = atoi (value) ;
+  else if (!strcmp (name, "cache_us"))
+    cfg->cache_us = atoi (value) ;
+  else if (!strcmp (name, "latency_us"))
+    cfg->latency_us = atoi (value) ;
+  else if (!strcmp (name, "jitter_us"))
+    cfg->jitter_us = atoi (value) ;
+  else if (!strcmp (name, "backend"))
+    cfg->backend = strcmp (value, "native") ? DISK_BACKEND_SIM : DISK_BACKEND_NATIVE ;
+  else if (!strcmp (name, "threads"))
+    cfg->threads = atoi (value) ;
+  else if (!strcmp (name, "qdepth"))
+    cfg->qdepth = atoi (value) ;
+  else if (!strcmp (name, "sync"))
+    cfg->sync = atoi (value) ;
+  else
+    return -1 ;
+  return 0 ;
+}
+
+/**********************************************************************/
+
+// aplica a variavel de ambiente PPOS_DISK (disco 0) ou PPOS_DISK<dev> sobre
+// a configuracao, no formato "nome=valor,nome=valor,..."; o perfil eh
+// aplicado antes dos demais
+static void disk_config_env (disk_config_t *cfg, int dev)
+{
+  char name[32], *env, *str, *item, *value, *save ;
+  int pass ;
+
+  if (dev)
+    snprintf (name, sizeof (name), DISK_ENV "%d", dev) ;
+  else
+    snprintf (name, sizeof (name), DISK_ENV) ;
+  env = getenv (name) ;
+  if (!env)
+    return ;
+
+  for (pass = 0; pass < 2; pass++)
+  {
+    str = strdup (env) ;
+    for (item = strtok_r (str, ",", &save); item; item = strtok_r (NULL, ",", &save))
+    {
+      value = strchr (item, '=') ;
+      if (!value)
+      {
+        if (pass)
+          fprintf (stderr, "DISK: bad %s item \"%s\"\n", name, item) ;
+        continue ;
+      }
+      *value++ = 0 ;
+      if (pass == 0)
+      {
+        if (!strcmp (item, "profile"))
+          disk_config_profile (cfg, strcmp (value, "ssd") ? DISK_PROFILE_HDD
+                                                           : DISK_PROFILE_SSD) ;
+      }
+      else if (disk_config_param (cfg, item, value))
+        fprintf (stderr, "DISK: unknown %s parameter \"%s\"\n", name, item) ;
+    }
+    free (str) ;
+  }
+}
+
+/**********************************************************************/
+
+// define a configuracao usada na inicializacao de um disco
+// retorno: 0 (sucesso) ou -1 (erro)
+int disk_dev_config (int dev, const disk_config_t *cfg)
+{
+  disk_t *disk ;
+
+  if ( dev < 0 || dev >= DISK_MAX_DEVICES || !cfg )
+    return -1 ;
+  disk = &disks[dev] ;
+  if ( disk->status != DISK_STATUS_UNKNOWN )
+    return -1 ;
+  if ( disk_config_check (cfg) )
+    return -1 ;
+
+  disk->config = *cfg ;
+  disk->configured = 1 ;
+  return 0 ;
+}
+
+/**********************************************************************/
+
+// define a configuracao usada na inicializacao do disco 0
+int disk_config (const disk_config_t *cfg)
+{
+  return (disk_dev_config (0, cfg)) ;
+}
+
+/**********************************************************************/
+
+// inicializa um disco virtual
 // retorno: 0 (sucesso) ou -1 (erro)
-static int disk_init ()
+static int disk_init (disk_t *disk)
 {
+  disk_config_t *cfg = &disk->config ;
+  sigset_t all, old ;
+  pthread_t thread ;
+  off_t size ;
+  int i, flags ;
+
   // o disco jah foi inicializado ?
-  if ( disk.status != DISK_STATUS_UNKNOWN )
+  if ( disk->status != DISK_STATUS_UNKNOWN )
     return -1 ;
 
-  // estado atual do disco
-  disk.status = DISK_STATUS_IDLE ;
-  disk.next_block = disk.prev_block = 0 ;
+  // configuracao: padrao ou disk_config(), ajustada pelo ambiente
+  if (!disk->configured)
+  {
+    disk_config_init (cfg) ;
+    if (disk->dev)
+      snprintf (cfg->image, DISK_PATH_MAX, DISK_NAME_DEV, disk->dev) ;
+  }
+  disk_config_env (cfg, disk->dev) ;
+  if (disk_config_check (cfg))
+  {
+    fprintf (stderr, "DISK: invalid configuration\n") ;
+    return -1 ;
+  }
 
-  // abre o arquivo no disco (leitura/escrita, sincrono)
-  disk.filename = DISK_NAME ;
-  disk.fd = open (disk.filename, O_RDWR|O_SYNC) ;
-  if (disk.fd < 0)
+  // abre o arquivo no disco (leitura/escrita, sincrono se configurado);
+  // se o tamanho foi definido, a imagem eh criada ou estendida
+  disk->filename = cfg->image ;
+  flags = O_RDWR | (cfg->sync ? O_SYNC : 0) ;
+  if (cfg->numblocks > 0)
+    disk->fd = open (disk->filename, flags|O_CREAT, 0644) ;
+  else
+    disk->fd = open (disk->filename, flags) ;
+  if (disk->fd < 0)
   {
-    perror("DISK: " DISK_NAME);
+    fprintf (stderr, "DISK: %s: ", disk->filename) ;
+    perror (NULL) ;
     exit (1) ;
   }
 
   // define seu tamanho em blocos
-  disk.blocksize = DISK_BLOCK_SIZE ;
-  disk.numblocks = lseek (disk.fd, 0, SEEK_END) / disk.blocksize ;
+  disk->blocksize = cfg->blocksize ;
+  size = lseek (disk->fd, 0, SEEK_END) ;
+  if (cfg->numblocks > 0)
+  {
+    if (size < (off_t) cfg->numblocks * disk->blocksize &&
+        ftruncate (disk->fd, (off_t) cfg->numblocks * disk->blocksize) < 0)
+    {
+      perror ("DISK: ftruncate") ;
+      exit (1) ;
+    }
+    disk->numblocks = cfg->numblocks ;
+  }
+  else
+    disk->numblocks = size / disk->blocksize ;
+  if (disk->numblocks <= 0)
+  {
+    fprintf (stderr, "DISK: %s: empty disk image\n", disk->filename) ;
+    return -1 ;
+  }
+
+  // estado atual do disco
+  disk->status = DISK_STATUS_IDLE ;
+  disk->next_block = disk->prev_block = 0 ;
+  disk->outstanding = disk->done_head = disk->done_count = 0 ;
+  pthread_mutex_init (&disk->lock, NULL) ;
+  disk->rand_state = disk_sim_seed + disk->dev ;
 
-  // ajusta atrasos mínimo e máximo de acesso no disco
-  disk.delay_min = DISK_DELAY_MIN ;
-  disk.delay_max = DISK_DELAY_MAX ;
+  // backend nativo: cria as threads auxiliares, com todos os sinais
+  // bloqueados (os sinais devem ser tratados pela thread do nucleo)
+  if (cfg->backend == DISK_BACKEND_NATIVE)
+  {
+    disk->depth = cfg->qdepth ;
+    disk->pending_head = disk->pending_count = 0 ;
+    pthread_cond_init (&disk->work, NULL) ;
+    disk->delay_min = disk->delay_max = cfg->latency_us / 1000 ;
+    disk->delay_block = 0 ;
+
+    sigfillset (&all) ;
+    pthread_sigmask (SIG_SETMASK, &all, &old) ;
+    for (i = 0; i < cfg->threads; i++)
+      if (pthread_create (&thread, NULL, disk_worker, disk))
+      {
+        perror ("DISK: pthread_create") ;
+        exit (1) ;
+      }
+      else
+        pthread_detach (thread) ;
+    pthread_sigmask (SIG_SETMASK, &old, NULL) ;
+
+    #ifdef DEBUG_DISK
+    printf ("DISK%d: initialized (native)\n", disk->dev) ;
+    #endif
+
+    return 0 ;
+  }
+  disk->depth = 1 ;
+
+  // cache de trilhas do disco, inicialmente vazio
+  if (cfg->cache_tracks > 0)
+  {
+    disk->cache = malloc (cfg->cache_tracks * sizeof (int)) ;
+    disk->cache_age = calloc (cfg->cache_tracks, sizeof (unsigned int)) ;
+    if (!disk->cache || !disk->cache_age)
+    {
+      perror ("DISK: cache") ;
+      exit (1) ;
+    }
+    for (i = 0; i < cfg->cache_tracks; i++)
+      disk->cache[i] = -1 ;
+  }
+
+  // atrasos mínimo e máximo de acesso no disco, em milisegundos
+  if (cfg->profile == DISK_PROFILE_SSD)
+  {
+    disk->delay_min = (cfg->latency_us + disk_xfer_us (disk, 1)) / 1000 ;
+    disk->delay_max = (cfg->latency_us + cfg->jitter_us + disk_xfer_us (disk, 1)) / 1000 ;
+  }
+  else
+  {
+    disk->delay_min = (cfg->seek_min_us + disk_xfer_us (disk, 1)) / 1000 ;
+    disk->delay_max = (cfg->seek_max_us + cfg->jitter_us + disk_xfer_us (disk, 1)
+                   + (cfg->rpm > 0 ? 60000000L / cfg->rpm : 0)) / 1000 ;
+  }
+  disk->delay_block = disk_xfer_us (disk, 1) / 1000 ;
 
-  // associa SIGIO do timer ao handle apropriado
-  disk.signal.sa_handler = disk_sighandle ;
-  sigemptyset (&disk.signal.sa_mask);
-  disk.signal.sa_flags = 0;
-  sigaction (SIGIO, &disk.signal, 0);
+  // associa SIGIO dos timers ao handle apropriado (uma vez para todos)
+  if (!disk_signal_set)
+  {
+    disk_signal.sa_sigaction = disk_sighandle ;
+    sigemptyset (&disk_signal.sa_mask);
+    disk_signal.sa_flags = SA_SIGINFO;
+    sigaction (SIGIO, &disk_signal, 0);
+    disk_signal_set = 1 ;
+  }
 
   // cria o timer que simula o tempo de acesso ao disco
-  disk.sigev.sigev_notify = SIGEV_SIGNAL;
-  disk.sigev.sigev_signo = SIGIO;
-  if (timer_create(CLOCK_REALTIME, &disk.sigev, &disk.timer) == -1)
+  disk->sigev.sigev_notify = SIGEV_SIGNAL;
+  disk->sigev.sigev_signo = SIGIO;
+  disk->sigev.sigev_value.sival_int = disk->dev;
+  if (timer_create(CLOCK_REALTIME, &disk->sigev, &disk->timer) == -1)
   {
     perror("DISK:");
     exit (1) ;
   }
 
   #ifdef DEBUG_DISK
-  printf ("DISK: initialized\n") ;
+  printf ("DISK%d: initialized\n", disk->dev) ;
   #endif
 
   return 0 ;
@@ -199,69 +920,221 @@ static int disk_init ()
 
 /**********************************************************************/
 
-// funcao que implementa a interface de acesso ao disco em baixo nivel
-int disk_cmd (int cmd, int block, void *buffer)
+// verifica os parametros de uma operacao de leitura/escrita
+// retorno: 0 (validos) ou -1 (invalidos)
+static int disk_check_op (disk_t *disk, int block, int nblocks, void **buffers)
+{
+  int i ;
+
+  if (disk->status == DISK_STATUS_UNKNOWN)
+    return -1 ;
+  if ( !buffers || nblocks < 1 || nblocks > DISK_VEC_MAX )
+    return -1 ;
+  if ( block < 0 || block + nblocks > disk->numblocks)
+    return -1 ;
+  for (i = 0; i < nblocks; i++)
+    if ( !buffers[i] )
+      return -1 ;
+  return 0 ;
+}
+
+/**********************************************************************/
+
+// entrega uma operacao as threads do backend nativo
+// retorno: 0 (sucesso) ou -1 (erro ou fila cheia)
+static int disk_native_queue (disk_t *disk, int cmd, int block, int nblocks,
+                              void **buffers, int queued, int tag)
+{
+  disk_op_t *op = NULL ;
+  sigset_t old ;
+  int i, slot ;
+
+  disk_lock (disk, &old) ;
+  if (disk->outstanding >= disk->depth)
+  {
+    disk_unlock (disk, &old) ;
+    return -1 ;
+  }
+  for (slot = 0; slot < disk->depth; slot++)
+    if (!disk->ops[slot].busy)
+    {
+      op = &disk->ops[slot] ;
+      break ;
+    }
+  if (!op)
+  {
+    disk_unlock (disk, &old) ;
+    return -1 ;
+  }
+
+  op->cmd = (cmd == DISK_CMD_READ || cmd == DISK_CMD_READV) ? DISK_CMD_READV
+                                                             : DISK_CMD_WRITEV ;
+  op->block = block ;
+  op->nblocks = nblocks ;
+  for (i = 0; i < nblocks; i++)
+  {
+    op->vec[i].iov_base = buffers[i] ;
+    op->vec[i].iov_len  = disk->blocksize ;
+  }
+  op->queued = queued ;
+  op->tag = tag ;
+  op->busy = 1 ;
+  disk->outstanding++ ;
+
+  disk->pending[(disk->pending_head + disk->pending_count) % DISK_QDEPTH_MAX] = slot ;
+  disk->pending_count++ ;
+  pthread_cond_signal (&disk->work) ;
+  disk_unlock (disk, &old) ;
+
+  return 0 ;
+}
+
+/**********************************************************************/
+
+// agenda uma operacao de leitura/escrita de nblocks blocos contiguos
+// retorno: 0 (sucesso) ou -1 (erro)
+static int disk_schedule (disk_t *disk, int cmd, int block, int nblocks,
+                          void **buffers, int queued, int tag)
+{
+  sigset_t old ;
+  int i ;
+
+  if (disk_check_op (disk, block, nblocks, buffers))
+    return -1 ;
+
+  if (disk->config.backend == DISK_BACKEND_NATIVE)
+    return (disk_native_queue (disk, cmd, block, nblocks, buffers, queued, tag)) ;
+
+  // simulacao: uma operacao por vez, coletada antes da proxima. O estado
+  // ocupado e o timer sao publicados com SIGIO bloqueado: senao o sinal de
+  // outro disco, entre os dois, encontraria este ocupado e com o timer
+  // ainda zerado, e concluiria a operacao sem atraso
+  disk_lock (disk, &old) ;
+  if (disk->status != DISK_STATUS_IDLE || disk->outstanding)
+  {
+    disk_unlock (disk, &old) ;
+    return -1 ;
+  }
+
+  // registra que ha uma operacao pendente
+  for (i = 0; i < nblocks; i++)
+  {
+    disk->vec[i].iov_base = buffers[i] ;
+    disk->vec[i].iov_len  = disk->blocksize ;
+  }
+  disk->nblocks = nblocks ;
+  disk->next_block = block ;
+  disk->queued = queued ;
+  disk->tag = tag ;
+  // toda operacao conta: disk_done() desconta as nao enfileiradas ao fim e
+  // disk_dev_reap() as enfileiradas na coleta
+  disk->outstanding = 1 ;
+  if (cmd == DISK_CMD_READ || cmd == DISK_CMD_READV)
+    disk->status = DISK_STATUS_READ ;
+  else
+    disk->status = DISK_STATUS_WRITE ;
+
+  // arma o timer que simula o atraso do disco
+  disk_settimer (disk) ;
+  disk_unlock (disk, &old) ;
+
+  return 0 ;
+}
+
+/**********************************************************************/
+
+// funcao que implementa a interface de acesso a um disco em baixo nivel
+int disk_dev_cmd (int dev, int cmd, int block, void *buffer)
 {
+  disk_t *disk ;
+
   #ifdef DEBUG_DISK
-  printf ("DISK: received command %d\n", cmd) ;
+  printf ("DISK%d: received command %d\n", dev, cmd) ;
   #endif
 
+  if (dev < 0 || dev >= DISK_MAX_DEVICES)
+    return (cmd == DISK_CMD_STATUS ? DISK_STATUS_UNKNOWN : -1) ;
+  disk = &disks[dev] ;
+
   switch (cmd)
   {
     // inicializa o disco
     case DISK_CMD_INIT:
-      return (disk_init ()) ;
+      disk->dev = dev ;
+      return (disk_init (disk)) ;
 
-    // solicita status do disco
+    // solicita status do disco (backend nativo: livre enquanto aceitar
+    // novas operacoes)
     case DISK_CMD_STATUS:
-      return (disk.status) ;
+      if (disk->status != DISK_STATUS_UNKNOWN &&
+          disk->config.backend == DISK_BACKEND_NATIVE)
+        return (disk->outstanding < disk->depth ? DISK_STATUS_IDLE
+                                                : DISK_STATUS_READ) ;
+      return (disk->status) ;
+
+    // solicita quantas operacoes o disco aceita ao mesmo tempo
+    case DISK_CMD_QDEPTH:
+      if (disk->status == DISK_STATUS_UNKNOWN)
+        return -1 ;
+      return (disk->depth) ;
 
     // solicita tamanho do disco
     case DISK_CMD_DISKSIZE:
-      if (disk.status == DISK_STATUS_UNKNOWN)
+      if (disk->status == DISK_STATUS_UNKNOWN)
         return -1 ;
-      return (disk.numblocks) ;
+      return (disk->numblocks) ;
 
     // solicita tamanho de bloco
     case DISK_CMD_BLOCKSIZE:
-      if (disk.status == DISK_STATUS_UNKNOWN)
+      if (disk->status == DISK_STATUS_UNKNOWN)
         return -1 ;
-      return (disk.blocksize) ;
+      return (disk->blocksize) ;
 
     // solicita atraso mínimo
     case DISK_CMD_DELAYMIN:
-      if (disk.status == DISK_STATUS_UNKNOWN)
+      if (disk->status == DISK_STATUS_UNKNOWN)
         return -1 ;
-      return (disk.delay_min) ;
+      return (disk->delay_min) ;
 
     // solicita atraso máximo
     case DISK_CMD_DELAYMAX:
-      if (disk.status == DISK_STATUS_UNKNOWN)
+      if (disk->status == DISK_STATUS_UNKNOWN)
+        return -1 ;
+      return (disk->delay_max) ;
+
+    // solicita tempo de transferencia por bloco
+    case DISK_CMD_DELAYBLOCK:
+      if (disk->status == DISK_STATUS_UNKNOWN)
         return -1 ;
-      return (disk.delay_max) ;
+      return (disk->delay_block) ;
 
     // solicita operação de leitura ou de escrita
     case DISK_CMD_READ:
     case DISK_CMD_WRITE:
-      if (disk.status != DISK_STATUS_IDLE)
-        return -1 ;
-      if ( !buffer )
-        return -1 ;
-      if ( block < 0 || block >= disk.numblocks)
-        return -1 ;
+      return (disk_schedule (disk, cmd, block, 1, &buffer, 0, 0)) ;
 
-      // registra que ha uma operacao pendente
-      disk.buffer = buffer ;
-      disk.next_block = block ;
-      if (cmd == DISK_CMD_READ)
-        disk.status = DISK_STATUS_READ ;
-      else
-        disk.status = DISK_STATUS_WRITE ;
+    default:
+      return -1 ;
+  }
+}
 
-      // arma o timer que simula o atraso do disco
-      disk_settimer () ;
+/**********************************************************************/
 
-      return 0 ;
+// interface vetorial: leitura/escrita de varios blocos contiguos
+int disk_dev_cmd_vec (int dev, int cmd, int block, int nblocks, void **buffers)
+{
+  #ifdef DEBUG_DISK
+  printf ("DISK%d: received vector command %d (%d blocks)\n", dev, cmd, nblocks) ;
+  #endif
+
+  if (dev < 0 || dev >= DISK_MAX_DEVICES)
+    return -1 ;
+
+  switch (cmd)
+  {
+    case DISK_CMD_READV:
+    case DISK_CMD_WRITEV:
+      return (disk_schedule (&disks[dev], cmd, block, nblocks, buffers, 0, 0)) ;
 
     default:
       return -1 ;
@@ -269,3 +1142,106 @@ int disk_cmd (int cmd, int block, void *buffer)
 }
 
 /**********************************************************************/
+
+// envia uma operacao identificada por tag a fila de comandos de um disco
+int disk_dev_queue (int dev, int cmd, int block, int nblocks, void **buffers, int tag)
+{
+  #ifdef DEBUG_DISK
+  printf ("DISK%d: queued command %d (%d blocks, tag %d)\n", dev, cmd, nblocks, tag) ;
+  #endif
+
+  if (dev < 0 || dev >= DISK_MAX_DEVICES)
+    return -1 ;
+  if (cmd != DISK_CMD_READV && cmd != DISK_CMD_WRITEV)
+    return -1 ;
+
+  return (disk_schedule (&disks[dev], cmd, block, nblocks, buffers, 1, tag)) ;
+}
+
+/**********************************************************************/
+
+// coleta uma operacao concluida da fila de comandos de um disco
+int disk_dev_reap (int dev, int *tag, int *result)
+{
+  disk_t *disk ;
+  sigset_t old ;
+  int found = 0 ;
+
+  if (dev < 0 || dev >= DISK_MAX_DEVICES || !tag || !result)
+    return -1 ;
+  disk = &disks[dev] ;
+  if (disk->status == DISK_STATUS_UNKNOWN)
+    return -1 ;
+
+  disk_lock (disk, &old) ;
+  if (disk->done_count)
+  {
+    *tag = disk->done[disk->done_head].tag ;
+    *result = disk->done[disk->done_head].result ;
+    disk->done_head = (disk->done_head + 1) % DISK_QDEPTH_MAX ;
+    disk->done_count-- ;
+    disk->outstanding-- ;
+    found = 1 ;
+  }
+  disk_unlock (disk, &old) ;
+
+  return found ;
+}
+
+/**********************************************************************/
+
+// quantidade de conclusoes de um disco aguardando coleta
+int disk_dev_done (int dev)
+{
+  disk_t *disk ;
+  sigset_t old ;
+  int count ;
+
+  if (dev < 0 || dev >= DISK_MAX_DEVICES)
+    return -1 ;
+  disk = &disks[dev] ;
+  if (disk->status == DISK_STATUS_UNKNOWN)
+    return -1 ;
+
+  disk_lock (disk, &old) ;
+  count = disk->done_count ;
+  disk_unlock (disk, &old) ;
+
+  return count ;
+}
+
+/**********************************************************************/
+
+// consulta os contadores do cache de trilhas de um disco
+int disk_dev_cache_stats (int dev, unsigned int *hits, unsigned int *misses)
+{
+  disk_t *disk ;
+
+  if (dev < 0 || dev >= DISK_MAX_DEVICES || !hits || !misses)
+    return -1 ;
+  disk = &disks[dev] ;
+  if (disk->status == DISK_STATUS_UNKNOWN)
+    return -1 ;
+
+  *hits = disk->cache_hits ;
+  *misses = disk->cache_misses ;
+  return 0 ;
+}
+
+/**********************************************************************/
+
+// interface de acesso ao disco 0
+int disk_cmd (int cmd, int block, void *buffer)
+{
+  return (disk_dev_cmd (0, cmd, block, buffer)) ;
+}
+
+/**********************************************************************/
+
+// interface vetorial de acesso ao disco 0
+int disk_cmd_vec (int cmd, int block, int nblocks, void **buffers)
+{
+  return (disk_dev_cmd_vec (0, cmd, block, nblocks, buffers)) ;
+}
+
+/**********************************************************************/
@@ -19,6 +19,19 @@
 #define DISK_CMD_BLOCKSIZE	5	// consulta tamanho de bloco em bytes
 #define DISK_CMD_DELAYMIN	6	// consulta tempo resposta mínimo (ms)
 #define DISK_CMD_DELAYMAX	7	// consulta tempo resposta máximo (ms)
+#define DISK_CMD_READV		8	// leitura de blocos contiguos do disco
+#define DISK_CMD_WRITEV		9	// escrita de blocos contiguos do disco
+#define DISK_CMD_DELAYBLOCK	10	// consulta tempo de transferencia por bloco (ms)
+#define DISK_CMD_QDEPTH		11	// consulta operacoes simultaneas aceitas
+
+// numero maximo de blocos em um comando vetorial (READV/WRITEV)
+#define DISK_VEC_MAX		64
+
+// numero maximo de discos simulados
+#define DISK_MAX_DEVICES	8
+
+// numero maximo de operacoes simultaneas na fila de comandos de um disco
+#define DISK_QDEPTH_MAX		64
 
 // estados internos do disco
 #define DISK_STATUS_UNKNOWN	0	// disco não inicializado
@@ -26,13 +39,136 @@
 #define DISK_STATUS_READ	2	// disco ocupado fazendo leitura
 #define DISK_STATUS_WRITE	3	// disco ocupado fazendo escrita
 
+// perfis de tempo de acesso do disco simulado
+#define DISK_PROFILE_HDD	0	// disco rigido: busca, rotacao e transferencia
+#define DISK_PROFILE_SSD	1	// memoria flash: latencia baixa e uniforme
+
+// curvas de tempo de busca em funcao da distancia percorrida pela cabeca
+#define DISK_SEEK_LINEAR	0	// proporcional a distancia
+#define DISK_SEEK_SQRT		1	// proporcional a raiz quadrada da distancia
+
+// implementacoes do disco
+#define DISK_BACKEND_SIM	0	// simulacao por timer, uma operacao por vez
+#define DISK_BACKEND_NATIVE	1	// preadv/pwritev em threads auxiliares,
+					// varias operacoes em andamento
+
+#define DISK_PATH_MAX		256	// tamanho maximo do nome da imagem
+#define DISK_ENV		"PPOS_DISK"	// variavel de ambiente de configuracao
+
+// geometria e modelo de tempo do disco simulado; tempos em microsegundos.
+// Perfil HDD: busca(distancia) + rotacao + fator aleatorio + transferencia;
+// leituras de trilhas presentes no cache custam cache_us + transferencia.
+// Perfil SSD: latency_us + fator aleatorio + transferencia.
+// Backend nativo: a imagem (arquivo ou dispositivo de blocos) eh acessada na
+// velocidade do sistema hospedeiro; latency_us, se > 0, eh uma latencia
+// artificial somada a cada operacao, para testes.
+typedef struct
+{
+  char image[DISK_PATH_MAX] ;	// arquivo com o conteudo do disco
+  int blocksize ;		// tamanho de cada bloco, em bytes
+  int numblocks ;		// tamanho em blocos (0 = tamanho da imagem; > 0
+				// cria ou estende a imagem ate esse tamanho)
+  int profile ;			// DISK_PROFILE_HDD ou DISK_PROFILE_SSD
+  int seek_curve ;		// DISK_SEEK_LINEAR ou DISK_SEEK_SQRT
+  int seek_min_us ;		// busca minima (mesmo bloco ou adjacente)
+  int seek_max_us ;		// busca de curso completo
+  int rpm ;			// velocidade de rotacao (0 = sem latencia rotacional)
+  int latency_us ;		// latencia de cada operacao (perfil SSD)
+  int jitter_us ;		// fator aleatorio maximo somado a cada operacao
+  long xfer_rate ;		// taxa de transferencia, em bytes/s
+  int track_blocks ;		// blocos por trilha
+  int cache_tracks ;		// trilhas no cache do disco (0 = sem cache)
+  int cache_us ;		// atendimento de leitura pelo cache de trilhas
+  int backend ;			// DISK_BACKEND_SIM ou DISK_BACKEND_NATIVE
+  int threads ;			// threads auxiliares (backend nativo)
+  int qdepth ;			// operacoes simultaneas (backend nativo)
+  int sync ;			// 1 = escritas sincronas na imagem (O_SYNC)
+} disk_config_t ;
+
+// preenche cfg com a configuracao padrao (disk.dat, blocos de 64 bytes,
+// perfil HDD com atrasos entre 30 e 300 ms)
+void disk_config_init (disk_config_t *cfg) ;
+
+// preenche os parametros de tempo de cfg com os valores padrao do perfil
+void disk_config_profile (disk_config_t *cfg, int profile) ;
+
+// define a configuracao do disco; deve ser chamada antes de DISK_CMD_INIT.
+// Na inicializacao, a variavel de ambiente PPOS_DISK, se definida, ajusta
+// a configuracao: lista "nome=valor" separada por virgulas com os campos
+// de disk_config_t, por exemplo
+//   PPOS_DISK="profile=ssd,image=disk4k.dat,blocksize=4096,numblocks=1024"
+//   PPOS_DISK="rpm=7200,seek_curve=sqrt,cache_tracks=8"
+//   PPOS_DISK="backend=native,image=/dev/sdb,blocksize=4096,qdepth=32,sync=0"
+// retorno: 0 (sucesso) ou -1 (erro: disco ja inicializado ou config invalida)
+int disk_config (const disk_config_t *cfg) ;
+
+// define a configuracao do disco dev (idem disk_config)
+int disk_dev_config (int dev, const disk_config_t *cfg) ;
+
 // No caso de operacoes assincronas, a chamada apenas "agenda" os pedidos de
 // operacao e retorna imediatamente. Quando a operacao solicitada for concluida,
 // o disco ira gerar um sinal SIGUSR1, que deve ser recebido e tratado pelo
 // gerenciador de discos, para acordar a tarefa que solicitou a operação.
+// O sinal eh enviado com sigqueue(): o numero do disco que concluiu a
+// operacao eh informado em si_value.sival_int (tratador com SA_SIGINFO).
 
 int disk_cmd (int cmd, int block, void *buffer) ;
 
+// Cada disco dev (0 a DISK_MAX_DEVICES-1) tem sua imagem, seu timer e sua
+// configuracao; disk_cmd(), disk_cmd_vec() e disk_config() operam sobre o
+// disco 0. A imagem padrao do disco dev > 0 eh "disk<dev>.dat" e sua
+// variavel de ambiente de configuracao eh PPOS_DISK<dev>.
+
+int disk_dev_cmd (int dev, int cmd, int block, void *buffer) ;
+
+// Comandos vetoriais: transferem nblocks blocos contiguos a partir de block,
+// cada um de/para o buffer correspondente em buffers[] (scatter/gather).
+// A sequencia paga um unico posicionamento da cabeca, mais um pequeno custo
+// de transferencia para cada bloco adicional.
+
+int disk_cmd_vec (int cmd, int block, int nblocks, void **buffers) ;
+
+int disk_dev_cmd_vec (int dev, int cmd, int block, int nblocks, void **buffers) ;
+
+// Fila de comandos: disk_dev_queue() agenda uma operacao READV/WRITEV
+// identificada por tag e retorna; ate DISK_CMD_QDEPTH operacoes podem estar
+// em andamento (1 na simulacao). Cada conclusao gera um SIGUSR1 (que podem
+// se fundir) e deve ser coletada com disk_dev_reap(), que devolve a tag e o
+// resultado (0 ou -1) de uma operacao concluida.
+// Operacoes agendadas por disk_cmd()/disk_cmd_vec() nao precisam de coleta.
+
+int disk_dev_queue (int dev, int cmd, int block, int nblocks, void **buffers, int tag) ;
+int disk_dev_reap (int dev, int *tag, int *result) ;
+
+// quantidade de conclusoes do disco dev aguardando disk_dev_reap(); como os
+// sinais de discos diferentes tambem se fundem, o si_value de um SIGUSR1
+// nao indica todos os discos que concluiram operacoes
+// retorno: conclusoes pendentes ou -1 (erro: disco nao inicializado)
+int disk_dev_done (int dev) ;
+
+// consulta os contadores do cache de trilhas do disco dev: leituras
+// atendidas pelo cache (*hits) e leituras que moveram a cabeca (*misses)
+// retorno: 0 (sucesso) ou -1 (erro: disco nao inicializado)
+int disk_dev_cache_stats (int dev, unsigned int *hits, unsigned int *misses) ;
+
+// Modo de simulacao em tempo virtual (usado pelo nucleo, veja ppos_sim):
+// os discos simulados deixam de armar timers. Cada operacao termina no
+// instante virtual clock() + tempo de atendimento, e so eh concluida quando
+// o nucleo chama disk_sim_run() com o relogio virtual nesse instante; os
+// fatores aleatorios do tempo de atendimento usam um gerador proprio de cada
+// disco, iniciado com seed, e se repetem de uma execucao para outra.
+// Deve ser chamada antes da inicializacao dos discos.
+void disk_sim_start (unsigned int seed, unsigned long long (*clock) (void)) ;
+
+// instante virtual (ns) da proxima conclusao em *due; as operacoes do
+// backend nativo terminam em tempo real e contam como conclusao imediata
+// retorno: 0 (ha operacao em andamento) ou -1 (nenhuma)
+int disk_sim_next (unsigned long long *due) ;
+
+// conclui as operacoes com instante <= now (gera SIGUSR1 para cada uma)
+// retorno: numero de operacoes concluidas
+int disk_sim_run (unsigned long long now) ;
+
 // Exemplos de uso:
 
 // inicializa um disco (operacao sincrona)
@@ -77,4 +213,35 @@ int disk_cmd (int cmd, int block, void *buffer) ;
 // result < 0: erro
 // result = 0: ok (escrita agendada, sinal SIGUSR1 serah gerado ao completar)
 
+// consulta quantas operacoes o disco aceita ao mesmo tempo (operacao sincrona)
+// int disk_cmd (DISK_CMD_QDEPTH, 0, 0) ;
+// result <  0: erro
+// result >= 1: profundidade da fila de comandos
+
+// agenda uma operacao na fila de comandos (operacao assincrona)
+// int disk_dev_queue (int dev, DISK_CMD_READV, int block, int nblocks, void **buffers, int tag) ;
+// result < 0: erro ou fila cheia
+// result = 0: ok (SIGUSR1 serah gerado ao completar)
+
+// coleta uma operacao concluida (operacao sincrona)
+// int disk_dev_reap (int dev, int *tag, int *result) ;
+// result < 0: erro
+// result = 0: nenhuma operacao concluida aguardando coleta
+// result = 1: operacao *tag concluida, com resultado *result
+
+// consulta tempo de transferencia de cada bloco adicional (operacao sincrona)
+// int disk_cmd (DISK_CMD_DELAYBLOCK, 0, 0) ;
+// result <  0: erro
+// result >= 0: tempo de transferencia por bloco (em ms)
+
+// agenda a leitura de nblocks blocos contiguos (operacao assincrona)
+// int disk_cmd_vec (DISK_CMD_READV, int block, int nblocks, void **buffers) ;
+// result < 0: erro
+// result = 0: ok (leitura agendada, um unico SIGUSR1 serah gerado ao completar)
+
+// agenda a escrita de nblocks blocos contiguos (operacao assincrona)
+// int disk_cmd_vec (DISK_CMD_WRITEV, int block, int nblocks, void **buffers) ;
+// result < 0: erro
+// result = 0: ok (escrita agendada, um unico SIGUSR1 serah gerado ao completar)
+
 #endif
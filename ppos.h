@@ -29,6 +29,14 @@
 // Inicializa o sistema operacional; deve ser chamada no inicio do main()
 void ppos_init () ;
 
+// Liga o modo de simulacao em tempo virtual; deve ser chamada antes de
+// ppos_init() (ou definir a variavel de ambiente PPOS_SIM=semente). O
+// relogio (systime, task_sleep, quantum, contabilizacao e discos) deixa de
+// seguir o tempo real: salta para o proximo evento quando nenhuma tarefa
+// esta pronta, e cada consulta ao relogio (systime, task_stats) custa
+// 1 us de CPU virtual. Com a mesma semente a execucao se repete.
+int ppos_sim (unsigned int seed) ;
+
 // gerência de tarefas =========================================================
 
 // Cria uma nova tarefa. Retorna um ID> 0 ou erro.
@@ -70,6 +78,19 @@ void task_sleep (int t) ;
 // retorna o relógio atual (em milisegundos)
 unsigned int systime () ;
 
+// retorna o instante atual em ns desde ppos_init(), sem custo no modo de
+// simulacao (usada pelos modulos do nucleo)
+unsigned long long ppos_clock () ;
+
+// contabilização =============================================================
+
+// consulta os contadores de uma tarefa (ou a tarefa atual); 0 ou erro
+int task_stats (task_t *task, task_stats_t *stats) ;
+
+// consulta os contadores do sistema e de ate max tarefas existentes (em
+// tasks, se nao for NULL); retorna o numero de tarefas existentes ou erro
+int ppos_stats (ppos_stats_t *stats, task_stats_t *tasks, int max) ;
+
 // operações de IPC ============================================================
 
 // semáforos
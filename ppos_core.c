@@ -7,17 +7,45 @@
 #include <signal.h>
 #include <string.h>
 #include <sys/time.h>
+#include <time.h>
 #include "ppos.h"
+#include "disk.h"
+#include "ppos_disk.h"
+#include "ppos_trace.h"
+#include "ppos_lat.h"
+#include "ppos_prof.h"
+#include "ppos_dump.h"
+#include "ppos_log.h"
+#include "ppos_stack.h"
 
 // variáveis globais e constantes ==============================================
 
-#define STACKSIZE 64*1024	/* tamanho de pilha das threads */
 #define TASK_AGING -1
 
+// estados contabilizados de uma tarefa
+#define ACCT_RUNNING 0
+#define ACCT_READY   1
+#define ACCT_BLOCKED 2
+#define ACCT_DONE    3
+
 task_t taskMain, taskDispatcher, *currentTask, *lastTask;
 task_t *readyQueue = NULL, *sleepQueue = NULL;
+task_t *taskList = NULL;   // registro das tarefas existentes
+mqueue_t *mqueueList = NULL;   // registro das filas de mensagens existentes
 unsigned int taskCount = 0, userTasks = 0, quantum_count, ticks;
 
+unsigned long long bootTime;          // instante de ppos_init() (ns)
+unsigned long long switchCount = 0;   // trocas de contexto
+unsigned long long preemptCount = 0;  // preempcoes por fim de quantum
+int preempted = 0;     // a troca em andamento eh uma preempcao?
+int preemptLock = 0;   // preempcao suspensa durante consultas ao registro
+
+// modo de simulacao em tempo virtual
+#define SIM_QUERY_NS 1000              // custo de uma consulta ao relogio (ns)
+int simMode = 0;                       // relogio virtual ligado?
+unsigned int simSeed;                  // semente do modo de simulacao
+unsigned long long simNow = 0;         // relogio virtual (ns desde ppos_init)
+
 // estrutura que define um tratador de sinal (deve ser global ou static)
 struct sigaction ticksAction ;
 
@@ -26,6 +54,153 @@ struct itimerval timer ;
 
 // funções locais ==============================================================
 
+/*!
+  \brief Relogio monotonico da contabilizacao, em ns
+*/
+static unsigned long long clock_ns () {
+  struct timespec t;
+
+  if ( simMode )
+    return(simNow);
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return( (unsigned long long) t.tv_sec * 1000000000ULL + t.tv_nsec );
+}
+
+/*!
+  \brief Encerra o estado contabilizado de uma tarefa e inicia outro
+
+  \param task Tarefa contabilizada
+  \param state Novo estado (ACCT_*)
+  \param now Instante da mudanca (ns)
+*/
+static void task_account (task_t *task, int state, unsigned long long now) {
+  unsigned long long spent = now - task->acct_since;
+
+  switch ( task->acct_state ) {
+  case ACCT_RUNNING:
+    task->run_ns += spent;
+    break;
+  case ACCT_READY:
+    task->ready_ns += spent;
+    break;
+  case ACCT_BLOCKED:
+    task->blocked_ns += spent;
+    break;
+  default:
+    break;
+  }
+  task->acct_state = state;
+  task->acct_since = now;
+}
+
+/*!
+  \brief Preenche os contadores de uma tarefa, incluindo o estado corrente
+*/
+static void task_fill_stats (task_t *task, task_stats_t *stats, unsigned long long now) {
+  unsigned long long spent = now - task->acct_since;
+
+  stats->id = task->id;
+  stats->status = task->status;
+  stats->prio = task->est_prio;
+  stats->system_task = task->system_task;
+  stats->activations = task->activ;
+  stats->vol_switches = task->vol_switches;
+  stats->invol_switches = task->invol_switches;
+  stats->elapsed_ns = now - task->create_ns;
+  stats->run_ns = task->run_ns;
+  stats->ready_ns = task->ready_ns;
+  stats->blocked_ns = task->blocked_ns;
+  if ( task->acct_state == ACCT_RUNNING )
+    stats->run_ns += spent;
+  else if ( task->acct_state == ACCT_READY )
+    stats->ready_ns += spent;
+  else if ( task->acct_state == ACCT_BLOCKED )
+    stats->blocked_ns += spent;
+  else
+    stats->elapsed_ns = task->acct_since - task->create_ns;
+}
+
+/*!
+  \brief Remove uma tarefa terminada do registro
+*/
+static void task_unregister (task_t *task) {
+  if ( task->reg_prev )
+    task->reg_prev->reg_next = task->reg_next;
+  else if ( taskList == task )
+    taskList = task->reg_next;
+  if ( task->reg_next )
+    task->reg_next->reg_prev = task->reg_prev;
+  task->reg_prev = task->reg_next = NULL;
+}
+
+/*!
+  \brief Avanca o relogio virtual, contando os ticks atravessados
+
+  \param ns Avanco (ns), consumido pela tarefa corrente
+
+  \return 1 se o quantum da tarefa corrente terminou, 0 caso contrario
+*/
+static int sim_advance (unsigned long long ns) {
+  int expired = 0;
+
+  simNow += ns;
+  while ( ticks < simNow / 1000000 ) {
+    ticks++;
+    TRACE(TRACE_TICK, currentTask->system_task, 0, ticks, quantum_count, 0, 0);
+    if ( !( currentTask->system_task ) && !preemptLock && currentTask->status == 1 &&
+         quantum_count > 0 )
+      expired |= ( --quantum_count == 0 );
+  }
+  return(expired);
+}
+
+/*!
+  \brief Cobra uma consulta ao relogio no modo de simulacao, preemptando a
+  tarefa corrente se o quantum terminou
+*/
+static void sim_query () {
+  if ( simMode && sim_advance(SIM_QUERY_NS) ) {
+    preempted = 1;
+    task_yield();
+  }
+}
+
+/*!
+  \brief Sem tarefas prontas, salta o relogio virtual para o proximo evento:
+  o despertar de uma tarefa adormecida ou a conclusao de uma operacao de
+  disco
+*/
+static void sim_idle () {
+  unsigned long long next = 0, due;
+  task_t *task = sleepQueue;
+  int found = 0;
+
+  if ( task ) {
+    do {
+      due = task->wake_time * 1000000ULL;
+      if ( !found || due < next )
+        next = due;
+      found = 1;
+      task = task->next;
+    } while ( task != sleepQueue );
+  }
+  if ( !disk_sim_next(&due) && ( !found || due < next ) ) {
+    next = due;
+    found = 1;
+  }
+
+  // nada pode acordar as tarefas suspensas
+  if ( !found ) {
+    fprintf(stderr, "[PPOS error]: dispatcher: no pending events in simulation mode (deadlock)\n");
+    exit(-1);
+  }
+
+  if ( next > simNow ) {
+    simNow = next;
+    ticks = simNow / 1000000;
+  }
+}
+
 /*!
   \brief Função para impressão de fila
 */  
@@ -63,13 +238,35 @@ static void task_init (task_t *task) {
   task->est_prio = 0;
   task->din_prio = 0;
   task->system_task = 0;
-  task->inic_time = systime();
+  task->inic_time = ticks;
   task->proc_time = 0;
   task->wake_time = 0;
   task->activ = 0;
   task->exit_code = 0;
   task->joinedQueue = NULL;
+  task->io_group = currentTask ? currentTask->io_group : 0;
+  task->io_ops = 0;
+  task->io_bytes = 0;
+  task->io_time = 0;
+  task->acct_state = ACCT_READY;
+  task->create_ns = task->acct_since = clock_ns();
+  task->run_ns = task->ready_ns = task->blocked_ns = 0;
+  task->vol_switches = task->invol_switches = 0;
+  task->lat_cause = -1;
+  task->wait_sem = NULL;
+  task->entry = NULL;
+  task->stack_max = 0;
+  task->stack_paint = 0;
   getcontext( &(task->context) );
+
+  // insere a tarefa no registro (o despachante retira as que terminam)
+  preemptLock++;
+  task->reg_prev = NULL;
+  task->reg_next = taskList;
+  if ( taskList )
+    taskList->reg_prev = task;
+  taskList = task;
+  preemptLock--;
 }
 
 /*!
@@ -79,12 +276,23 @@ static void task_init (task_t *task) {
   \param queue Fila em que a tarefa está
 */  
 void wake_task (task_t *task, queue_t *queue) {
+  preemptLock++;
+
   // remove task da fila de tasks adormecidas passada por parametro
   if ( queue_remove ((queue_t**) queue, (queue_t*) task) ) {
     fprintf(stderr, "[PPOS error]: wake_task: fail removing task from queue\n");
     exit(-1);
   }
 
+  TRACE(TRACE_WAKEUP, 0, queue, task->id, 0, 0, 0);
+
+  // o tempo na fila de prontas comeca agora (a tarefa pode ser acordada
+  // antes de deixar o processador)
+  if ( task->acct_state == ACCT_BLOCKED )
+    task_account(task, ACCT_READY, clock_ns());
+  if ( task->lat_cause < 0 )
+    task->lat_cause = LAT_WAKEUP;
+
   // seta o status da task para pronta e ajusta a prioridade
   task->status = 1;
   task->din_prio = task->est_prio;
@@ -94,6 +302,8 @@ void wake_task (task_t *task, queue_t *queue) {
     fprintf(stderr, "[PPOS error]: wake_task: fail adding task to ready queue\n");
     exit(-1);
   }
+
+  preemptLock--;
 }
 
 /*!
@@ -103,12 +313,16 @@ void wake_task (task_t *task, queue_t *queue) {
   \param queue Fila em que a tarefa vai dormir
 */  
 void go_sleep (task_t *task, queue_t *queue) {
+  preemptLock++;
+
   // remove task da fila de tasks prontas
   if ( queue_remove ((queue_t**) &readyQueue, (queue_t*) currentTask) ) {
     fprintf(stderr, "[PPOS error]: go_sleep: fail removing task from ready queue\n");
     exit(-1);
   }
 
+  TRACE(TRACE_BLOCK, 0, queue, 0, 0, 0, 0);
+
   // seta o status da tarefa atual para suspensa e o tempo em que deve acordar
   currentTask->status = 3;
   
@@ -117,6 +331,8 @@ void go_sleep (task_t *task, queue_t *queue) {
     fprintf(stderr, "[PPOS error]: go_sleep: fail adding task to queue\n");
     exit(-1);
   }
+
+  preemptLock--;
 }
 
 /*!
@@ -129,7 +345,7 @@ static void sleep_verify () {
   while ( count < size ) {
     aux = task->next;
     // verifica se esta na hora de acordar
-    if( task->wake_time == systime() ) {
+    if( task->wake_time <= ticks ) {
       task->wake_time = 0;
       wake_task(task, (queue_t *) &sleepQueue);
     }
@@ -182,7 +398,7 @@ static task_t * scheduler () {
   nextTask->din_prio = nextTask->est_prio;
 
   #ifdef DEBUG
-  fprintf(stdout, "[PPOS debug]: task scheduler: task %d is the next\n", nextTask->id);
+  ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: task scheduler: task %d is the next\n", nextTask->id);
   #endif
 
   return ( nextTask );
@@ -194,7 +410,7 @@ static task_t * scheduler () {
 static void dispatcher () {
 
   #ifdef DEBUG
-  fprintf(stdout, "[PPOS debug]: task dispatcher launched\n");
+  ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: task dispatcher launched\n");
   #endif
 
   task_t *nextTask;
@@ -226,6 +442,8 @@ static void dispatcher () {
         }    
         break;
       case 2:
+        // pico de uso da pilha, antes de libera-la
+        stack_exit(lastTask);
         free(lastTask->context.uc_stack.ss_sp);
         lastTask->context.uc_stack.ss_size = 0;
         // remove task da fila de tasks prontas
@@ -234,6 +452,7 @@ static void dispatcher () {
           exit(-1);
         }
         userTasks--;        
+        task_unregister(lastTask);
         break;
       case 3:
         break;
@@ -245,11 +464,22 @@ static void dispatcher () {
       queue_print("Ready ", (queue_t *) readyQueue, print_elem);
       #endif
 
-    }
+    } else if ( simMode )
+      sim_idle();
+
+    // no tempo virtual, as conclusoes de disco sao geradas aqui
+    if ( simMode )
+      disk_sim_run(simNow);
+
+    // acorda os gerentes dos discos que concluiram operacoes
+    disk_poll();
 
     // verifica fila de adormecidas
     sleep_verify();
 
+    // grava em lote a saida acumulada pelas tarefas
+    log_poll();
+
   }
 
   free(currentTask->context.uc_stack.ss_sp);
@@ -265,32 +495,82 @@ static void ticks_handler (int signum) {
   // incrementa contador de ticks e tempo de processamento da tarefa atual
   ticks++;
 
-  // se não é tarefa de sistema, decrementa quantum
-  if ( !( currentTask->system_task ) ) {
+  TRACE(TRACE_TICK, currentTask->system_task, 0, ticks, quantum_count, 0, 0);
+
+  // se não é tarefa de sistema, decrementa quantum; uma tarefa que esta
+  // suspendendo ou terminando (status != 1) ja vai liberar o processador
+  if ( !( currentTask->system_task ) && !preemptLock && currentTask->status == 1 ) {
     quantum_count--;
     // quando o contador chega em zero, devolve CPU
-    if ( quantum_count == 0 )
+    if ( quantum_count == 0 ) {
+      preempted = 1;
       task_yield();
+    }
   }
 
 }
 
-// funcoes para operacoes atomicas
+// funcoes para operacoes atomicas; a tarefa nao eh preemptada dentro da
+// secao critica, senao o despachante poderia esperar para sempre pela trava
 void enter_cs (int *lock) {
+  preemptLock++;
   while (__sync_fetch_and_or(lock, 1)) ;   // busy waiting
 } 
 void leave_cs (int *lock) {
   (*lock) = 0 ;
+  preemptLock--;
 }
 
 // funções gerais ==============================================================
 
+/*!
+  \brief Liga o modo de simulacao em tempo virtual
+
+  Deve ser chamada antes de ppos_init(). O relogio virtual so avanca com as
+  consultas ao relogio (SIM_QUERY_NS cada) e com os saltos do dispatcher
+  para o proximo evento; rand() e random() sao iniciados com a semente, e os
+  discos simulados passam a concluir as operacoes no tempo virtual.
+
+  \param seed Semente
+
+  \return 0 em sucesso e -1 em erro (sistema ja inicializado)
+*/
+int ppos_sim (unsigned int seed) {
+  if ( currentTask ) {
+    fprintf(stderr, "[PPOS error]: ppos_sim: system already initialized\n");
+    return(-1);
+  }
+
+  simMode = 1;
+  simSeed = seed;
+  simNow = 0;
+  srand(seed);
+  srandom(seed);
+  disk_sim_start(seed, ppos_clock);
+
+  return(0);
+}
+
 // Inicializa o sistema operacional; deve ser chamada no inicio do main()
 void ppos_init () {
   /* desativa o buffer da saida padrao (stdout), usado pela função printf */
   setvbuf ( stdout, 0, _IONBF, 0 ) ;
 
+  // a saida padrao passa pelo registro assincrono, salvo PPOS_LOG=sync
+  log_init();
+
+  // tamanhos de pilha aprendidos, pedidos pela variavel PPOS_STACK
+  stack_init();
+
+  // modo de simulacao pedido pela variavel de ambiente PPOS_SIM
+  if ( !simMode && getenv("PPOS_SIM") )
+    ppos_sim(atoi(getenv("PPOS_SIM")));
+
   ticks = 0;
+  bootTime = clock_ns();
+
+  // rastreamento pedido pela variavel de ambiente PPOS_TRACE
+  trace_init();
 
   task_init(&taskMain);
 
@@ -302,6 +582,7 @@ void ppos_init () {
   }
 
   currentTask = &taskMain;
+  task_account(&taskMain, ACCT_RUNNING, clock_ns());
 
   // cria o dispatcher e remove ele da fila
   if ( task_create(&taskDispatcher, dispatcher, NULL) < 0 ) {
@@ -316,6 +597,18 @@ void ppos_init () {
   taskDispatcher.system_task = 1;
   userTasks--;
 
+  // perfilador pedido pela variavel de ambiente PPOS_PROF
+  prof_init();
+
+  // retratos do nucleo pedidos pela variavel de ambiente PPOS_DUMP
+  dump_init();
+
+  // no modo de simulacao, os ticks sao gerados pelo relogio virtual
+  if ( simMode ) {
+    task_switch(&taskDispatcher);
+    return;
+  }
+
   // registra a ação para o sinal de timer SIGALRM
   ticksAction.sa_handler = ticks_handler ;
   sigemptyset (&ticksAction.sa_mask) ;
@@ -338,7 +631,7 @@ void ppos_init () {
   }
 
   #ifdef DEBUG
-  fprintf(stdout, "[PPOS debug]: system initialized\n");
+  ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: system initialized\n");
   #endif
 
   task_switch(&taskDispatcher);
@@ -358,15 +651,17 @@ void ppos_init () {
 */
 int task_create (task_t *task, void (*start_func)(void *), void *arg) {
 
+  unsigned int size;
   char *stack;
 
   task_init(task);
 
-  // aloca stack
-  stack = malloc (STACKSIZE);
+  // aloca stack, com o tamanho aprendido para a funcao de entrada
+  task->entry = start_func;
+  stack = stack_alloc (task, &size);
   if (stack) {
     task->context.uc_stack.ss_sp = stack;
-    task->context.uc_stack.ss_size = STACKSIZE;
+    task->context.uc_stack.ss_size = size;
     task->context.uc_stack.ss_flags = 0;
     task->context.uc_link = 0;
   } else {
@@ -378,13 +673,18 @@ int task_create (task_t *task, void (*start_func)(void *), void *arg) {
   makecontext ( &(task->context), (void*)(start_func), 1, arg );
 
   // adiciona task a fila de tasks prontas
-  if ( queue_append ((queue_t **) &readyQueue, (queue_t*) task) )
+  preemptLock++;
+  if ( queue_append ((queue_t **) &readyQueue, (queue_t*) task) ) {
+    preemptLock--;
     return -1;
-  
+  }
   userTasks++;
+  preemptLock--;
+
+  TRACE(TRACE_CREATE, 0, task, task->id, 0, 0, 0);
 
   #ifdef DEBUG
-  fprintf(stdout, "[PPOS debug]: task %d created by task %d\n", task->id, currentTask->id);
+  ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: task %d created by task %d\n", task->id, currentTask->id);
   #endif
 
   return task->id;
@@ -397,10 +697,13 @@ int task_create (task_t *task, void (*start_func)(void *), void *arg) {
   \param exitCode código de término devolvido pela tarefa corrente
 */
 void task_exit (int exitCode) {
+  unsigned long long now;
 
   currentTask->status = 2;
   currentTask->exit_code = exitCode;
 
+  TRACE(TRACE_EXIT, 0, currentTask, exitCode, 0, 0, 0);
+
   task_t *task = currentTask->joinedQueue;
   while (task) {
     wake_task(task, (queue_t *) &(currentTask->joinedQueue) );
@@ -409,10 +712,15 @@ void task_exit (int exitCode) {
   }
 
   #ifdef DEBUG
-  fprintf(stdout, "[PPOS debug]: task %d exited\n", currentTask->id);
+  ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: task %d exited\n", currentTask->id);
   #endif
 
-  fprintf(stdout, "Task %d exit: execution time %d ms, processor time %d ms, %d activations\n", currentTask->id, (systime() - currentTask->inic_time), currentTask->proc_time, currentTask->activ );
+  // tempos de execucao e de processamento ate aqui, no mesmo relogio
+  now = clock_ns();
+  task_account(currentTask, ACCT_RUNNING, now);
+  currentTask->proc_time = currentTask->run_ns / 1000000;
+
+  ppos_log(LOG_LEVEL_INFO, "Task %d exit: execution time %d ms, processor time %d ms, %d activations\n", currentTask->id, (int) ((now - currentTask->create_ns) / 1000000), currentTask->proc_time, currentTask->activ );
 
   if ( currentTask == &taskDispatcher )
     exit(0);
@@ -429,6 +737,7 @@ void task_exit (int exitCode) {
   \return Zero em sucesso, valor negativo se houver erro
 */
 int task_switch (task_t *task) {
+  unsigned long long now;
 
   if (!task){
     fprintf(stderr, "[PPOS error]: switch to inexistent task");
@@ -436,15 +745,35 @@ int task_switch (task_t *task) {
   }
 
   #ifdef DEBUG
-  fprintf(stdout, "[PPOS debug]: switch task %d -> task %d\n", currentTask->id, task->id);
+  ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: switch task %d -> task %d\n", currentTask->id, task->id);
   #endif
 
+  TRACE(TRACE_SWITCH, 0, task, task->id, 0, 0, 0);
+
   lastTask = currentTask;
   currentTask = task;
 
-  // para o cronometro da ultima tarefa e inicia o da proxima
-  lastTask->proc_time += systime() - lastTask->inic_proc_time;
-  currentTask->inic_proc_time = systime();
+  // encerra o tempo de execucao da ultima tarefa e inicia o da proxima
+  now = clock_ns();
+  task_account(lastTask, lastTask->status == 1 ? ACCT_READY :
+                         lastTask->status == 2 ? ACCT_DONE : ACCT_BLOCKED, now);
+
+  // latencia de escalonamento da tarefa que assume o processador
+  if ( task->acct_state == ACCT_READY && task != &taskDispatcher )
+    lat_sched(task, task->lat_cause, now - task->acct_since);
+  task->lat_cause = -1;
+  task_account(task, ACCT_RUNNING, now);
+
+  lastTask->proc_time = lastTask->run_ns / 1000000;
+
+  // preempcoes sao as trocas involuntarias; as demais sao voluntarias
+  if ( preempted ) {
+    lastTask->invol_switches++;
+    preemptCount++;
+    preempted = 0;
+  } else
+    lastTask->vol_switches++;
+  switchCount++;
 
   task->activ++;
 
@@ -475,7 +804,7 @@ void task_yield () {
   }
 
   #ifdef DEBUG
-  fprintf(stdout, "[PPOS debug]: task %d yields the CPU\n", currentTask->id);
+  ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: task %d yields the CPU\n", currentTask->id);
   #endif
 
   task_switch(&taskDispatcher);
@@ -489,7 +818,7 @@ void task_setprio (task_t *task, int prio) {
     task = currentTask;
 
   #ifdef DEBUG
-  fprintf(stdout, "[PPOS debug]: task %d priority setted to %d \n", task->id, prio);
+  ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: task %d priority setted to %d \n", task->id, prio);
   #endif
 
   task->est_prio = prio;
@@ -505,7 +834,7 @@ int task_getprio (task_t *task) {
     task = currentTask;
   
   #ifdef DEBUG
-  fprintf(stdout, "[PPOS debug]: got priority of task %d\n", task->id);
+  ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: got priority of task %d\n", task->id);
   #endif
 
   return ( task->est_prio );  
@@ -525,7 +854,7 @@ int task_join (task_t *task) {
   go_sleep(currentTask, (queue_t *) &(task->joinedQueue));
 
   #ifdef DEBUG
-  fprintf(stdout, "[PPOS debug]: task %d added to joined queue of task %d\n", currentTask->id, task->id);
+  ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: task %d added to joined queue of task %d\n", currentTask->id, task->id);
   #endif
 
   task_switch(&taskDispatcher);
@@ -541,12 +870,12 @@ int task_join (task_t *task) {
 */
 void task_sleep (int t) {
 
-  currentTask->wake_time = systime() + t;
+  currentTask->wake_time = ticks + t;
 
   go_sleep(currentTask, (queue_t *) &sleepQueue);
 
   #ifdef DEBUG
-  fprintf(stdout, "[PPOS debug]: task %d went to sleep for %d ms\n", currentTask->id, t);
+  ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: task %d went to sleep for %d ms\n", currentTask->id, t);
   #endif
 
   task_switch(&taskDispatcher);
@@ -556,9 +885,90 @@ void task_sleep (int t) {
   \brief Retorna o relógio atual (em milisegundos)
 */
 unsigned int systime () {
+  sim_query();
   return ticks;
 }
 
+/*!
+  \brief Retorna o instante atual em ns desde ppos_init() (virtual no modo
+  de simulacao, sem custo)
+*/
+unsigned long long ppos_clock () {
+  return( clock_ns() - bootTime );
+}
+
+// contabilização =============================================================
+
+/*!
+  \brief Consulta os contadores de uma tarefa
+
+  \param task Tarefa consultada (NULL = tarefa atual)
+  \param stats Contadores da tarefa, incluindo o estado corrente
+
+  \return 0 em sucesso e -1 em erro
+*/
+int task_stats (task_t *task, task_stats_t *stats) {
+  unsigned long long since;
+
+  if ( !stats )
+    return(-1);
+  if ( !task )
+    task = currentTask;
+
+  sim_query();
+
+  // uma troca de contexto entre a leitura do relogio e a dos contadores
+  // muda acct_since: a leitura eh refeita
+  do {
+    since = task->acct_since;
+    task_fill_stats(task, stats, clock_ns());
+  } while ( task->acct_since != since );
+
+  return(0);
+}
+
+/*!
+  \brief Consulta os contadores do sistema e das tarefas existentes
+
+  A preempcao fica suspensa durante a consulta, de modo que todas as tarefas
+  sao observadas no mesmo instante.
+
+  \param stats Contadores do sistema (ou NULL)
+  \param tasks Vetor para os contadores das tarefas (ou NULL)
+  \param max Posicoes do vetor tasks
+
+  \return Numero de tarefas existentes ou -1 em erro
+*/
+int ppos_stats (ppos_stats_t *stats, task_stats_t *tasks, int max) {
+  unsigned long long now;
+  task_t *task;
+  int n = 0;
+
+  if ( (tasks && max < 0) || (!stats && !tasks) )
+    return(-1);
+
+  preemptLock++;
+  now = clock_ns();
+  if ( stats ) {
+    memset(stats, 0, sizeof(ppos_stats_t));
+    stats->uptime_ns = now - bootTime;
+    stats->switches = switchCount;
+    stats->preemptions = preemptCount;
+    stats->ready = queue_size( (queue_t *) readyQueue );
+  }
+  for ( task = taskList; task; task = task->reg_next, n++ ) {
+    if ( tasks && n < max )
+      task_fill_stats(task, &tasks[n], now);
+    if ( stats && task->status == 3 )
+      stats->blocked++;
+  }
+  if ( stats )
+    stats->tasks = n;
+  preemptLock--;
+
+  return(n);
+}
+
 // operações de IPC ============================================================
 
 // semáforos
@@ -583,7 +993,7 @@ int sem_create (semaphore_t *s, int value) {
   s->lock = 0;
 
   #ifdef DEBUG
-  fprintf(stdout, "[PPOS debug]: semaphore created\n");
+  ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: semaphore created\n");
   #endif
 
   return(0);
@@ -605,17 +1015,21 @@ int sem_down (semaphore_t *s) {
   enter_cs( &(s->lock) );
   s->count--;
 
+  TRACE(TRACE_SEM_DOWN, s->count < 0, s, s->count, 0, 0, 0);
+
   if ( s->count < 0 ) {
     go_sleep(currentTask, (queue_t *) &(s->queue));
+    currentTask->wait_sem = s;
 
     #ifdef DEBUG
-    fprintf(stdout, "[PPOS debug]: task %d went to sleep on semaphore\n", currentTask->id);
+    ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: task %d went to sleep on semaphore\n", currentTask->id);
     #endif
 
     // sai da secao critica
     leave_cs( &(s->lock) );
 
     task_switch(&taskDispatcher);
+    currentTask->wait_sem = NULL;
   } else {
     // sai da secao critica
     leave_cs( &(s->lock) );
@@ -646,12 +1060,16 @@ int sem_up (semaphore_t *s) {
   enter_cs( &(s->lock) );
   s->count++;
 
+  TRACE(TRACE_SEM_UP, 0, s, s->count, s->count <= 0 ? s->queue->id : -1, 0, 0);
+
   if ( s->count <= 0 ) {
     task = s->queue;
+    if ( task->lat_cause < 0 )
+      task->lat_cause = LAT_SEM;
     wake_task(task, (queue_t *) &(s->queue));
 
     #ifdef DEBUG
-    fprintf(stdout, "[PPOS debug]: task %d awake from semaphore\n", task->id);
+    ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: task %d awake from semaphore\n", task->id);
     #endif
   }
 
@@ -690,7 +1108,7 @@ int sem_destroy (semaphore_t *s) {
   leave_cs( &(s->lock) );
 
   #ifdef DEBUG
-  fprintf(stdout, "[PPOS debug]: semaphore destroyed\n");
+  ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: semaphore destroyed\n");
   #endif
 
   return(0);
@@ -721,8 +1139,15 @@ int mqueue_create (mqueue_t *queue, int max, int size) {
   queue->buffer_start = 0;
   queue->buffer_count = 0;
 
+  // insere a fila no registro
+  queue->reg_prev = NULL;
+  queue->reg_next = mqueueList;
+  if ( mqueueList )
+    mqueueList->reg_prev = queue;
+  mqueueList = queue;
+
   #ifdef DEBUG
-  fprintf(stdout, "[PPOS debug]: message queue created\n");
+  ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: message queue created\n");
   #endif
 
   return(0);
@@ -747,6 +1172,8 @@ int mqueue_send (mqueue_t *queue, void *msg) {
   memcpy( (queue->buffer + ((queue->buffer_start + queue->buffer_count) % (queue->msg_max)) * queue->msg_size), msg, queue->msg_size);
   queue->buffer_count++;
 
+  TRACE(TRACE_MQ_SEND, 0, queue, queue->buffer_count, 0, 0, 0);
+
   if ( sem_up( &(queue->s_buffer) ) || sem_up( &(queue->s_item) ) )
     return(-1);
 
@@ -776,6 +1203,8 @@ int mqueue_recv (mqueue_t *queue, void *msg) {
   queue->buffer_start++;
   queue->buffer_count--;
 
+  TRACE(TRACE_MQ_RECV, 0, queue, queue->buffer_count, 0, 0, 0);
+
   if ( sem_up( &(queue->s_buffer) ) || sem_up( &(queue->s_vaga) ) )
     return(-1);
 
@@ -799,6 +1228,15 @@ int mqueue_destroy (mqueue_t *queue) {
   queue->buffer_start = 0;
   queue->buffer_count = 0;
 
+  // remove a fila do registro
+  if ( queue->reg_prev )
+    queue->reg_prev->reg_next = queue->reg_next;
+  else if ( mqueueList == queue )
+    mqueueList = queue->reg_next;
+  if ( queue->reg_next )
+    queue->reg_next->reg_prev = queue->reg_prev;
+  queue->reg_prev = queue->reg_next = NULL;
+
   if ( sem_destroy( &(queue->s_buffer) ) || sem_destroy( &(queue->s_item) ) || sem_destroy( &(queue->s_vaga) ) )
     return(-1);
 
@@ -806,7 +1244,7 @@ int mqueue_destroy (mqueue_t *queue) {
   queue->msg_size = 0;
 
   #ifdef DEBUG
-  fprintf(stdout, "[PPOS debug]: message queue destroyed\n");
+  ppos_log(LOG_LEVEL_DEBUG, "[PPOS debug]: message queue destroyed\n");
   #endif
 
   return(0);
@@ -21,14 +21,58 @@ typedef struct task_t
    int din_prio ;  // prioridade dinâmica da tarefa
    int system_task ;  // task de sistema? ( 0 = NÃO, 1 = SIM)
    unsigned int inic_time;  // tempo em que a tarefa foi iniciada
-   unsigned int proc_time;  // tempo de processamento da tarefa
-   unsigned int inic_proc_time;   // tempo em que a tarefa iniciou um processamento
+   unsigned int proc_time;  // tempo de processamento da tarefa (ms)
    unsigned int wake_time;  // tempo em que a tarefa deve ser acordada
    unsigned int activ;  // quantidade de ativações do processo
    unsigned int exit_code;  // exit code da tarefa
    struct task_t *joinedQueue;  // fila de tarefas esperando fim da task
+   int io_group;  // grupo de E/S da tarefa (herdado da criadora)
+   unsigned int io_ops;  // pedidos de disco concluidos
+   unsigned long long io_bytes;  // bytes transferidos de/para os discos
+   unsigned long long io_time;  // tempo de disco consumido (us)
+   struct task_t *reg_prev, *reg_next;  // registro das tarefas existentes
+   int acct_state;  // estado contabilizado (executando, pronta, suspensa, terminada)
+   unsigned long long acct_since;  // inicio do estado contabilizado (ns)
+   unsigned long long create_ns;  // instante de criacao (ns)
+   unsigned long long run_ns;  // tempo executando (ns)
+   unsigned long long ready_ns;  // tempo pronta, aguardando o processador (ns)
+   unsigned long long blocked_ns;  // tempo suspensa (ns)
+   unsigned int vol_switches;  // trocas voluntarias (bloqueio, yield, fim)
+   unsigned int invol_switches;  // trocas involuntarias (fim de quantum)
+   int lat_cause;  // causa da espera na fila de prontas (LAT_*, -1 = nenhuma)
+   void *wait_sem;  // semaforo em que a tarefa esta suspensa (ou NULL)
+   void (*entry)(void *);  // funcao de entrada da tarefa (NULL = main)
+   unsigned int stack_max;  // pico de uso da pilha, medido no fim (bytes)
+   int stack_paint;         // pilha pintada inteira na criacao (medicao ligada)
 } task_t ;
 
+// contadores de uma tarefa, consultados com task_stats()
+typedef struct
+{
+  int id;                        // identificador da tarefa
+  int status;                    // status da tarefa (como em task_t)
+  int prio;                      // prioridade estatica
+  int system_task;               // tarefa de sistema?
+  unsigned int activations;      // ativacoes
+  unsigned int vol_switches;     // trocas voluntarias (bloqueio, yield, fim)
+  unsigned int invol_switches;   // trocas involuntarias (fim de quantum)
+  unsigned long long elapsed_ns; // tempo desde a criacao (ns)
+  unsigned long long run_ns;     // tempo executando (ns)
+  unsigned long long ready_ns;   // tempo pronta, aguardando o processador (ns)
+  unsigned long long blocked_ns; // tempo suspensa (ns)
+} task_stats_t ;
+
+// contadores do sistema, consultados com ppos_stats()
+typedef struct
+{
+  unsigned long long uptime_ns;   // tempo desde ppos_init() (ns)
+  unsigned long long switches;    // trocas de contexto
+  unsigned long long preemptions; // preempcoes por fim de quantum
+  unsigned int tasks;             // tarefas existentes (inclusive o dispatcher)
+  unsigned int ready;             // tarefas na fila de prontas
+  unsigned int blocked;           // tarefas suspensas
+} ppos_stats_t ;
+
 // estrutura que define um semáforo
 typedef struct
 {
@@ -51,7 +95,7 @@ typedef struct
 } barrier_t ;
 
 // estrutura que define uma fila de mensagens
-typedef struct
+typedef struct mqueue_t
 {
   semaphore_t s_buffer, s_item, s_vaga;   // semáforos de buffer, itens e vagas
   void *buffer;    // buffer circular para armazenamento de mensagens
@@ -59,6 +103,7 @@ typedef struct
   int buffer_count;   // quantidade de elementos no buffer
   int msg_size;   // tamanho de cada mensagem
   int msg_max;    // capacidade de mensagens
+  struct mqueue_t *reg_prev, *reg_next;   // registro das filas existentes
 } mqueue_t ;
 
 #endif
@@ -4,236 +4,1329 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <signal.h>
+#include <time.h>
 #include "ppos.h"
 #include "disk.h"
 #include "ppos_disk.h"
+#include "ppos_trace.h"
+#include "ppos_lat.h"
 
 // variáveis globais e constantes ==============================================
 
 extern task_t *currentTask;
 extern int userTasks;
-task_t taskDiskMgr;
-semaphore_t diskSleep;
-disk_t disk;
-int diskSignal;
+disk_t disks[DISK_MAX_DEVICES];   // tabela de discos
 
 // estrutura que define um tratador de sinal (deve ser global ou static)
 struct sigaction diskAction;
+int diskActionSet = 0;
+
+// intervalo maximo (ms) em que o gerente dorme aguardando limites de banda
+#define DISK_IO_POLL 2
+
+// grupo de E/S: contadores e baldes de fichas dos limites
+typedef struct
+{
+  disk_limit_t limit;  // limites do grupo
+  double ops, bytes;   // fichas disponiveis
+  unsigned int last;   // ultima reposicao das fichas (ms)
+  disk_io_t io;        // contadores do grupo
+} disk_group_t;
+
+disk_group_t diskGroups[DISK_IO_GROUPS];   // tabela de grupos de E/S
+
+// SIGUSR1 recebido desde o ultimo disk_poll()
+static volatile sig_atomic_t diskSignal = 0;
 
 // funções locais ==============================================================
 
-// tratador de sinal de disco
-static void disk_handler (int signum) {
+/*!
+  \brief Acorda o gerente de um disco, se ainda nao foi acordado. Chamada
+  pelas tarefas e pelo despachante (disk_poll), nunca pelo tratador de sinal
+*/
+static void disk_wakeup (disk_t *disk) {
+  if ( !disk->signal ) {
+    disk->signal = 1;
+    sem_up(&(disk->sleep));
+  }
+}
+
+// tratador de sinal de disco: si_value indica o disco que concluiu a
+// operacao; o tratador apenas marca o disco, pois pode interromper uma
+// tarefa no meio de uma operacao sobre as filas do nucleo
+static void disk_handler (int signum, siginfo_t *info, void *context) {
+  int dev = 0;
+
   diskSignal = 1;
-  // acorda tarefa de gerente de disco, caso esteja dormindo
-  if (taskDiskMgr.status == 3) 
-    sem_up(&(diskSleep));
+  if ( info && info->si_code == SI_QUEUE )
+    dev = info->si_value.sival_int;
+  if ( dev < 0 || dev >= DISK_MAX_DEVICES || !disks[dev].active )
+    return;
+
+  disks[dev].irq = 1;
 }
 
 /*!
-  \brief Tarefa gerente de disco
+  \brief Verifica se o intervalo [b1, b1+c1) contem [b2, b2+c2)
+*/
+static int range_contains (int b1, int c1, int b2, int c2) {
+  return ( b2 >= b1 && b2 + c2 <= b1 + c1 );
+}
+
+/*!
+  \brief Verifica se os intervalos [b1, b1+c1) e [b2, b2+c2) se sobrepoem
 */
-static void disk_manager () {
+static int range_overlaps (int b1, int c1, int b2, int c2) {
+  return ( b1 < b2 + c2 && b2 < b1 + c1 );
+}
 
-  request_t *req = NULL;
+/*!
+  \brief Relogio do nucleo em microssegundos (virtual no modo de simulacao)
+*/
+static unsigned long long disk_clock (void) {
+  return( ppos_clock() / 1000 );
+}
 
-  while (1) {
-    
-    sem_down(&(disk.access));
-
-    if ( diskSignal ) {
-      diskSignal = 0;
-      req = disk.queue;
-      sem_up(&(req->wait));
-      if ( queue_remove( (queue_t **) &(disk.queue), (queue_t *) req ) )
-        fprintf(stderr, "[PPOS error] disk_manager: fail to remove request from queue\n");
+/*!
+  \brief Capacidade de um balde de fichas: burst ms de taxa, no minimo 1
+*/
+static double disk_bucket_cap (int rate, int burst) {
+  double cap = (double) rate * (burst ? burst : DISK_IO_BURST) / 1000.0;
+
+  return( cap < 1.0 ? 1.0 : cap );
+}
+
+/*!
+  \brief Verifica o limite do grupo de E/S de um pedido
+
+  Um pedido pode ser enviado se o grupo tem fichas para seu custo (ou o
+  balde esta cheio, para pedidos maiores que a rajada).
+
+  \param disk Disco do pedido
+  \param req Pedido a verificar
+  \param now Instante atual (ms)
+
+  \return 0 se o pedido pode ser enviado, ou a espera estimada em ms
+*/
+static unsigned int disk_throttle (disk_t *disk, request_t *req, unsigned int now) {
+  disk_group_t *group = &diskGroups[req->group];
+  disk_limit_t *limit = &(group->limit);
+  unsigned int elapsed, wait = 0, w;
+  double cap, need;
+
+  if ( !limit->iops && !limit->bps )
+    return(0);
+
+  // repoe as fichas pelo tempo decorrido
+  elapsed = now - group->last;
+  group->last = now;
+  if ( limit->iops ) {
+    cap = disk_bucket_cap(limit->iops, limit->burst);
+    group->ops += (double) limit->iops * elapsed / 1000.0;
+    if ( group->ops > cap )
+      group->ops = cap;
+    need = cap < 1.0 ? cap : 1.0;
+    if ( group->ops < need ) {
+      w = (unsigned int) ((need - group->ops) * 1000.0 / limit->iops) + 1;
+      wait = w > wait ? w : wait;
+    }
+  }
+  if ( limit->bps ) {
+    cap = disk_bucket_cap(limit->bps, limit->burst);
+    group->bytes += (double) limit->bps * elapsed / 1000.0;
+    if ( group->bytes > cap )
+      group->bytes = cap;
+    need = (double) req->count * disk->blockSize;
+    if ( need > cap )
+      need = cap;
+    if ( group->bytes < need ) {
+      w = (unsigned int) ((need - group->bytes) * 1000.0 / limit->bps) + 1;
+      wait = w > wait ? w : wait;
+    }
+  }
+
+  // contabiliza o pedido retido (uma vez por pedido)
+  if ( wait && !req->throttled ) {
+    req->throttled = 1;
+    disk->stats.throttled++;
+    group->io.throttled++;
+  }
+  return(wait);
+}
+
+/*!
+  \brief Desconta do grupo de E/S as fichas de um pedido enviado ao disco
+*/
+static void disk_charge (disk_t *disk, request_t *req) {
+  disk_group_t *group = &diskGroups[req->group];
+
+  if ( group->limit.iops )
+    group->ops -= 1.0;
+  if ( group->limit.bps )
+    group->bytes -= (double) req->count * disk->blockSize;
+}
+
+/*!
+  \brief Conclui um pedido, acordando a tarefa que o solicitou
+
+  \param disk Disco do pedido
+  \param req Pedido a ser concluido
+  \param queue Fila em que o pedido esta
+  \param exit_code Resultado da operacao
+  \param time Tempo de disco consumido pelo pedido (us)
+*/
+static void disk_complete (disk_t *disk, request_t *req, request_t **queue, int exit_code,
+                           unsigned long long time) {
+  disk_io_t *io = &(diskGroups[req->group].io);
+  unsigned int ms = systime() - req->submit;
+  unsigned long long bytes = exit_code ? 0 : (unsigned long long) req->count * disk->blockSize;
+
+  if ( queue_remove( (queue_t **) queue, (queue_t *) req ) )
+    fprintf(stderr, "[PPOS error] disk_complete: fail to remove request from queue\n");
+
+  req->exit_code = exit_code;
+
+  TRACE(TRACE_DISK_DONE, req->type, req, disk->dev, req->block, req->count, exit_code);
+
+  // a tarefa que aguarda o pedido retoma por causa do disco
+  if ( req->wait.queue && req->wait.queue->lat_cause < 0 )
+    req->wait.queue->lat_cause = LAT_DISK;
+
+  // pedidos abandonados nao sao contabilizados
+  if ( exit_code == DISK_ECANCELED || exit_code == DISK_ETIMEDOUT ) {
+    sem_up(&(req->wait));
+    return;
+  }
+
+  // contabiliza o pedido na tarefa e no seu grupo
+  req->task->io_ops++;
+  req->task->io_bytes += bytes;
+  req->task->io_time += time;
+  io->ops++;
+  io->bytes += bytes;
+  io->time += time;
+
+  // registra a latencia do pedido na sua classe
+  lat_record(&(disk->latency[req->own_cls]), (unsigned long long) ms * 1000000);
+
+  sem_up(&(req->wait));
+}
+
+/*!
+  \brief Absorve escritas pendentes que serao sobrescritas por um novo pedido
+
+  Uma escrita ainda na fila cujos blocos estao todos contidos em uma escrita
+  mais nova eh concluida sem ir ao disco, desde que nenhuma leitura pendente
+  dependa do seu conteudo.
+
+  \param disk Disco em que o pedido foi inserido
+  \param req Pedido de escrita recem inserido na fila
+*/
+static void disk_absorb (disk_t *disk, request_t *req) {
+  request_t **writes = &(disk->queue[WRITE_OPERATION]);
+  request_t *reads = disk->queue[READ_OPERATION];
+  request_t *aux, *next, *r;
+  int n, size, reader;
+
+  size = queue_size( (queue_t *) *writes );
+  aux = *writes;
+  for ( n = 0; n < size; n++ ) {
+    next = aux->next;
+    if ( aux != req && aux->seq < req->seq &&
+         range_contains(req->block, req->count, aux->block, aux->count) ) {
+      // verifica se existe leitura pendente sobre os blocos da escrita antiga
+      reader = 0;
+      if ( (r = reads) )
+        do {
+          if ( range_overlaps(r->block, r->count, aux->block, aux->count) )
+            reader = 1;
+          r = r->next;
+        } while ( !reader && r != reads );
+
+      if ( !reader ) {
+        disk_complete(disk, aux, writes, 0, 0);
+        disk->stats.absorbed++;
+        req->pinned = 1;
+      }
+    }
+    aux = next;
+  }
+}
+
+/*!
+  \brief Abandona os pedidos da fila cujo prazo de abandono venceu
+
+  \param disk Disco cuja fila sera verificada
+*/
+static void disk_expire (disk_t *disk) {
+  request_t *req, *next;
+  unsigned int now = systime();
+  int type, n, size;
+
+  for ( type = 0; type < 2; type++ ) {
+    req = disk->queue[type];
+    size = queue_size( (queue_t *) req );
+    for ( n = 0; n < size; n++ ) {
+      next = req->next;
+      if ( req->expire && !req->pinned && (int) (now - req->expire) >= 0 ) {
+        disk_complete(disk, req, &(disk->queue[type]), DISK_ETIMEDOUT, 0);
+        disk->stats.timedout++;
+      }
+      req = next;
+    }
+  }
+}
+
+/*!
+  \brief Insere um pedido na fila, mantendo-a em ordem crescente de bloco
+  (pedidos sobre o mesmo bloco ficam em ordem de chegada)
+*/
+static void disk_insert (request_t **queue, request_t *req) {
+  request_t *aux = *queue;
+  int n, size = queue_size( (queue_t *) *queue );
+
+  for ( n = 0; n < size && aux->block <= req->block; n++ )
+    aux = aux->next;
+
+  if ( n == size ) {
+    queue_append( (queue_t **) queue, (queue_t *) req );
+    return;
+  }
+
+  // insere antes de aux
+  req->next = aux;
+  req->prev = aux->prev;
+  aux->prev->next = req;
+  aux->prev = req;
+  if ( n == 0 )
+    *queue = req;
+}
+
+/*!
+  \brief Verifica se dois pedidos devem chegar ao disco em ordem de chegada:
+  tem blocos em comum e ao menos um deles eh escrita
+*/
+static int disk_depends (request_t *a, request_t *b) {
+  return ( (a->type == WRITE_OPERATION || b->type == WRITE_OPERATION) &&
+           range_overlaps(a->block, a->count, b->block, b->count) );
+}
+
+/*!
+  \brief Verifica se um pedido conflita com as operacoes em andamento ou com
+  pedidos mais antigos da fila
+
+  Um pedido nao pode ser enviado enquanto houver operacao em andamento ou
+  pedido anterior ainda na fila sobre os mesmos blocos em que um dos dois
+  seja escrita, para manter a ordem: a preferencia pelas leituras e o
+  elevador nao podem passar uma leitura a frente da escrita que ela deve
+  ver, nem inverter duas escritas sobrepostas. A fila so eh percorrida para
+  os pedidos que encontraram um desses na chegada (ordered).
+*/
+static int disk_conflict (disk_t *disk, request_t *req) {
+  disk_batch_t *batch;
+  request_t *aux;
+  int i, type, n, size;
+
+  for ( i = 0; i < disk->depth; i++ ) {
+    batch = &(disk->batches[i]);
+    if ( batch->busy &&
+         (batch->type == WRITE_OPERATION || req->type == WRITE_OPERATION) &&
+         range_overlaps(batch->first, batch->count, req->block, req->count) )
+      return(1);
+  }
+
+  if ( !req->ordered )
+    return(0);
+  for ( type = 0; type < 2; type++ ) {
+    aux = disk->queue[type];
+    size = queue_size( (queue_t *) aux );
+    for ( n = 0; n < size; n++, aux = aux->next )
+      if ( aux->seq < req->seq && disk_depends(aux, req) )
+        return(1);
+  }
+  // os pedidos anteriores ja sairam da fila, e novos sao sempre posteriores
+  req->ordered = 0;
+  return(0);
+}
+
+/*!
+  \brief Heranca de prioridade: os pedidos anteriores da fila que req deve
+  esperar recebem sua classe e seu prazo, se forem mais urgentes, e os
+  repassam aos pedidos que eles proprios esperam. Assim uma leitura urgente
+  nao herda o prazo longo da escrita de baixa prioridade a sua frente.
+
+  \param disk Disco do pedido
+  \param req Pedido recem inserido (ou que acabou de herdar)
+  \param cls Classe herdada
+  \param deadline Prazo herdado
+
+  \return 1 se req espera algum pedido da fila, 0 caso contrario
+*/
+static int disk_inherit (disk_t *disk, request_t *req, int cls, unsigned int deadline) {
+  request_t *aux;
+  int type, n, size, found = 0;
+
+  for ( type = 0; type < 2; type++ ) {
+    aux = disk->queue[type];
+    size = queue_size( (queue_t *) aux );
+    for ( n = 0; n < size; n++, aux = aux->next ) {
+      if ( aux->seq >= req->seq || !disk_depends(aux, req) )
+        continue;
+      found = 1;
+      if ( aux->cls <= cls && (int) (aux->deadline - deadline) <= 0 )
+        continue;
+      if ( aux->cls > cls )
+        aux->cls = cls;
+      if ( (int) (aux->deadline - deadline) > 0 )
+        aux->deadline = deadline;
+      if ( aux->ordered )
+        disk_inherit(disk, aux, aux->cls, aux->deadline);
     }
+  }
+  return(found);
+}
+
+/*!
+  \brief Atende uma leitura com os dados da escrita mais recente da fila
+  sobre os mesmos blocos, se essa escrita contem toda a leitura. Escritas
+  em andamento sobre esses blocos sao sempre anteriores as da fila.
 
-    // verifica se o disco esta livre e se existem pedidos a serem atendidos
-    if ( (disk_cmd(DISK_CMD_STATUS, 0, 0) == DISK_STATUS_IDLE) && disk.queue ) {
-      req = disk.queue;
-      
-      // verifica se a operacao desejada eh leitura ou escrita
-      switch ( req->type ) {
-      case READ_OPERATION:
-        if ( disk_cmd(DISK_CMD_READ, req->block, req->buffer) ) {
-          fprintf(stderr, "[PPOS error] disk_manager: fail to read disk\n");
-          req->exit_code = -1;
+  \return 1 se a leitura foi atendida, 0 caso contrario
+*/
+static int disk_forward (disk_t *disk, request_t *req) {
+  request_t *aux, *last = NULL;
+  int i, n, size;
+
+  aux = disk->queue[WRITE_OPERATION];
+  size = queue_size( (queue_t *) aux );
+  for ( n = 0; n < size; n++, aux = aux->next )
+    if ( range_overlaps(aux->block, aux->count, req->block, req->count) &&
+         ( !last || aux->seq > last->seq ) )
+      last = aux;
+  if ( !last || !range_contains(last->block, last->count, req->block, req->count) )
+    return(0);
+
+  for ( i = 0; i < req->count; i++ )
+    memcpy(req->buffers[i], last->buffers[req->block - last->block + i], disk->blockSize);
+  return(1);
+}
+
+/*!
+  \brief Verifica se um pedido pode ser enviado agora: sem conflito com as
+  operacoes em andamento e dentro do limite do seu grupo. A menor espera por
+  limite fica em disk->wait.
+*/
+static int disk_ready (disk_t *disk, request_t *req, unsigned int now) {
+  unsigned int wait;
+
+  if ( disk_conflict(disk, req) )
+    return(0);
+  if ( (wait = disk_throttle(disk, req, now)) ) {
+    if ( !disk->wait || wait < disk->wait )
+      disk->wait = wait;
+    return(0);
+  }
+  return(1);
+}
+
+/*!
+  \brief Escolhe o pedido que inicia a proxima operacao de disco
+
+  Na politica DISK_SCHED_FIFO, o pedido mais antigo. Na DISK_SCHED_DEADLINE,
+  o pedido de prazo vencido mais antigo; senao, na classe de prioridade mais
+  alta com pedidos, uma leitura (ou uma escrita, se as escritas ja esperaram
+  writes_starved operacoes), a primeira a partir da posicao da cabeca.
+  Pedidos que conflitam com operacoes em andamento nao sao escolhidos.
+
+  \param disk Disco cuja fila sera atendida
+
+  \return Pedido escolhido ou NULL
+*/
+static request_t * disk_pick (disk_t *disk) {
+  request_t *req, *best = NULL;
+  unsigned int now = systime();
+  int type, n, size, cls = DISK_CLASSES, waiting[2] = {0, 0};
+
+  disk->wait = 0;
+
+  // pedido mais antigo (FIFO) ou de prazo vencido mais antigo (DEADLINE)
+  for ( type = 0; type < 2; type++ ) {
+    req = disk->queue[type];
+    size = queue_size( (queue_t *) req );
+    for ( n = 0; n < size; n++, req = req->next ) {
+      if ( !disk_ready(disk, req, now) )
+        continue;
+      if ( disk->sched.policy == DISK_SCHED_FIFO ||
+           (int) (now - req->deadline) >= 0 ) {
+        if ( !best || req->seq < best->seq )
+          best = req;
+      }
+      if ( req->cls < cls )
+        cls = req->cls;
+    }
+  }
+  if ( best ) {
+    if ( disk->sched.policy != DISK_SCHED_FIFO )
+      disk->stats.expired++;
+    return(best);
+  }
+  if ( cls == DISK_CLASSES )
+    return(NULL);
+
+  // tipos com pedidos na classe escolhida
+  for ( type = 0; type < 2; type++ ) {
+    req = disk->queue[type];
+    size = queue_size( (queue_t *) req );
+    for ( n = 0; n < size && !waiting[type]; n++, req = req->next )
+      if ( req->cls == cls && disk_ready(disk, req, now) )
+        waiting[type] = 1;
+  }
+
+  // leituras primeiro, mas sem deixar as escritas esperando demais
+  if ( waiting[READ_OPERATION] &&
+       ( !waiting[WRITE_OPERATION] || disk->starved < disk->sched.writes_starved ) ) {
+    type = READ_OPERATION;
+    if ( waiting[WRITE_OPERATION] )
+      disk->starved++;
+  } else {
+    type = WRITE_OPERATION;
+    disk->starved = 0;
+  }
+
+  // elevador: primeiro pedido a partir da cabeca, ou o de menor bloco
+  req = disk->queue[type];
+  size = queue_size( (queue_t *) req );
+  for ( n = 0; n < size; n++, req = req->next ) {
+    if ( req->cls != cls || !disk_ready(disk, req, now) )
+      continue;
+    if ( !best )
+      best = req;
+    if ( req->block >= disk->head )
+      return(req);
+  }
+  return(best);
+}
+
+/*!
+  \brief Monta a proxima operacao de disco a partir do pedido escolhido
+
+  O pedido eh estendido com pedidos do mesmo tipo sobre blocos adjacentes
+  (ate DISK_VEC_MAX blocos); leituras cujos blocos ja estao cobertos pela
+  operacao sao atendidas pela mesma conclusao. Os pedidos escolhidos sao
+  movidos para a fila de pedidos da operacao.
+
+  \param disk Disco cuja fila sera atendida
+  \param batch Operacao livre a preencher
+  \param head Pedido escolhido por disk_pick()
+*/
+static void disk_batch (disk_t *disk, disk_batch_t *batch, request_t *head) {
+  request_t **queue = &(disk->queue[head->type]);
+  request_t *req, *next;
+  unsigned int now = systime();
+  int first, last;
+  int changed, n, size, i;
+
+  first = head->block;
+  last = head->block + head->count;
+  batch->reqs = NULL;
+  batch->type = head->type;
+  queue_remove( (queue_t **) queue, (queue_t *) head );
+  head->dup = 0;
+  queue_append( (queue_t **) &(batch->reqs), (queue_t *) head );
+  disk_charge(disk, head);
+
+  // estende a operacao enquanto houver pedidos compativeis
+  while ( *queue ) {
+    changed = 0;
+    size = queue_size( (queue_t *) *queue );
+    req = *queue;
+    for ( n = 0; n < size; n++ ) {
+      next = req->next;
+      if ( disk_ready(disk, req, now) ) {
+        req->dup = -1;
+        if ( head->type == READ_OPERATION &&
+             range_contains(first, last - first, req->block, req->count) ) {
+          // leitura duplicada: copiada da operacao em andamento
+          req->dup = 1;
+          disk->stats.dedup++;
+        } else if ( req->block == last &&
+                    last + req->count - first <= DISK_VEC_MAX ) {
+          last += req->count;
+          req->dup = 0;
+        } else if ( req->block + req->count == first &&
+                    last - req->block <= DISK_VEC_MAX ) {
+          first = req->block;
+          req->dup = 0;
         }
-        break;
-      case WRITE_OPERATION:
-        if ( disk_cmd(DISK_CMD_WRITE, req->block, req->buffer) ) {
-          fprintf(stderr, "[PPOS error] disk_manager: fail to write disk\n");
-          req->exit_code = -1;
+        if ( req->dup >= 0 ) {
+          if ( !req->dup )
+            disk->stats.merged++;
+          queue_remove( (queue_t **) queue, (queue_t *) req );
+          queue_append( (queue_t **) &(batch->reqs), (queue_t *) req );
+          disk_charge(disk, req);
+          changed = 1;
         }
-        break;
-      default:
-        fprintf(stderr, "[PPOS error] disk_manager: wrong disk operation\n");
-        req->exit_code = -1;
+      }
+      req = next;
+    }
+    if ( !changed )
+      break;
+  }
+
+  // monta o vetor de buffers da operacao com os pedidos nao duplicados
+  batch->first = first;
+  batch->count = last - first;
+  req = batch->reqs;
+  do {
+    if ( !req->dup )
+      for ( i = 0; i < req->count; i++ )
+        batch->vec[req->block - first + i] = req->buffers[i];
+    req = req->next;
+  } while ( req != batch->reqs );
+
+  batch->busy = 1;
+  batch->start = disk_clock();
+  disk->stats.travel += abs(first - disk->head);
+  disk->head = last;
+}
+
+/*!
+  \brief Conclui todos os pedidos de uma operacao
+
+  \param disk Disco que concluiu a operacao
+  \param batch Operacao concluida
+  \param exit_code Resultado da operacao
+*/
+static void disk_finish (disk_t *disk, disk_batch_t *batch, int exit_code) {
+  unsigned long long time = disk_clock() - batch->start;
+  request_t *req;
+  int i, blocks = 0;
+
+  // o tempo de disco eh dividido entre os pedidos, pelo numero de blocos
+  req = batch->reqs;
+  do {
+    blocks += req->count;
+    req = req->next;
+  } while ( req != batch->reqs );
+
+  while ( (req = batch->reqs) ) {
+    // leituras duplicadas recebem copia dos blocos lidos
+    if ( req->dup && !exit_code )
+      for ( i = 0; i < req->count; i++ )
+        memcpy(req->buffers[i], batch->vec[req->block - batch->first + i], disk->blockSize);
+    disk_complete(disk, req, &(batch->reqs), exit_code, time * req->count / blocks);
+  }
+  batch->busy = 0;
+}
+
+/*!
+  \brief Tarefa gerente de disco
+
+  \param arg Disco atendido pela tarefa
+*/
+static void disk_manager (void *arg) {
+
+  disk_t *disk = arg;
+  disk_batch_t *batch;
+  request_t *head;
+  unsigned int wait;
+  int tag, result, i;
+
+  while (1) {
+    
+    sem_down(&(disk->access));
+
+    // novas conclusoes ou pedidos a partir daqui acordam o gerente de novo
+    disk->signal = 0;
+
+    // coleta as operacoes concluidas pelo disco
+    while ( disk_dev_reap(disk->dev, &tag, &result) > 0 )
+      if ( tag >= 0 && tag < disk->depth )
+        disk_finish(disk, &(disk->batches[tag]), result);
+
+    // descarta os pedidos com prazo de abandono vencido
+    disk_expire(disk);
+
+    // envia operacoes enquanto houver pedidos e espaco na fila do disco;
+    // se sobrarem apenas pedidos retidos por limites, o gerente dorme ate
+    // que o limite os libere (no maximo DISK_IO_POLL ms)
+    wait = 0;
+    for ( i = 0; i < disk->depth; i++ ) {
+      batch = &(disk->batches[i]);
+      if ( batch->busy )
+        continue;
+      if ( !(head = disk_pick(disk)) ) {
+        wait = disk->wait;
         break;
       }
+      disk_batch(disk, batch, head);
+      disk->stats.ops++;
+      disk->stats.blocks += batch->count;
+
+      TRACE(TRACE_DISK_ISSUE, batch->type, batch, disk->dev, batch->first, batch->count, 0);
+
+      if ( disk_dev_queue(disk->dev,
+                          (batch->type == READ_OPERATION) ? DISK_CMD_READV : DISK_CMD_WRITEV,
+                          batch->first, batch->count, batch->vec, i) ) {
+        fprintf(stderr, "[PPOS error] disk_manager: fail to %s disk %d\n",
+                (batch->type == READ_OPERATION) ? "read" : "write", disk->dev);
+        disk_finish(disk, batch, -1);
+      }
     }
 
-    sem_up(&(disk.access));
+    sem_up(&(disk->access));
 
-    sem_down(&(diskSleep));
+    if ( wait )
+      task_sleep(wait < DISK_IO_POLL ? wait : DISK_IO_POLL);
+    else
+      sem_down(&(disk->sleep));
 
   }
 
 }
 
+/*!
+  \brief Retorna o disco ativo de numero dev, ou NULL
+*/
+static disk_t * disk_get (int dev) {
+  if ( dev < 0 || dev >= DISK_MAX_DEVICES || !disks[dev].active )
+    return(NULL);
+  return(&disks[dev]);
+}
+
+/*!
+  \brief Divide uma operacao vetorial em pedidos de ate DISK_VEC_MAX blocos,
+  enviados todos de uma vez, e aguarda a conclusao de todos
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int disk_request_vec (int dev, int type, int block, int count, void **buffers) {
+  disk_t *disk = disk_get(dev);
+  request_t *reqs;
+  int i, n, nreqs, result = 0;
+
+  // verifica parametros
+  if ( !disk || !buffers || count < 1 || block < 0 || block + count > disk->numBlocks )
+    return(-1);
+
+  nreqs = (count + DISK_VEC_MAX - 1) / DISK_VEC_MAX;
+  reqs = malloc(nreqs * sizeof(request_t));
+  if ( !reqs )
+    return(-1);
+
+  for ( i = 0; i < nreqs; i++ ) {
+    n = ( count > DISK_VEC_MAX ) ? DISK_VEC_MAX : count;
+    if ( disk_dev_submit(dev, &reqs[i], type, block, n, buffers) ) {
+      nreqs = i;
+      result = -1;
+      break;
+    }
+    block += n;
+    buffers += n;
+    count -= n;
+  }
+
+  for ( i = 0; i < nreqs; i++ )
+    if ( disk_dev_wait(&reqs[i]) )
+      result = -1;
+
+  free(reqs);
+
+  return(result);
+}
+
 // funções gerais ==============================================================
 
 /*!
-  \brief Inicializacao do gerente de disco
+  \brief Acorda os gerentes dos discos que concluiram operacoes desde o
+  ultimo SIGUSR1: o disco indicado em si_value e, como sinais de discos
+  diferentes se fundem, os demais que tem conclusoes aguardando coleta
+*/
+void disk_poll () {
+  int dev;
+
+  if ( !diskSignal )
+    return;
+  // limpa antes de acordar: o gerente colhe todas as conclusoes
+  diskSignal = 0;
+
+  for ( dev = 0; dev < DISK_MAX_DEVICES; dev++ )
+    if ( disks[dev].active && ( disks[dev].irq || disk_dev_done(dev) > 0 ) ) {
+      disks[dev].irq = 0;
+      disk_wakeup(&disks[dev]);
+    }
+}
+
+/*!
+  \brief Inicializacao do gerente de um disco
 
+  \param dev Numero do disco (0 a DISK_MAX_DEVICES-1)
   \param numBlocks Tamanho do disco, em blocos
   \param blockSize Tamanho de cada bloco do disco, em bytes
 
   \return -1 em erro ou 0 em sucesso
-*/  
-int disk_mgr_init (int *numBlocks, int *blockSize) {
+*/
+int disk_dev_mgr_init (int dev, int *numBlocks, int *blockSize) {
+
+  disk_t *disk;
+
+  if ( dev < 0 || dev >= DISK_MAX_DEVICES || disks[dev].active ) {
+    fprintf(stderr, "[PPOS error] disk_mgr_init: invalid disk %d\n", dev);
+    return(-1);
+  }
+  disk = &disks[dev];
 
   // inicializa disco
-  if ( disk_cmd(DISK_CMD_INIT, 0, 0) ) {
-    fprintf(stderr, "[PPOS error] disk_mgr_init: fail to initialize disk\n");
+  if ( disk_dev_cmd(dev, DISK_CMD_INIT, 0, 0) ) {
+    fprintf(stderr, "[PPOS error] disk_mgr_init: fail to initialize disk %d\n", dev);
     return(-1);
   }
 
   // coleta a quantidade de blocos e o tamanho dos blocos
-  disk.numBlocks = disk_cmd(DISK_CMD_DISKSIZE, 0, 0);
-  if ( disk.numBlocks < 0 ) {
+  disk->numBlocks = disk_dev_cmd(dev, DISK_CMD_DISKSIZE, 0, 0);
+  if ( disk->numBlocks < 0 ) {
     fprintf(stderr, "[PPOS error] disk_mgr_init: fail to collect disk size\n");
     return(-1);
   }
-  disk.blockSize = disk_cmd(DISK_CMD_BLOCKSIZE, 0, 0);
-  if ( disk.blockSize < 0 ) {
+  disk->blockSize = disk_dev_cmd(dev, DISK_CMD_BLOCKSIZE, 0, 0);
+  if ( disk->blockSize < 0 ) {
     fprintf(stderr, "[PPOS error] disk_mgr_init: fail to collect block size\n");
     return(-1);
   }
-  disk.queue = NULL;
+  disk->depth = disk_dev_cmd(dev, DISK_CMD_QDEPTH, 0, 0);
+  if ( disk->depth < 1 )
+    disk->depth = 1;
+  if ( disk->depth > DISK_QDEPTH_MAX )
+    disk->depth = DISK_QDEPTH_MAX;
+  memset(disk->batches, 0, sizeof(disk->batches));
+  disk->dev = dev;
+  disk->queue[READ_OPERATION] = NULL;
+  disk->queue[WRITE_OPERATION] = NULL;
+  disk->signal = 0;
+  disk->irq = 0;
+  disk->seq = 0;
+  disk->head = 0;
+  disk->starved = 0;
+  disk->sched.policy = DISK_SCHED_DEADLINE;
+  disk->sched.read_expire = DISK_READ_EXPIRE;
+  disk->sched.write_expire = DISK_WRITE_EXPIRE;
+  disk->sched.writes_starved = DISK_WRITES_STARVED;
+  memset(&(disk->stats), 0, sizeof(disk_stats_t));
+  memset(disk->latency, 0, sizeof(disk->latency));
 
-  *numBlocks = disk.numBlocks;
-  *blockSize = disk.blockSize;
+  *numBlocks = disk->numBlocks;
+  *blockSize = disk->blockSize;
 
-  if ( sem_create(&(disk.access), 1) )
+  if ( sem_create(&(disk->access), 1) )
     return(-1);
-  if ( sem_create(&(diskSleep), 0) )
+  if ( sem_create(&(disk->sleep), 0) )
     return(-1);
 
-  diskSignal = 0;
-
-  // registra a ação para o sinal de timer SIGALRM
-  diskAction.sa_handler = disk_handler ;
-  sigemptyset (&diskAction.sa_mask) ;
-  diskAction.sa_flags = 0 ;
-  if ( sigaction( SIGUSR1, &diskAction, 0 ) < 0 ) {
-    perror ("Erro em sigaction disk: ") ;
-    exit(-1) ;
+  // registra a ação para o sinal de disco SIGUSR1 (uma vez para todos os
+  // discos); SIGIO fica bloqueado durante o tratador, para que conclusoes
+  // de outros discos nao se fundam em um unico SIGUSR1
+  if ( !diskActionSet ) {
+    diskAction.sa_sigaction = disk_handler ;
+    sigemptyset (&diskAction.sa_mask) ;
+    sigaddset (&diskAction.sa_mask, SIGIO) ;
+    diskAction.sa_flags = SA_SIGINFO ;
+    if ( sigaction( SIGUSR1, &diskAction, 0 ) < 0 ) {
+      perror ("Erro em sigaction disk: ") ;
+      exit(-1) ;
+    }
+    diskActionSet = 1;
   }
 
-  // cria tarefa de gerenciador de disco
-  task_create(&taskDiskMgr, disk_manager, NULL);
+  disk->active = 1;
+
+  // cria tarefa de gerenciador do disco
+  task_create(&(disk->manager), disk_manager, disk);
   userTasks--;
 
   return(0);
 }
 
 /*!
-  \brief Leitura de um bloco, do disco para o buffer
+  \brief Inicializacao do gerente do disco 0
+
+  \param numBlocks Tamanho do disco, em blocos
+  \param blockSize Tamanho de cada bloco do disco, em bytes
 
   \return -1 em erro ou 0 em sucesso
-*/  
-int disk_block_read (int block, void *buffer) {
+*/
+int disk_mgr_init (int *numBlocks, int *blockSize) {
+  return ( disk_dev_mgr_init(0, numBlocks, blockSize) );
+}
+
+/*!
+  \brief Insere um pedido na fila de um disco, com prazo de abandono, sem
+  aguardar seu atendimento
+
+  \param dev Numero do disco
+  \param req Pedido a preencher; deve existir ate disk_dev_wait()
+  \param type READ_OPERATION ou WRITE_OPERATION
+  \param block Bloco inicial da operacao
+  \param count Quantidade de blocos (no maximo DISK_VEC_MAX)
+  \param buffers Vetor com um buffer para cada bloco
+  \param timeout Prazo para o envio ao disco, em ms (0 = sem prazo)
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_dev_submit_timed (int dev, request_t *req, int type, int block, int count,
+                           void **buffers, int timeout) {
+  disk_t *disk = disk_get(dev);
+
+  // verifica parametros
+  if ( !disk || !req || !buffers || count < 1 || count > DISK_VEC_MAX ||
+       (type != READ_OPERATION && type != WRITE_OPERATION) || timeout < 0 )
+    return(-1);
+
   // preenche struct de pedido
-  request_t req;  
-  req.prev = NULL;
-  req.next = NULL;
-  req.block = block;
-  req.buffer = buffer;
-  req.task = currentTask;
-  req.type = READ_OPERATION;
-  req.exit_code = 0;
-  if ( sem_create(&(req.wait), 0) ) {
-    fprintf(stderr, "[PPOS error] disk_block_read: fail on create semaphore\n");
+  req->prev = NULL;
+  req->next = NULL;
+  req->block = block;
+  req->count = count;
+  req->buffer = buffers[0];
+  req->buffers = buffers;
+  req->task = currentTask;
+  req->type = type;
+  req->exit_code = 0;
+  req->dup = 0;
+  req->group = currentTask->io_group;
+  req->throttled = 0;
+  req->pinned = 0;
+  req->ordered = 0;
+  if ( currentTask->est_prio < 0 )
+    req->cls = DISK_CLASS_HIGH;
+  else if ( currentTask->est_prio > 0 )
+    req->cls = DISK_CLASS_LOW;
+  else
+    req->cls = DISK_CLASS_NORMAL;
+  req->own_cls = req->cls;
+  if ( sem_create(&(req->wait), 0) ) {
+    fprintf(stderr, "[PPOS error] disk_dev_submit_timed: fail on create semaphore\n");
     return(-1);
   }
-  
-  if ( sem_down(&(disk.access)) )
-    return(-1);
 
-  // insere pedido na fila do disco
-  if ( queue_append( (queue_t **) &(disk.queue), (queue_t *) &req) ) {
-    sem_up(&(disk.access));
-    fprintf(stderr, "[PPOS error] disk_block_read: fail to append request on queue\n");
+  if ( sem_down(&(disk->access)) )
     return(-1);
+
+  // insere pedido na fila do disco, em ordem de bloco
+  req->seq = disk->seq++;
+  req->submit = systime();
+  req->deadline = req->submit + ( (type == READ_OPERATION) ? disk->sched.read_expire
+                                                            : disk->sched.write_expire );
+  req->expire = timeout ? req->submit + timeout : 0;
+  disk_insert(&(disk->queue[type]), req);
+  disk->stats.requests++;
+
+  TRACE(TRACE_DISK_SUBMIT, type, req, dev, block, count, 0);
+
+  if ( type == READ_OPERATION && disk_forward(disk, req) ) {
+    // leitura atendida pela escrita pendente, sem ir ao disco
+    disk->stats.forwarded++;
+    disk_complete(disk, req, &(disk->queue[READ_OPERATION]), 0, 0);
+  } else {
+    // escritas pendentes sobrescritas por esta sao absorvidas
+    if ( type == WRITE_OPERATION )
+      disk_absorb(disk, req);
+
+    // o pedido espera os anteriores sobre os mesmos blocos, que herdam
+    // sua classe e seu prazo
+    req->ordered = disk_inherit(disk, req, req->cls, req->deadline);
+
+    // acorda a tarefa gerente de disco
+    disk_wakeup(disk);
   }
-    
-  // se tarefa gerente de disco estah dormindo, acorda
-  if ( taskDiskMgr.status == 3 ) {
-    sem_up(&(diskSleep));
-  }
-  
-  if ( sem_up(&(disk.access)) )
+
+  if ( sem_up(&(disk->access)) )
+    return(-1);
+
+  return(0);
+}
+
+/*!
+  \brief Insere um pedido na fila de um disco, sem aguardar seu atendimento
+
+  \param dev Numero do disco
+  \param req Pedido a preencher; deve existir ate disk_dev_wait()
+  \param type READ_OPERATION ou WRITE_OPERATION
+  \param block Bloco inicial da operacao
+  \param count Quantidade de blocos (no maximo DISK_VEC_MAX)
+  \param buffers Vetor com um buffer para cada bloco
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_dev_submit (int dev, request_t *req, int type, int block, int count, void **buffers) {
+  return ( disk_dev_submit_timed(dev, req, type, block, count, buffers, 0) );
+}
+
+/*!
+  \brief Cancela um pedido que ainda nao foi enviado ao disco
+
+  O pedido cancelado eh concluido com resultado DISK_ECANCELED; a tarefa
+  ainda deve chamar disk_dev_wait() para ele.
+
+  \param dev Numero do disco
+  \param req Pedido enviado com disk_dev_submit()
+
+  \return -1 se o pedido ja foi enviado ao disco ou concluido, 0 em sucesso
+*/
+int disk_dev_cancel (int dev, request_t *req) {
+  disk_t *disk = disk_get(dev);
+  request_t *aux;
+  int n, size, found = 0;
+
+  if ( !disk || !req || (req->type != READ_OPERATION && req->type != WRITE_OPERATION) )
     return(-1);
 
+  if ( sem_down(&(disk->access)) )
+    return(-1);
+
+  // o pedido ainda esta na fila do disco?
+  aux = disk->queue[req->type];
+  size = queue_size( (queue_t *) aux );
+  for ( n = 0; n < size && !found; n++, aux = aux->next )
+    found = ( aux == req );
+
+  if ( found && !req->pinned ) {
+    disk_complete(disk, req, &(disk->queue[req->type]), DISK_ECANCELED, 0);
+    disk->stats.canceled++;
+  } else
+    found = 0;
+
+  sem_up(&(disk->access));
+
+  return( found ? 0 : -1 );
+}
+
+/*!
+  \brief Aguarda a conclusao de um pedido enviado com disk_dev_submit()
+
+  \param req Pedido a aguardar
+
+  \return -1 em erro, 0 em sucesso, ou DISK_ECANCELED / DISK_ETIMEDOUT se o
+  pedido foi abandonado
+*/
+int disk_dev_wait (request_t *req) {
   // espera o disco terminar a operacao
-  if ( sem_down(&(req.wait)) ){
+  if ( sem_down(&(req->wait)) ){
     fprintf(stderr, "[PPOS error] fail to wait disk operation\n");
     return(-1);
   }
 
-  sem_destroy(&(req.wait));
+  sem_destroy(&(req->wait));
 
-  return(req.exit_code);
+  return(req->exit_code);
+}
+
+/*!
+  \brief Leitura de um bloco de um disco, do disco para o buffer
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_dev_block_read (int dev, int block, void *buffer) {
+  request_t req;
+
+  if ( disk_dev_submit(dev, &req, READ_OPERATION, block, 1, &buffer) )
+    return(-1);
+  return ( disk_dev_wait(&req) );
+}
+
+/*!
+  \brief Escrita de um bloco de um disco, do buffer para o disco
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_dev_block_write (int dev, int block, void *buffer) {
+  request_t req;
+
+  if ( disk_dev_submit(dev, &req, WRITE_OPERATION, block, 1, &buffer) )
+    return(-1);
+  return ( disk_dev_wait(&req) );
+}
+
+/*!
+  \brief Leitura de blocos contiguos de um disco, do disco para os buffers
+
+  \param dev Numero do disco
+  \param block Bloco inicial
+  \param count Quantidade de blocos
+  \param buffers Vetor com um buffer para cada bloco
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_dev_block_readv (int dev, int block, int count, void **buffers) {
+  return ( disk_request_vec(dev, READ_OPERATION, block, count, buffers) );
+}
+
+/*!
+  \brief Escrita de blocos contiguos de um disco, dos buffers para o disco
+
+  \param dev Numero do disco
+  \param block Bloco inicial
+  \param count Quantidade de blocos
+  \param buffers Vetor com um buffer para cada bloco
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_dev_block_writev (int dev, int block, int count, void **buffers) {
+  return ( disk_request_vec(dev, WRITE_OPERATION, block, count, buffers) );
+}
+
+/*!
+  \brief Leitura de um bloco, do disco para o buffer
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_block_read (int block, void *buffer) {
+  return ( disk_dev_block_read(0, block, buffer) );
 }
 
 /*!
   \brief Escrita de um bloco, do buffer para o disco
 
   \return -1 em erro ou 0 em sucesso
-*/  
+*/
 int disk_block_write (int block, void *buffer) {
-  // preenche struct de pedido
-  request_t req;  
-  req.prev = NULL;
-  req.next = NULL;
-  req.block = block;
-  req.buffer = buffer;
-  req.task = currentTask;
-  req.type = WRITE_OPERATION;
-  req.exit_code = 0;
-  if ( sem_create(&(req.wait), 0) ) {
-    fprintf(stderr, "[PPOS error] disk_block_write: fail on create semaphore\n");
+  return ( disk_dev_block_write(0, block, buffer) );
+}
+
+/*!
+  \brief Leitura de blocos contiguos, do disco para os buffers
+
+  \param block Bloco inicial
+  \param count Quantidade de blocos
+  \param buffers Vetor com um buffer para cada bloco
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_block_readv (int block, int count, void **buffers) {
+  return ( disk_dev_block_readv(0, block, count, buffers) );
+}
+
+/*!
+  \brief Escrita de blocos contiguos, dos buffers para o disco
+
+  \param block Bloco inicial
+  \param count Quantidade de blocos
+  \param buffers Vetor com um buffer para cada bloco
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_block_writev (int block, int count, void **buffers) {
+  return ( disk_dev_block_writev(0, block, count, buffers) );
+}
+
+/*!
+  \brief Consulta a geometria de um disco ja inicializado
+
+  \param dev Numero do disco
+  \param numBlocks Tamanho do disco, em blocos
+  \param blockSize Tamanho de cada bloco do disco, em bytes
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_dev_geometry (int dev, int *numBlocks, int *blockSize) {
+  disk_t *disk = disk_get(dev);
+
+  if ( !disk || !numBlocks || !blockSize )
     return(-1);
-  }
-  
-  if ( sem_down(&(disk.access)) )
+
+  *numBlocks = disk->numBlocks;
+  *blockSize = disk->blockSize;
+
+  return(0);
+}
+
+/*!
+  \brief Consulta os contadores do gerente de um disco
+
+  \param dev Numero do disco
+  \param stats Estrutura que recebe os contadores
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_dev_mgr_stats (int dev, disk_stats_t *stats) {
+  disk_t *disk = disk_get(dev);
+
+  if ( !disk || !stats )
     return(-1);
 
-  // insere pedido na fila do disco
-  if ( queue_append( (queue_t **) &(disk.queue), (queue_t *) &req) ) {
-    sem_up(&(disk.access));
-    fprintf(stderr, "[PPOS error] disk_block_write: fail to append request on queue\n");
+  *stats = disk->stats;
+
+  return(0);
+}
+
+/*!
+  \brief Consulta os contadores do gerente do disco 0
+
+  \param stats Estrutura que recebe os contadores
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_mgr_stats (disk_stats_t *stats) {
+  return ( disk_dev_mgr_stats(0, stats) );
+}
+
+/*!
+  \brief Define os parametros do escalonador de pedidos de um disco
+
+  \param dev Numero do disco
+  \param sched Parametros do escalonador
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_dev_set_sched (int dev, const disk_sched_t *sched) {
+  disk_t *disk = disk_get(dev);
+
+  if ( !disk || !sched || sched->read_expire < 0 || sched->write_expire < 0 ||
+       sched->writes_starved < 0 ||
+       (sched->policy != DISK_SCHED_FIFO && sched->policy != DISK_SCHED_DEADLINE) )
     return(-1);
-  }
-    
-  // se tarefa gerente de disco estah dormindo, acorda
-  if ( taskDiskMgr.status == 3 ) {
-    sem_up(&(diskSleep));
-  }
-  
-  if ( sem_up(&(disk.access)) )
+
+  if ( sem_down(&(disk->access)) )
     return(-1);
+  disk->sched = *sched;
+  sem_up(&(disk->access));
 
-  // espera o disco terminar a operacao
-  if ( sem_down(&(req.wait)) ){
-    fprintf(stderr, "[PPOS error] fail to wait disk operation\n");
+  return(0);
+}
+
+/*!
+  \brief Consulta os parametros do escalonador de pedidos de um disco
+
+  \param dev Numero do disco
+  \param sched Estrutura que recebe os parametros
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_dev_get_sched (int dev, disk_sched_t *sched) {
+  disk_t *disk = disk_get(dev);
+
+  if ( !disk || !sched )
     return(-1);
-  }
 
-  sem_destroy(&(req.wait));
+  *sched = disk->sched;
+
+  return(0);
+}
+
+/*!
+  \brief Percentil da latencia dos pedidos de uma classe de prioridade
+
+  \param dev Numero do disco
+  \param cls Classe de prioridade (DISK_CLASS_*)
+  \param pct Percentil desejado, de 0 a 100
+
+  \return Latencia em ms (limite superior da faixa), ou -1 em erro ou se
+  nao ha pedidos concluidos na classe
+*/
+int disk_dev_latency (int dev, int cls, double pct) {
+  disk_t *disk = disk_get(dev);
 
-  return(req.exit_code);
-}
\ No newline at end of file
+  if ( !disk || cls < 0 || cls >= DISK_CLASSES || pct < 0 || pct > 100 ||
+       !disk->latency[cls].count )
+    return(-1);
+
+  return( (int) (lat_percentile(&(disk->latency[cls]), pct) / 1000000) );
+}
+
+/*!
+  \brief Define o grupo de E/S de uma tarefa
+
+  \param task Tarefa (NULL = tarefa atual)
+  \param group Grupo de E/S (0 a DISK_IO_GROUPS-1)
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_io_setgroup (task_t *task, int group) {
+  if ( group < 0 || group >= DISK_IO_GROUPS )
+    return(-1);
+  if ( !task )
+    task = currentTask;
+
+  task->io_group = group;
+
+  return(0);
+}
+
+/*!
+  \brief Retorna o grupo de E/S de uma tarefa
+
+  \param task Tarefa (NULL = tarefa atual)
+
+  \return Grupo de E/S da tarefa
+*/
+int disk_io_getgroup (task_t *task) {
+  if ( !task )
+    task = currentTask;
+
+  return(task->io_group);
+}
+
+/*!
+  \brief Define os limites de um grupo de E/S (0 = sem limite)
+
+  \param group Grupo de E/S
+  \param limit Limites de pedidos/s e bytes/s
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_io_setlimit (int group, const disk_limit_t *limit) {
+  disk_group_t *g;
+
+  if ( group < 0 || group >= DISK_IO_GROUPS || !limit ||
+       limit->iops < 0 || limit->bps < 0 || limit->burst < 0 )
+    return(-1);
+  g = &diskGroups[group];
+
+  // os baldes comecam cheios
+  g->limit = *limit;
+  g->ops = disk_bucket_cap(limit->iops, limit->burst);
+  g->bytes = disk_bucket_cap(limit->bps, limit->burst);
+  g->last = systime();
+
+  return(0);
+}
+
+/*!
+  \brief Consulta os contadores de E/S de uma tarefa
+
+  \param task Tarefa (NULL = tarefa atual)
+  \param io Estrutura que recebe os contadores
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_io_task (task_t *task, disk_io_t *io) {
+  if ( !io )
+    return(-1);
+  if ( !task )
+    task = currentTask;
+
+  io->ops = task->io_ops;
+  io->bytes = task->io_bytes;
+  io->time = task->io_time;
+  io->throttled = 0;
+
+  return(0);
+}
+
+/*!
+  \brief Consulta os contadores de E/S de um grupo
+
+  \param group Grupo de E/S
+  \param io Estrutura que recebe os contadores
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int disk_io_group (int group, disk_io_t *io) {
+  if ( group < 0 || group >= DISK_IO_GROUPS || !io )
+    return(-1);
+
+  *io = diskGroups[group].io;
+
+  return(0);
+}
@@ -7,32 +7,141 @@
 #ifndef __DISK_MGR__
 #define __DISK_MGR__
 
+#include <signal.h>
+#include "disk.h"		// interface do disco (DISK_VEC_MAX)
+#include "ppos_lat.h"		// histogramas de latencia (lat_hist_t)
+
 #define READ_OPERATION 0
 #define WRITE_OPERATION 1
 
+// resultados de pedidos abandonados (alem de 0 = sucesso e -1 = erro)
+#define DISK_ECANCELED  -2  // pedido cancelado com disk_dev_cancel()
+#define DISK_ETIMEDOUT  -3  // prazo de abandono venceu antes do envio
+
+// classes de prioridade de E/S, dadas pela prioridade estatica da tarefa
+#define DISK_CLASS_HIGH   0  // est_prio < 0
+#define DISK_CLASS_NORMAL 1  // est_prio == 0
+#define DISK_CLASS_LOW    2  // est_prio > 0
+#define DISK_CLASSES      3
+
+// politicas de escalonamento dos pedidos de disco
+#define DISK_SCHED_FIFO     0  // ordem de chegada
+#define DISK_SCHED_DEADLINE 1  // prazos, classes de prioridade e elevador
+
+// parametros padrao do escalonador (ms)
+#define DISK_READ_EXPIRE     500
+#define DISK_WRITE_EXPIRE   5000
+#define DISK_WRITES_STARVED    2
+
+// grupos de E/S (contabilidade e limites de banda compartilhados)
+#define DISK_IO_GROUPS    16
+#define DISK_IO_BURST    100  // rajada padrao dos limites (ms de taxa)
+
 // estruturas de dados e rotinas de inicializacao e acesso
 // a um dispositivo de entrada/saida orientado a blocos,
 // tipicamente um disco rigido.
 
 // estrutura que representa um request de disco
-typedef struct
+typedef struct request_t
 {
   struct request_t *prev, *next; // ponteiros para usar em filas
   task_t *task;     // task pedindo o disco
   int type;         // READ_OPERATION ou WRITE_OPERATION
-  int block;        // bloco da operacao
-  void *buffer;     // buffer de dados
+  int block;        // bloco (inicial) da operacao
+  int count;        // quantidade de blocos contiguos da operacao
+  void *buffer;     // buffer de dados (operacoes de um bloco)
+  void **buffers;   // buffers de dados, um por bloco
   int exit_code;    // exit_code da tarefa
+  int dup;          // 1 = leitura atendida por copia de outro pedido
+  int cls;          // classe de prioridade (DISK_CLASS_*), pode ser herdada
+  int own_cls;      // classe da tarefa, usada nas latencias
+  int group;        // grupo de E/S da tarefa
+  int throttled;    // pedido ja aguardou o limite do grupo
+  unsigned int seq;      // ordem de chegada
+  unsigned int submit;   // instante de chegada (ms)
+  unsigned int deadline; // prazo de atendimento (ms)
+  unsigned int expire;   // prazo de abandono (ms, 0 = nenhum)
+  int pinned;       // escrita que absorveu outras: nao pode ser abandonada
+  int ordered;      // chegou depois de pedido da fila sobre os mesmos blocos
   semaphore_t wait; // tarefa aguarda disco
 } request_t ;
 
+// parametros do escalonador de pedidos de um disco
+typedef struct
+{
+  int policy;         // DISK_SCHED_FIFO ou DISK_SCHED_DEADLINE
+  int read_expire;    // prazo das leituras (ms)
+  int write_expire;   // prazo das escritas (ms)
+  int writes_starved; // operacoes de leitura antes de forcar uma escrita
+} disk_sched_t ;
+
+// contadores do gerente de disco
+typedef struct
+{
+  unsigned int requests;  // pedidos recebidos
+  unsigned int ops;       // operacoes enviadas ao disco
+  unsigned int blocks;    // blocos transferidos pelo disco
+  unsigned int merged;    // pedidos unidos a uma operacao de blocos adjacentes
+  unsigned int dedup;     // leituras atendidas por copia de outra leitura
+  unsigned int forwarded; // leituras atendidas pela escrita pendente
+  unsigned int absorbed;  // escritas descartadas por serem sobrescritas
+  unsigned int expired;   // pedidos escolhidos por terem o prazo vencido
+  unsigned int throttled; // vezes em que pedidos aguardaram limite de banda
+  unsigned int canceled;  // pedidos cancelados antes do envio
+  unsigned int timedout;  // pedidos abandonados por prazo vencido
+  unsigned int travel;    // deslocamento da cabeca entre operacoes (blocos)
+} disk_stats_t ;
+
+// contadores de E/S de uma tarefa ou grupo de tarefas
+typedef struct
+{
+  unsigned int ops;        // pedidos concluidos
+  unsigned long long bytes; // bytes transferidos
+  unsigned long long time;  // tempo de disco consumido (us)
+  unsigned int throttled;  // pedidos que aguardaram o limite (grupos)
+} disk_io_t ;
+
+// limites de um grupo de E/S (balde de fichas), 0 = sem limite
+typedef struct
+{
+  int iops;     // pedidos por segundo
+  int bps;      // bytes por segundo
+  int burst;    // rajada permitida, em ms de taxa (0 = DISK_IO_BURST)
+} disk_limit_t ;
+
+// operacao enviada a fila de comandos do disco (pedidos unidos)
+typedef struct
+{
+  request_t *reqs;         // pedidos atendidos pela operacao
+  int type;                // READ_OPERATION ou WRITE_OPERATION
+  int first, count;        // faixa de blocos da operacao
+  int busy;                // operacao em andamento
+  unsigned long long start; // instante de envio ao disco (us)
+  void *vec[DISK_VEC_MAX]; // buffers da operacao
+} disk_batch_t ;
+
 // estrutura que representa um disco no sistema operacional
 typedef struct
 {
-  request_t *queue;   // fila de pedidos de disco
+  int dev;            // numero do disco
+  int active;         // disco inicializado
+  task_t manager;     // tarefa gerente do disco
+  semaphore_t sleep;  // gerente aguarda pedidos ou conclusoes
+  int signal;         // ha conclusoes ou pedidos novos para o gerente
+  volatile sig_atomic_t irq; // conclusoes sinalizadas, o gerente ainda nao foi acordado
+  request_t *queue[2]; // filas de leituras e escritas, ordenadas por bloco
   semaphore_t access; // semaforo de acesso ao disco
   int numBlocks;      // quantidade de blocos no disco
   int blockSize;      // tamanho do bloco do disco
+  int depth;          // operacoes simultaneas aceitas pelo disco
+  disk_batch_t batches[DISK_QDEPTH_MAX]; // operacoes em andamento
+  disk_stats_t stats; // contadores do gerente
+  disk_sched_t sched; // parametros do escalonador
+  unsigned int seq;   // contador de chegada de pedidos
+  int head;           // posicao da cabeca apos a ultima operacao
+  int starved;        // operacoes de leitura com escritas aguardando
+  unsigned int wait;  // espera (ms) ate o limite liberar um pedido
+  lat_hist_t latency[DISK_CLASSES]; // latencias por classe
 } disk_t ;
 
 // inicializacao do gerente de disco
@@ -41,10 +150,84 @@ typedef struct
 // blockSize: tamanho de cada bloco do disco, em bytes
 int disk_mgr_init (int *numBlocks, int *blockSize) ;
 
+// acorda os gerentes dos discos que sinalizaram conclusoes; chamada pelo
+// despachante, fora do tratador de sinal
+void disk_poll () ;
+
+// As operacoes abaixo sem o prefixo disk_dev_ atuam sobre o disco 0; as
+// versoes disk_dev_* recebem o numero do disco (0 a DISK_MAX_DEVICES-1).
+// Cada disco tem sua fila de pedidos e sua tarefa gerente, que mantem ate
+// DISK_CMD_QDEPTH operacoes em andamento no disco (varias no backend nativo).
+
+// inicializacao do gerente do disco dev
+int disk_dev_mgr_init (int dev, int *numBlocks, int *blockSize) ;
+int disk_dev_block_read (int dev, int block, void *buffer) ;
+int disk_dev_block_write (int dev, int block, void *buffer) ;
+int disk_dev_block_readv (int dev, int block, int count, void **buffers) ;
+int disk_dev_block_writev (int dev, int block, int count, void **buffers) ;
+int disk_dev_mgr_stats (int dev, disk_stats_t *stats) ;
+
+// consulta a geometria do disco dev, ja inicializado
+int disk_dev_geometry (int dev, int *numBlocks, int *blockSize) ;
+
+// Escalonador de pedidos: na politica DISK_SCHED_DEADLINE, pedidos com prazo
+// vencido sao atendidos primeiro; depois, a classe de prioridade mais alta,
+// leituras antes de escritas (no maximo writes_starved operacoes seguidas)
+// e, dentro delas, ordem crescente de bloco a partir da cabeca (elevador).
+// O padrao eh DISK_SCHED_DEADLINE com os prazos DISK_*_EXPIRE.
+int disk_dev_set_sched (int dev, const disk_sched_t *sched) ;
+int disk_dev_get_sched (int dev, disk_sched_t *sched) ;
+
+// percentil pct (0 a 100) da latencia dos pedidos da classe cls do disco
+// dev, em ms; retorna -1 em erro ou se nao ha pedidos concluidos na classe
+int disk_dev_latency (int dev, int cls, double pct) ;
+
+// Contabilidade e limites de E/S: cada tarefa pertence a um grupo de E/S
+// (0 a DISK_IO_GROUPS-1, padrao o da tarefa criadora; a principal esta no
+// grupo 0). Bytes, pedidos e tempo de disco sao contados por tarefa e por
+// grupo, em todos os discos. Um grupo pode ter limites de pedidos/s e
+// bytes/s, aplicados pelos gerentes de disco ao escolher o proximo pedido.
+// Todas retornam -1 em erro ou 0 em sucesso.
+int disk_io_setgroup (task_t *task, int group) ;   // task NULL = atual
+int disk_io_getgroup (task_t *task) ;              // retorna o grupo
+int disk_io_setlimit (int group, const disk_limit_t *limit) ;
+int disk_io_task (task_t *task, disk_io_t *io) ;   // task NULL = atual
+int disk_io_group (int group, disk_io_t *io) ;
+
+// interface assincrona, usada pelas camadas construidas sobre os discos:
+// disk_dev_submit() insere o pedido req (ate DISK_VEC_MAX blocos) na fila
+// do disco e retorna; disk_dev_wait() aguarda sua conclusao e retorna seu
+// resultado. Ambas retornam -1 em erro ou 0 em sucesso.
+int disk_dev_submit (int dev, request_t *req, int type, int block, int count, void **buffers) ;
+int disk_dev_wait (request_t *req) ;
+
+// Abandono de pedidos: disk_dev_submit_timed() envia um pedido que eh
+// descartado pelo gerente, sem ir ao disco, se nao for enviado ao disco em
+// timeout ms (0 = sem prazo); disk_dev_cancel() retira da fila um pedido
+// ainda nao enviado ao disco (retorna -1 se ele ja foi enviado ou concluido).
+// disk_dev_wait() de um pedido abandonado retorna DISK_ETIMEDOUT ou
+// DISK_ECANCELED. Escritas que absorveram escritas anteriores nao podem
+// mais ser abandonadas.
+int disk_dev_submit_timed (int dev, request_t *req, int type, int block, int count,
+                           void **buffers, int timeout) ;
+int disk_dev_cancel (int dev, request_t *req) ;
+
 // leitura de um bloco, do disco para o buffer
 int disk_block_read (int block, void *buffer) ;
 
 // escrita de um bloco, do buffer para o disco
 int disk_block_write (int block, void *buffer) ;
 
+// leitura de count blocos contiguos a partir de block, cada um para o
+// buffer correspondente em buffers[] (scatter)
+int disk_block_readv (int block, int count, void **buffers) ;
+
+// escrita de count blocos contiguos a partir de block, cada um a partir
+// do buffer correspondente em buffers[] (gather)
+int disk_block_writev (int block, int count, void **buffers) ;
+
+// consulta os contadores do gerente de disco
+// retorna -1 em erro ou 0 em sucesso
+int disk_mgr_stats (disk_stats_t *stats) ;
+
 #endif
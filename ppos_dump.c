@@ -0,0 +1,590 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+#define _GNU_SOURCE     // REG_RSP
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <ucontext.h>
+#undef _XOPEN_SOURCE    // redefinido por ppos.h
+#include "ppos.h"
+#include "ppos_disk.h"
+#include "ppos_dump.h"
+#include "ppos_stack.h"
+
+// variáveis globais e constantes ==============================================
+
+extern task_t *currentTask, *readyQueue, *sleepQueue, *taskList;
+extern mqueue_t *mqueueList;
+extern disk_t disks[];
+extern int userTasks;
+extern int preemptLock;
+
+// papel de um semaforo com tarefas suspensas
+#define DUMP_SEM    0   // semaforo da aplicacao
+#define DUMP_ITEMS  1   // itens de uma fila de mensagens (receptores)
+#define DUMP_SLOTS  2   // vagas de uma fila de mensagens (remetentes)
+#define DUMP_BUFFER 3   // acesso ao buffer de uma fila de mensagens
+
+// tarefa no retrato
+typedef struct
+{
+  task_stats_t st;        // contadores da tarefa
+  task_t *task;           // TCB (valido apenas durante a copia)
+  int din_prio;           // prioridade dinamica
+  int current;            // tarefa corrente?
+  void *sem;              // semaforo em que esta suspensa
+  int sleeping;           // na fila de adormecidas?
+  unsigned int wake_time; // instante de despertar (ms)
+  int join;               // tarefa aguardada (-1 = nenhuma)
+  long stack;             // bytes de pilha em uso (-1 = desconhecido)
+  long stack_max;         // pico de uso da pilha (-1 = desconhecido)
+} dump_task_t ;
+
+// semaforo com tarefas suspensas no retrato
+typedef struct
+{
+  void *sem;              // endereco do semaforo
+  int count;              // contador
+  int waiters;            // tarefas suspensas
+  int role;               // DUMP_SEM, DUMP_ITEMS, DUMP_SLOTS ou DUMP_BUFFER
+  void *mqueue;           // fila de mensagens dona do semaforo
+} dump_sem_t ;
+
+// fila de mensagens no retrato
+typedef struct
+{
+  void *mqueue;           // endereco da fila
+  int msgs, max, size;    // mensagens, capacidade e tamanho
+  int receivers, senders; // tarefas suspensas esperando itens e vagas
+} dump_mq_t ;
+
+// disco no retrato
+typedef struct
+{
+  int dev;                // numero do disco
+  int reads, writes;      // pedidos nas filas do gerente
+  int busy;               // operacoes em andamento no disco
+  disk_stats_t st;        // contadores do gerente
+  int cache;              // contadores do cache validos?
+  unsigned int hits, misses;  // acertos e faltas do cache do disco
+} dump_disk_t ;
+
+// retrato completo
+typedef struct
+{
+  ppos_stats_t sys;       // contadores do sistema
+  int sleeping;           // tarefas adormecidas
+  int ntasks, nsems, nmqs, ndisks;
+  dump_task_t *tasks;
+  dump_sem_t *sems;
+  dump_mq_t *mqs;
+  dump_disk_t disks[DISK_MAX_DEVICES];
+} dump_snap_t ;
+
+static volatile int dumpRequested = 0;   // SIGUSR2 recebido
+static int dumpOn = 0;                   // retratos ligados?
+static int dumpFormat = DUMP_TEXT;       // formato dos retratos
+static char dumpFile[DUMP_PATH];         // arquivo dos retratos
+static unsigned int dumpCount = 0;       // retratos gravados
+
+static task_t dumpTask;                  // tarefa que grava os retratos
+static int dumpTaskOn = 0;               // tarefa existe?
+
+// estrutura que define um tratador de sinal (deve ser global ou static)
+static struct sigaction dumpAction, dumpOldAction;
+
+// funções locais ==============================================================
+
+/*!
+  \brief Tratador do SIGUSR2: apenas marca o pedido, sem mexer nas filas do
+  nucleo
+*/
+static void dump_handler (int signum) {
+  dumpRequested = 1;
+}
+
+/*!
+  \brief Bytes de pilha em uso pela tarefa, pelo ponteiro de pilha salvo
+  no contexto
+
+  \return bytes em uso ou -1 se desconhecido (tarefa main, arquitetura sem
+  REG_RSP)
+*/
+static long dump_stack (task_t *task) {
+  char *base = task->context.uc_stack.ss_sp, *top, *sp;
+
+  if ( !base || !task->context.uc_stack.ss_size )
+    return(-1);
+  top = base + task->context.uc_stack.ss_size;
+
+  if ( task == currentTask )
+    sp = (char *) &top;
+  else {
+#if defined(__x86_64__) && defined(REG_RSP)
+    sp = (char *) task->context.uc_mcontext.gregs[REG_RSP];
+#else
+    return(-1);
+#endif
+  }
+  if ( sp < base || sp > top )
+    return(-1);
+  return(top - sp);
+}
+
+/*!
+  \brief Localiza no retrato a tarefa com o TCB indicado
+
+  \return indice da tarefa ou -1
+*/
+static int dump_find (dump_snap_t *snap, task_t *task) {
+  int i;
+
+  for ( i = 0; i < snap->ntasks; i++ )
+    if ( snap->tasks[i].task == task )
+      return(i);
+  return(-1);
+}
+
+/*!
+  \brief Quantidade de pedidos em uma fila circular de pedidos de disco
+*/
+static int dump_requests (request_t *queue) {
+  request_t *req = queue;
+  int n = 0;
+
+  if ( !req )
+    return(0);
+  do {
+    n++;
+    req = req->next;
+  } while ( req && req != queue );
+  return(n);
+}
+
+/*!
+  \brief Copia o estado do nucleo para o retrato, com a preempcao suspensa;
+  as tabelas sao alocadas com o tamanho do registro de tarefas
+
+  \return 0 em sucesso e -1 em erro
+*/
+static int dump_take (dump_snap_t *snap) {
+  dump_task_t *t;
+  dump_sem_t *s;
+  task_stats_t *st;
+  task_t *task, *w;
+  mqueue_t *mq;
+  int i, j, n, k;
+
+  memset(snap, 0, sizeof(dump_snap_t));
+
+  preemptLock++;
+  n = ppos_stats(&snap->sys, NULL, 0);
+  for ( k = 0, mq = mqueueList; mq; mq = mq->reg_next )
+    k++;
+  snap->tasks = calloc(n, sizeof(dump_task_t));
+  snap->sems = calloc(n, sizeof(dump_sem_t));
+  snap->mqs = calloc(k ? k : 1, sizeof(dump_mq_t));
+  st = malloc(n * sizeof(task_stats_t));
+  if ( !snap->tasks || !snap->sems || !snap->mqs || !st ) {
+    preemptLock--;
+    free(snap->tasks);
+    free(snap->sems);
+    free(snap->mqs);
+    free(st);
+    return(-1);
+  }
+
+  // tarefas, na ordem do registro
+  ppos_stats(NULL, st, n);
+  for ( i = 0, task = taskList; task && i < n; task = task->reg_next, i++ ) {
+    t = &snap->tasks[i];
+    t->st = st[i];
+    t->task = task;
+    t->din_prio = task->din_prio;
+    t->current = ( task == currentTask );
+    t->sem = task->wait_sem;
+    t->join = -1;
+    t->stack = dump_stack(task);
+    t->stack_max = stack_used(task);
+  }
+  snap->ntasks = i;
+  free(st);
+
+  // adormecidas e tarefas aguardando o fim de outra
+  if ( (w = sleepQueue) ) {
+    do {
+      if ( (j = dump_find(snap, w)) >= 0 ) {
+        snap->tasks[j].sleeping = 1;
+        snap->tasks[j].wake_time = w->wake_time;
+      }
+      snap->sleeping++;
+      w = w->next;
+    } while ( w && w != sleepQueue );
+  }
+  for ( i = 0; i < snap->ntasks; i++ ) {
+    if ( !(w = snap->tasks[i].task->joinedQueue) )
+      continue;
+    do {
+      if ( (j = dump_find(snap, w)) >= 0 )
+        snap->tasks[j].join = snap->tasks[i].st.id;
+      w = w->next;
+    } while ( w && w != snap->tasks[i].task->joinedQueue );
+  }
+
+  // semaforos com tarefas suspensas, a partir das tarefas
+  for ( i = 0; i < snap->ntasks; i++ ) {
+    if ( !snap->tasks[i].sem )
+      continue;
+    for ( j = 0; j < snap->nsems && snap->sems[j].sem != snap->tasks[i].sem; j++ )
+      ;
+    s = &snap->sems[j];
+    if ( j == snap->nsems ) {
+      snap->nsems++;
+      s->sem = snap->tasks[i].sem;
+      s->count = ((semaphore_t *) s->sem)->count;
+    }
+    s->waiters++;
+  }
+
+  // filas de mensagens, marcando os semaforos delas
+  for ( mq = mqueueList; mq && snap->nmqs < k; mq = mq->reg_next ) {
+    dump_mq_t *m = &snap->mqs[snap->nmqs++];
+
+    m->mqueue = mq;
+    m->msgs = mq->buffer_count;
+    m->max = mq->msg_max;
+    m->size = mq->msg_size;
+    for ( j = 0; j < snap->nsems; j++ ) {
+      s = &snap->sems[j];
+      if ( s->sem == &mq->s_item ) {
+        s->role = DUMP_ITEMS;
+        m->receivers = s->waiters;
+      }
+      else if ( s->sem == &mq->s_vaga ) {
+        s->role = DUMP_SLOTS;
+        m->senders = s->waiters;
+      }
+      else if ( s->sem == &mq->s_buffer )
+        s->role = DUMP_BUFFER;
+      else
+        continue;
+      s->mqueue = mq;
+    }
+  }
+
+  // discos ativos
+  for ( i = 0; i < DISK_MAX_DEVICES; i++ ) {
+    dump_disk_t *d;
+
+    if ( !disks[i].active )
+      continue;
+    d = &snap->disks[snap->ndisks++];
+    d->dev = i;
+    d->reads = dump_requests(disks[i].queue[0]);
+    d->writes = dump_requests(disks[i].queue[1]);
+    for ( j = 0; j < disks[i].depth; j++ )
+      d->busy += disks[i].batches[j].busy;
+    d->st = disks[i].stats;
+    d->cache = !disk_dev_cache_stats(i, &d->hits, &d->misses);
+  }
+  preemptLock--;
+
+  return(0);
+}
+
+/*!
+  \brief Estado de uma tarefa do retrato
+*/
+static const char *dump_state (dump_task_t *t) {
+  if ( t->current )
+    return("executando");
+  switch ( t->st.status ) {
+    case 1: return("pronta");
+    case 2: return("terminada");
+  }
+  if ( t->sem )
+    return("semaforo");
+  if ( t->sleeping )
+    return("dormindo");
+  if ( t->join >= 0 )
+    return("join");
+  return("suspensa");
+}
+
+/*!
+  \brief Nome do papel de um semaforo do retrato
+*/
+static const char *dump_role (int role) {
+  switch ( role ) {
+    case DUMP_ITEMS: return("itens");
+    case DUMP_SLOTS: return("vagas");
+    case DUMP_BUFFER: return("buffer");
+  }
+  return("semaforo");
+}
+
+/*!
+  \brief Escreve o retrato em texto
+*/
+static void dump_text (FILE *f, dump_snap_t *snap) {
+  dump_task_t *t;
+  dump_sem_t *s;
+  dump_mq_t *m;
+  dump_disk_t *d;
+  int i, j;
+
+  fprintf(f, "=== PPOS dump: %llu ms, %llu trocas, %llu preempcoes\n",
+          snap->sys.uptime_ns / 1000000, snap->sys.switches, snap->sys.preemptions);
+  fprintf(f, "tarefas %u: prontas %u, adormecidas %d, suspensas %u\n",
+          snap->sys.tasks, snap->sys.ready, snap->sleeping, snap->sys.blocked);
+
+  fprintf(f, "%5s %-10s %4s %4s %3s %7s %9s %9s %9s %7s %7s  espera\n", "id", "estado",
+          "prio", "din", "sis", "ativ", "cpu_ms", "pronta_ms", "susp_ms", "pilha", "pico");
+  for ( i = 0; i < snap->ntasks; i++ ) {
+    t = &snap->tasks[i];
+    fprintf(f, "%5d %-10s %4d %4d %3d %7u %9llu %9llu %9llu %7ld %7ld  ", t->st.id,
+            dump_state(t), t->st.prio, t->din_prio, t->st.system_task, t->st.activations,
+            t->st.run_ns / 1000000, t->st.ready_ns / 1000000, t->st.blocked_ns / 1000000,
+            t->stack, t->stack_max);
+    if ( t->sem )
+      fprintf(f, "semaforo %p", t->sem);
+    else if ( t->sleeping )
+      fprintf(f, "ate %u ms", t->wake_time);
+    else if ( t->join >= 0 )
+      fprintf(f, "tarefa %d", t->join);
+    else
+      fprintf(f, "-");
+    fprintf(f, "\n");
+  }
+
+  for ( i = 0; i < snap->nsems; i++ ) {
+    s = &snap->sems[i];
+    fprintf(f, "semaforo %p (%s", s->sem, dump_role(s->role));
+    if ( s->mqueue )
+      fprintf(f, " da fila %p", s->mqueue);
+    fprintf(f, "): contador %d, %d suspensas:", s->count, s->waiters);
+    for ( j = 0; j < snap->ntasks; j++ )
+      if ( snap->tasks[j].sem == s->sem )
+        fprintf(f, " %d", snap->tasks[j].st.id);
+    fprintf(f, "\n");
+  }
+
+  for ( i = 0; i < snap->nmqs; i++ ) {
+    m = &snap->mqs[i];
+    fprintf(f, "fila %p: %d/%d mensagens de %d bytes, %d receptores e %d remetentes suspensos\n",
+            m->mqueue, m->msgs, m->max, m->size, m->receivers, m->senders);
+  }
+
+  for ( i = 0; i < snap->ndisks; i++ ) {
+    d = &snap->disks[i];
+    fprintf(f, "disco %d: fila %d leituras e %d escritas, %d operacoes no disco, "
+            "%u pedidos, %u operacoes, %u unidos, %u copiados", d->dev, d->reads,
+            d->writes, d->busy, d->st.requests, d->st.ops, d->st.merged, d->st.dedup);
+    if ( d->cache )
+      fprintf(f, ", cache %u acertos e %u faltas", d->hits, d->misses);
+    fprintf(f, "\n");
+  }
+}
+
+/*!
+  \brief Escreve o retrato em JSON, em uma unica linha
+*/
+static void dump_json (FILE *f, dump_snap_t *snap) {
+  dump_task_t *t;
+  dump_sem_t *s;
+  dump_mq_t *m;
+  dump_disk_t *d;
+  int i, j, n;
+
+  fprintf(f, "{\"uptime_ms\":%llu,\"switches\":%llu,\"preemptions\":%llu,"
+          "\"ready\":%u,\"sleeping\":%d,\"blocked\":%u,\"tasks\":[",
+          snap->sys.uptime_ns / 1000000, snap->sys.switches, snap->sys.preemptions,
+          snap->sys.ready, snap->sleeping, snap->sys.blocked);
+  for ( i = 0; i < snap->ntasks; i++ ) {
+    t = &snap->tasks[i];
+    fprintf(f, "%s{\"id\":%d,\"state\":\"%s\",\"prio\":%d,\"din_prio\":%d,\"system\":%d,"
+            "\"activations\":%u,\"cpu_ms\":%llu,\"ready_ms\":%llu,\"blocked_ms\":%llu,"
+            "\"stack\":%ld,\"stack_max\":%ld", i ? "," : "", t->st.id, dump_state(t),
+            t->st.prio, t->din_prio, t->st.system_task, t->st.activations,
+            t->st.run_ns / 1000000, t->st.ready_ns / 1000000, t->st.blocked_ns / 1000000,
+            t->stack, t->stack_max);
+    if ( t->sem )
+      fprintf(f, ",\"sem\":\"%p\"", t->sem);
+    if ( t->sleeping )
+      fprintf(f, ",\"wake_ms\":%u", t->wake_time);
+    if ( t->join >= 0 )
+      fprintf(f, ",\"join\":%d", t->join);
+    fprintf(f, "}");
+  }
+
+  fprintf(f, "],\"semaphores\":[");
+  for ( i = 0; i < snap->nsems; i++ ) {
+    s = &snap->sems[i];
+    fprintf(f, "%s{\"addr\":\"%p\",\"role\":\"%s\",", i ? "," : "", s->sem, dump_role(s->role));
+    if ( s->mqueue )
+      fprintf(f, "\"mqueue\":\"%p\",", s->mqueue);
+    fprintf(f, "\"count\":%d,\"waiters\":[", s->count);
+    for ( j = n = 0; j < snap->ntasks; j++ )
+      if ( snap->tasks[j].sem == s->sem )
+        fprintf(f, "%s%d", n++ ? "," : "", snap->tasks[j].st.id);
+    fprintf(f, "]}");
+  }
+
+  fprintf(f, "],\"mqueues\":[");
+  for ( i = 0; i < snap->nmqs; i++ ) {
+    m = &snap->mqs[i];
+    fprintf(f, "%s{\"addr\":\"%p\",\"msgs\":%d,\"max\":%d,\"size\":%d,\"receivers\":%d,"
+            "\"senders\":%d}", i ? "," : "", m->mqueue, m->msgs, m->max, m->size,
+            m->receivers, m->senders);
+  }
+
+  fprintf(f, "],\"disks\":[");
+  for ( i = 0; i < snap->ndisks; i++ ) {
+    d = &snap->disks[i];
+    fprintf(f, "%s{\"dev\":%d,\"reads\":%d,\"writes\":%d,\"busy\":%d,\"requests\":%u,"
+            "\"ops\":%u,\"merged\":%u,\"dedup\":%u", i ? "," : "", d->dev, d->reads,
+            d->writes, d->busy, d->st.requests, d->st.ops, d->st.merged, d->st.dedup);
+    if ( d->cache )
+      fprintf(f, ",\"cache_hits\":%u,\"cache_misses\":%u", d->hits, d->misses);
+    fprintf(f, "}");
+  }
+  fprintf(f, "]}\n");
+}
+
+/*!
+  \brief Corpo da tarefa que atende os pedidos de retrato
+*/
+static void dump_body (void *arg) {
+  FILE *f;
+
+  while ( dumpOn ) {
+    if ( dumpRequested ) {
+      dumpRequested = 0;
+      if ( !(f = fopen(dumpFile, "a")) )
+        fprintf(stderr, "[PPOS error]: dump: opening %s\n", dumpFile);
+      else {
+        if ( !dump_write(f, dumpFormat) )
+          dumpCount++;
+        fclose(f);
+      }
+    }
+    task_sleep(DUMP_POLL);
+  }
+
+  dumpTaskOn = 0;
+  userTasks++;
+  task_exit(0);
+}
+
+// funções gerais ==============================================================
+
+/*!
+  \brief Liga os retratos se a variavel de ambiente PPOS_DUMP estiver
+  definida
+*/
+void dump_init () {
+  char *file = getenv("PPOS_DUMP");
+  size_t len;
+
+  if ( !file || !*file )
+    return;
+  len = strlen(file);
+  if ( dump_start(file, ( len > 5 && !strcmp(file + len - 5, ".json") ) ? DUMP_JSON : DUMP_TEXT) )
+    fprintf(stderr, "[PPOS error]: dump_init: starting dumps to %s\n", file);
+}
+
+/*!
+  \brief Instala o tratador de SIGUSR2 e cria a tarefa que grava os
+  retratos
+
+  \param file Arquivo ao qual os retratos sao acrescentados
+  \param format DUMP_TEXT ou DUMP_JSON
+
+  \return 0 em sucesso e -1 em erro
+*/
+int dump_start (const char *file, int format) {
+  if ( !file || !*file || strlen(file) >= DUMP_PATH ||
+       ( format != DUMP_TEXT && format != DUMP_JSON ) || dumpOn )
+    return(-1);
+
+  strcpy(dumpFile, file);
+  dumpFormat = format;
+  dumpRequested = 0;
+
+  dumpAction.sa_handler = dump_handler;
+  sigemptyset(&dumpAction.sa_mask);
+  dumpAction.sa_flags = SA_RESTART;
+  if ( sigaction(SIGUSR2, &dumpAction, &dumpOldAction) < 0 ) {
+    fprintf(stderr, "[PPOS error]: dump_start: sigaction\n");
+    return(-1);
+  }
+
+  dumpOn = 1;
+  if ( !dumpTaskOn ) {
+    if ( task_create(&dumpTask, dump_body, NULL) < 0 ) {
+      dumpOn = 0;
+      sigaction(SIGUSR2, &dumpOldAction, NULL);
+      return(-1);
+    }
+    dumpTask.system_task = 1;
+    dumpTaskOn = 1;
+    userTasks--;
+  }
+
+  return(0);
+}
+
+/*!
+  \brief Desliga os retratos; a tarefa de servico termina no proximo
+  intervalo
+
+  \return 0 em sucesso e -1 em erro
+*/
+int dump_stop () {
+  if ( !dumpOn )
+    return(-1);
+  dumpOn = 0;
+  sigaction(SIGUSR2, &dumpOldAction, NULL);
+  return(0);
+}
+
+/*!
+  \brief Tira um retrato e o escreve em f, na tarefa corrente
+
+  \param f Arquivo de saida
+  \param format DUMP_TEXT ou DUMP_JSON
+
+  \return 0 em sucesso e -1 em erro
+*/
+int dump_write (FILE *f, int format) {
+  dump_snap_t snap;
+
+  if ( !f || ( format != DUMP_TEXT && format != DUMP_JSON ) )
+    return(-1);
+  if ( dump_take(&snap) ) {
+    fprintf(stderr, "[PPOS error]: dump_write: taking snapshot\n");
+    return(-1);
+  }
+
+  if ( format == DUMP_JSON )
+    dump_json(f, &snap);
+  else
+    dump_text(f, &snap);
+  fflush(f);
+
+  free(snap.tasks);
+  free(snap.sems);
+  free(snap.mqs);
+  return(0);
+}
+
+/*!
+  \brief Numero de retratos gravados pela tarefa de servico
+*/
+unsigned int dump_count () {
+  return(dumpCount);
+}
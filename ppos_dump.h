@@ -0,0 +1,50 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Retrato do nucleo sob demanda: ao receber SIGUSR2, uma tarefa de servico
+// grava em um arquivo o estado das filas, das tarefas, dos semaforos com
+// tarefas suspensas, das filas de mensagens e dos discos, sem recompilar
+// com -DDEBUG nem reiniciar o processo
+
+#ifndef __PPOS_DUMP__
+#define __PPOS_DUMP__
+
+#include <stdio.h>
+
+// O tratador de SIGUSR2 apenas marca o pedido; a tarefa de servico o
+// percebe em ate DUMP_POLL ms, copia o estado do nucleo com a preempcao
+// suspensa e so entao formata e grava o retrato, fora do dispatcher. Cada
+// retrato eh acrescentado ao arquivo: em texto, ou em JSON com um objeto
+// por linha. Se a variavel de ambiente PPOS_DUMP estiver definida,
+// ppos_init() liga os retratos no arquivo indicado (JSON se o nome
+// terminar em ".json"), por exemplo
+//   PPOS_DUMP=ppos.dump ./programa &  kill -USR2 %1
+
+#define DUMP_POLL   50      // intervalo (ms) de verificacao de pedidos
+#define DUMP_PATH   256     // tamanho maximo do nome do arquivo
+
+// formatos do retrato
+#define DUMP_TEXT   0
+#define DUMP_JSON   1
+
+// Todas as funcoes retornam -1 em erro ou 0 em sucesso, exceto quando
+// indicado.
+
+// liga os retratos se PPOS_DUMP estiver definida (chamada por ppos_init())
+void dump_init () ;
+
+// instala o tratador de SIGUSR2 e cria a tarefa que grava os retratos em
+// file, no formato indicado
+int dump_start (const char *file, int format) ;
+
+// desliga os retratos e restaura o tratador anterior de SIGUSR2
+int dump_stop () ;
+
+// tira um retrato imediatamente e o escreve em f (na tarefa corrente)
+int dump_write (FILE *f, int format) ;
+
+// retorna o numero de retratos gravados pela tarefa de servico
+unsigned int dump_count () ;
+
+#endif
@@ -0,0 +1,825 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ppos.h"
+#include "ppos_fs.h"
+
+// variáveis globais e constantes ==============================================
+
+#define FS_MAGIC 0x50504653  // superbloco ("PPFS")
+
+// campos (inteiros) do superbloco
+#define SB_MAGIC     0
+#define SB_BLOCKS    1
+#define SB_BLOCKSIZE 2
+#define SB_INODES    3
+
+// funções locais ==============================================================
+
+/*!
+  \brief Calcula a disposicao do sistema de arquivos
+
+  \return -1 se o disco nao comporta a disposicao, 0 em sucesso
+*/
+static int fs_layout (fs_t *fs, int dev, int numBlocks, int blockSize, int ninodes) {
+  if ( blockSize < FS_INODE_SIZE || blockSize % FS_INODE_SIZE || ninodes < 1 )
+    return(-1);
+
+  fs->dev = dev;
+  fs->numBlocks = numBlocks;
+  fs->blockSize = blockSize;
+  fs->ninodes = ninodes;
+  fs->bitmapStart = 1;
+  fs->bitmapBlocks = (numBlocks + 8 * blockSize - 1) / (8 * blockSize);
+  fs->inodeStart = fs->bitmapStart + fs->bitmapBlocks;
+  fs->inodeBlocks = (ninodes * FS_INODE_SIZE + blockSize - 1) / blockSize;
+  fs->dirStart = fs->inodeStart + fs->inodeBlocks;
+  fs->dirBlocks = (ninodes * (int) sizeof(fs_dirent_t) + blockSize - 1) / blockSize;
+  fs->journalStart = fs->dirStart + fs->dirBlocks;
+  fs->dataStart = fs->journalStart + FS_JOURNAL;
+
+  return( fs->dataStart < numBlocks ? 0 : -1 );
+}
+
+/*!
+  \brief Aloca as estruturas em memoria do sistema de arquivos
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int fs_alloc_mem (fs_t *fs) {
+  fs->meta = calloc(fs->journalStart, fs->blockSize);
+  fs->dirty = calloc(fs->journalStart, 1);
+  fs->free = malloc((fs->numBlocks / 2 + 1) * sizeof(fs_extent_t));
+  fs->bounce = malloc(2 * fs->blockSize);
+  if ( !fs->meta || !fs->dirty || !fs->free || !fs->bounce )
+    return(-1);
+
+  fs->inodes = (fs_inode_t *) (fs->meta + fs->inodeStart * fs->blockSize);
+  fs->dir = (fs_dirent_t *) (fs->meta + fs->dirStart * fs->blockSize);
+  fs->nfree = fs->freeBlocks = 0;
+
+  return(0);
+}
+
+/*!
+  \brief Libera as estruturas em memoria do sistema de arquivos
+*/
+static void fs_release (fs_t *fs) {
+  free(fs->meta);
+  free(fs->dirty);
+  free(fs->free);
+  free(fs->bounce);
+  fs->meta = fs->dirty = fs->bounce = NULL;
+  fs->free = NULL;
+  fs->inodes = NULL;
+  fs->dir = NULL;
+}
+
+/*!
+  \brief Le ou escreve count blocos contiguos do disco com um unico acesso
+  vetorial, usando um buffer por bloco
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int fs_io (fs_t *fs, int type, int block, int count, void **buffers) {
+  if ( type == READ_OPERATION )
+    return( disk_dev_block_readv(fs->dev, block, count, buffers) );
+  return( disk_dev_block_writev(fs->dev, block, count, buffers) );
+}
+
+/*!
+  \brief Le ou escreve count blocos contiguos do disco a partir de uma area
+  contigua de memoria
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int fs_area (fs_t *fs, int type, int block, int count, void *area) {
+  void **buffers;
+  int i, result;
+
+  buffers = malloc(count * sizeof(void *));
+  if ( !buffers )
+    return(-1);
+  for ( i = 0; i < count; i++ )
+    buffers[i] = (char *) area + i * fs->blockSize;
+
+  result = fs_io(fs, type, block, count, buffers);
+
+  free(buffers);
+  return(result);
+}
+
+/*!
+  \brief Marca como alterado o bloco de metadados que contem o endereco ptr
+*/
+static void fs_touch (fs_t *fs, void *ptr) {
+  fs->dirty[((char *) ptr - fs->meta) / fs->blockSize] = 1;
+}
+
+/*!
+  \brief Grava os blocos de metadados alterados como uma transacao do
+  journal (ou mais, se nao cabem em uma)
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int fs_commit (fs_t *fs) {
+  journal_tx_t tx;
+  int block, result = 0;
+
+  if ( journal_begin(&(fs->journal), &tx) )
+    return(-1);
+  for ( block = 0; block < fs->journalStart; block++ ) {
+    if ( !fs->dirty[block] )
+      continue;
+    if ( tx.count == fs->journal.maxTx &&
+         (journal_commit(&tx) || journal_begin(&(fs->journal), &tx)) )
+      return(-1);
+    if ( journal_write(&tx, block, fs->meta + block * fs->blockSize) )
+      result = -1;
+    fs->dirty[block] = 0;
+    fs->stats.meta++;
+  }
+  if ( journal_commit(&tx) )
+    result = -1;
+
+  return(result);
+}
+
+/*!
+  \brief Marca (used = 1) ou desmarca os blocos [start, start+count) no mapa
+  de bits
+*/
+static void fs_mark (fs_t *fs, int start, int count, int used) {
+  unsigned char *bitmap = (unsigned char *) fs->meta + fs->bitmapStart * fs->blockSize;
+  int b;
+
+  for ( b = start; b < start + count; b++ ) {
+    if ( used )
+      bitmap[b / 8] |= 1 << (b % 8);
+    else
+      bitmap[b / 8] &= ~(1 << (b % 8));
+    fs_touch(fs, &bitmap[b / 8]);
+  }
+}
+
+/*!
+  \brief Reconstroi a lista de extents livres a partir do mapa de bits
+*/
+static void fs_scan (fs_t *fs) {
+  unsigned char *bitmap = (unsigned char *) fs->meta + fs->bitmapStart * fs->blockSize;
+  int b;
+
+  fs->nfree = fs->freeBlocks = 0;
+  for ( b = fs->dataStart; b < fs->numBlocks; b++ ) {
+    if ( bitmap[b / 8] & (1 << (b % 8)) )
+      continue;
+    if ( fs->nfree && fs->free[fs->nfree - 1].start + fs->free[fs->nfree - 1].count == b )
+      fs->free[fs->nfree - 1].count++;
+    else {
+      fs->free[fs->nfree].start = b;
+      fs->free[fs->nfree].count = 1;
+      fs->nfree++;
+    }
+    fs->freeBlocks++;
+  }
+}
+
+/*!
+  \brief Retira count blocos do inicio do extent livre i
+*/
+static void fs_take (fs_t *fs, int i, int count) {
+  fs_mark(fs, fs->free[i].start, count, 1);
+  fs->free[i].start += count;
+  fs->free[i].count -= count;
+  fs->freeBlocks -= count;
+  if ( !fs->free[i].count ) {
+    memmove(&fs->free[i], &fs->free[i + 1], (fs->nfree - i - 1) * sizeof(fs_extent_t));
+    fs->nfree--;
+  }
+}
+
+/*!
+  \brief Devolve os blocos [start, start+count) a lista de extents livres,
+  juntando-os aos extents livres vizinhos
+*/
+static void fs_give (fs_t *fs, int start, int count) {
+  int i;
+
+  fs_mark(fs, start, count, 0);
+  fs->freeBlocks += count;
+
+  for ( i = 0; i < fs->nfree && fs->free[i].start < start; i++ ) ;
+
+  if ( i > 0 && fs->free[i - 1].start + fs->free[i - 1].count == start ) {
+    // junta ao extent anterior e, talvez, ao seguinte
+    fs->free[i - 1].count += count;
+    if ( i < fs->nfree && start + count == fs->free[i].start ) {
+      fs->free[i - 1].count += fs->free[i].count;
+      memmove(&fs->free[i], &fs->free[i + 1], (fs->nfree - i - 1) * sizeof(fs_extent_t));
+      fs->nfree--;
+    }
+  }
+  else if ( i < fs->nfree && start + count == fs->free[i].start ) {
+    // junta ao extent seguinte
+    fs->free[i].start = start;
+    fs->free[i].count += count;
+  }
+  else {
+    memmove(&fs->free[i + 1], &fs->free[i], (fs->nfree - i) * sizeof(fs_extent_t));
+    fs->free[i].start = start;
+    fs->free[i].count = count;
+    fs->nfree++;
+  }
+}
+
+/*!
+  \brief Blocos de dados alocados a um inode
+*/
+static int fs_blocks (fs_inode_t *ino) {
+  int i, count = 0;
+
+  if ( ino->flags & FS_INLINE )
+    return(0);
+  for ( i = 0; i < ino->nextents; i++ )
+    count += ino->extents[i].count;
+  return(count);
+}
+
+/*!
+  \brief Aloca blocos ao inode ate que ele tenha blocks blocos de dados
+
+  O ultimo extent do arquivo eh estendido no lugar enquanto o bloco seguinte
+  estiver livre; senao, usa o menor extent livre que comporte todo o restante
+  (ou o maior extent livre, se nenhum comporta).
+
+  \return -1 se faltam blocos ou extents no inode, 0 em sucesso
+*/
+static int fs_grow (fs_t *fs, fs_inode_t *ino, int blocks) {
+  fs_extent_t *last;
+  int need = blocks - fs_blocks(ino), i, best, largest, take;
+
+  while ( need > 0 ) {
+    // estende o ultimo extent no lugar
+    if ( ino->nextents ) {
+      last = &ino->extents[ino->nextents - 1];
+      for ( i = 0; i < fs->nfree && fs->free[i].start < last->start + last->count; i++ ) ;
+      if ( i < fs->nfree && fs->free[i].start == last->start + last->count ) {
+        take = ( need < fs->free[i].count ) ? need : fs->free[i].count;
+        last->count += take;
+        fs_take(fs, i, take);
+        need -= take;
+        continue;
+      }
+    }
+
+    // novo extent: melhor encaixe ou, sem encaixe, o maior extent livre
+    best = largest = -1;
+    for ( i = 0; i < fs->nfree; i++ ) {
+      if ( fs->free[i].count >= need && (best < 0 || fs->free[i].count < fs->free[best].count) )
+        best = i;
+      if ( largest < 0 || fs->free[i].count > fs->free[largest].count )
+        largest = i;
+    }
+    i = ( best >= 0 ) ? best : largest;
+    if ( i < 0 || ino->nextents == FS_EXTENTS )
+      return(-1);
+
+    take = ( need < fs->free[i].count ) ? need : fs->free[i].count;
+    ino->extents[ino->nextents].start = fs->free[i].start;
+    ino->extents[ino->nextents].count = take;
+    ino->nextents++;
+    fs_take(fs, i, take);
+    need -= take;
+  }
+
+  return(0);
+}
+
+/*!
+  \brief Bloco fisico do bloco fblock do arquivo
+
+  \param run Recebe a quantidade de blocos contiguos a partir dele no extent
+
+  \return Bloco fisico, ou -1 se fblock nao esta alocado
+*/
+static int fs_bmap (fs_inode_t *ino, int fblock, int *run) {
+  int i;
+
+  for ( i = 0; i < ino->nextents; i++ ) {
+    if ( fblock < ino->extents[i].count ) {
+      *run = ino->extents[i].count - fblock;
+      return( ino->extents[i].start + fblock );
+    }
+    fblock -= ino->extents[i].count;
+  }
+  return(-1);
+}
+
+/*!
+  \brief Transfere bytes entre o buffer e os blocos do arquivo a partir da
+  posicao pos (ja alocados); cada trecho contiguo de um extent eh um unico
+  acesso vetorial, com os blocos inteiros lidos ou escritos diretamente no
+  buffer da aplicacao
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int fs_xfer (fs_t *fs, fs_inode_t *ino, int type, int pos, char *buffer, int bytes) {
+  int bs = fs->blockSize, done = 0, off, phys, run, nblk, len, j, b0, e0;
+  void **buffers;
+  char *data;
+
+  buffers = malloc(((bytes + bs - 1) / bs + 1) * sizeof(void *));
+  if ( !buffers )
+    return(-1);
+
+  while ( done < bytes ) {
+    off = (pos + done) % bs;
+    phys = fs_bmap(ino, (pos + done) / bs, &run);
+    if ( phys < 0 ) {
+      free(buffers);
+      return(-1);
+    }
+    nblk = (off + bytes - done + bs - 1) / bs;
+    if ( nblk > run )
+      nblk = run;
+    len = nblk * bs - off;
+    if ( len > bytes - done )
+      len = bytes - done;
+
+    // blocos parciais (primeiro e ultimo) passam pelos buffers intermediarios
+    for ( j = 0; j < nblk; j++ ) {
+      b0 = j ? 0 : off;
+      e0 = ( off + len - j * bs < bs ) ? off + len - j * bs : bs;
+      data = buffer + done + j * bs - off;
+      if ( b0 == 0 && e0 == bs ) {
+        buffers[j] = data;
+        continue;
+      }
+      buffers[j] = fs->bounce + (j ? bs : 0);
+      if ( type == WRITE_OPERATION ) {
+        // bloco com dados do arquivo: le antes de alterar parte dele
+        if ( (long) ((pos + done) / bs + j) * bs < ino->size ) {
+          if ( disk_dev_block_read(fs->dev, phys + j, buffers[j]) ) {
+            free(buffers);
+            return(-1);
+          }
+          fs->stats.rmw++;
+        }
+        else
+          memset(buffers[j], 0, bs);
+        memcpy((char *) buffers[j] + b0, data + b0, e0 - b0);
+      }
+    }
+
+    if ( fs_io(fs, type, phys, nblk, buffers) ) {
+      free(buffers);
+      return(-1);
+    }
+    fs->stats.ios++;
+
+    if ( type == READ_OPERATION )
+      for ( j = 0; j < nblk; j++ )
+        if ( buffers[j] == fs->bounce || buffers[j] == fs->bounce + bs ) {
+          b0 = j ? 0 : off;
+          e0 = ( off + len - j * bs < bs ) ? off + len - j * bs : bs;
+          memcpy(buffer + done + j * bs - off + b0, (char *) buffers[j] + b0, e0 - b0);
+        }
+
+    done += len;
+  }
+
+  free(buffers);
+  return(0);
+}
+
+/*!
+  \brief Entrada do diretorio com o nome indicado
+
+  \return Indice da entrada, ou -1 se nao existe
+*/
+static int fs_lookup (fs_t *fs, const char *name) {
+  int i;
+
+  for ( i = 0; i < fs->ninodes; i++ )
+    if ( fs->dir[i].name[0] && !strncmp(fs->dir[i].name, name, FS_NAME_MAX) )
+      return(i);
+  return(-1);
+}
+
+/*!
+  \brief Verifica um nome de arquivo
+
+  \return -1 se invalido ou 0 se valido
+*/
+static int fs_name (const char *name) {
+  return( (name && name[0] && strlen(name) <= FS_NAME_MAX) ? 0 : -1 );
+}
+
+// funções gerais ==============================================================
+
+/*!
+  \brief Formata um disco com o sistema de arquivos
+
+  \param dev Disco, ja inicializado com disk_dev_mgr_init()
+  \param ninodes Quantidade maxima de arquivos
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int fs_format (int dev, int ninodes) {
+  fs_t fs;
+  int numBlocks, blockSize, *sb, result;
+
+  memset(&fs, 0, sizeof(fs_t));
+  if ( disk_dev_geometry(dev, &numBlocks, &blockSize) ||
+       fs_layout(&fs, dev, numBlocks, blockSize, ninodes) ) {
+    fprintf(stderr, "[PPOS error] fs_format: invalid geometry on disk %d\n", dev);
+    return(-1);
+  }
+  if ( fs_alloc_mem(&fs) ) {
+    fs_release(&fs);
+    return(-1);
+  }
+
+  // superbloco, metadados em uso no mapa de bits, inodes e diretorio vazios
+  sb = (int *) fs.meta;
+  sb[SB_MAGIC] = FS_MAGIC;
+  sb[SB_BLOCKS] = numBlocks;
+  sb[SB_BLOCKSIZE] = blockSize;
+  sb[SB_INODES] = ninodes;
+  fs_mark(&fs, 0, fs.dataStart, 1);
+
+  result = fs_area(&fs, WRITE_OPERATION, 0, fs.journalStart, fs.meta) ||
+           journal_format(dev, fs.journalStart, FS_JOURNAL);
+
+  fs_release(&fs);
+  return(result);
+}
+
+/*!
+  \brief Monta o sistema de arquivos de um disco: abre o journal, que
+  reaplica as transacoes gravadas, e le todos os metadados (mapa de bits,
+  inodes e diretorio) para a memoria
+
+  \param fs Estrutura do sistema de arquivos a preencher
+  \param dev Disco, ja inicializado e formatado com fs_format()
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int fs_mount (fs_t *fs, int dev) {
+  int numBlocks, blockSize, *sb;
+
+  if ( !fs )
+    return(-1);
+  memset(fs, 0, sizeof(fs_t));
+  if ( disk_dev_geometry(dev, &numBlocks, &blockSize) || blockSize < (int) (4 * sizeof(int)) )
+    return(-1);
+
+  sb = malloc(blockSize);
+  if ( !sb || disk_dev_block_read(dev, 0, sb) ) {
+    free(sb);
+    return(-1);
+  }
+  if ( sb[SB_MAGIC] != FS_MAGIC || sb[SB_BLOCKS] != numBlocks || sb[SB_BLOCKSIZE] != blockSize ||
+       fs_layout(fs, dev, numBlocks, blockSize, sb[SB_INODES]) ) {
+    fprintf(stderr, "[PPOS error] fs_mount: disk %d is not formatted\n", dev);
+    free(sb);
+    return(-1);
+  }
+  free(sb);
+
+  if ( fs_alloc_mem(fs) ) {
+    fs_release(fs);
+    return(-1);
+  }
+  if ( journal_open(&(fs->journal), dev, fs->journalStart, FS_JOURNAL) ) {
+    fs_release(fs);
+    return(-1);
+  }
+  if ( fs_area(fs, READ_OPERATION, 0, fs->journalStart, fs->meta) ||
+       sem_create(&(fs->lock), 1) ) {
+    journal_close(&(fs->journal));
+    fs_release(fs);
+    return(-1);
+  }
+  fs_scan(fs);
+
+  return(0);
+}
+
+/*!
+  \brief Desmonta o sistema de arquivos, copiando para o disco os metadados
+  ainda no journal
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int fs_umount (fs_t *fs) {
+  int result;
+
+  if ( !fs || !fs->meta )
+    return(-1);
+
+  result = fs_commit(fs);
+  if ( journal_close(&(fs->journal)) )
+    result = -1;
+  sem_destroy(&(fs->lock));
+  fs_release(fs);
+
+  return(result);
+}
+
+/*!
+  \brief Cria um arquivo vazio (com dados no inode)
+
+  \return -1 em erro (inclusive se o arquivo ja existe) ou 0 em sucesso
+*/
+int fs_create (fs_t *fs, const char *name) {
+  int i, d, result;
+
+  if ( !fs || !fs->meta || fs_name(name) )
+    return(-1);
+
+  if ( sem_down(&(fs->lock)) )
+    return(-1);
+
+  if ( fs_lookup(fs, name) >= 0 ) {
+    sem_up(&(fs->lock));
+    return(-1);
+  }
+  for ( i = 0; i < fs->ninodes && fs->inodes[i].used; i++ ) ;
+  for ( d = 0; d < fs->ninodes && fs->dir[d].name[0]; d++ ) ;
+  if ( i == fs->ninodes || d == fs->ninodes ) {
+    fprintf(stderr, "[PPOS error] fs_create: no free inode on disk %d\n", fs->dev);
+    sem_up(&(fs->lock));
+    return(-1);
+  }
+
+  memset(&fs->inodes[i], 0, sizeof(fs_inode_t));
+  fs->inodes[i].used = 1;
+  fs->inodes[i].flags = FS_INLINE;
+  fs_touch(fs, &fs->inodes[i]);
+
+  memset(&fs->dir[d], 0, sizeof(fs_dirent_t));
+  strncpy(fs->dir[d].name, name, FS_NAME_MAX);
+  fs->dir[d].inode = i;
+  fs_touch(fs, &fs->dir[d]);
+
+  result = fs_commit(fs);
+
+  sem_up(&(fs->lock));
+
+  return(result);
+}
+
+/*!
+  \brief Remove um arquivo, devolvendo seus extents a lista de livres
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int fs_unlink (fs_t *fs, const char *name) {
+  fs_inode_t *ino;
+  int d, i, result;
+
+  if ( !fs || !fs->meta || fs_name(name) )
+    return(-1);
+
+  if ( sem_down(&(fs->lock)) )
+    return(-1);
+
+  d = fs_lookup(fs, name);
+  if ( d < 0 ) {
+    sem_up(&(fs->lock));
+    return(-1);
+  }
+
+  ino = &fs->inodes[fs->dir[d].inode];
+  if ( !(ino->flags & FS_INLINE) )
+    for ( i = 0; i < ino->nextents; i++ )
+      fs_give(fs, ino->extents[i].start, ino->extents[i].count);
+  memset(ino, 0, sizeof(fs_inode_t));
+  fs_touch(fs, ino);
+
+  memset(&fs->dir[d], 0, sizeof(fs_dirent_t));
+  fs_touch(fs, &fs->dir[d]);
+
+  result = fs_commit(fs);
+
+  sem_up(&(fs->lock));
+
+  return(result);
+}
+
+/*!
+  \brief Abre um arquivo existente, na posicao 0
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int fs_open (fs_t *fs, fs_file_t *file, const char *name) {
+  int d;
+
+  if ( !fs || !fs->meta || !file || fs_name(name) )
+    return(-1);
+
+  if ( sem_down(&(fs->lock)) )
+    return(-1);
+  d = fs_lookup(fs, name);
+  if ( d >= 0 ) {
+    file->fs = fs;
+    file->inode = fs->dir[d].inode;
+    file->pos = 0;
+  }
+  sem_up(&(fs->lock));
+
+  return( d >= 0 ? 0 : -1 );
+}
+
+/*!
+  \brief Fecha um arquivo aberto
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int fs_close (fs_file_t *file) {
+  if ( !file || !file->fs )
+    return(-1);
+  file->fs = NULL;
+  return(0);
+}
+
+/*!
+  \brief Le ate bytes bytes do arquivo a partir da posicao corrente
+
+  \return Bytes lidos (0 no fim do arquivo) ou -1 em erro
+*/
+int fs_read (fs_file_t *file, void *buffer, int bytes) {
+  fs_t *fs;
+  fs_inode_t *ino;
+  int result = 0;
+
+  if ( !file || !file->fs || !buffer || bytes < 0 )
+    return(-1);
+  fs = file->fs;
+
+  if ( sem_down(&(fs->lock)) )
+    return(-1);
+
+  ino = &fs->inodes[file->inode];
+  if ( bytes > ino->size - file->pos )
+    bytes = ino->size - file->pos;
+  if ( bytes > 0 ) {
+    if ( ino->flags & FS_INLINE )
+      memcpy(buffer, ino->data + file->pos, bytes);
+    else
+      result = fs_xfer(fs, ino, READ_OPERATION, file->pos, buffer, bytes);
+    if ( !result )
+      file->pos += bytes;
+  }
+  else
+    bytes = 0;
+  fs->stats.reads++;
+
+  sem_up(&(fs->lock));
+
+  return( result ? -1 : bytes );
+}
+
+/*!
+  \brief Escreve bytes bytes no arquivo a partir da posicao corrente,
+  alocando os blocos que faltam
+
+  Enquanto o arquivo cabe em FS_INLINE_MAX bytes seus dados ficam no inode;
+  ao crescer alem disso, os dados passam para blocos alocados de uma vez. Se
+  a passagem falha (disco cheio), o arquivo continua no inode como estava.
+
+  \return Bytes escritos ou -1 em erro
+*/
+int fs_write (fs_file_t *file, const void *buffer, int bytes) {
+  char old[FS_INLINE_MAX];
+  fs_t *fs;
+  fs_inode_t *ino;
+  int end, size, result = 0;
+
+  if ( !file || !file->fs || !buffer || bytes < 0 )
+    return(-1);
+  fs = file->fs;
+
+  if ( sem_down(&(fs->lock)) )
+    return(-1);
+
+  ino = &fs->inodes[file->inode];
+  end = file->pos + bytes;
+  size = ( end > ino->size ) ? end : ino->size;
+
+  if ( (ino->flags & FS_INLINE) && size <= FS_INLINE_MAX )
+    // o arquivo continua no inode
+    memcpy(ino->data + file->pos, buffer, bytes);
+  else {
+    if ( ino->flags & FS_INLINE ) {
+      // passa os dados do inode para blocos
+      memcpy(old, ino->data, ino->size);
+      memset(ino->extents, 0, sizeof(ino->extents));
+      ino->flags &= ~FS_INLINE;
+      ino->nextents = 0;
+      result = fs_grow(fs, ino, (size + fs->blockSize - 1) / fs->blockSize) ||
+               (ino->size && fs_xfer(fs, ino, WRITE_OPERATION, 0, old, ino->size));
+      if ( result ) {
+        // devolve os blocos tomados e volta a guardar os dados no inode
+        while ( ino->nextents > 0 ) {
+          ino->nextents--;
+          fs_give(fs, ino->extents[ino->nextents].start, ino->extents[ino->nextents].count);
+        }
+        memset(ino->data, 0, sizeof(ino->data));
+        memcpy(ino->data, old, ino->size);
+        ino->flags |= FS_INLINE;
+      }
+    }
+    else
+      result = fs_grow(fs, ino, (size + fs->blockSize - 1) / fs->blockSize);
+    if ( result )
+      fprintf(stderr, "[PPOS error] fs_write: no space on disk %d\n", fs->dev);
+    else
+      result = fs_xfer(fs, ino, WRITE_OPERATION, file->pos, (char *) buffer, bytes);
+  }
+
+  if ( !result ) {
+    ino->size = size;
+    file->pos = end;
+  }
+  fs_touch(fs, ino);
+  if ( fs_commit(fs) )
+    result = -1;
+  fs->stats.writes++;
+
+  sem_up(&(fs->lock));
+
+  return( result ? -1 : bytes );
+}
+
+/*!
+  \brief Muda a posicao corrente do arquivo
+
+  \return -1 em erro (posicao alem do fim do arquivo) ou 0 em sucesso
+*/
+int fs_seek (fs_file_t *file, int pos) {
+  int result = -1;
+
+  if ( !file || !file->fs )
+    return(-1);
+
+  if ( sem_down(&(file->fs->lock)) )
+    return(-1);
+  if ( pos >= 0 && pos <= file->fs->inodes[file->inode].size ) {
+    file->pos = pos;
+    result = 0;
+  }
+  sem_up(&(file->fs->lock));
+
+  return(result);
+}
+
+/*!
+  \brief Consulta as informacoes de um arquivo
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int fs_stat (fs_t *fs, const char *name, fs_stat_t *st) {
+  fs_inode_t *ino;
+  int d;
+
+  if ( !fs || !fs->meta || !st || fs_name(name) )
+    return(-1);
+
+  if ( sem_down(&(fs->lock)) )
+    return(-1);
+  d = fs_lookup(fs, name);
+  if ( d >= 0 ) {
+    ino = &fs->inodes[fs->dir[d].inode];
+    st->size = ino->size;
+    st->blocks = fs_blocks(ino);
+    st->inlined = ( ino->flags & FS_INLINE ) ? 1 : 0;
+    st->extents = st->inlined ? 0 : ino->nextents;
+  }
+  sem_up(&(fs->lock));
+
+  return( d >= 0 ? 0 : -1 );
+}
+
+/*!
+  \brief Consulta os contadores e os blocos livres do sistema de arquivos
+
+  \param freeBlocks Recebe os blocos livres (se nao for NULL)
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int fs_stats (fs_t *fs, fs_stats_t *stats, int *freeBlocks) {
+  if ( !fs || !fs->meta || !stats )
+    return(-1);
+
+  *stats = fs->stats;
+  if ( freeBlocks )
+    *freeBlocks = fs->freeBlocks;
+
+  return(0);
+}
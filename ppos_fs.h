@@ -0,0 +1,153 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Sistema de arquivos mínimo baseado em extents sobre um disco do gerente de
+// disco
+
+#ifndef __PPOS_FS__
+#define __PPOS_FS__
+
+#include "ppos_disk.h"
+#include "ppos_journal.h"
+
+// Disposição no disco (todos os metadados ficam em memória enquanto o
+// sistema de arquivos está montado):
+//   [superbloco][mapa de bits][tabela de inodes][diretório][journal][dados...]
+//
+// As alterações de metadados de cada operação são gravadas como uma
+// transação do journal (ppos_journal.h), que as copia depois para suas
+// posições; na montagem, as transações gravadas são reaplicadas. Os dados
+// dos arquivos são gravados diretamente, antes da transação.
+//
+// Cada arquivo é descrito por até FS_EXTENTS extents (faixas contíguas de
+// blocos); o alocador de extents livres estende o último extent do arquivo
+// no lugar quando possível e, senão, escolhe a menor faixa livre que caiba a
+// alocação inteira, mantendo os arquivos contíguos. Arquivos de até
+// FS_INLINE_MAX bytes são guardados no próprio inode, sem blocos de dados.
+// Leituras e escritas de vários blocos de um extent são feitas com um único
+// acesso vetorial ao disco. O diretório é único (raiz), com nomes de até
+// FS_NAME_MAX caracteres.
+
+#define FS_NAME_MAX     27   // tamanho maximo do nome de um arquivo
+#define FS_EXTENTS      14   // extents por inode
+#define FS_INODE_SIZE  128   // tamanho de um inode no disco (bytes)
+#define FS_JOURNAL      64   // blocos da regiao do journal
+#define FS_INLINE_MAX  (FS_EXTENTS * (int) sizeof (fs_extent_t))
+
+#define FS_INLINE       1    // flag: dados guardados no inode
+
+// faixa contigua de blocos
+typedef struct
+{
+  int start;   // primeiro bloco
+  int count;   // quantidade de blocos
+} fs_extent_t ;
+
+// inode no disco e em memoria
+typedef struct
+{
+  int used;       // inode em uso
+  int size;       // tamanho do arquivo (bytes)
+  int flags;      // FS_INLINE
+  int nextents;   // extents em uso
+  union
+  {
+    fs_extent_t extents[FS_EXTENTS]; // blocos do arquivo, em ordem
+    char data[FS_EXTENTS * sizeof (fs_extent_t)]; // dados (FS_INLINE)
+  } ;
+} fs_inode_t ;
+
+// entrada do diretorio
+typedef struct
+{
+  char name[FS_NAME_MAX + 1];   // nome do arquivo ("" = entrada livre)
+  int inode;                    // inode do arquivo
+} fs_dirent_t ;
+
+// contadores do sistema de arquivos
+typedef struct
+{
+  unsigned int reads;    // chamadas de leitura
+  unsigned int writes;   // chamadas de escrita
+  unsigned int ios;      // acessos vetoriais a blocos de dados
+  unsigned int rmw;      // blocos parciais lidos antes de escrever
+  unsigned int meta;     // blocos de metadados gravados no journal
+} fs_stats_t ;
+
+// informacoes de um arquivo
+typedef struct
+{
+  int size;       // tamanho (bytes)
+  int blocks;     // blocos de dados alocados
+  int extents;    // extents em uso
+  int inlined;    // dados guardados no inode
+} fs_stat_t ;
+
+// estrutura que representa um sistema de arquivos montado
+typedef struct
+{
+  int dev;                // disco do sistema de arquivos
+  int numBlocks;          // blocos do disco
+  int blockSize;          // tamanho de cada bloco, em bytes
+  int bitmapStart, bitmapBlocks;   // mapa de bits dos blocos
+  int inodeStart, inodeBlocks;     // tabela de inodes
+  int ninodes;            // quantidade de inodes (e de entradas)
+  int dirStart, dirBlocks;         // diretorio
+  int journalStart;       // regiao do journal (FS_JOURNAL blocos)
+  int dataStart;          // primeiro bloco de dados
+  char *meta;             // metadados (blocos 0 a journalStart-1) em memoria
+  char *dirty;            // blocos de metadados alterados
+  fs_inode_t *inodes;     // tabela de inodes (dentro de meta)
+  fs_dirent_t *dir;       // diretorio (dentro de meta)
+  fs_extent_t *free;      // extents livres, em ordem de bloco
+  int nfree;              // quantidade de extents livres
+  int freeBlocks;         // blocos livres
+  char *bounce;           // blocos parciais de leitura/escrita
+  semaphore_t lock;       // acesso exclusivo ao sistema de arquivos
+  journal_t journal;      // journal dos metadados
+  fs_stats_t stats;       // contadores
+} fs_t ;
+
+// arquivo aberto
+typedef struct
+{
+  fs_t *fs;       // sistema de arquivos do arquivo
+  int inode;      // inode do arquivo
+  int pos;        // posicao corrente (bytes)
+} fs_file_t ;
+
+// Todas as funcoes retornam -1 em erro; fs_read/fs_write retornam a
+// quantidade de bytes transferidos e as demais 0 em sucesso.
+
+// formata o disco dev (ja inicializado) com ninodes inodes
+int fs_format (int dev, int ninodes) ;
+
+// monta e desmonta o sistema de arquivos do disco dev
+int fs_mount (fs_t *fs, int dev) ;
+int fs_umount (fs_t *fs) ;
+
+// cria um arquivo vazio; erro se ja existe
+int fs_create (fs_t *fs, const char *name) ;
+
+// remove um arquivo (que nao deve estar aberto)
+int fs_unlink (fs_t *fs, const char *name) ;
+
+// abre e fecha um arquivo existente
+int fs_open (fs_t *fs, fs_file_t *file, const char *name) ;
+int fs_close (fs_file_t *file) ;
+
+// leitura/escrita a partir da posicao corrente, que avanca
+int fs_read (fs_file_t *file, void *buffer, int bytes) ;
+int fs_write (fs_file_t *file, const void *buffer, int bytes) ;
+
+// muda a posicao corrente (no maximo o tamanho do arquivo)
+int fs_seek (fs_file_t *file, int pos) ;
+
+// consulta as informacoes de um arquivo
+int fs_stat (fs_t *fs, const char *name, fs_stat_t *st) ;
+
+// consulta os contadores e os blocos livres
+int fs_stats (fs_t *fs, fs_stats_t *stats, int *freeBlocks) ;
+
+#endif
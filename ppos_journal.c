@@ -0,0 +1,898 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "ppos.h"
+#include "ppos_journal.h"
+#include "queue.h"
+
+// variáveis globais e constantes ==============================================
+
+extern int userTasks;
+
+#define JOURNAL_MAGIC      0x4a524e4c  // superbloco do journal ("JRNL")
+#define JOURNAL_MAGIC_DESC 0x4a524e44  // descritor de registro ("JRND")
+
+// prioridade da tarefa de checkpoint: suas gravacoes ficam na classe baixa
+// do escalonador do disco, atras das gravacoes do journal
+#define JOURNAL_PRIO 10
+
+// campos (inteiros) do superbloco
+#define JS_MAGIC  0
+#define JS_BLOCKS 1
+#define JS_EPOCH  2
+#define JS_TAIL   3
+#define JS_SEQ    4
+
+// campos (inteiros) do descritor, seguidos dos blocos de destino
+#define JD_MAGIC 0
+#define JD_EPOCH 1
+#define JD_SEQ   2
+#define JD_COUNT 3
+#define JD_SUM   4
+#define JD_HDR   5
+
+// funções locais ==============================================================
+
+/*!
+  \brief Endereco do bloco pos do log na imagem em memoria
+*/
+static char *journal_slot (journal_t *journal, int pos) {
+  return( journal->log + pos * journal->blockSize );
+}
+
+/*!
+  \brief Le ou escreve count blocos contiguos do disco a partir de uma area
+  contigua de memoria
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int journal_io (journal_t *journal, int type, int block, int count, void *area) {
+  void **buffers;
+  int i, result;
+
+  buffers = malloc(count * sizeof(void *));
+  if ( !buffers )
+    return(-1);
+  for ( i = 0; i < count; i++ )
+    buffers[i] = (char *) area + i * journal->blockSize;
+
+  if ( type == READ_OPERATION )
+    result = disk_dev_block_readv(journal->dev, block, count, buffers);
+  else
+    result = disk_dev_block_writev(journal->dev, block, count, buffers);
+
+  free(buffers);
+  return(result);
+}
+
+/*!
+  \brief Checksum (FNV-1a) de um registro: cabecalho, blocos de destino e
+  blocos de dados, que seguem o descritor na imagem do log
+*/
+static unsigned int journal_sum (journal_t *journal, int *desc, char *data) {
+  unsigned int sum = 2166136261u;
+  unsigned char *p;
+  int i, n;
+
+  p = (unsigned char *) &desc[JD_EPOCH];
+  for ( i = 0; i < 3 * (int) sizeof(int); i++ )
+    sum = (sum ^ p[i]) * 16777619u;
+  p = (unsigned char *) &desc[JD_HDR];
+  n = desc[JD_COUNT] * sizeof(int);
+  for ( i = 0; i < n; i++ )
+    sum = (sum ^ p[i]) * 16777619u;
+  p = (unsigned char *) data;
+  n = desc[JD_COUNT] * journal->blockSize;
+  for ( i = 0; i < n; i++ )
+    sum = (sum ^ p[i]) * 16777619u;
+
+  return(sum);
+}
+
+/*!
+  \brief Procura um bloco em um mapa de versoes (tabela hash)
+
+  \return Entrada do bloco, ou a entrada livre em que ele seria inserido
+*/
+static journal_entry_t *journal_find (journal_t *journal, journal_entry_t *map, int block) {
+  int i = ((unsigned int) block * 2654435761u) & (journal->mapSize - 1);
+
+  while ( map[i].block >= 0 && map[i].block != block )
+    i = (i + 1) & (journal->mapSize - 1);
+  return( &map[i] );
+}
+
+/*!
+  \brief Registra a nova versao de um bloco em um mapa de versoes
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int journal_put (journal_t *journal, journal_entry_t *map, int block, const void *data) {
+  journal_entry_t *entry = journal_find(journal, map, block);
+
+  if ( entry->block < 0 ) {
+    entry->data = malloc(journal->blockSize);
+    if ( !entry->data )
+      return(-1);
+    entry->block = block;
+  }
+  memcpy(entry->data, data, journal->blockSize);
+
+  return(0);
+}
+
+/*!
+  \brief Esvazia um mapa de versoes
+*/
+static void journal_clear (journal_t *journal, journal_entry_t *map) {
+  int i;
+
+  for ( i = 0; i < journal->mapSize; i++ )
+    if ( map[i].block >= 0 ) {
+      free(map[i].data);
+      map[i].block = -1;
+      map[i].data = NULL;
+    }
+}
+
+/*!
+  \brief Ordena entradas por bloco (qsort)
+*/
+static int journal_cmp (const void *a, const void *b) {
+  return( ((journal_entry_t *) a)->block - ((journal_entry_t *) b)->block );
+}
+
+/*!
+  \brief Copia para suas posicoes no disco as versoes de um mapa; blocos
+  vizinhos vao no mesmo pedido e todos os pedidos sao enviados de uma vez,
+  para que o escalonador do disco os atenda em ordem de bloco
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int journal_writeback (journal_t *journal, journal_entry_t *map) {
+  journal_entry_t *list;
+  request_t *reqs;
+  void **buffers;
+  int i, n = 0, nreqs = 0, first, result = 0;
+
+  list = malloc(journal->mapSize * sizeof(journal_entry_t));
+  reqs = malloc(journal->mapSize * sizeof(request_t));
+  buffers = malloc(journal->mapSize * sizeof(void *));
+  if ( !list || !reqs || !buffers ) {
+    free(list);
+    free(reqs);
+    free(buffers);
+    return(-1);
+  }
+
+  for ( i = 0; i < journal->mapSize; i++ )
+    if ( map[i].block >= 0 )
+      list[n++] = map[i];
+  qsort(list, n, sizeof(journal_entry_t), journal_cmp);
+
+  for ( i = 0; i < n; i++ )
+    buffers[i] = list[i].data;
+  for ( first = 0; first < n; first = i ) {
+    for ( i = first + 1; i < n && i - first < DISK_VEC_MAX &&
+                         list[i].block == list[i - 1].block + 1; i++ ) ;
+    if ( disk_dev_submit(journal->dev, &reqs[nreqs], WRITE_OPERATION, list[first].block,
+                         i - first, &buffers[first]) )
+      result = -1;
+    else
+      nreqs++;
+  }
+  for ( i = 0; i < nreqs; i++ )
+    if ( disk_dev_wait(&reqs[i]) )
+      result = -1;
+
+  free(list);
+  free(reqs);
+  free(buffers);
+  return(result);
+}
+
+/*!
+  \brief Grava o superbloco do journal
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int journal_write_super (journal_t *journal, int tail, unsigned int seq) {
+  int *sb, result;
+
+  sb = calloc(1, journal->blockSize);
+  if ( !sb )
+    return(-1);
+  sb[JS_MAGIC] = JOURNAL_MAGIC;
+  sb[JS_BLOCKS] = journal->logBlocks + 1;
+  sb[JS_EPOCH] = journal->epoch;
+  sb[JS_TAIL] = tail;
+  sb[JS_SEQ] = seq;
+  result = disk_dev_block_write(journal->dev, journal->start, sb);
+
+  free(sb);
+  return(result);
+}
+
+/*!
+  \brief Checkpoint: copia para o disco as versoes gravadas ate agora e
+  libera o log correspondente. Chamada com o journal travado, que eh
+  liberado durante as gravacoes.
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int journal_do_checkpoint (journal_t *journal) {
+  journal_entry_t *map;
+  unsigned int seq;
+  int head, used, result, i;
+
+  // apenas um checkpoint por vez
+  while ( journal->checkpointing ) {
+    journal->spaceWaiting++;
+    sem_up(&(journal->lock));
+    sem_down(&(journal->space));
+    sem_down(&(journal->lock));
+  }
+  if ( !journal->used )
+    return(0);
+
+  // as versoes gravadas ate aqui passam ao mapa do checkpoint
+  journal->checkpointing = 1;
+  map = journal->ckpt;
+  journal->ckpt = journal->cur;
+  journal->cur = map;
+  head = journal->head;
+  seq = journal->seq;
+  used = journal->used;
+  sem_up(&(journal->lock));
+
+  // o log so eh liberado depois que as versoes estao no disco
+  result = journal_writeback(journal, journal->ckpt);
+  if ( !result )
+    result = journal_write_super(journal, head, seq);
+
+  sem_down(&(journal->lock));
+  if ( result ) {
+    // as versoes voltam ao mapa corrente, sem sobrepor versoes mais novas
+    for ( i = 0; i < journal->mapSize; i++ )
+      if ( journal->ckpt[i].block >= 0 &&
+           journal_find(journal, journal->cur, journal->ckpt[i].block)->block < 0 )
+        journal_put(journal, journal->cur, journal->ckpt[i].block, journal->ckpt[i].data);
+  }
+  else {
+    journal->used -= used;
+    journal->stats.checkpoints++;
+  }
+  journal_clear(journal, journal->ckpt);
+  journal->checkpointing = 0;
+
+  // acorda as tarefas que aguardavam espaco no log
+  while ( journal->spaceWaiting ) {
+    journal->spaceWaiting--;
+    sem_up(&(journal->space));
+  }
+
+  return(result);
+}
+
+/*!
+  \brief Corpo da tarefa de checkpoint
+*/
+static void journal_checkpointer (void *arg) {
+  journal_t *journal = arg;
+
+  while (1) {
+    sem_down(&(journal->kick));
+    if ( journal->stop )
+      break;
+
+    sem_down(&(journal->lock));
+    journal->wake = 0;
+    journal_do_checkpoint(journal);
+    sem_up(&(journal->lock));
+  }
+
+  // a tarefa nao era contada como tarefa de usuario (ver journal_open)
+  userTasks++;
+  task_exit(0);
+}
+
+/*!
+  \brief Acorda a tarefa de checkpoint, se ainda nao foi acordada
+*/
+static void journal_kick (journal_t *journal) {
+  if ( !journal->wake && !journal->stop ) {
+    journal->wake = 1;
+    sem_up(&(journal->kick));
+  }
+}
+
+/*!
+  \brief Monta na imagem do log os registros das transacoes pendentes que
+  cabem no espaco livre, a partir da cabeca do log
+
+  Cada registro ocupa posicoes contiguas do log (se nao cabe antes do fim,
+  comeca no inicio); transacoes inteiras sao acrescentadas ao registro
+  corrente enquanto cabem no descritor, e blocos repetidos no registro
+  guardam apenas a versao mais nova.
+
+  \param batch Recebe as transacoes retiradas da fila
+  \param nrec Recebe a quantidade de registros montados
+  \param space Recebe os blocos do log ocupados (inclusive o desperdicio
+  no fim do log)
+  \param split Recebe a posicao em que o log deu a volta (-1 se nao deu)
+
+  \return Posicao do log depois do ultimo registro
+*/
+static int journal_build (journal_t *journal, journal_tx_t **batch, int *nrec, int *space,
+                          int *split) {
+  int maxDesc = journal->blockSize / sizeof(int) - JD_HDR;
+  int pos = journal->head, rec = -1, fresh, i, j, *desc = NULL, need, waste, wrap;
+  journal_tx_t *tx;
+
+  *batch = NULL;
+  *nrec = *space = 0;
+  *split = -1;
+
+  while ( journal->pending ) {
+    tx = journal->pending;
+
+    // blocos da transacao ainda ausentes no registro corrente
+    fresh = tx->count;
+    if ( rec >= 0 )
+      for ( i = 0; i < tx->count; i++ )
+        for ( j = 0; j < desc[JD_COUNT]; j++ )
+          if ( desc[JD_HDR + j] == tx->blocks[i] ) {
+            fresh--;
+            break;
+          }
+
+    if ( rec >= 0 && desc[JD_COUNT] + fresh <= maxDesc &&
+         pos + fresh <= journal->logBlocks ) {
+      // acrescenta a transacao ao registro corrente
+      if ( journal->used + *space + fresh >= journal->logBlocks )
+        break;
+      *space += fresh;
+    }
+    else {
+      // novo registro
+      need = 1 + tx->count;
+      wrap = ( pos + need > journal->logBlocks );
+      waste = wrap ? journal->logBlocks - pos : 0;
+      if ( journal->used + *space + waste + need >= journal->logBlocks )
+        break;
+      if ( wrap ) {
+        *split = pos;
+        pos = 0;
+      }
+      *space += waste + 1;
+      rec = pos;
+      desc = (int *) journal_slot(journal, rec);
+      memset(desc, 0, journal->blockSize);
+      desc[JD_MAGIC] = JOURNAL_MAGIC_DESC;
+      desc[JD_EPOCH] = journal->epoch;
+      desc[JD_SEQ] = journal->seq + *nrec;
+      pos++;
+      (*nrec)++;
+      *space += fresh = tx->count;
+    }
+
+    // copia os blocos da transacao para o registro
+    for ( i = 0; i < tx->count; i++ ) {
+      for ( j = 0; j < desc[JD_COUNT] && desc[JD_HDR + j] != tx->blocks[i]; j++ ) ;
+      if ( j == desc[JD_COUNT] ) {
+        desc[JD_HDR + j] = tx->blocks[i];
+        desc[JD_COUNT]++;
+        pos++;
+      }
+      else
+        journal->stats.absorbed++;
+      memcpy(journal_slot(journal, rec + 1 + j), tx->data + i * journal->blockSize,
+             journal->blockSize);
+    }
+
+    queue_remove((queue_t **) &(journal->pending), (queue_t *) tx);
+    queue_append((queue_t **) batch, (queue_t *) tx);
+  }
+
+  return(pos);
+}
+
+/*!
+  \brief Posicao do registro seguinte ao registro que termina em pos: os
+  registros que nao cabem antes do fim do log comecam no inicio
+*/
+static int journal_next (int pos, int split) {
+  return( (pos == split) ? 0 : pos );
+}
+
+/*!
+  \brief Grava no disco os registros montados entre as posicoes from e to
+  do log: um acesso sequencial ou, se o log deu a volta em split, dois
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int journal_flush (journal_t *journal, int from, int to, int split, int nrec) {
+  int pos = from, n, *desc;
+
+  // completa os descritores com o checksum dos registros
+  for ( n = 0; n < nrec; n++ ) {
+    pos = journal_next(pos, split);
+    desc = (int *) journal_slot(journal, pos);
+    desc[JD_SUM] = journal_sum(journal, desc, journal_slot(journal, pos + 1));
+    pos += 1 + desc[JD_COUNT];
+  }
+
+  if ( split < 0 )
+    return( journal_io(journal, WRITE_OPERATION, journal->start + 1 + from, to - from,
+                       journal_slot(journal, from)) );
+  if ( split > from && journal_io(journal, WRITE_OPERATION, journal->start + 1 + from,
+                                  split - from, journal_slot(journal, from)) )
+    return(-1);
+  return( journal_io(journal, WRITE_OPERATION, journal->start + 1, to, journal->log) );
+}
+
+/*!
+  \brief Registra no mapa corrente as versoes dos registros gravados
+*/
+static void journal_apply (journal_t *journal, int from, int split, int nrec) {
+  int pos = from, n, j, *desc;
+
+  for ( n = 0; n < nrec; n++ ) {
+    pos = journal_next(pos, split);
+    desc = (int *) journal_slot(journal, pos);
+    for ( j = 0; j < desc[JD_COUNT]; j++ )
+      journal_put(journal, journal->cur, desc[JD_HDR + j], journal_slot(journal, pos + 1 + j));
+    journal->stats.blocks += desc[JD_COUNT];
+    pos += 1 + desc[JD_COUNT];
+  }
+}
+
+/*!
+  \brief Le do disco o registro da posicao pos do log, se ele eh o proximo
+  registro esperado (epoca, sequencia e checksum conferem)
+
+  \return Blocos de dados do registro, 0 se nao eh o registro esperado ou
+  -1 em erro
+*/
+static int journal_record (journal_t *journal, int pos) {
+  int *desc = (int *) journal_slot(journal, pos), n;
+
+  if ( journal_io(journal, READ_OPERATION, journal->start + 1 + pos, 1, desc) )
+    return(-1);
+  n = desc[JD_COUNT];
+  if ( desc[JD_MAGIC] != JOURNAL_MAGIC_DESC || (unsigned int) desc[JD_EPOCH] != journal->epoch ||
+       (unsigned int) desc[JD_SEQ] != journal->seq || n < 1 ||
+       n > journal->blockSize / (int) sizeof(int) - JD_HDR || pos + 1 + n > journal->logBlocks )
+    return(0);
+  if ( journal_io(journal, READ_OPERATION, journal->start + 2 + pos, n,
+                  journal_slot(journal, pos + 1)) )
+    return(-1);
+  if ( (unsigned int) desc[JD_SUM] != journal_sum(journal, desc, journal_slot(journal, pos + 1)) )
+    return(0);
+
+  return(n);
+}
+
+/*!
+  \brief Reaplica ao mapa corrente os registros gravados depois do ultimo
+  checkpoint, que comecam na posicao tail do log
+
+  \return Registros reaplicados, ou -1 em erro
+*/
+static int journal_replay (journal_t *journal, int tail) {
+  int pos, n, count = 0;
+
+  journal->head = tail;
+  journal->used = 0;
+  while (1) {
+    // o proximo registro esta na cabeca ou, se nao coube, no inicio do log
+    pos = journal->head;
+    n = ( pos < journal->logBlocks ) ? journal_record(journal, pos) : 0;
+    if ( !n && pos ) {
+      pos = 0;
+      n = journal_record(journal, pos);
+    }
+    if ( n < 0 )
+      return(-1);
+    if ( !n )
+      break;
+
+    if ( pos != journal->head )
+      journal->used += journal->logBlocks - journal->head;
+    journal_apply(journal, pos, -1, 1);
+    journal->used += 1 + n;
+    journal->seq++;
+    journal->head = pos + 1 + n;
+    count++;
+  }
+
+  return(count);
+}
+
+// funções gerais ==============================================================
+
+/*!
+  \brief Formata uma regiao de um disco como journal vazio
+
+  \param dev Disco, ja inicializado com disk_dev_mgr_init()
+  \param start Primeiro bloco da regiao
+  \param blocks Blocos da regiao (superbloco + log)
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int journal_format (int dev, int start, int blocks) {
+  journal_t journal;
+  int numBlocks, blockSize, *sb;
+  unsigned int epoch = time(NULL);
+
+  if ( disk_dev_geometry(dev, &numBlocks, &blockSize) || blockSize < 64 ||
+       start < 0 || blocks < 8 || start + blocks > numBlocks ) {
+    fprintf(stderr, "[PPOS error] journal_format: invalid region on disk %d\n", dev);
+    return(-1);
+  }
+
+  memset(&journal, 0, sizeof(journal_t));
+  journal.dev = dev;
+  journal.start = start;
+  journal.logBlocks = blocks - 1;
+  journal.blockSize = blockSize;
+
+  // a nova formatacao nao pode reconhecer registros de formatacoes anteriores
+  sb = malloc(blockSize);
+  if ( !sb )
+    return(-1);
+  if ( !disk_dev_block_read(dev, start, sb) && sb[JS_MAGIC] == JOURNAL_MAGIC &&
+       (unsigned int) sb[JS_EPOCH] >= epoch )
+    epoch = sb[JS_EPOCH] + 1;
+  free(sb);
+  journal.epoch = epoch;
+
+  return( journal_write_super(&journal, 0, 1) );
+}
+
+/*!
+  \brief Abre o journal de uma regiao de um disco, reaplicando os registros
+  posteriores ao ultimo checkpoint, e cria a tarefa de checkpoint
+
+  \param journal Estrutura do journal a preencher
+  \param dev Disco, ja inicializado com disk_dev_mgr_init()
+  \param start Primeiro bloco da regiao, formatada com journal_format()
+  \param blocks Blocos da regiao
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int journal_open (journal_t *journal, int dev, int start, int blocks) {
+  int *sb, tail, replayed, i;
+
+  if ( !journal )
+    return(-1);
+  memset(journal, 0, sizeof(journal_t));
+  if ( disk_dev_geometry(dev, &(journal->numBlocks), &(journal->blockSize)) ||
+       journal->blockSize < 64 || start < 0 || blocks < 8 || start + blocks > journal->numBlocks )
+    return(-1);
+  journal->dev = dev;
+  journal->start = start;
+  journal->logBlocks = blocks - 1;
+
+  // transacoes cabem em um descritor e em meio log
+  journal->maxTx = journal->blockSize / sizeof(int) - JD_HDR;
+  if ( journal->maxTx > journal->logBlocks / 2 - 2 )
+    journal->maxTx = journal->logBlocks / 2 - 2;
+  for ( journal->mapSize = 1; journal->mapSize < 2 * journal->logBlocks; journal->mapSize *= 2 ) ;
+
+  journal->log = malloc(journal->logBlocks * journal->blockSize);
+  journal->cur = malloc(journal->mapSize * sizeof(journal_entry_t));
+  journal->ckpt = malloc(journal->mapSize * sizeof(journal_entry_t));
+  if ( !journal->log || !journal->cur || !journal->ckpt ) {
+    free(journal->log);
+    free(journal->cur);
+    free(journal->ckpt);
+    return(-1);
+  }
+  for ( i = 0; i < journal->mapSize; i++ ) {
+    journal->cur[i].block = journal->ckpt[i].block = -1;
+    journal->cur[i].data = journal->ckpt[i].data = NULL;
+  }
+
+  // superbloco: inicio do log (cauda) e sequencia do primeiro registro
+  sb = (int *) journal->log;
+  if ( disk_dev_block_read(dev, start, sb) || sb[JS_MAGIC] != JOURNAL_MAGIC ||
+       sb[JS_BLOCKS] != blocks || sb[JS_TAIL] < 0 || sb[JS_TAIL] >= journal->logBlocks ) {
+    fprintf(stderr, "[PPOS error] journal_open: disk %d has no journal at block %d\n", dev, start);
+    free(journal->log);
+    free(journal->cur);
+    free(journal->ckpt);
+    return(-1);
+  }
+  journal->epoch = sb[JS_EPOCH];
+  journal->seq = sb[JS_SEQ];
+  tail = sb[JS_TAIL];
+
+  if ( sem_create(&(journal->lock), 1) || sem_create(&(journal->done), 0) ||
+       sem_create(&(journal->space), 0) || sem_create(&(journal->kick), 0) )
+    return(-1);
+
+  // reaplica os registros e copia suas versoes para o disco
+  replayed = journal_replay(journal, tail);
+  if ( replayed < 0 || (replayed && journal_checkpoint(journal)) ) {
+    journal_clear(journal, journal->cur);
+    free(journal->log);
+    free(journal->cur);
+    free(journal->ckpt);
+    return(-1);
+  }
+  journal->stats.replayed = replayed;
+  journal->stats.blocks = journal->stats.checkpoints = 0;
+
+  // cria a tarefa de checkpoint, que nao conta como tarefa de usuario
+  task_create(&(journal->task), journal_checkpointer, journal);
+  task_setprio(&(journal->task), JOURNAL_PRIO);
+  userTasks--;
+
+  return(0);
+}
+
+/*!
+  \brief Fecha o journal: realiza um checkpoint final e termina a tarefa de
+  checkpoint
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int journal_close (journal_t *journal) {
+  int result;
+
+  if ( !journal || !journal->log )
+    return(-1);
+
+  result = journal_checkpoint(journal);
+
+  journal->stop = 1;
+  sem_up(&(journal->kick));
+  task_join(&(journal->task));
+
+  sem_destroy(&(journal->lock));
+  sem_destroy(&(journal->done));
+  sem_destroy(&(journal->space));
+  sem_destroy(&(journal->kick));
+  journal_clear(journal, journal->cur);
+  free(journal->log);
+  free(journal->cur);
+  free(journal->ckpt);
+  journal->log = NULL;
+  journal->cur = journal->ckpt = NULL;
+
+  return(result);
+}
+
+/*!
+  \brief Inicia uma transacao vazia
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int journal_begin (journal_t *journal, journal_tx_t *tx) {
+  if ( !journal || !journal->log || !tx )
+    return(-1);
+
+  memset(tx, 0, sizeof(journal_tx_t));
+  tx->journal = journal;
+
+  return(0);
+}
+
+/*!
+  \brief Registra na transacao a nova versao de um bloco; uma nova escrita
+  do mesmo bloco substitui a anterior
+
+  \return -1 em erro (bloco invalido ou transacao cheia) ou 0 em sucesso
+*/
+int journal_write (journal_tx_t *tx, int block, const void *buffer) {
+  journal_t *journal;
+  int i, *blocks;
+  char *data;
+
+  if ( !tx || !tx->journal || !buffer )
+    return(-1);
+  journal = tx->journal;
+  if ( block < 0 || block >= journal->numBlocks ||
+       (block >= journal->start && block <= journal->start + journal->logBlocks) )
+    return(-1);
+
+  for ( i = 0; i < tx->count && tx->blocks[i] != block; i++ ) ;
+  if ( i == tx->count ) {
+    if ( tx->count == journal->maxTx ) {
+      fprintf(stderr, "[PPOS error] journal_write: transaction too large\n");
+      return(-1);
+    }
+    if ( tx->count == tx->cap ) {
+      tx->cap = tx->cap ? 2 * tx->cap : 4;
+      blocks = realloc(tx->blocks, tx->cap * sizeof(int));
+      if ( blocks )
+        tx->blocks = blocks;
+      data = realloc(tx->data, tx->cap * journal->blockSize);
+      if ( data )
+        tx->data = data;
+      if ( !blocks || !data )
+        return(-1);
+    }
+    tx->blocks[i] = block;
+    tx->count++;
+  }
+  memcpy(tx->data + i * journal->blockSize, buffer, journal->blockSize);
+
+  return(0);
+}
+
+/*!
+  \brief Grava a transacao no journal e aguarda a gravacao
+
+  A primeira tarefa a encontrar o journal livre grava, em um unico acesso,
+  as transacoes de todas as tarefas que chegaram enquanto a gravacao
+  anterior estava em andamento; as demais aguardam essa gravacao.
+
+  \return -1 em erro ou 0 em sucesso (a transacao eh liberada nos dois casos)
+*/
+int journal_commit (journal_tx_t *tx) {
+  journal_t *journal;
+  journal_tx_t *batch, *t;
+  int from, to, nrec, space, split, result;
+
+  if ( !tx || !tx->journal )
+    return(-1);
+  journal = tx->journal;
+
+  if ( !tx->count ) {
+    journal_abort(tx);
+    return(0);
+  }
+
+  if ( sem_down(&(journal->lock)) )
+    return(-1);
+
+  queue_append((queue_t **) &(journal->pending), (queue_t *) tx);
+
+  while ( !tx->done ) {
+    if ( journal->writing ) {
+      // outra tarefa esta gravando: aguarda o fim da gravacao
+      journal->waiting++;
+      sem_up(&(journal->lock));
+      sem_down(&(journal->done));
+      sem_down(&(journal->lock));
+      continue;
+    }
+
+    // esta tarefa grava as transacoes pendentes que cabem no log
+    from = journal->head;
+    to = journal_build(journal, &batch, &nrec, &space, &split);
+    if ( !batch ) {
+      // log cheio: aguarda um checkpoint
+      journal->stats.stalls++;
+      journal->spaceWaiting++;
+      journal_kick(journal);
+      sem_up(&(journal->lock));
+      sem_down(&(journal->space));
+      sem_down(&(journal->lock));
+      continue;
+    }
+    journal->writing = 1;
+    sem_up(&(journal->lock));
+
+    result = journal_flush(journal, from, to, split, nrec);
+
+    sem_down(&(journal->lock));
+    if ( !result ) {
+      journal_apply(journal, from, split, nrec);
+      journal->seq += nrec;
+      journal->head = to;
+      journal->used += space;
+      journal->stats.writes++;
+      journal->stats.records += nrec;
+    }
+    while ( batch ) {
+      t = batch;
+      queue_remove((queue_t **) &batch, (queue_t *) t);
+      t->result = result;
+      t->done = 1;
+      if ( !result )
+        journal->stats.commits++;
+    }
+    journal->writing = 0;
+
+    // acorda as tarefas que aguardavam esta gravacao
+    while ( journal->waiting ) {
+      journal->waiting--;
+      sem_up(&(journal->done));
+    }
+    if ( journal->used * 100 > journal->logBlocks * JOURNAL_CKPT_PCT )
+      journal_kick(journal);
+  }
+  result = tx->result;
+
+  sem_up(&(journal->lock));
+
+  journal_abort(tx);
+  return(result);
+}
+
+/*!
+  \brief Descarta a transacao, liberando sua memoria
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int journal_abort (journal_tx_t *tx) {
+  if ( !tx || !tx->journal )
+    return(-1);
+
+  free(tx->blocks);
+  free(tx->data);
+  tx->blocks = NULL;
+  tx->data = NULL;
+  tx->count = tx->cap = 0;
+  tx->journal = NULL;
+
+  return(0);
+}
+
+/*!
+  \brief Le um bloco: a versao mais nova gravada no journal, se ainda nao
+  foi copiada pelo checkpoint, ou o bloco do disco
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int journal_read (journal_t *journal, int block, void *buffer) {
+  journal_entry_t *entry;
+
+  if ( !journal || !journal->log || !buffer )
+    return(-1);
+
+  if ( sem_down(&(journal->lock)) )
+    return(-1);
+  entry = journal_find(journal, journal->cur, block);
+  if ( entry->block < 0 )
+    entry = journal_find(journal, journal->ckpt, block);
+  if ( entry->block >= 0 ) {
+    memcpy(buffer, entry->data, journal->blockSize);
+    sem_up(&(journal->lock));
+    return(0);
+  }
+  sem_up(&(journal->lock));
+
+  return( disk_dev_block_read(journal->dev, block, buffer) );
+}
+
+/*!
+  \brief Copia imediatamente para o disco as versoes gravadas no journal
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int journal_checkpoint (journal_t *journal) {
+  int result;
+
+  if ( !journal || !journal->log )
+    return(-1);
+
+  if ( sem_down(&(journal->lock)) )
+    return(-1);
+  result = journal_do_checkpoint(journal);
+  sem_up(&(journal->lock));
+
+  return(result);
+}
+
+/*!
+  \brief Consulta os contadores do journal
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int journal_stats (journal_t *journal, journal_stats_t *stats) {
+  if ( !journal || !journal->log || !stats )
+    return(-1);
+
+  *stats = journal->stats;
+
+  return(0);
+}
@@ -0,0 +1,131 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Journal (write-ahead log) de blocos com commit em grupo sobre uma região de
+// um disco do gerente de disco
+
+#ifndef __PPOS_JOURNAL__
+#define __PPOS_JOURNAL__
+
+#include "ppos_disk.h"
+
+// Uma transação acumula em memória as novas versões (redo) de blocos do
+// disco; journal_commit() a grava no journal e só retorna quando ela está no
+// disco. As transações de tarefas que chegam ao commit enquanto uma gravação
+// do journal está em andamento são reunidas na gravação seguinte, um único
+// acesso sequencial (commit em grupo). Os blocos das transações gravadas
+// são copiados para suas posições no disco por uma tarefa de checkpoint,
+// quando o journal passa de JOURNAL_CKPT_PCT% de ocupação; até lá, leituras
+// devem usar journal_read(). Na abertura, os registros posteriores ao último
+// checkpoint são reaplicados.
+//
+// Disposição da região do journal:
+//   [superbloco][log circular de registros]
+//   registro: bloco descritor (sequência, blocos de destino, checksum) +
+//             blocos de dados; só é aplicado se o checksum confere
+
+#define JOURNAL_CKPT_PCT 50   // ocupacao do log que dispara o checkpoint (%)
+
+// contadores do journal
+typedef struct
+{
+  unsigned int commits;      // transacoes gravadas
+  unsigned int writes;       // gravacoes do journal (grupos de transacoes)
+  unsigned int records;      // registros gravados
+  unsigned int blocks;       // blocos de dados gravados no journal
+  unsigned int absorbed;     // blocos repetidos absorvidos em um registro
+  unsigned int checkpoints;  // checkpoints realizados
+  unsigned int stalls;       // commits que aguardaram espaco no log
+  unsigned int replayed;     // registros reaplicados na abertura
+} journal_stats_t ;
+
+// versao de um bloco ainda nao copiada para sua posicao no disco
+typedef struct
+{
+  int block;       // bloco do disco (-1 = entrada livre)
+  char *data;      // conteudo do bloco
+} journal_entry_t ;
+
+struct journal_t ;
+
+// transacao
+typedef struct journal_tx_t
+{
+  struct journal_tx_t *prev, *next ;  // para usar com a biblioteca de filas
+  struct journal_t *journal;  // journal da transacao
+  int count;                  // blocos na transacao
+  int cap;                    // capacidade de blocks/data
+  int *blocks;                // blocos do disco
+  char *data;                 // novas versoes dos blocos
+  int done;                   // transacao ja gravada (ou com erro)
+  int result;                 // resultado da gravacao
+} journal_tx_t ;
+
+// estrutura que representa um journal aberto
+typedef struct journal_t
+{
+  int dev;                // disco do journal
+  int start;              // primeiro bloco da regiao (superbloco)
+  int logBlocks;          // blocos do log (regiao menos o superbloco)
+  int blockSize;          // tamanho de cada bloco, em bytes
+  int numBlocks;          // blocos do disco
+  int maxTx;              // maximo de blocos por transacao
+  unsigned int epoch;     // identificador da formatacao
+  unsigned int seq;       // sequencia do proximo registro
+  int head;               // posicao do proximo registro no log
+  int used;               // blocos do log ocupados desde o checkpoint
+  char *log;              // imagem do log em memoria (montagem dos registros)
+  journal_entry_t *cur;   // versoes gravadas depois do ultimo checkpoint
+  journal_entry_t *ckpt;  // versoes sendo copiadas pelo checkpoint
+  int mapSize;            // capacidade de cur e ckpt (potencia de 2)
+  journal_tx_t *pending;  // transacoes aguardando gravacao
+  int writing;            // gravacao do journal em andamento
+  int waiting;            // tarefas aguardando uma gravacao
+  int spaceWaiting;       // tarefas aguardando espaco no log
+  int checkpointing;      // checkpoint em andamento
+  int wake;               // tarefa de checkpoint ja foi acordada
+  int stop;               // tarefa de checkpoint deve terminar
+  semaphore_t lock;       // acesso exclusivo ao journal
+  semaphore_t done;       // fim de uma gravacao do journal
+  semaphore_t space;      // fim de um checkpoint
+  semaphore_t kick;       // tarefa de checkpoint aguarda trabalho
+  task_t task;            // tarefa de checkpoint
+  journal_stats_t stats;  // contadores
+} journal_t ;
+
+// Todas as funcoes retornam -1 em erro ou 0 em sucesso.
+
+// formata a regiao [start, start+blocks) do disco dev como journal vazio
+int journal_format (int dev, int start, int blocks) ;
+
+// abre o journal da regiao, reaplicando os registros posteriores ao ultimo
+// checkpoint, e cria a tarefa de checkpoint
+int journal_open (journal_t *journal, int dev, int start, int blocks) ;
+
+// realiza um checkpoint final e termina a tarefa de checkpoint
+int journal_close (journal_t *journal) ;
+
+// inicia uma transacao vazia
+int journal_begin (journal_t *journal, journal_tx_t *tx) ;
+
+// registra a nova versao de um bloco (fora da regiao do journal) na
+// transacao; o conteudo eh copiado
+int journal_write (journal_tx_t *tx, int block, const void *buffer) ;
+
+// grava a transacao no journal, aguardando a gravacao, e a libera
+int journal_commit (journal_tx_t *tx) ;
+
+// descarta a transacao
+int journal_abort (journal_tx_t *tx) ;
+
+// le um bloco, considerando as versoes ainda nao copiadas pelo checkpoint
+int journal_read (journal_t *journal, int block, void *buffer) ;
+
+// copia imediatamente para o disco as versoes gravadas no journal
+int journal_checkpoint (journal_t *journal) ;
+
+// consulta os contadores do journal
+int journal_stats (journal_t *journal, journal_stats_t *stats) ;
+
+#endif
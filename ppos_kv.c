@@ -0,0 +1,1264 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "ppos.h"
+#include "ppos_kv.h"
+
+// variáveis globais e constantes ==============================================
+
+#define KV_MAGIC     0x4b564d31  // manifesto ("KVM1")
+#define KV_MAGIC_WAL 0x4b565731  // escrita no WAL ("KVW1")
+
+// campos (inteiros) do manifesto, seguidos de (inicio, blocos, paginas,
+// entradas) de cada run, da mais nova para a mais antiga
+#define M_MAGIC 0
+#define M_EPOCH 1
+#define M_GEN   2
+#define M_SEQ   3
+#define M_NRUNS 4
+#define M_HDR   5
+#define M_RUN   4
+
+#define ENTRY_HDR 4   // cabecalho de uma entrada em uma pagina
+
+// escrita no WAL
+typedef struct
+{
+  int magic;
+  unsigned int epoch, gen, seq;
+  kv_entry_t entry;
+} kv_wal_t ;
+
+// entrada coletada por uma varredura ou compactacao
+typedef struct
+{
+  int rank;           // origem: 0 = mais nova
+  kv_entry_t entry;
+} kv_item_t ;
+
+// funções locais ==============================================================
+
+/*!
+  \brief Compara duas chaves (ordem lexicografica dos bytes)
+*/
+static int kv_cmp (const char *a, int alen, const char *b, int blen) {
+  int r = memcmp(a, b, ( alen < blen ) ? alen : blen);
+
+  return( r ? r : alen - blen );
+}
+
+/*!
+  \brief Compara itens por chave e, para a mesma chave, pela origem (qsort)
+*/
+static int kv_item_cmp (const void *a, const void *b) {
+  const kv_item_t *x = a, *y = b;
+  int r = kv_cmp(x->entry.key, x->entry.klen, y->entry.key, y->entry.klen);
+
+  return( r ? r : x->rank - y->rank );
+}
+
+/*!
+  \brief Compara escritas do WAL pela sequencia (qsort)
+*/
+static int kv_wal_cmp (const void *a, const void *b) {
+  const kv_wal_t *x = a, *y = b;
+
+  return( (x->seq > y->seq) - (x->seq < y->seq) );
+}
+
+/*!
+  \brief Le ou escreve count blocos contiguos do disco a partir de uma area
+  contigua de memoria
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int kv_area (kv_t *kv, int type, int block, int count, void *area) {
+  void **buffers;
+  int i, result;
+
+  buffers = malloc(count * sizeof(void *));
+  if ( !buffers )
+    return(-1);
+  for ( i = 0; i < count; i++ )
+    buffers[i] = (char *) area + i * kv->blockSize;
+
+  if ( type == READ_OPERATION )
+    result = disk_dev_block_readv(kv->dev, block, count, buffers);
+  else
+    result = disk_dev_block_writev(kv->dev, block, count, buffers);
+
+  free(buffers);
+  return(result);
+}
+
+/*!
+  \brief Calcula a disposicao do armazenamento a partir da geometria do disco
+
+  \return -1 se o disco nao comporta a disposicao, 0 em sucesso
+*/
+static int kv_layout (kv_t *kv, int dev) {
+  if ( disk_dev_geometry(dev, &(kv->numBlocks), &(kv->blockSize)) || kv->blockSize < 64 )
+    return(-1);
+
+  kv->dev = dev;
+  kv->pageBlocks = (KV_PAGE + kv->blockSize - 1) / kv->blockSize;
+  kv->pageSize = kv->pageBlocks * kv->blockSize;
+  kv->manBlocks = ((M_HDR + M_RUN * (KV_RUNS_MAX + 1)) * sizeof(int) + kv->blockSize - 1)
+                  / kv->blockSize;
+  kv->journalStart = kv->manBlocks;
+  kv->walStart = kv->journalStart + KV_JOURNAL;
+  kv->walBlocks = (sizeof(kv_wal_t) + kv->blockSize - 1) / kv->blockSize;
+  kv->dataStart = kv->walStart + 2 * KV_WAL_SLOTS * kv->walBlocks;
+
+  return( kv->dataStart + 16 * kv->pageBlocks <= kv->numBlocks ? 0 : -1 );
+}
+
+/*!
+  \brief Primeiro bloco da posicao slot do WAL da geracao gen
+*/
+static int kv_wal_block (kv_t *kv, unsigned int gen, int slot) {
+  return( kv->walStart + ((gen % 2) * KV_WAL_SLOTS + slot) * kv->walBlocks );
+}
+
+/*!
+  \brief Busca binaria de uma chave em uma tabela ordenada
+
+  \param found Recebe 1 se a chave esta na tabela
+
+  \return Posicao da chave, ou em que ela seria inserida
+*/
+static int kv_search (kv_entry_t *tab, int n, const char *key, int klen, int *found) {
+  int lo = 0, hi = n, mid, r;
+
+  *found = 0;
+  while ( lo < hi ) {
+    mid = (lo + hi) / 2;
+    r = kv_cmp(tab[mid].key, tab[mid].klen, key, klen);
+    if ( !r ) {
+      *found = 1;
+      return(mid);
+    }
+    if ( r < 0 )
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return(lo);
+}
+
+/*!
+  \brief Insere ou substitui uma entrada em uma tabela ordenada
+*/
+static void kv_insert (kv_entry_t *tab, int *n, kv_entry_t *entry) {
+  int found, i = kv_search(tab, *n, entry->key, entry->klen, &found);
+
+  if ( !found ) {
+    memmove(&tab[i + 1], &tab[i], (*n - i) * sizeof(kv_entry_t));
+    (*n)++;
+  }
+  tab[i] = *entry;
+}
+
+/*!
+  \brief Hash (FNV-1a) de uma chave
+*/
+static unsigned int kv_hash (const char *key, int klen) {
+  unsigned int h = 2166136261u;
+  int i;
+
+  for ( i = 0; i < klen; i++ )
+    h = (h ^ (unsigned char) key[i]) * 16777619u;
+  return(h);
+}
+
+/*!
+  \brief Insere (add = 1) ou testa uma chave no filtro de Bloom da run
+
+  \return 1 se a chave pode estar na run, 0 se certamente nao esta
+*/
+static int kv_bloom (kv_run_t *run, const char *key, int klen, int add) {
+  unsigned int h1 = kv_hash(key, klen), h2 = (h1 >> 17) | (h1 << 15), bit;
+  int i;
+
+  for ( i = 0; i < KV_BLOOM_K; i++ ) {
+    bit = (h1 + i * h2) % run->bloomBits;
+    if ( add )
+      run->bloom[bit / 8] |= 1 << (bit % 8);
+    else if ( !(run->bloom[bit / 8] & (1 << (bit % 8))) )
+      return(0);
+  }
+  return(1);
+}
+
+/*!
+  \brief Decodifica a entrada na posicao *off de uma pagina, avancando *off
+
+  \return 1 se uma entrada foi decodificada, 0 no fim da pagina
+*/
+static int kv_decode (kv_t *kv, char *page, int *off, kv_entry_t *entry) {
+  unsigned short vlen;
+
+  if ( *off + ENTRY_HDR > kv->pageSize || !page[*off] )
+    return(0);
+  entry->klen = page[*off];
+  entry->deleted = page[*off + 1];
+  memcpy(&vlen, page + *off + 2, sizeof(vlen));
+  entry->vlen = vlen;
+  memcpy(entry->key, page + *off + ENTRY_HDR, entry->klen);
+  memcpy(entry->val, page + *off + ENTRY_HDR + entry->klen, entry->vlen);
+  *off += ENTRY_HDR + entry->klen + entry->vlen;
+  return(1);
+}
+
+/*!
+  \brief Codifica entradas ordenadas em paginas; uma entrada nunca fica
+  dividida entre paginas
+
+  \param area Recebe as paginas (alocadas aqui)
+
+  \return Quantidade de paginas, ou -1 em erro
+*/
+static int kv_pack (kv_t *kv, kv_entry_t *tab, int n, char **area) {
+  int i, pages = 1, off = 0, size, page = 0;
+  unsigned short vlen;
+  char *p;
+
+  for ( i = 0; i < n; i++ ) {
+    size = ENTRY_HDR + tab[i].klen + tab[i].vlen;
+    if ( off + size > kv->pageSize ) {
+      pages++;
+      off = 0;
+    }
+    off += size;
+  }
+
+  *area = calloc(pages, kv->pageSize);
+  if ( !*area )
+    return(-1);
+
+  for ( i = 0, off = 0; i < n; i++ ) {
+    size = ENTRY_HDR + tab[i].klen + tab[i].vlen;
+    if ( off + size > kv->pageSize ) {
+      page++;
+      off = 0;
+    }
+    p = *area + page * kv->pageSize + off;
+    p[0] = tab[i].klen;
+    p[1] = tab[i].deleted;
+    vlen = tab[i].vlen;
+    memcpy(p + 2, &vlen, sizeof(vlen));
+    memcpy(p + ENTRY_HDR, tab[i].key, tab[i].klen);
+    memcpy(p + ENTRY_HDR + tab[i].klen, tab[i].val, tab[i].vlen);
+    off += size;
+  }
+
+  return(pages);
+}
+
+/*!
+  \brief Libera uma run em memoria
+*/
+static void kv_run_free (kv_run_t *run) {
+  if ( run ) {
+    free(run->index);
+    free(run->bloom);
+    free(run);
+  }
+}
+
+/*!
+  \brief Cria a run em memoria (indice esparso e filtro de Bloom) a partir
+  de suas paginas
+
+  \return Run criada, ou NULL em erro
+*/
+static kv_run_t *kv_run_new (kv_t *kv, int start, int pages, int entries, char *area) {
+  kv_entry_t entry;
+  kv_run_t *run;
+  int p, off, first;
+
+  run = calloc(1, sizeof(kv_run_t));
+  if ( !run )
+    return(NULL);
+  run->id = kv->nextRun++;
+  run->start = start;
+  run->pages = pages;
+  run->blocks = pages * kv->pageBlocks;
+  run->entries = entries;
+  run->bloomBits = ( entries * KV_BLOOM_BITS > 64 ) ? entries * KV_BLOOM_BITS : 64;
+  run->bloomBits = (run->bloomBits + 7) / 8 * 8;
+  run->index = calloc(pages, KV_KEY_MAX + 1);
+  run->bloom = calloc(run->bloomBits / 8, 1);
+  if ( !run->index || !run->bloom ) {
+    kv_run_free(run);
+    return(NULL);
+  }
+
+  for ( p = 0; p < pages; p++ )
+    for ( off = 0, first = 1; kv_decode(kv, area + p * kv->pageSize, &off, &entry); first = 0 ) {
+      if ( first ) {
+        run->index[p * (KV_KEY_MAX + 1)] = entry.klen;
+        memcpy(run->index + p * (KV_KEY_MAX + 1) + 1, entry.key, entry.klen);
+      }
+      kv_bloom(run, entry.key, entry.klen, 1);
+    }
+
+  return(run);
+}
+
+/*!
+  \brief Pagina da run em que a chave estaria (ultima pagina cuja primeira
+  chave nao eh maior que ela)
+
+  \return Pagina, ou -1 se a chave eh menor que todas as chaves da run
+*/
+static int kv_run_page (kv_run_t *run, const char *key, int klen) {
+  int lo = 0, hi = run->pages - 1, mid;
+  char *first;
+
+  while ( lo <= hi ) {
+    mid = (lo + hi) / 2;
+    first = run->index + mid * (KV_KEY_MAX + 1);
+    if ( kv_cmp(first + 1, (unsigned char) first[0], key, klen) <= 0 )
+      lo = mid + 1;
+    else
+      hi = mid - 1;
+  }
+  return(hi);
+}
+
+/*!
+  \brief Blocos livres para uma nova run: o primeiro intervalo entre as runs
+  em uso (inclusive as substituidas) com pelo menos blocks blocos. Chamada
+  com o armazenamento travado.
+
+  \return Primeiro bloco, ou -1 se nao ha espaco
+*/
+static int kv_alloc (kv_t *kv, int blocks) {
+  kv_run_t *used[2 * (KV_RUNS_MAX + 1)], *tmp;
+  int n = 0, i, j, start = kv->dataStart;
+
+  for ( i = 0; i < kv->nruns; i++ )
+    used[n++] = kv->runs[i];
+  for ( i = 0; i < kv->ndead; i++ )
+    used[n++] = kv->dead[i];
+
+  // ordena as runs por posicao
+  for ( i = 1; i < n; i++ )
+    for ( j = i; j > 0 && used[j]->start < used[j - 1]->start; j-- ) {
+      tmp = used[j];
+      used[j] = used[j - 1];
+      used[j - 1] = tmp;
+    }
+
+  for ( i = 0; i < n; i++ ) {
+    if ( used[i]->start - start >= blocks )
+      return(start);
+    if ( used[i]->start + used[i]->blocks > start )
+      start = used[i]->start + used[i]->blocks;
+  }
+  return( (kv->numBlocks - start >= blocks) ? start : -1 );
+}
+
+/*!
+  \brief Grava entradas ordenadas como uma nova run, em um unico acesso
+  sequencial. Chamada com o armazenamento livre, pela tarefa que grava a
+  memtable (a unica que cria runs).
+
+  \return Run criada, ou NULL em erro
+*/
+static kv_run_t *kv_write_run (kv_t *kv, kv_entry_t *tab, int n) {
+  kv_run_t *run = NULL;
+  char *area;
+  int pages, start;
+
+  pages = kv_pack(kv, tab, n, &area);
+  if ( pages < 0 )
+    return(NULL);
+
+  sem_down(&(kv->lock));
+  start = kv_alloc(kv, pages * kv->pageBlocks);
+  sem_up(&(kv->lock));
+
+  if ( start < 0 )
+    fprintf(stderr, "[PPOS error] kv_write_run: no space on disk %d\n", kv->dev);
+  else if ( !kv_area(kv, WRITE_OPERATION, start, pages * kv->pageBlocks, area) )
+    run = kv_run_new(kv, start, pages, n, area);
+
+  free(area);
+  return(run);
+}
+
+/*!
+  \brief Procura uma pagina de run na cache, atualizando seu uso. Chamada
+  com o armazenamento travado.
+*/
+static kv_page_t *kv_cache_find (kv_t *kv, int run, int page) {
+  int i;
+
+  for ( i = 0; i < KV_CACHE; i++ )
+    if ( kv->cache[i].run == run && kv->cache[i].page == page ) {
+      kv->cache[i].used = ++kv->clock;
+      return( &kv->cache[i] );
+    }
+  return(NULL);
+}
+
+/*!
+  \brief Insere uma pagina de run na cache, no lugar da menos usada.
+  Chamada com o armazenamento travado.
+*/
+static void kv_cache_put (kv_t *kv, int run, int page, char *data) {
+  kv_page_t *victim = &kv->cache[0];
+  int i;
+
+  for ( i = 1; i < KV_CACHE && victim->run; i++ )
+    if ( !kv->cache[i].run || kv->cache[i].used < victim->used )
+      victim = &kv->cache[i];
+
+  if ( !victim->data ) {
+    victim->data = malloc(kv->pageSize);
+    if ( !victim->data )
+      return;
+  }
+  memcpy(victim->data, data, kv->pageSize);
+  victim->run = run;
+  victim->page = page;
+  victim->used = ++kv->clock;
+}
+
+/*!
+  \brief Descarta da cache as paginas de uma run. Chamada com o
+  armazenamento travado.
+*/
+static void kv_cache_drop (kv_t *kv, int run) {
+  int i;
+
+  for ( i = 0; i < KV_CACHE; i++ )
+    if ( kv->cache[i].run == run )
+      kv->cache[i].run = 0;
+}
+
+/*!
+  \brief Copia uma pagina de run para o buffer, da cache ou do disco (um
+  unico acesso dos blocos da pagina)
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int kv_page (kv_t *kv, kv_run_t *run, int page, char *buffer) {
+  kv_page_t *cached;
+
+  sem_down(&(kv->lock));
+  cached = kv_cache_find(kv, run->id, page);
+  if ( cached ) {
+    memcpy(buffer, cached->data, kv->pageSize);
+    kv->stats.cachehits++;
+    sem_up(&(kv->lock));
+    return(0);
+  }
+  sem_up(&(kv->lock));
+
+  if ( kv_area(kv, READ_OPERATION, run->start + page * kv->pageBlocks, kv->pageBlocks, buffer) )
+    return(-1);
+
+  sem_down(&(kv->lock));
+  kv_cache_put(kv, run->id, page, buffer);
+  kv->stats.pagereads++;
+  sem_up(&(kv->lock));
+
+  return(0);
+}
+
+/*!
+  \brief Fixa as runs em uso para uma busca, que pode entao le-las sem o
+  armazenamento travado. Chamada com o armazenamento travado.
+
+  \return Quantidade de runs copiadas para snap
+*/
+static int kv_pin (kv_t *kv, kv_run_t **snap) {
+  int i;
+
+  for ( i = 0; i < kv->nruns; i++ ) {
+    snap[i] = kv->runs[i];
+    snap[i]->refs++;
+  }
+  return(kv->nruns);
+}
+
+/*!
+  \brief Libera as runs fixadas por kv_pin(); runs substituidas sem buscas
+  em andamento sao liberadas. Chamada com o armazenamento travado.
+*/
+static void kv_unpin (kv_t *kv, kv_run_t **snap, int n) {
+  int i;
+
+  for ( i = 0; i < n; i++ )
+    snap[i]->refs--;
+  for ( i = 0; i < kv->ndead; )
+    if ( !kv->dead[i]->refs ) {
+      kv_run_free(kv->dead[i]);
+      kv->dead[i] = kv->dead[--kv->ndead];
+    }
+    else
+      i++;
+}
+
+/*!
+  \brief Procura uma chave em uma run: no maximo uma pagina eh lida
+
+  \return 1 se encontrada (em entry), 0 se ausente ou -1 em erro
+*/
+static int kv_run_find (kv_t *kv, kv_run_t *run, const char *key, int klen,
+                        kv_entry_t *entry, char *buffer) {
+  int page = kv_run_page(run, key, klen), off = 0, r;
+
+  if ( page < 0 )
+    return(0);
+  if ( kv_page(kv, run, page, buffer) )
+    return(-1);
+  while ( kv_decode(kv, buffer, &off, entry) ) {
+    r = kv_cmp(entry->key, entry->klen, key, klen);
+    if ( !r )
+      return(1);
+    if ( r > 0 )
+      break;
+  }
+  return(0);
+}
+
+/*!
+  \brief Grava o manifesto (geracao do WAL e runs em uso) como uma transacao
+  do journal. Chamada com o armazenamento travado, que eh liberado durante a
+  gravacao.
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int kv_save_manifest (kv_t *kv) {
+  journal_tx_t tx;
+  int *man, i, result;
+
+  man = calloc(kv->manBlocks, kv->blockSize);
+  if ( !man )
+    return(-1);
+  man[M_MAGIC] = KV_MAGIC;
+  man[M_EPOCH] = kv->epoch;
+  man[M_GEN] = kv->gen;
+  man[M_SEQ] = kv->seq;
+  man[M_NRUNS] = kv->nruns;
+  for ( i = 0; i < kv->nruns; i++ ) {
+    man[M_HDR + i * M_RUN] = kv->runs[i]->start;
+    man[M_HDR + i * M_RUN + 1] = kv->runs[i]->blocks;
+    man[M_HDR + i * M_RUN + 2] = kv->runs[i]->pages;
+    man[M_HDR + i * M_RUN + 3] = kv->runs[i]->entries;
+  }
+
+  result = journal_begin(&(kv->journal), &tx);
+  for ( i = 0; !result && i < kv->manBlocks; i++ )
+    result = journal_write(&tx, i, (char *) man + i * kv->blockSize);
+  free(man);
+  if ( result ) {
+    journal_abort(&tx);
+    return(-1);
+  }
+
+  sem_up(&(kv->lock));
+  result = journal_commit(&tx);
+  sem_down(&(kv->lock));
+
+  return(result);
+}
+
+/*!
+  \brief Intercala todas as runs em uma so, mantendo apenas a versao mais
+  nova de cada chave e descartando remocoes. Chamada com o armazenamento
+  travado pela tarefa que grava a memtable, que o libera durante as
+  leituras e gravacoes.
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int kv_compact (kv_t *kv) {
+  kv_run_t *old[KV_RUNS_MAX + 1], *run;
+  kv_item_t *items;
+  kv_entry_t *tab;
+  char *area;
+  int n, r, p, off, count = 0, total = 0, i, unique = 0;
+
+  // as runs substituidas pela compactacao anterior devem estar livres
+  while ( kv->ndead ) {
+    sem_up(&(kv->lock));
+    task_sleep(1);
+    sem_down(&(kv->lock));
+  }
+
+  n = kv->nruns;
+  for ( r = 0; r < n; r++ ) {
+    old[r] = kv->runs[r];
+    total += old[r]->entries;
+  }
+  sem_up(&(kv->lock));
+
+  items = malloc(total * sizeof(kv_item_t));
+  tab = malloc(total * sizeof(kv_entry_t));
+  if ( !items || !tab ) {
+    free(items);
+    free(tab);
+    sem_down(&(kv->lock));
+    return(-1);
+  }
+
+  // le cada run inteira em um acesso sequencial
+  for ( r = 0; r < n; r++ ) {
+    area = malloc(old[r]->blocks * kv->blockSize);
+    if ( !area || kv_area(kv, READ_OPERATION, old[r]->start, old[r]->blocks, area) ) {
+      free(area);
+      free(items);
+      free(tab);
+      sem_down(&(kv->lock));
+      return(-1);
+    }
+    for ( p = 0; p < old[r]->pages; p++ )
+      for ( off = 0; count < total &&
+                     kv_decode(kv, area + p * kv->pageSize, &off, &items[count].entry); count++ )
+        items[count].rank = r;
+    free(area);
+  }
+
+  // versao mais nova de cada chave, sem remocoes
+  qsort(items, count, sizeof(kv_item_t), kv_item_cmp);
+  for ( i = 0; i < count; i++ )
+    if ( (!i || kv_cmp(items[i].entry.key, items[i].entry.klen,
+                       items[i - 1].entry.key, items[i - 1].entry.klen)) &&
+         !items[i].entry.deleted )
+      tab[unique++] = items[i].entry;
+  free(items);
+
+  run = kv_write_run(kv, tab, unique);
+  free(tab);
+
+  sem_down(&(kv->lock));
+  if ( !run )
+    return(-1);
+
+  // as runs antigas sao liberadas quando nao houver buscas nelas
+  for ( r = 0; r < n; r++ ) {
+    kv_cache_drop(kv, old[r]->id);
+    if ( old[r]->refs )
+      kv->dead[kv->ndead++] = old[r];
+    else
+      kv_run_free(old[r]);
+  }
+  kv->runs[0] = run;
+  kv->nruns = 1;
+  kv->stats.compactions++;
+
+  return(0);
+}
+
+/*!
+  \brief Grava a memtable como uma nova run e a apaga; as escritas
+  seguintes vao para a outra metade do WAL, em uma nova geracao. Chamada com
+  o armazenamento travado, que eh liberado durante as gravacoes.
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int kv_flush (kv_t *kv) {
+  kv_entry_t *tab;
+  kv_run_t *run;
+  int i, found, result = 0;
+
+  kv->flushing = 1;
+
+  // as escritas em andamento no WAL devem terminar antes da troca de metade
+  while ( kv->inflight ) {
+    kv->idleWaiting++;
+    sem_up(&(kv->lock));
+    sem_down(&(kv->idle));
+    sem_down(&(kv->lock));
+  }
+
+  if ( kv->nmem ) {
+    // a memtable passa a imutavel (ainda consultada pelas buscas)
+    tab = kv->imm;
+    kv->imm = kv->mem;
+    kv->nimm = kv->nmem;
+    kv->mem = tab;
+    kv->nmem = 0;
+    kv->walNext = 0;
+    kv->gen++;
+    sem_up(&(kv->lock));
+
+    run = kv_write_run(kv, kv->imm, kv->nimm);
+
+    sem_down(&(kv->lock));
+    if ( run ) {
+      memmove(&kv->runs[1], &kv->runs[0], kv->nruns * sizeof(kv_run_t *));
+      kv->runs[0] = run;
+      kv->nruns++;
+      kv->stats.flushes++;
+    }
+    else {
+      // as entradas voltam a memtable, sem sobrepor escritas mais novas
+      for ( i = 0; i < kv->nimm; i++ )
+        if ( kv->nmem < 2 * KV_WAL_SLOTS ) {
+          kv_search(kv->mem, kv->nmem, kv->imm[i].key, kv->imm[i].klen, &found);
+          if ( !found )
+            kv_insert(kv->mem, &kv->nmem, &kv->imm[i]);
+        }
+      result = -1;
+    }
+    kv->nimm = 0;
+
+    if ( !result && kv->nruns > KV_RUNS_MAX )
+      result = kv_compact(kv);
+    if ( !result )
+      result = kv_save_manifest(kv);
+  }
+
+  // acorda as tarefas que aguardavam a gravacao
+  kv->flushing = 0;
+  while ( kv->flushWaiting ) {
+    kv->flushWaiting--;
+    sem_up(&(kv->flushed));
+  }
+
+  return(result);
+}
+
+/*!
+  \brief Escrita de um par ou de uma remocao: insere na memtable e grava no
+  WAL, aguardando a gravacao (em grupo com as escritas concorrentes)
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int kv_write (kv_t *kv, const void *key, int klen, const void *val, int vlen,
+                     int deleted) {
+  journal_tx_t tx;
+  kv_wal_t *rec;
+  int i, block, result;
+
+  if ( !kv || !kv->mem || !key || klen < 1 || klen > KV_KEY_MAX ||
+       vlen < 0 || vlen > KV_VAL_MAX || (vlen && !val) )
+    return(-1);
+
+  rec = calloc(kv->walBlocks, kv->blockSize);
+  if ( !rec )
+    return(-1);
+
+  if ( sem_down(&(kv->lock)) ) {
+    free(rec);
+    return(-1);
+  }
+
+  // WAL cheio: grava a memtable ou aguarda a gravacao em andamento
+  while ( kv->walNext == KV_WAL_SLOTS ) {
+    if ( !kv->flushing ) {
+      kv_flush(kv);
+      continue;
+    }
+    kv->flushWaiting++;
+    sem_up(&(kv->lock));
+    sem_down(&(kv->flushed));
+    sem_down(&(kv->lock));
+  }
+
+  rec->magic = KV_MAGIC_WAL;
+  rec->epoch = kv->epoch;
+  rec->gen = kv->gen;
+  rec->seq = kv->seq++;
+  rec->entry.klen = klen;
+  rec->entry.deleted = deleted;
+  rec->entry.vlen = vlen;
+  memcpy(rec->entry.key, key, klen);
+  if ( vlen )
+    memcpy(rec->entry.val, val, vlen);
+  kv_insert(kv->mem, &kv->nmem, &rec->entry);
+
+  block = kv_wal_block(kv, kv->gen, kv->walNext++);
+  result = journal_begin(&(kv->journal), &tx);
+  for ( i = 0; !result && i < kv->walBlocks; i++ )
+    result = journal_write(&tx, block + i, (char *) rec + i * kv->blockSize);
+  kv->inflight++;
+  kv->stats.puts++;
+  sem_up(&(kv->lock));
+
+  free(rec);
+  if ( result )
+    journal_abort(&tx);
+  else
+    result = journal_commit(&tx);
+
+  // a ultima escrita em andamento libera a troca de metade do WAL
+  sem_down(&(kv->lock));
+  kv->inflight--;
+  if ( !kv->inflight )
+    while ( kv->idleWaiting ) {
+      kv->idleWaiting--;
+      sem_up(&(kv->idle));
+    }
+  sem_up(&(kv->lock));
+
+  return(result);
+}
+
+/*!
+  \brief Reaplica a memtable as escritas do WAL da geracao gen
+
+  \return Escritas reaplicadas, ou -1 em erro
+*/
+static int kv_replay (kv_t *kv, unsigned int gen) {
+  kv_wal_t *recs;
+  char *area;
+  int slot, n = 0;
+
+  area = malloc(KV_WAL_SLOTS * kv->walBlocks * kv->blockSize);
+  recs = malloc(KV_WAL_SLOTS * sizeof(kv_wal_t));
+  if ( !area || !recs ||
+       kv_area(kv, READ_OPERATION, kv_wal_block(kv, gen, 0), KV_WAL_SLOTS * kv->walBlocks, area) ) {
+    free(area);
+    free(recs);
+    return(-1);
+  }
+
+  for ( slot = 0; slot < KV_WAL_SLOTS; slot++ ) {
+    memcpy(&recs[n], area + slot * kv->walBlocks * kv->blockSize, sizeof(kv_wal_t));
+    if ( recs[n].magic == KV_MAGIC_WAL && recs[n].epoch == kv->epoch && recs[n].gen == gen &&
+         recs[n].entry.klen >= 1 && recs[n].entry.klen <= KV_KEY_MAX &&
+         recs[n].entry.vlen <= KV_VAL_MAX )
+      n++;
+  }
+
+  // aplica em ordem de escrita
+  qsort(recs, n, sizeof(kv_wal_t), kv_wal_cmp);
+  for ( slot = 0; slot < n; slot++ ) {
+    kv_insert(kv->mem, &kv->nmem, &recs[slot].entry);
+    if ( recs[slot].seq >= kv->seq )
+      kv->seq = recs[slot].seq + 1;
+  }
+
+  free(area);
+  free(recs);
+  return(n);
+}
+
+/*!
+  \brief Libera as estruturas em memoria do armazenamento
+*/
+static void kv_release (kv_t *kv) {
+  int i;
+
+  for ( i = 0; i < kv->nruns; i++ )
+    kv_run_free(kv->runs[i]);
+  for ( i = 0; i < kv->ndead; i++ )
+    kv_run_free(kv->dead[i]);
+  for ( i = 0; i < KV_CACHE; i++ )
+    free(kv->cache[i].data);
+  free(kv->mem);
+  free(kv->imm);
+  memset(kv, 0, sizeof(kv_t));
+}
+
+// funções gerais ==============================================================
+
+/*!
+  \brief Formata um disco como armazenamento chave-valor vazio
+
+  \param dev Disco, ja inicializado com disk_dev_mgr_init()
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int kv_format (int dev) {
+  kv_t kv;
+  int *man, result;
+  unsigned int epoch = time(NULL);
+
+  memset(&kv, 0, sizeof(kv_t));
+  if ( kv_layout(&kv, dev) ) {
+    fprintf(stderr, "[PPOS error] kv_format: disk %d too small\n", dev);
+    return(-1);
+  }
+
+  man = calloc(kv.manBlocks, kv.blockSize);
+  if ( !man )
+    return(-1);
+
+  // a nova formatacao nao pode reconhecer escritas de formatacoes anteriores
+  if ( !kv_area(&kv, READ_OPERATION, 0, kv.manBlocks, man) && man[M_MAGIC] == KV_MAGIC &&
+       (unsigned int) man[M_EPOCH] >= epoch )
+    epoch = man[M_EPOCH] + 1;
+
+  memset(man, 0, kv.manBlocks * kv.blockSize);
+  man[M_MAGIC] = KV_MAGIC;
+  man[M_EPOCH] = epoch;
+  man[M_GEN] = 0;
+  man[M_SEQ] = 1;
+  man[M_NRUNS] = 0;
+  result = kv_area(&kv, WRITE_OPERATION, 0, kv.manBlocks, man) ||
+           journal_format(dev, kv.journalStart, KV_JOURNAL);
+
+  free(man);
+  return( result ? -1 : 0 );
+}
+
+/*!
+  \brief Abre o armazenamento de um disco: abre o journal, le o manifesto e
+  as runs (indices e filtros) e reaplica as escritas do WAL
+
+  \param kv Estrutura do armazenamento a preencher
+  \param dev Disco, ja inicializado e formatado com kv_format()
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int kv_open (kv_t *kv, int dev) {
+  int *man, r, n, replayed, start, blocks;
+  char *area;
+
+  if ( !kv )
+    return(-1);
+  memset(kv, 0, sizeof(kv_t));
+  if ( kv_layout(kv, dev) )
+    return(-1);
+  kv->nextRun = 1;
+
+  // memtable com espaco para as duas metades do WAL (reaplicacao)
+  kv->mem = malloc(2 * KV_WAL_SLOTS * sizeof(kv_entry_t));
+  kv->imm = malloc(2 * KV_WAL_SLOTS * sizeof(kv_entry_t));
+  man = malloc(kv->manBlocks * kv->blockSize);
+  if ( !kv->mem || !kv->imm || !man ||
+       journal_open(&(kv->journal), dev, kv->journalStart, KV_JOURNAL) ) {
+    free(man);
+    kv_release(kv);
+    return(-1);
+  }
+
+  if ( kv_area(kv, READ_OPERATION, 0, kv->manBlocks, man) || man[M_MAGIC] != KV_MAGIC ||
+       man[M_NRUNS] < 0 || man[M_NRUNS] > KV_RUNS_MAX + 1 ) {
+    fprintf(stderr, "[PPOS error] kv_open: disk %d is not formatted\n", dev);
+    free(man);
+    journal_close(&(kv->journal));
+    kv_release(kv);
+    return(-1);
+  }
+  kv->epoch = man[M_EPOCH];
+  kv->gen = man[M_GEN];
+  kv->seq = man[M_SEQ];
+
+  // reconstroi os indices e filtros das runs, lendo cada uma inteira
+  n = man[M_NRUNS];
+  for ( r = 0; r < n; r++ ) {
+    start = man[M_HDR + r * M_RUN];
+    blocks = man[M_HDR + r * M_RUN + 1];
+    area = malloc(blocks * kv->blockSize);
+    if ( !area || kv_area(kv, READ_OPERATION, start, blocks, area) ||
+         !(kv->runs[r] = kv_run_new(kv, start, man[M_HDR + r * M_RUN + 2],
+                                    man[M_HDR + r * M_RUN + 3], area)) ) {
+      free(area);
+      free(man);
+      journal_close(&(kv->journal));
+      kv_release(kv);
+      return(-1);
+    }
+    kv->nruns++;
+    free(area);
+  }
+  free(man);
+
+  if ( sem_create(&(kv->lock), 1) || sem_create(&(kv->idle), 0) ||
+       sem_create(&(kv->flushed), 0) ) {
+    journal_close(&(kv->journal));
+    kv_release(kv);
+    return(-1);
+  }
+
+  // escritas da geracao corrente e da seguinte (gravadas durante a ultima
+  // gravacao de memtable, antes do manifesto)
+  replayed = kv_replay(kv, kv->gen);
+  n = ( replayed >= 0 ) ? kv_replay(kv, kv->gen + 1) : -1;
+  if ( replayed < 0 || n < 0 ) {
+    kv_close(kv);
+    return(-1);
+  }
+  replayed += n;
+  kv->stats.replayed = replayed;
+
+  // as escritas reaplicadas vao para uma run; as novas escritas usam uma
+  // geracao posterior as reaplicadas
+  if ( replayed ) {
+    kv->gen++;
+    sem_down(&(kv->lock));
+    r = kv_flush(kv);
+    sem_up(&(kv->lock));
+    if ( r ) {
+      kv_close(kv);
+      return(-1);
+    }
+  }
+
+  return(0);
+}
+
+/*!
+  \brief Fecha o armazenamento: grava a memtable e fecha o journal
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int kv_close (kv_t *kv) {
+  int result;
+
+  if ( !kv || !kv->mem )
+    return(-1);
+
+  result = kv_sync(kv);
+  if ( journal_close(&(kv->journal)) )
+    result = -1;
+  sem_destroy(&(kv->lock));
+  sem_destroy(&(kv->idle));
+  sem_destroy(&(kv->flushed));
+  kv_release(kv);
+
+  return(result);
+}
+
+/*!
+  \brief Insere ou substitui um par; retorna quando a escrita esta no WAL
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int kv_put (kv_t *kv, const void *key, int klen, const void *val, int vlen) {
+  return( kv_write(kv, key, klen, val, vlen, 0) );
+}
+
+/*!
+  \brief Remove uma chave; retorna quando a remocao esta no WAL
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int kv_delete (kv_t *kv, const void *key, int klen) {
+  return( kv_write(kv, key, klen, NULL, 0, 1) );
+}
+
+/*!
+  \brief Busca uma chave: memtable, memtable em gravacao e runs, da mais
+  nova para a mais antiga (as runs descartadas pelo filtro de Bloom nao sao
+  lidas)
+
+  \return Tamanho do valor copiado para val, KV_NOTFOUND se a chave esta
+  ausente ou -1 em erro
+*/
+int kv_get (kv_t *kv, const void *key, int klen, void *val) {
+  kv_run_t *snap[KV_RUNS_MAX + 1];
+  kv_entry_t entry;
+  char *buffer;
+  int found, i, n, r, result = KV_NOTFOUND, skips = 0;
+
+  if ( !kv || !kv->mem || !key || klen < 1 || klen > KV_KEY_MAX || !val )
+    return(-1);
+
+  buffer = malloc(kv->pageSize);
+  if ( !buffer || sem_down(&(kv->lock)) ) {
+    free(buffer);
+    return(-1);
+  }
+  kv->stats.gets++;
+
+  // memtables
+  i = kv_search(kv->mem, kv->nmem, key, klen, &found);
+  if ( found )
+    entry = kv->mem[i];
+  else {
+    i = kv_search(kv->imm, kv->nimm, key, klen, &found);
+    if ( found )
+      entry = kv->imm[i];
+  }
+  if ( found ) {
+    kv->stats.memhits++;
+    sem_up(&(kv->lock));
+    free(buffer);
+    if ( entry.deleted )
+      return(KV_NOTFOUND);
+    memcpy(val, entry.val, entry.vlen);
+    return(entry.vlen);
+  }
+
+  // runs, sem o armazenamento travado
+  n = kv_pin(kv, snap);
+  sem_up(&(kv->lock));
+
+  for ( r = 0; r < n; r++ ) {
+    if ( !kv_bloom(snap[r], key, klen, 0) ) {
+      skips++;
+      continue;
+    }
+    found = kv_run_find(kv, snap[r], key, klen, &entry, buffer);
+    if ( found < 0 ) {
+      result = -1;
+      break;
+    }
+    if ( found ) {
+      if ( !entry.deleted ) {
+        memcpy(val, entry.val, entry.vlen);
+        result = entry.vlen;
+      }
+      break;
+    }
+  }
+
+  sem_down(&(kv->lock));
+  kv_unpin(kv, snap, n);
+  kv->stats.bloomskips += skips;
+  sem_up(&(kv->lock));
+
+  free(buffer);
+  return(result);
+}
+
+/*!
+  \brief Visita os pares com chave em [lo, hi], em ordem de chave
+
+  As entradas da faixa sao coletadas das memtables e de cada run (lendo as
+  paginas em sequencia a partir da pagina de lo) e intercaladas, valendo a
+  versao mais nova de cada chave.
+
+  \return Pares visitados, ou -1 em erro
+*/
+int kv_scan (kv_t *kv, const void *lo, int lolen, const void *hi, int hilen,
+             kv_scan_fn fn, void *arg) {
+  kv_run_t *snap[KV_RUNS_MAX + 1];
+  kv_item_t *items, *more;
+  kv_entry_t entry, *tab[2];
+  char *buffer;
+  int cap = 64, count = 0, n, r, p, off, i, ntab[2], t, visited = 0, stop = 0, result = 0;
+
+  if ( !kv || !kv->mem || !lo || !hi || lolen < 1 || lolen > KV_KEY_MAX ||
+       hilen < 1 || hilen > KV_KEY_MAX || !fn )
+    return(-1);
+
+  items = malloc(cap * sizeof(kv_item_t));
+  buffer = malloc(kv->pageSize);
+  if ( !items || !buffer || sem_down(&(kv->lock)) ) {
+    free(items);
+    free(buffer);
+    return(-1);
+  }
+  kv->stats.scans++;
+
+  // entradas das memtables (origens 0 e 1)
+  tab[0] = kv->mem;
+  ntab[0] = kv->nmem;
+  tab[1] = kv->imm;
+  ntab[1] = kv->nimm;
+  for ( t = 0; t < 2; t++ )
+    for ( i = kv_search(tab[t], ntab[t], lo, lolen, &n); i < ntab[t] &&
+          kv_cmp(tab[t][i].key, tab[t][i].klen, hi, hilen) <= 0; i++ ) {
+      if ( count == cap ) {
+        more = realloc(items, 2 * cap * sizeof(kv_item_t));
+        if ( !more ) {
+          result = -1;
+          break;
+        }
+        items = more;
+        cap *= 2;
+      }
+      items[count].rank = t;
+      items[count++].entry = tab[t][i];
+    }
+  n = kv_pin(kv, snap);
+  sem_up(&(kv->lock));
+
+  // entradas das runs (origens 2...), paginas em sequencia
+  for ( r = 0; !result && r < n; r++ ) {
+    p = kv_run_page(snap[r], lo, lolen);
+    for ( p = ( p < 0 ) ? 0 : p, stop = 0; !stop && !result && p < snap[r]->pages; p++ ) {
+      if ( kv_page(kv, snap[r], p, buffer) ) {
+        result = -1;
+        break;
+      }
+      for ( off = 0; kv_decode(kv, buffer, &off, &entry); ) {
+        if ( kv_cmp(entry.key, entry.klen, hi, hilen) > 0 ) {
+          stop = 1;
+          break;
+        }
+        if ( kv_cmp(entry.key, entry.klen, lo, lolen) < 0 )
+          continue;
+        if ( count == cap ) {
+          more = realloc(items, 2 * cap * sizeof(kv_item_t));
+          if ( !more ) {
+            result = -1;
+            break;
+          }
+          items = more;
+          cap *= 2;
+        }
+        items[count].rank = 2 + r;
+        items[count++].entry = entry;
+      }
+    }
+  }
+
+  sem_down(&(kv->lock));
+  kv_unpin(kv, snap, n);
+  sem_up(&(kv->lock));
+
+  // versao mais nova de cada chave, sem remocoes
+  if ( !result ) {
+    qsort(items, count, sizeof(kv_item_t), kv_item_cmp);
+    for ( i = 0; i < count; i++ ) {
+      if ( i && !kv_cmp(items[i].entry.key, items[i].entry.klen,
+                        items[i - 1].entry.key, items[i - 1].entry.klen) )
+        continue;
+      if ( items[i].entry.deleted )
+        continue;
+      visited++;
+      if ( fn(items[i].entry.key, items[i].entry.klen, items[i].entry.val,
+              items[i].entry.vlen, arg) )
+        break;
+    }
+  }
+
+  free(items);
+  free(buffer);
+  return( result ? -1 : visited );
+}
+
+/*!
+  \brief Grava a memtable como run (aguardando a gravacao em andamento)
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int kv_sync (kv_t *kv) {
+  int result;
+
+  if ( !kv || !kv->mem )
+    return(-1);
+
+  if ( sem_down(&(kv->lock)) )
+    return(-1);
+  while ( kv->flushing ) {
+    kv->flushWaiting++;
+    sem_up(&(kv->lock));
+    sem_down(&(kv->flushed));
+    sem_down(&(kv->lock));
+  }
+  result = kv_flush(kv);
+  sem_up(&(kv->lock));
+
+  return(result);
+}
+
+/*!
+  \brief Consulta os contadores do armazenamento
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int kv_stats (kv_t *kv, kv_stats_t *stats) {
+  if ( !kv || !kv->mem || !stats )
+    return(-1);
+
+  *stats = kv->stats;
+
+  return(0);
+}
@@ -0,0 +1,167 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Armazenamento persistente de pares chave-valor (LSM) sobre um disco do
+// gerente de disco
+
+#ifndef __PPOS_KV__
+#define __PPOS_KV__
+
+#include "ppos_disk.h"
+#include "ppos_journal.h"
+
+// Estrutura em log (LSM): as escritas vão para uma tabela ordenada em
+// memória (memtable) e para um registro de escrita antecipada (WAL), gravado
+// como transações do journal (ppos_journal.h), o que reúne as escritas
+// concorrentes em uma só gravação (commit em grupo). Quando o WAL enche, a
+// memtable é gravada no disco como uma sequência ordenada (run) em páginas
+// de KV_PAGE bytes (ou um bloco, se maior), em um único acesso sequencial.
+// Cada run tem em memória um índice esparso (primeira chave de cada página)
+// e um filtro de Bloom, de modo que uma busca lê no máximo uma página por
+// run em que a chave pode estar; as páginas lidas ficam em uma cache. Com
+// mais de KV_RUNS_MAX runs, todas são intercaladas em uma só (compactação),
+// descartando versões antigas e remoções.
+//
+// Disposição no disco:
+//   [manifesto][journal][WAL: duas metades][runs...]
+//   manifesto: geração do WAL e runs em uso; o WAL alterna de metade a cada
+//   gravação da memtable; na abertura, as escritas do WAL são reaplicadas.
+
+#define KV_KEY_MAX     32   // tamanho maximo de uma chave (bytes)
+#define KV_VAL_MAX    128   // tamanho maximo de um valor (bytes)
+#define KV_PAGE       512   // tamanho minimo de uma pagina de run (bytes)
+#define KV_WAL_SLOTS  128   // escritas por metade do WAL (e por memtable)
+#define KV_RUNS_MAX     4   // runs antes da compactacao
+#define KV_CACHE       64   // paginas na cache
+#define KV_BLOOM_BITS  10   // bits do filtro de Bloom por chave
+#define KV_BLOOM_K      4   // funcoes de hash do filtro de Bloom
+#define KV_JOURNAL    256   // blocos da regiao do journal
+
+#define KV_NOTFOUND    -2   // retorno de kv_get() para chave ausente
+
+// entrada (chave, valor) na memtable
+typedef struct
+{
+  unsigned char klen;      // tamanho da chave
+  unsigned char deleted;   // remocao (sem valor)
+  unsigned short vlen;     // tamanho do valor
+  char key[KV_KEY_MAX];    // chave
+  char val[KV_VAL_MAX];    // valor
+} kv_entry_t ;
+
+// sequencia ordenada gravada no disco
+typedef struct
+{
+  int id;                  // identificador (paginas na cache)
+  int start;               // primeiro bloco
+  int blocks;              // blocos ocupados
+  int pages;               // paginas
+  int entries;             // entradas
+  char *index;             // primeira chave de cada pagina (tamanho + chave)
+  unsigned char *bloom;    // filtro de Bloom
+  int bloomBits;           // bits do filtro
+  int refs;                // buscas em andamento na run
+} kv_run_t ;
+
+// pagina de run na cache
+typedef struct
+{
+  int run;                 // identificador da run (0 = livre)
+  int page;                // pagina da run
+  unsigned int used;       // ultimo uso (LRU)
+  char *data;              // conteudo da pagina
+} kv_page_t ;
+
+// contadores do armazenamento
+typedef struct
+{
+  unsigned int puts;       // escritas (inclusive remocoes)
+  unsigned int gets;       // buscas
+  unsigned int scans;      // varreduras
+  unsigned int memhits;    // buscas resolvidas na memtable
+  unsigned int bloomskips; // runs descartadas pelo filtro de Bloom
+  unsigned int pagereads;  // paginas lidas do disco
+  unsigned int cachehits;  // paginas encontradas na cache
+  unsigned int flushes;    // memtables gravadas como runs
+  unsigned int compactions;// compactacoes
+  unsigned int replayed;   // escritas reaplicadas do WAL na abertura
+} kv_stats_t ;
+
+// estrutura que representa um armazenamento aberto
+typedef struct
+{
+  int dev;                 // disco do armazenamento
+  int numBlocks;           // blocos do disco
+  int blockSize;           // tamanho de cada bloco, em bytes
+  int pageBlocks;          // blocos por pagina
+  int pageSize;            // tamanho da pagina, em bytes
+  int manBlocks;           // blocos do manifesto
+  int journalStart;        // regiao do journal
+  int walStart;            // regiao do WAL
+  int walBlocks;           // blocos por escrita no WAL
+  int dataStart;           // primeiro bloco das runs
+  unsigned int epoch;      // identificador da formatacao
+  unsigned int gen;        // geracao corrente do WAL
+  unsigned int seq;        // sequencia da proxima escrita
+  int walNext;             // proxima posicao na metade corrente do WAL
+  kv_entry_t *mem;         // memtable, em ordem de chave
+  int nmem;                // entradas na memtable
+  kv_entry_t *imm;         // memtable sendo gravada como run
+  int nimm;                // entradas em imm
+  kv_run_t *runs[KV_RUNS_MAX + 1];  // runs, da mais nova para a mais antiga
+  int nruns;               // runs em uso
+  kv_run_t *dead[KV_RUNS_MAX + 1];  // runs substituidas ainda em uso
+  int ndead;               // runs substituidas
+  int nextRun;             // identificador da proxima run
+  kv_page_t cache[KV_CACHE];        // cache de paginas
+  unsigned int clock;      // relogio do LRU da cache
+  int inflight;            // escritas aguardando o WAL
+  int flushing;            // gravacao da memtable em andamento
+  int idleWaiting;         // tarefas aguardando inflight == 0
+  int flushWaiting;        // tarefas aguardando o fim da gravacao
+  semaphore_t lock;        // acesso exclusivo as estruturas
+  semaphore_t idle;        // fim das escritas no WAL
+  semaphore_t flushed;     // fim da gravacao da memtable
+  journal_t journal;       // journal do WAL e do manifesto
+  kv_stats_t stats;        // contadores
+} kv_t ;
+
+// funcao chamada por kv_scan() para cada par; retorna != 0 para parar
+typedef int (*kv_scan_fn) (const void *key, int klen, const void *val, int vlen,
+                           void *arg) ;
+
+// Todas as funcoes retornam -1 em erro ou 0 em sucesso, exceto quando
+// indicado.
+
+// formata o disco dev (ja inicializado com disk_dev_mgr_init)
+int kv_format (int dev) ;
+
+// abre o armazenamento do disco dev, reaplicando as escritas do WAL
+int kv_open (kv_t *kv, int dev) ;
+
+// grava a memtable e fecha o armazenamento
+int kv_close (kv_t *kv) ;
+
+// insere ou substitui um par; retorna quando a escrita esta no disco
+int kv_put (kv_t *kv, const void *key, int klen, const void *val, int vlen) ;
+
+// remove uma chave (mesmo ausente); retorna quando a remocao esta no disco
+int kv_delete (kv_t *kv, const void *key, int klen) ;
+
+// busca uma chave: copia o valor (ate KV_VAL_MAX bytes) e retorna seu
+// tamanho, ou KV_NOTFOUND se ausente, ou -1 em erro
+int kv_get (kv_t *kv, const void *key, int klen, void *val) ;
+
+// chama fn para cada par com chave em [lo, hi], em ordem de chave; retorna
+// a quantidade de pares visitados, ou -1 em erro
+int kv_scan (kv_t *kv, const void *lo, int lolen, const void *hi, int hilen,
+             kv_scan_fn fn, void *arg) ;
+
+// grava a memtable como run
+int kv_sync (kv_t *kv) ;
+
+// consulta os contadores
+int kv_stats (kv_t *kv, kv_stats_t *stats) ;
+
+#endif
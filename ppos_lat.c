@@ -0,0 +1,210 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ppos.h"
+#include "ppos_lat.h"
+
+// variáveis globais e constantes ==============================================
+
+static lat_hist_t latHist[LAT_KINDS][LAT_CLASSES];   // histogramas do nucleo
+
+static const char *latNames[LAT_KINDS] = { "pronta", "despertar", "semaforo", "disco" };
+static const char *latClasses[LAT_CLASSES + 1] = { "alta", "normal", "baixa", "todas" };
+
+// funções locais ==============================================================
+
+/*!
+  \brief Indice da faixa do histograma para o valor ns
+*/
+static int lat_bucket (unsigned long long ns) {
+  int e, shift;
+
+  if ( ns < LAT_SUB )
+    return(ns);
+  e = 63 - __builtin_clzll(ns);
+  if ( e > LAT_MAX_EXP )
+    return(LAT_BUCKETS - 1);
+  // ns tem e+1 bits: os LAT_SUB_BITS+1 mais altos escolhem a faixa
+  shift = e - LAT_SUB_BITS;
+  return( (shift + 1) * LAT_SUB + (int) (ns >> shift) - LAT_SUB );
+}
+
+/*!
+  \brief Maior valor (ns) contido na faixa b do histograma
+*/
+static unsigned long long lat_limit (int b) {
+  int shift;
+
+  if ( b < LAT_SUB )
+    return(b);
+  shift = b / LAT_SUB - 1;
+  return( ((unsigned long long) (b % LAT_SUB + LAT_SUB + 1) << shift) - 1 );
+}
+
+/*!
+  \brief Classe de prioridade de uma tarefa
+*/
+static int lat_class (task_t *task) {
+  if ( task->est_prio < 0 )
+    return(LAT_CLASS_HIGH);
+  if ( task->est_prio > 0 )
+    return(LAT_CLASS_LOW);
+  return(LAT_CLASS_NORMAL);
+}
+
+/*!
+  \brief Soma o histograma src em dst
+*/
+static void lat_merge (lat_hist_t *dst, lat_hist_t *src) {
+  int b;
+
+  if ( !src->count )
+    return;
+  if ( !dst->count || src->min < dst->min )
+    dst->min = src->min;
+  if ( src->max > dst->max )
+    dst->max = src->max;
+  dst->count += src->count;
+  dst->total += src->total;
+  for ( b = 0; b < LAT_BUCKETS; b++ )
+    dst->buckets[b] += src->buckets[b];
+}
+
+// funções gerais ==============================================================
+
+/*!
+  \brief Registra um valor no histograma
+
+  \param hist Histograma
+  \param ns Valor em nanossegundos
+*/
+void lat_record (lat_hist_t *hist, unsigned long long ns) {
+  if ( !hist->count || ns < hist->min )
+    hist->min = ns;
+  if ( ns > hist->max )
+    hist->max = ns;
+  hist->count++;
+  hist->total += ns;
+  hist->buckets[lat_bucket(ns)]++;
+}
+
+/*!
+  \brief Percentil de um histograma
+
+  \param hist Histograma
+  \param pct Percentual (0 a 100)
+
+  \return Menor limite de faixa que acumula pct% dos valores (limitado ao
+  maior valor registrado), ou 0 se o histograma estiver vazio
+*/
+unsigned long long lat_percentile (lat_hist_t *hist, double pct) {
+  unsigned long long target, sum = 0;
+  int b;
+
+  if ( !hist || !hist->count || pct < 0 || pct > 100 )
+    return(0);
+
+  target = (unsigned long long) (pct * hist->count / 100.0 + 0.999999);
+  if ( target < 1 )
+    target = 1;
+  for ( b = 0; b < LAT_BUCKETS; b++ ) {
+    sum += hist->buckets[b];
+    if ( sum >= target )
+      return( lat_limit(b) < hist->max ? lat_limit(b) : hist->max );
+  }
+  return(hist->max);
+}
+
+/*!
+  \brief Registra a latencia de uma tarefa que volta a executar
+
+  Toda espera entra em LAT_READY; esperas iniciadas por um despertar entram
+  tambem em LAT_WAKEUP e, conforme a causa, em LAT_SEM ou LAT_DISK.
+
+  \param task Tarefa que volta a executar
+  \param cause Causa da espera (LAT_WAKEUP, LAT_SEM, LAT_DISK ou -1)
+  \param ns Tempo desde que a tarefa ficou pronta
+*/
+void lat_sched (task_t *task, int cause, unsigned long long ns) {
+  lat_hist_t *h = &latHist[0][lat_class(task)];
+
+  lat_record(h + LAT_READY * LAT_CLASSES, ns);
+  if ( cause < 0 )
+    return;
+  lat_record(h + LAT_WAKEUP * LAT_CLASSES, ns);
+  if ( cause == LAT_SEM || cause == LAT_DISK )
+    lat_record(h + cause * LAT_CLASSES, ns);
+}
+
+/*!
+  \brief Copia um histograma do nucleo
+
+  \param kind Latencia (LAT_READY, LAT_WAKEUP, LAT_SEM ou LAT_DISK)
+  \param cls Classe de prioridade ou LAT_CLASS_ALL
+  \param hist Copia do histograma
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int lat_get (int kind, int cls, lat_hist_t *hist) {
+  int c;
+
+  if ( kind < 0 || kind >= LAT_KINDS || cls < 0 || cls > LAT_CLASS_ALL || !hist )
+    return(-1);
+
+  if ( cls < LAT_CLASSES ) {
+    *hist = latHist[kind][cls];
+    return(0);
+  }
+  memset(hist, 0, sizeof(lat_hist_t));
+  for ( c = 0; c < LAT_CLASSES; c++ )
+    lat_merge(hist, &latHist[kind][c]);
+
+  return(0);
+}
+
+/*!
+  \brief Zera todos os histogramas do nucleo
+
+  \return 0
+*/
+int lat_reset () {
+  memset(latHist, 0, sizeof(latHist));
+  return(0);
+}
+
+/*!
+  \brief Escreve os percentis das latencias com valores registrados, uma
+  linha por latencia e classe (valores em us)
+
+  \param f Arquivo de saida
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int lat_report (FILE *f) {
+  lat_hist_t *hist;
+  int kind, cls;
+
+  if ( !f || !(hist = malloc(sizeof(lat_hist_t))) )
+    return(-1);
+
+  fprintf(f, "%-10s %-7s %9s %10s %10s %10s %10s %10s %10s\n", "latencia", "classe",
+          "amostras", "media", "p50", "p90", "p99", "p99.9", "max");
+  for ( kind = 0; kind < LAT_KINDS; kind++ )
+    for ( cls = 0; cls <= LAT_CLASS_ALL; cls++ ) {
+      lat_get(kind, cls, hist);
+      if ( !hist->count )
+        continue;
+      fprintf(f, "%-10s %-7s %9llu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+              latNames[kind], latClasses[cls], hist->count,
+              hist->total / 1000.0 / hist->count, lat_percentile(hist, 50) / 1000.0,
+              lat_percentile(hist, 90) / 1000.0, lat_percentile(hist, 99) / 1000.0,
+              lat_percentile(hist, 99.9) / 1000.0, hist->max / 1000.0);
+    }
+
+  free(hist);
+  return(0);
+}
@@ -0,0 +1,72 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Histogramas de latencia de escalonamento mantidos pelo nucleo: tempo
+// entre uma tarefa ficar pronta e voltar a executar, por causa e por classe
+// de prioridade. O mesmo histograma guarda as latencias dos pedidos de
+// disco (ppos_disk).
+
+#ifndef __PPOS_LAT__
+#define __PPOS_LAT__
+
+#include <stdio.h>
+#include "ppos.h"
+
+// Os histogramas sao log-lineares (como os HDR): valores em ns ate
+// LAT_SUB - 1 sao exatos e cada potencia de 2 acima eh dividida em LAT_SUB
+// faixas, com erro maximo de 1/LAT_SUB (~3%). Registrar um valor custa um
+// calculo de indice e um incremento; o nucleo os mantem sempre ligados.
+
+#define LAT_SUB_BITS  5
+#define LAT_SUB       (1 << LAT_SUB_BITS)   // faixas por potencia de 2
+#define LAT_MAX_EXP   40                    // maior valor: 2^41 ns (~36 min)
+#define LAT_BUCKETS   ((LAT_MAX_EXP - LAT_SUB_BITS + 2) * LAT_SUB)
+
+// latencias medidas
+#define LAT_READY   0   // tempo na fila de prontas (toda espera, inclusive apos preempcao)
+#define LAT_WAKEUP  1   // despertar ate executar (qualquer suspensao)
+#define LAT_SEM     2   // sem_up ate a tarefa retomar
+#define LAT_DISK    3   // conclusao de pedido de disco ate a tarefa retomar
+#define LAT_KINDS   4
+
+// classes de prioridade (como as classes de disco)
+#define LAT_CLASS_HIGH   0  // est_prio < 0
+#define LAT_CLASS_NORMAL 1  // est_prio == 0
+#define LAT_CLASS_LOW    2  // est_prio > 0
+#define LAT_CLASSES      3
+#define LAT_CLASS_ALL    3  // consulta: todas as classes somadas
+
+// histograma de latencias
+typedef struct
+{
+  unsigned long long count;             // valores registrados
+  unsigned long long total;             // soma dos valores (ns)
+  unsigned long long min, max;          // menor e maior valor (ns)
+  unsigned int buckets[LAT_BUCKETS];    // valores por faixa
+} lat_hist_t ;
+
+// Todas as funcoes retornam -1 em erro ou 0 em sucesso, exceto quando
+// indicado.
+
+// registra o valor ns (em nanossegundos) no histograma
+void lat_record (lat_hist_t *hist, unsigned long long ns) ;
+
+// retorna o valor (ns) abaixo do qual estao pct% dos valores (0 se vazio)
+unsigned long long lat_percentile (lat_hist_t *hist, double pct) ;
+
+// registra a latencia ns de uma tarefa que volta a executar apos ficar
+// pronta por causa cause (LAT_WAKEUP, LAT_SEM, LAT_DISK ou -1 = preempcao
+// ou yield); usada pelo nucleo
+void lat_sched (task_t *task, int cause, unsigned long long ns) ;
+
+// copia o histograma da latencia kind da classe cls (ou LAT_CLASS_ALL)
+int lat_get (int kind, int cls, lat_hist_t *hist) ;
+
+// zera todos os histogramas do nucleo
+int lat_reset () ;
+
+// escreve em f os percentis de todas as latencias e classes com valores
+int lat_report (FILE *f) ;
+
+#endif
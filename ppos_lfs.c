@@ -0,0 +1,677 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "ppos.h"
+#include "ppos_lfs.h"
+
+// variáveis globais e constantes ==============================================
+
+extern int userTasks;
+
+#define LFS_MAGIC     0x4c465331  // cabecalho do checkpoint ("LFS1")
+#define LFS_MAGIC_SEG 0x4c465353  // resumo de segmento ("LFSS")
+
+// campos (inteiros) do cabecalho do checkpoint
+#define CP_MAGIC     0
+#define CP_SEQ       1
+#define CP_BLOCKS    2
+#define CP_SEGBLOCKS 3
+#define CP_NSEGS     4
+#define CP_EPOCH     5
+
+// campos (inteiros) do resumo de segmento, seguidos dos blocos logicos
+#define SS_MAGIC 0
+#define SS_EPOCH 1
+#define SS_SEQ   2
+#define SS_COUNT 3
+#define SS_HDR   4
+
+// funções locais ==============================================================
+
+/*!
+  \brief Primeiro bloco fisico (resumo) do segmento s
+*/
+static int lfs_base (lfs_t *lfs, int s) {
+  return ( lfs->segStart + s * lfs->segBlocks );
+}
+
+/*!
+  \brief Segmento que contem o bloco fisico phys
+*/
+static int lfs_seg (lfs_t *lfs, int phys) {
+  return ( (phys - lfs->segStart) / lfs->segBlocks );
+}
+
+/*!
+  \brief Le ou escreve count blocos contiguos do disco a partir de uma area
+  contigua de memoria
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int lfs_io (lfs_t *lfs, int type, int block, int count, void *area) {
+  void **buffers;
+  int i, result;
+
+  buffers = malloc(count * sizeof(void *));
+  if ( !buffers )
+    return(-1);
+  for ( i = 0; i < count; i++ )
+    buffers[i] = (char *) area + i * lfs->blockSize;
+
+  if ( type == READ_OPERATION )
+    result = disk_dev_block_readv(lfs->dev, block, count, buffers);
+  else
+    result = disk_dev_block_writev(lfs->dev, block, count, buffers);
+
+  free(buffers);
+  return(result);
+}
+
+/*!
+  \brief Calcula a disposicao do volume a partir da geometria do disco
+
+  O mapa ocupa parte do disco e seu tamanho depende da quantidade de blocos
+  logicos; o calculo eh repetido ate estabilizar.
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int lfs_layout (lfs_t *lfs, int dev) {
+  int numBlocks, blockSize, mapBlocks = 0, i;
+  long logical = 0;
+
+  if ( disk_dev_geometry(dev, &numBlocks, &blockSize) || blockSize < 64 )
+    return(-1);
+
+  lfs->dev = dev;
+  lfs->blockSize = blockSize;
+  lfs->segData = blockSize / sizeof(int) - SS_HDR;
+  if ( lfs->segData > DISK_VEC_MAX - 1 )
+    lfs->segData = DISK_VEC_MAX - 1;
+  lfs->segBlocks = lfs->segData + 1;
+
+  for ( i = 0; i < 8; i++ ) {
+    lfs->cpBlocks = 1 + mapBlocks;
+    lfs->nsegs = (numBlocks - 2 * lfs->cpBlocks) / lfs->segBlocks;
+    if ( lfs->nsegs <= LFS_CLEAN_HIGH )
+      return(-1);
+    logical = (long) lfs->nsegs * lfs->segData * LFS_UTIL / 100;
+    mapBlocks = (logical * sizeof(int) + blockSize - 1) / blockSize;
+  }
+
+  // disposicao final: o mapa deve caber nos blocos reservados
+  lfs->cpBlocks = 1 + mapBlocks;
+  lfs->nsegs = (numBlocks - 2 * lfs->cpBlocks) / lfs->segBlocks;
+  if ( lfs->nsegs <= LFS_CLEAN_HIGH )
+    return(-1);
+  logical = (long) lfs->nsegs * lfs->segData * LFS_UTIL / 100;
+  if ( logical > (long) mapBlocks * blockSize / (long) sizeof(int) )
+    logical = (long) mapBlocks * blockSize / sizeof(int);
+  lfs->numBlocks = logical;
+  lfs->segStart = 2 * lfs->cpBlocks;
+
+  return(0);
+}
+
+/*!
+  \brief Aloca as estruturas em memoria do volume
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int lfs_alloc (lfs_t *lfs) {
+  int i, phys = lfs->nsegs * lfs->segBlocks;
+
+  lfs->map = malloc((lfs->cpBlocks - 1) * lfs->blockSize);
+  lfs->owner = malloc(phys * sizeof(int));
+  lfs->live = calloc(lfs->nsegs, sizeof(int));
+  lfs->segbuf = calloc(lfs->segBlocks, lfs->blockSize);
+  lfs->cleanbuf = malloc(lfs->segBlocks * lfs->blockSize);
+  if ( !lfs->map || !lfs->owner || !lfs->live || !lfs->segbuf || !lfs->cleanbuf )
+    return(-1);
+
+  for ( i = 0; i < lfs->numBlocks; i++ )
+    lfs->map[i] = -1;
+  for ( i = 0; i < phys; i++ )
+    lfs->owner[i] = -1;
+
+  return(0);
+}
+
+/*!
+  \brief Libera as estruturas em memoria do volume
+*/
+static void lfs_release (lfs_t *lfs) {
+  free(lfs->map);
+  free(lfs->owner);
+  free(lfs->live);
+  free(lfs->segbuf);
+  free(lfs->cleanbuf);
+  lfs->map = lfs->owner = lfs->live = NULL;
+  lfs->segbuf = lfs->cleanbuf = NULL;
+}
+
+/*!
+  \brief Grava o mapa e o cabecalho na proxima copia do checkpoint
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int lfs_checkpoint (lfs_t *lfs) {
+  int base = lfs->cp * lfs->cpBlocks;
+  int *hdr;
+
+  hdr = calloc(1, lfs->blockSize);
+  if ( !hdr )
+    return(-1);
+  hdr[CP_MAGIC] = LFS_MAGIC;
+  hdr[CP_SEQ] = lfs->seq;
+  hdr[CP_BLOCKS] = lfs->numBlocks;
+  hdr[CP_SEGBLOCKS] = lfs->segBlocks;
+  hdr[CP_NSEGS] = lfs->nsegs;
+  hdr[CP_EPOCH] = lfs->epoch;
+
+  // o cabecalho eh gravado por ultimo: so vale com o mapa completo
+  if ( lfs_io(lfs, WRITE_OPERATION, base + 1, lfs->cpBlocks - 1, lfs->map) ||
+       disk_dev_block_write(lfs->dev, base, hdr) ) {
+    free(hdr);
+    return(-1);
+  }
+
+  free(hdr);
+  lfs->cp ^= 1;
+  lfs->stats.checkpoints++;
+
+  return(0);
+}
+
+/*!
+  \brief Grava no disco o segmento corrente (resumo e dados), em um unico
+  acesso sequencial
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int lfs_flush (lfs_t *lfs) {
+  int *sum = (int *) lfs->segbuf;
+
+  if ( lfs->used == lfs->flushed )
+    return(0);
+
+  sum[SS_MAGIC] = LFS_MAGIC_SEG;
+  sum[SS_EPOCH] = lfs->epoch;
+  sum[SS_SEQ] = ++lfs->seq;
+  sum[SS_COUNT] = lfs->used;
+  if ( lfs_io(lfs, WRITE_OPERATION, lfs_base(lfs, lfs->head), 1 + lfs->used, lfs->segbuf) )
+    return(-1);
+
+  lfs->flushed = lfs->used;
+  lfs->stats.segments++;
+
+  return(0);
+}
+
+/*!
+  \brief Quantidade de segmentos livres (sem blocos vivos), fora o corrente
+*/
+static int lfs_free (lfs_t *lfs) {
+  int s, count = 0;
+
+  for ( s = 0; s < lfs->nsegs; s++ )
+    if ( s != lfs->head && !lfs->live[s] )
+      count++;
+  return(count);
+}
+
+static int lfs_clean_one (lfs_t *lfs) ;
+
+/*!
+  \brief Grava o segmento corrente e passa para o proximo segmento livre
+
+  \param lfs Volume
+  \param cleaning 1 se chamada pela limpeza (pode usar a reserva)
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int lfs_advance (lfs_t *lfs, int cleaning) {
+  int k, s = -1;
+
+  if ( lfs_flush(lfs) )
+    return(-1);
+
+  // escritas das aplicacoes nao usam a reserva: limpa antes, se preciso
+  if ( !cleaning ) {
+    while ( lfs_free(lfs) <= LFS_RESERVE )
+      if ( lfs_clean_one(lfs) )
+        break;
+    if ( lfs_free(lfs) < LFS_CLEAN_LOW && !lfs->wake && !lfs->stop ) {
+      lfs->wake = 1;
+      sem_up(&(lfs->clean));
+    }
+  }
+
+  // proximo segmento livre depois do corrente, mantendo o log sequencial
+  for ( k = 1; k < lfs->nsegs; k++ )
+    if ( !lfs->live[(lfs->head + k) % lfs->nsegs] ) {
+      s = (lfs->head + k) % lfs->nsegs;
+      break;
+    }
+  if ( s < 0 ) {
+    fprintf(stderr, "[PPOS error] lfs_advance: no free segment on disk %d\n", lfs->dev);
+    return(-1);
+  }
+
+  lfs->head = s;
+  lfs->used = lfs->flushed = 0;
+  memset(lfs->segbuf, 0, lfs->blockSize);
+
+  return(0);
+}
+
+/*!
+  \brief Acrescenta um bloco logico ao segmento corrente
+
+  \param lfs Volume
+  \param block Bloco logico
+  \param data Conteudo do bloco
+  \param cleaning 1 se chamada pela limpeza
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int lfs_append (lfs_t *lfs, int block, void *data, int cleaning) {
+  int *sum = (int *) lfs->segbuf;
+  int phys, old;
+
+  if ( lfs->used == lfs->segData && lfs_advance(lfs, cleaning) )
+    return(-1);
+
+  phys = lfs_base(lfs, lfs->head) + 1 + lfs->used;
+  memcpy(lfs->segbuf + (1 + lfs->used) * lfs->blockSize, data, lfs->blockSize);
+  sum[SS_HDR + lfs->used] = block;
+
+  // a copia anterior do bloco morre
+  old = lfs->map[block];
+  if ( old >= 0 ) {
+    lfs->owner[old - lfs->segStart] = -1;
+    lfs->live[lfs_seg(lfs, old)]--;
+  }
+  lfs->map[block] = phys;
+  lfs->owner[phys - lfs->segStart] = block;
+  lfs->live[lfs->head]++;
+  lfs->used++;
+
+  // segmento cheio eh gravado imediatamente
+  if ( lfs->used == lfs->segData )
+    return( lfs_flush(lfs) );
+
+  return(0);
+}
+
+/*!
+  \brief Limpa o segmento com menos blocos vivos, copiando-os para o log
+
+  \return -1 se nao ha segmento a limpar ou em erro, 0 em sucesso
+*/
+static int lfs_clean_one (lfs_t *lfs) {
+  int s, victim = -1, i, phys, block;
+
+  // escolhe o segmento mais vazio (guloso)
+  for ( s = 0; s < lfs->nsegs; s++ )
+    if ( s != lfs->head && lfs->live[s] > 0 && lfs->live[s] < lfs->segData &&
+         (victim < 0 || lfs->live[s] < lfs->live[victim]) )
+      victim = s;
+  if ( victim < 0 )
+    return(-1);
+
+  // le o segmento inteiro em um unico acesso e copia os blocos vivos
+  if ( lfs_io(lfs, READ_OPERATION, lfs_base(lfs, victim), lfs->segBlocks, lfs->cleanbuf) )
+    return(-1);
+  for ( i = 0; i < lfs->segData; i++ ) {
+    phys = lfs_base(lfs, victim) + 1 + i;
+    block = lfs->owner[phys - lfs->segStart];
+    if ( block >= 0 ) {
+      if ( lfs_append(lfs, block, lfs->cleanbuf + (1 + i) * lfs->blockSize, 1) )
+        return(-1);
+      lfs->stats.moved++;
+    }
+  }
+  lfs->stats.cleaned++;
+
+  return(0);
+}
+
+/*!
+  \brief Tarefa de limpeza: libera segmentos ate LFS_CLEAN_HIGH livres,
+  um segmento por vez, sempre que acordada
+
+  \param arg Volume atendido pela tarefa
+*/
+static void lfs_cleaner (void *arg) {
+  lfs_t *lfs = arg;
+  int done;
+
+  while (1) {
+    sem_down(&(lfs->clean));
+    if ( lfs->stop )
+      break;
+
+    do {
+      sem_down(&(lfs->lock));
+      done = ( lfs_free(lfs) >= LFS_CLEAN_HIGH || lfs_clean_one(lfs) );
+      if ( done )
+        lfs->wake = 0;
+      sem_up(&(lfs->lock));
+    } while ( !done && !lfs->stop );
+  }
+
+  // a tarefa nao era contada como tarefa de usuario (ver lfs_mount)
+  userTasks++;
+  task_exit(0);
+}
+
+/*!
+  \brief Le o cabecalho de uma copia do checkpoint
+
+  \return Sequencia do checkpoint, ou -1 se a copia nao eh valida
+*/
+static long lfs_read_header (lfs_t *lfs, int copy, int *hdr) {
+  if ( disk_dev_block_read(lfs->dev, copy * lfs->cpBlocks, hdr) ||
+       hdr[CP_MAGIC] != LFS_MAGIC || hdr[CP_BLOCKS] != lfs->numBlocks ||
+       hdr[CP_SEGBLOCKS] != lfs->segBlocks || hdr[CP_NSEGS] != lfs->nsegs )
+    return(-1);
+  return( (unsigned int) hdr[CP_SEQ] );
+}
+
+/*!
+  \brief Reaplica os segmentos gravados depois do checkpoint, em ordem
+
+  \return Quantidade de segmentos reaplicados, ou -1 em erro
+*/
+static int lfs_roll_forward (lfs_t *lfs) {
+  unsigned int *seqs, next, cpseq = lfs->seq;
+  int *sum = (int *) lfs->cleanbuf;
+  int s, i, best, block, rolled = 0;
+
+  seqs = calloc(lfs->nsegs, sizeof(unsigned int));
+  if ( !seqs )
+    return(-1);
+
+  // resumos validos desta formatacao, posteriores ao checkpoint
+  for ( s = 0; s < lfs->nsegs; s++ ) {
+    if ( disk_dev_block_read(lfs->dev, lfs_base(lfs, s), sum) ) {
+      free(seqs);
+      return(-1);
+    }
+    if ( sum[SS_MAGIC] == LFS_MAGIC_SEG && (unsigned int) sum[SS_EPOCH] == lfs->epoch &&
+         (unsigned int) sum[SS_SEQ] > cpseq && sum[SS_COUNT] <= lfs->segData )
+      seqs[s] = sum[SS_SEQ];
+  }
+
+  // aplica os segmentos em ordem crescente de sequencia
+  while (1) {
+    best = -1;
+    for ( s = 0; s < lfs->nsegs; s++ )
+      if ( seqs[s] && (best < 0 || seqs[s] < seqs[best]) )
+        best = s;
+    if ( best < 0 )
+      break;
+    next = seqs[best];
+    seqs[best] = 0;
+    if ( disk_dev_block_read(lfs->dev, lfs_base(lfs, best), sum) ) {
+      free(seqs);
+      return(-1);
+    }
+    for ( i = 0; i < sum[SS_COUNT]; i++ ) {
+      block = sum[SS_HDR + i];
+      if ( block >= 0 && block < lfs->numBlocks )
+        lfs->map[block] = lfs_base(lfs, best) + 1 + i;
+    }
+    lfs->seq = next;
+    lfs->head = best;
+    rolled++;
+  }
+
+  free(seqs);
+  return(rolled);
+}
+
+// funções gerais ==============================================================
+
+/*!
+  \brief Formata um disco como volume com estrutura de log
+
+  \param dev Disco, ja inicializado com disk_dev_mgr_init()
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int lfs_format (int dev) {
+  lfs_t lfs;
+  int *hdr, copy, result;
+  unsigned int epoch = time(NULL);
+
+  memset(&lfs, 0, sizeof(lfs_t));
+  if ( lfs_layout(&lfs, dev) ) {
+    fprintf(stderr, "[PPOS error] lfs_format: disk %d too small\n", dev);
+    return(-1);
+  }
+  if ( lfs_alloc(&lfs) ) {
+    lfs_release(&lfs);
+    return(-1);
+  }
+  hdr = (int *) lfs.cleanbuf;
+
+  // a nova formatacao nao pode reconhecer resumos de formatacoes anteriores
+  for ( copy = 0; copy < 2; copy++ )
+    if ( lfs_read_header(&lfs, copy, hdr) >= 0 && (unsigned int) hdr[CP_EPOCH] >= epoch )
+      epoch = hdr[CP_EPOCH] + 1;
+  lfs.epoch = epoch;
+
+  // checkpoint inicial na copia 0 (mapa vazio) e copia 1 invalida
+  memset(hdr, 0, lfs.blockSize);
+  result = lfs_checkpoint(&lfs) ||
+           disk_dev_block_write(dev, lfs.cpBlocks, hdr);
+
+  lfs_release(&lfs);
+  return( result ? -1 : 0 );
+}
+
+/*!
+  \brief Monta o volume com estrutura de log de um disco
+
+  \param lfs Estrutura do volume a preencher
+  \param dev Disco, ja inicializado e formatado com lfs_format()
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int lfs_mount (lfs_t *lfs, int dev) {
+  long seq[2];
+  int *hdr, best, rolled, s, block, phys;
+
+  if ( !lfs )
+    return(-1);
+  memset(lfs, 0, sizeof(lfs_t));
+  if ( lfs_layout(lfs, dev) || lfs_alloc(lfs) ) {
+    lfs_release(lfs);
+    return(-1);
+  }
+  hdr = (int *) lfs->cleanbuf;
+
+  // usa a copia valida mais recente do checkpoint
+  seq[0] = lfs_read_header(lfs, 0, hdr);
+  seq[1] = lfs_read_header(lfs, 1, hdr);
+  best = ( seq[1] > seq[0] ) ? 1 : 0;
+  if ( seq[best] < 0 ) {
+    fprintf(stderr, "[PPOS error] lfs_mount: disk %d is not formatted\n", dev);
+    lfs_release(lfs);
+    return(-1);
+  }
+  lfs_read_header(lfs, best, hdr);
+  lfs->epoch = hdr[CP_EPOCH];
+  lfs->seq = seq[best];
+  lfs->cp = best ^ 1;
+  if ( lfs_io(lfs, READ_OPERATION, best * lfs->cpBlocks + 1, lfs->cpBlocks - 1, lfs->map) ) {
+    lfs_release(lfs);
+    return(-1);
+  }
+
+  // reaplica as gravacoes posteriores ao checkpoint
+  lfs->head = -1;
+  rolled = lfs_roll_forward(lfs);
+  if ( rolled < 0 ) {
+    lfs_release(lfs);
+    return(-1);
+  }
+  lfs->stats.rolled = rolled;
+
+  // reconstroi o mapa reverso e os blocos vivos por segmento
+  for ( block = 0; block < lfs->numBlocks; block++ ) {
+    phys = lfs->map[block];
+    if ( phys >= 0 ) {
+      lfs->owner[phys - lfs->segStart] = block;
+      lfs->live[lfs_seg(lfs, phys)]++;
+    }
+  }
+
+  // o log continua no primeiro segmento livre depois do ultimo gravado
+  for ( s = 1; s <= lfs->nsegs; s++ )
+    if ( !lfs->live[(lfs->head + s + lfs->nsegs) % lfs->nsegs] )
+      break;
+  if ( s > lfs->nsegs ) {
+    fprintf(stderr, "[PPOS error] lfs_mount: no free segment on disk %d\n", dev);
+    lfs_release(lfs);
+    return(-1);
+  }
+  lfs->head = (lfs->head + s + lfs->nsegs) % lfs->nsegs;
+  lfs->used = lfs->flushed = 0;
+
+  if ( sem_create(&(lfs->lock), 1) || sem_create(&(lfs->clean), 0) ) {
+    lfs_release(lfs);
+    return(-1);
+  }
+
+  // com segmentos reaplicados, um novo checkpoint torna o estado estavel
+  if ( rolled && lfs_checkpoint(lfs) ) {
+    lfs_release(lfs);
+    return(-1);
+  }
+
+  // cria a tarefa de limpeza, que nao conta como tarefa de usuario
+  task_create(&(lfs->cleaner), lfs_cleaner, lfs);
+  userTasks--;
+
+  return(0);
+}
+
+/*!
+  \brief Desmonta o volume: grava o segmento corrente e um checkpoint e
+  termina a tarefa de limpeza
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int lfs_umount (lfs_t *lfs) {
+  int result;
+
+  if ( !lfs || !lfs->map )
+    return(-1);
+
+  result = lfs_sync(lfs);
+
+  lfs->stop = 1;
+  sem_up(&(lfs->clean));
+  task_join(&(lfs->cleaner));
+
+  sem_destroy(&(lfs->lock));
+  sem_destroy(&(lfs->clean));
+  lfs_release(lfs);
+
+  return(result);
+}
+
+/*!
+  \brief Leitura de um bloco logico do volume
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int lfs_block_read (lfs_t *lfs, int block, void *buffer) {
+  int phys, result = 0;
+
+  if ( !lfs || !lfs->map || !buffer || block < 0 || block >= lfs->numBlocks )
+    return(-1);
+
+  if ( sem_down(&(lfs->lock)) )
+    return(-1);
+
+  phys = lfs->map[block];
+  if ( phys < 0 )
+    // bloco nunca escrito
+    memset(buffer, 0, lfs->blockSize);
+  else if ( lfs_seg(lfs, phys) == lfs->head )
+    // bloco no segmento corrente, em memoria
+    memcpy(buffer, lfs->segbuf + (phys - lfs_base(lfs, lfs->head)) * lfs->blockSize,
+           lfs->blockSize);
+  else
+    result = disk_dev_block_read(lfs->dev, phys, buffer);
+  lfs->stats.reads++;
+
+  sem_up(&(lfs->lock));
+
+  return(result);
+}
+
+/*!
+  \brief Escrita de um bloco logico do volume, acrescentado ao log
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int lfs_block_write (lfs_t *lfs, int block, void *buffer) {
+  int result;
+
+  if ( !lfs || !lfs->map || !buffer || block < 0 || block >= lfs->numBlocks )
+    return(-1);
+
+  if ( sem_down(&(lfs->lock)) )
+    return(-1);
+
+  result = lfs_append(lfs, block, buffer, 0);
+  lfs->stats.writes++;
+
+  sem_up(&(lfs->lock));
+
+  return(result);
+}
+
+/*!
+  \brief Grava o segmento corrente e um checkpoint do mapa
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int lfs_sync (lfs_t *lfs) {
+  int result;
+
+  if ( !lfs || !lfs->map )
+    return(-1);
+
+  if ( sem_down(&(lfs->lock)) )
+    return(-1);
+
+  result = ( lfs_flush(lfs) || lfs_checkpoint(lfs) ) ? -1 : 0;
+
+  sem_up(&(lfs->lock));
+
+  return(result);
+}
+
+/*!
+  \brief Consulta os contadores do volume
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int lfs_stats (lfs_t *lfs, lfs_stats_t *stats) {
+  if ( !lfs || !stats )
+    return(-1);
+
+  *stats = lfs->stats;
+
+  return(0);
+}
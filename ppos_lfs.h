@@ -0,0 +1,98 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Camada de blocos com estrutura de log (log-structured) sobre um disco do
+// gerente de disco
+
+#ifndef __PPOS_LFS__
+#define __PPOS_LFS__
+
+#include "ppos_disk.h"
+
+// As escritas de blocos lógicos são acumuladas no segmento corrente, em
+// memória, e gravadas no disco como um único acesso sequencial de vários
+// blocos (segmento = 1 bloco de resumo + blocos de dados). O mapa de blocos
+// lógicos para físicos fica em memória e é gravado em um checkpoint (duas
+// cópias alternadas) por lfs_sync(); na montagem, os segmentos gravados
+// depois do último checkpoint são reaplicados a partir de seus resumos.
+// Uma tarefa de limpeza copia os blocos vivos dos segmentos mais vazios
+// para o log, liberando segmentos inteiros.
+//
+// Disposição no disco:
+//   [checkpoint 0][checkpoint 1][segmento 0][segmento 1]...
+//   checkpoint: bloco de cabeçalho + blocos do mapa
+//   segmento:   bloco de resumo + blocos de dados
+//
+// Escritas só são duráveis após lfs_sync() ou o preenchimento do segmento.
+
+#define LFS_UTIL        75  // ocupacao maxima dos segmentos pelos dados (%)
+#define LFS_CLEAN_LOW    4  // segmentos livres que disparam a limpeza
+#define LFS_CLEAN_HIGH   8  // segmentos livres em que a limpeza termina
+#define LFS_RESERVE      1  // segmentos reservados para a limpeza
+
+// contadores da camada de log
+typedef struct
+{
+  unsigned int reads;       // blocos lidos pelas aplicacoes
+  unsigned int writes;      // blocos escritos pelas aplicacoes
+  unsigned int segments;    // gravacoes de segmentos no disco
+  unsigned int cleaned;     // segmentos liberados pela limpeza
+  unsigned int moved;       // blocos vivos copiados pela limpeza
+  unsigned int checkpoints; // checkpoints gravados
+  unsigned int rolled;      // segmentos reaplicados na montagem
+} lfs_stats_t ;
+
+// estrutura que representa um volume com estrutura de log montado
+typedef struct
+{
+  int dev;                // disco do volume
+  int numBlocks;          // blocos logicos do volume
+  int blockSize;          // tamanho de cada bloco, em bytes
+  int segBlocks;          // blocos por segmento (resumo + dados)
+  int segData;            // blocos de dados por segmento
+  int nsegs;              // quantidade de segmentos
+  int segStart;           // primeiro bloco do segmento 0
+  int cpBlocks;           // blocos de cada copia do checkpoint
+  unsigned int epoch;     // identificador da formatacao
+  unsigned int seq;       // sequencia da ultima gravacao de segmento
+  int cp;                 // copia do checkpoint a gravar em seguida
+  int *map;               // bloco logico -> fisico (-1 = nunca escrito)
+  int *owner;             // bloco fisico -> logico (-1 = livre ou morto)
+  int *live;              // blocos vivos em cada segmento
+  int head;               // segmento corrente
+  int used;               // blocos de dados usados no segmento corrente
+  int flushed;            // blocos de dados do segmento corrente ja gravados
+  char *segbuf;           // segmento corrente, em memoria
+  char *cleanbuf;         // segmento em limpeza, em memoria
+  int wake;               // tarefa de limpeza ja foi acordada
+  int stop;               // tarefa de limpeza deve terminar
+  semaphore_t lock;       // acesso exclusivo ao volume
+  semaphore_t clean;      // tarefa de limpeza aguarda trabalho
+  task_t cleaner;         // tarefa de limpeza
+  lfs_stats_t stats;      // contadores
+} lfs_t ;
+
+// Todas as funcoes retornam -1 em erro ou 0 em sucesso.
+
+// formata o disco dev (ja inicializado com disk_dev_mgr_init)
+int lfs_format (int dev) ;
+
+// monta o volume do disco dev, reaplicando as gravacoes posteriores ao
+// ultimo checkpoint, e cria a tarefa de limpeza
+int lfs_mount (lfs_t *lfs, int dev) ;
+
+// grava o segmento corrente e um checkpoint, e termina a tarefa de limpeza
+int lfs_umount (lfs_t *lfs) ;
+
+// leitura/escrita de um bloco logico do volume
+int lfs_block_read (lfs_t *lfs, int block, void *buffer) ;
+int lfs_block_write (lfs_t *lfs, int block, void *buffer) ;
+
+// grava o segmento corrente e um checkpoint do mapa
+int lfs_sync (lfs_t *lfs) ;
+
+// consulta os contadores do volume
+int lfs_stats (lfs_t *lfs, lfs_stats_t *stats) ;
+
+#endif
@@ -0,0 +1,333 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+#define _GNU_SOURCE     // fopencookie()
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#undef _XOPEN_SOURCE    // redefinido por ppos.h
+#include "ppos.h"
+#include "ppos_log.h"
+
+// variáveis globais e constantes ==============================================
+
+extern unsigned int ticks;
+extern int preemptLock;
+
+#define LOG_ALTSTACK 65536  // pilha alternativa do tratador de sinais fatais
+
+static char logRing[LOG_RING];                   // anel de bytes
+static volatile unsigned long long logHead = 0;  // bytes copiados para o anel
+static volatile unsigned long long logTail = 0;  // bytes gravados
+static unsigned int logSince = 0;                // chegada do byte mais antigo (ms)
+static int logOn = 0;                            // registro ligado?
+static int logLevel = LOG_LEVEL_DEBUG;           // nivel minimo das mensagens
+static int logFd = -1;                           // descritor da saida original
+static FILE *logStdout = NULL;                   // stdout original
+static FILE *logStream = NULL;                   // fluxo que escreve no anel
+static int logHooks = 0;                         // atexit e sinais instalados?
+static log_stats_t logStats;
+
+// sinais que terminam o processo e devem esvaziar o anel antes
+static const int logSignals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT, SIGINT, SIGTERM };
+
+static char logAltStack[LOG_ALTSTACK];
+
+// estrutura que define um tratador de sinal (deve ser global ou static)
+static struct sigaction logAction;
+
+// funções locais ==============================================================
+
+/*!
+  \brief Escreve n bytes no descritor da saida, repetindo as escritas
+  parciais e as interrompidas por sinais (o relogio do nucleo)
+*/
+static void log_write (const char *buf, size_t n) {
+  ssize_t done;
+
+  while ( n > 0 ) {
+    done = write(logFd, buf, n);
+    if ( done < 0 ) {
+      if ( errno == EINTR )
+        continue;
+      return;
+    }
+    logStats.writes++;
+    buf += done;
+    n -= done;
+  }
+}
+
+/*!
+  \brief Grava todo o conteudo do anel; deve ser chamada com a preempcao
+  suspensa (ou no dispatcher), para que ninguem escreva no anel durante a
+  gravacao
+*/
+static void log_drain () {
+  unsigned long long head = logHead;
+  size_t start, n;
+
+  if ( head == logTail )
+    return;
+
+  start = logTail % LOG_RING;
+  n = head - logTail;
+  if ( start + n > LOG_RING ) {
+    log_write(logRing + start, LOG_RING - start);
+    n -= LOG_RING - start;
+    start = 0;
+  }
+  log_write(logRing + start, n);
+  logTail = head;
+  logStats.flushes++;
+}
+
+/*!
+  \brief Copia n bytes para o anel, com a preempcao suspensa; se nao
+  couberem, o anel eh gravado antes
+*/
+static void log_append (const char *buf, size_t n) {
+  size_t start, part;
+
+  preemptLock++;
+  logStats.records++;
+  logStats.bytes += n;
+
+  if ( n > LOG_RING - (logHead - logTail) ) {
+    logStats.stalls++;
+    log_drain();
+  }
+  // maior que o anel: vai direto para a saida, depois do que ja estava nele
+  if ( n > LOG_RING ) {
+    log_write(buf, n);
+    preemptLock--;
+    return;
+  }
+
+  if ( logHead == logTail )
+    logSince = ticks;
+  start = logHead % LOG_RING;
+  part = ( start + n > LOG_RING ) ? LOG_RING - start : n;
+  memcpy(logRing + start, buf, part);
+  memcpy(logRing, buf + part, n - part);
+  logHead += n;
+  preemptLock--;
+}
+
+/*!
+  \brief Escrita do fluxo que substitui stdout: cada chamada eh um registro
+  no anel
+*/
+static ssize_t log_cookie_write (void *cookie, const char *buf, size_t size) {
+  log_append(buf, size);
+  return(size);
+}
+
+/*!
+  \brief Esvazia o anel ao fim do processo
+*/
+static void log_atexit () {
+  if ( logOn )
+    log_flush();
+}
+
+/*!
+  \brief Tratador dos sinais fatais: grava o anel e deixa o sinal terminar
+  o processo com a acao padrao
+*/
+static void log_fatal (int signum) {
+  if ( logOn )
+    log_drain();
+  raise(signum);
+}
+
+/*!
+  \brief Instala a gravacao do anel em exit() e nos sinais fatais que ainda
+  usam a acao padrao
+*/
+static void log_hooks () {
+  struct sigaction old;
+  stack_t ss;
+  unsigned int i;
+
+  if ( logHooks )
+    return;
+  logHooks = 1;
+  atexit(log_atexit);
+
+  // pilha propria, para esvaziar o anel mesmo com a pilha da tarefa estourada
+  ss.ss_sp = logAltStack;
+  ss.ss_size = LOG_ALTSTACK;
+  ss.ss_flags = 0;
+  sigaltstack(&ss, NULL);
+
+  logAction.sa_handler = log_fatal;
+  sigemptyset(&logAction.sa_mask);
+  logAction.sa_flags = SA_RESETHAND | SA_NODEFER | SA_ONSTACK;
+  for ( i = 0; i < sizeof(logSignals) / sizeof(logSignals[0]); i++ )
+    if ( !sigaction(logSignals[i], NULL, &old) && old.sa_handler == SIG_DFL )
+      sigaction(logSignals[i], &logAction, NULL);
+}
+
+// funções gerais ==============================================================
+
+/*!
+  \brief Liga o registro conforme a variavel de ambiente PPOS_LOG
+*/
+void log_init () {
+  static const char *names[] = { "debug", "info", "warn", "error" };
+  char *env = getenv("PPOS_LOG");
+  int i;
+
+  if ( env ) {
+    if ( !strcmp(env, "sync") )
+      return;
+    for ( i = LOG_LEVEL_DEBUG; i <= LOG_LEVEL_ERROR; i++ )
+      if ( !strcmp(env, names[i]) )
+        log_level(i);
+  }
+  if ( log_start() )
+    fprintf(stderr, "[PPOS error]: log_init: starting log\n");
+}
+
+/*!
+  \brief Liga o registro: stdout passa a ser um fluxo sem buffer que
+  escreve no anel
+
+  \return 0 em sucesso e -1 em erro
+*/
+int log_start () {
+  cookie_io_functions_t io = { NULL, log_cookie_write, NULL, NULL };
+
+  if ( logOn )
+    return(-1);
+
+  fflush(stdout);
+  if ( (logFd = fileno(stdout)) < 0 )
+    return(-1);
+  if ( !(logStream = fopencookie(NULL, "w", io)) ) {
+    fprintf(stderr, "[PPOS error]: log_start: fopencookie\n");
+    return(-1);
+  }
+  // sem buffer: cada printf() chega ao anel em uma unica escrita
+  setvbuf(logStream, NULL, _IONBF, 0);
+
+  log_hooks();
+  logStdout = stdout;
+  stdout = logStream;
+  logOn = 1;
+
+  return(0);
+}
+
+/*!
+  \brief Grava o anel e devolve stdout a saida original, sem buffer
+
+  \return 0 em sucesso e -1 em erro
+*/
+int log_stop () {
+  if ( !logOn )
+    return(-1);
+
+  log_flush();
+  logOn = 0;
+  stdout = logStdout;
+  fclose(logStream);
+  logStream = NULL;
+
+  return(0);
+}
+
+/*!
+  \brief Grava imediatamente o conteudo do anel
+
+  \return 0 em sucesso e -1 em erro
+*/
+int log_flush () {
+  if ( !logOn )
+    return(fflush(stdout) ? -1 : 0);
+
+  preemptLock++;
+  log_drain();
+  preemptLock--;
+
+  return(0);
+}
+
+/*!
+  \brief Grava o anel se o dado mais antigo espera ha LOG_FLUSH ms ou se o
+  anel passou da metade; chamada pelo dispatcher, que nao eh preemptado
+*/
+void log_poll () {
+  if ( !logOn || logHead == logTail )
+    return;
+  if ( ticks - logSince >= LOG_FLUSH || logHead - logTail >= LOG_RING / 2 )
+    log_drain();
+}
+
+/*!
+  \brief Define o nivel minimo das mensagens de ppos_log()
+
+  \return nivel anterior ou -1 em erro
+*/
+int log_level (int level) {
+  int old = logLevel;
+
+  if ( level < LOG_LEVEL_DEBUG || level > LOG_LEVEL_ERROR )
+    return(-1);
+  logLevel = level;
+  return(old);
+}
+
+/*!
+  \brief Escreve uma mensagem com a severidade indicada, no formato de
+  printf; mensagens maiores que LOG_LINE sao truncadas
+
+  \return 0 em sucesso e -1 em erro
+*/
+int ppos_log (int level, const char *format, ...) {
+  char line[LOG_LINE];
+  va_list args;
+  int n;
+
+  if ( level < LOG_LEVEL_DEBUG || level > LOG_LEVEL_ERROR || !format )
+    return(-1);
+  if ( level < logLevel ) {
+    logStats.dropped++;
+    return(0);
+  }
+
+  va_start(args, format);
+  n = vsnprintf(line, LOG_LINE, format, args);
+  va_end(args);
+  if ( n < 0 )
+    return(-1);
+  if ( n >= LOG_LINE )
+    n = LOG_LINE - 1;
+
+  fwrite(line, 1, n, stdout);
+  if ( level == LOG_LEVEL_ERROR )
+    log_flush();
+
+  return(0);
+}
+
+/*!
+  \brief Consulta os contadores do registro
+
+  \return 0 em sucesso e -1 em erro
+*/
+int log_stats (log_stats_t *stats) {
+  if ( !stats )
+    return(-1);
+  preemptLock++;
+  *stats = logStats;
+  preemptLock--;
+  return(0);
+}
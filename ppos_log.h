@@ -0,0 +1,76 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Registro assincrono: as mensagens do nucleo e a saida padrao das tarefas
+// sao acumuladas em um anel em memoria e gravadas em lotes, em vez de uma
+// chamada write() por linha
+
+#ifndef __PPOS_LOG__
+#define __PPOS_LOG__
+
+// Com o registro ligado, stdout passa a ser um fluxo sem buffer cuja
+// escrita copia os bytes para o anel com a preempcao suspensa: cada
+// printf() chega inteiro ao anel, e as mensagens de todas as tarefas
+// ficam na ordem em que foram escritas. O dispatcher, que ja eh a tarefa
+// de sistema que roda entre as tarefas, grava o anel no descritor da saida
+// padrao original quando ha dados ha mais de LOG_FLUSH ms ou quando o anel
+// passa da metade. Se o anel encher, a tarefa que escreve o esvazia na
+// hora. O anel tambem eh esvaziado por exit(), pelas mensagens de erro e
+// pelos sinais que terminam o processo (falhas de segmentacao, abort(),
+// SIGINT, SIGTERM). ppos_init() liga o registro, exceto se PPOS_LOG=sync;
+// PPOS_LOG tambem aceita o nome de um nivel ("debug", "info", "warn" ou
+// "error") como nivel minimo das mensagens.
+
+#define LOG_RING   65536    // tamanho do anel (bytes)
+#define LOG_FLUSH  20       // atraso maximo (ms) de uma mensagem no anel
+#define LOG_LINE   1024     // tamanho maximo de uma mensagem de ppos_log()
+
+// niveis de severidade, em ordem crescente
+#define LOG_LEVEL_DEBUG  0
+#define LOG_LEVEL_INFO   1
+#define LOG_LEVEL_WARN   2
+#define LOG_LEVEL_ERROR  3
+
+// contadores do registro
+typedef struct
+{
+  unsigned long long bytes;   // bytes copiados para o anel
+  unsigned int records;       // escritas no anel (uma por printf/ppos_log)
+  unsigned int writes;        // chamadas write() ao gravar o anel
+  unsigned int flushes;       // gravacoes do anel
+  unsigned int stalls;        // gravacoes feitas por quem escreve, com o anel cheio
+  unsigned int dropped;       // mensagens abaixo do nivel minimo
+} log_stats_t ;
+
+// Todas as funcoes retornam -1 em erro ou 0 em sucesso, exceto quando
+// indicado.
+
+// liga o registro conforme PPOS_LOG (chamada por ppos_init())
+void log_init () ;
+
+// liga o registro: stdout passa a escrever no anel
+int log_start () ;
+
+// grava o anel e devolve stdout a saida sem buffer
+int log_stop () ;
+
+// grava imediatamente o conteudo do anel
+int log_flush () ;
+
+// grava o anel se o atraso ou a ocupacao justificarem (chamada pelo
+// dispatcher)
+void log_poll () ;
+
+// define o nivel minimo das mensagens de ppos_log(); retorna o anterior
+int log_level (int level) ;
+
+// escreve uma mensagem com a severidade indicada (formato de printf); as
+// de nivel LOG_LEVEL_ERROR sao gravadas imediatamente
+int ppos_log (int level, const char *format, ...)
+  __attribute__ ((format (printf, 2, 3))) ;
+
+// consulta os contadores do registro
+int log_stats (log_stats_t *stats) ;
+
+#endif
@@ -0,0 +1,478 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+#define _GNU_SOURCE     // dladdr()
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <execinfo.h>
+#include <dlfcn.h>
+#undef _XOPEN_SOURCE    // redefinido por ppos.h
+#include "ppos.h"
+#include "ppos_prof.h"
+
+// variáveis globais e constantes ==============================================
+
+extern task_t *currentTask;
+extern int userTasks;
+extern int preemptLock;
+
+#define PROF_SKIP  2        // quadros do tratador e do retorno do sinal
+#define PROF_HASH  4096     // faixas da tabela de pilhas
+#define PROF_NAME  128      // tamanho dos nomes de funcoes
+
+// pilha agregada
+typedef struct prof_stack_t
+{
+  struct prof_stack_t *next;  // proxima pilha da mesma faixa
+  prof_sample_t sample;       // tarefa e enderecos
+  unsigned long long count;   // amostras
+} prof_stack_t ;
+
+// funcao agregada (relatorio)
+typedef struct
+{
+  void *addr;                 // inicio da funcao
+  char name[PROF_NAME];
+  unsigned long long self;    // amostras como funcao interrompida
+  unsigned long long total;   // amostras com a funcao na pilha
+} prof_func_t ;
+
+static prof_sample_t profRing[PROF_RING];        // anel de amostras
+static volatile unsigned int profHead = 0;       // amostras escritas (tratador)
+static volatile unsigned int profTail = 0;       // amostras agregadas
+static volatile unsigned int profLost = 0;       // amostras descartadas
+static volatile int profOn = 0;                  // amostragem ligada?
+static int profHz = 0;                           // frequencia de amostragem
+
+static prof_stack_t *profTable[PROF_HASH];       // pilhas agregadas
+static unsigned int profStacks = 0;              // pilhas distintas
+static unsigned long long profTotal = 0;         // amostras agregadas
+
+static task_t profTask;                          // tarefa que esvazia o anel
+static int profTaskOn = 0;                       // tarefa existe?
+static char *profFile = NULL;                    // arquivo de PPOS_PROF
+
+// estrutura que define um tratador de sinal (deve ser global ou static)
+static struct sigaction profAction;
+
+// funções locais ==============================================================
+
+/*!
+  \brief Tratador do SIGPROF: copia a tarefa corrente e sua pilha para o
+  anel, sem alocar memoria
+*/
+static void prof_handler (int signum) {
+  void *pc[PROF_DEPTH + PROF_SKIP];
+  prof_sample_t *s;
+  int n;
+
+  if ( !profOn )
+    return;
+  if ( profHead - profTail >= PROF_RING ) {
+    profLost++;
+    return;
+  }
+
+  n = backtrace(pc, PROF_DEPTH + PROF_SKIP) - PROF_SKIP;
+  s = &profRing[profHead % PROF_RING];
+  s->task = currentTask ? currentTask->id : -1;
+  s->depth = n > 0 ? n : 0;
+  if ( n > 0 )
+    memcpy(s->pc, pc + PROF_SKIP, n * sizeof(void *));
+  profHead++;
+}
+
+/*!
+  \brief Faixa da tabela de pilhas de uma amostra
+*/
+static unsigned int prof_hash (prof_sample_t *s) {
+  unsigned long h = s->task * 2654435761UL;
+  int i;
+
+  for ( i = 0; i < s->depth; i++ )
+    h = (h ^ (unsigned long) s->pc[i]) * 1099511628211UL;
+  return( (h ^ (h >> 29)) % PROF_HASH );
+}
+
+/*!
+  \brief Soma uma amostra a sua pilha na tabela
+*/
+static void prof_add (prof_sample_t *s) {
+  unsigned int h = prof_hash(s);
+  prof_stack_t *st;
+
+  for ( st = profTable[h]; st; st = st->next )
+    if ( st->sample.task == s->task && st->sample.depth == s->depth &&
+         !memcmp(st->sample.pc, s->pc, s->depth * sizeof(void *)) )
+      break;
+
+  if ( !st ) {
+    if ( !(st = calloc(1, sizeof(prof_stack_t))) ) {
+      fprintf(stderr, "[PPOS error] prof_add: fail to allocate a stack\n");
+      return;
+    }
+    st->sample = *s;
+    st->next = profTable[h];
+    profTable[h] = st;
+    profStacks++;
+  }
+  st->count++;
+  profTotal++;
+}
+
+/*!
+  \brief Agrega as amostras do anel (sem preempcao, pois a tarefa de servico
+  e prof_stop() podem faze-lo)
+*/
+static void prof_drain () {
+  preemptLock++;
+  while ( profTail != profHead ) {
+    prof_add(&profRing[profTail % PROF_RING]);
+    profTail++;
+  }
+  preemptLock--;
+}
+
+/*!
+  \brief Corpo da tarefa que esvazia o anel enquanto a amostragem estiver
+  ligada
+*/
+static void prof_body (void *arg) {
+  while ( profOn ) {
+    prof_drain();
+    task_sleep(PROF_DRAIN);
+  }
+  prof_drain();
+  profTaskOn = 0;
+
+  // a tarefa nao era contada como tarefa de usuario (ver prof_start)
+  userTasks++;
+  task_exit(0);
+}
+
+/*!
+  \brief Nome da funcao que contem um endereco da pilha
+
+  \param pc Endereco
+  \param caller 1 se pc eh endereco de retorno (aponta apos a chamada)
+  \param name Nome da funcao, da biblioteca ou o endereco
+  \return Inicio da funcao (ou o endereco, se desconhecida)
+*/
+static void *prof_symbol (void *pc, int caller, char *name) {
+  void *addr = (char *) pc - caller;
+  const char *base;
+  Dl_info info;
+
+  if ( dladdr(addr, &info) ) {
+    if ( info.dli_sname && info.dli_saddr ) {
+      snprintf(name, PROF_NAME, "%s", info.dli_sname);
+      return(info.dli_saddr);
+    }
+    // funcao static ou sem simbolo exportado: agrupada por biblioteca
+    if ( info.dli_fname ) {
+      base = strrchr(info.dli_fname, '/');
+      snprintf(name, PROF_NAME, "[%s]", base ? base + 1 : info.dli_fname);
+      return(info.dli_fbase);
+    }
+  }
+  snprintf(name, PROF_NAME, "%p", addr);
+  return(addr);
+}
+
+/*!
+  \brief Ordena funcoes por amostras proprias, decrescente
+*/
+static int prof_cmp_self (const void *a, const void *b) {
+  const prof_func_t *fa = a, *fb = b;
+
+  return( fa->self < fb->self ? 1 : fa->self > fb->self ? -1 : 0 );
+}
+
+/*!
+  \brief Ordena funcoes por amostras totais, decrescente
+*/
+static int prof_cmp_total (const void *a, const void *b) {
+  const prof_func_t *fa = a, *fb = b;
+
+  return( fa->total < fb->total ? 1 : fa->total > fb->total ? -1 : 0 );
+}
+
+/*!
+  \brief Grava as pilhas no arquivo de PPOS_PROF ao fim do programa
+*/
+static void prof_atexit () {
+  FILE *f;
+
+  prof_stop();
+  if ( !(f = fopen(profFile, "w")) || prof_folded(f) )
+    fprintf(stderr, "[PPOS error] prof_atexit: fail to write %s\n", profFile);
+  if ( f )
+    fclose(f);
+}
+
+// funções gerais ==============================================================
+
+/*!
+  \brief Liga a amostragem
+
+  \param hz Amostras por segundo de CPU (0 = PROF_HZ)
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int prof_start (int hz) {
+  struct itimerval timer;
+  void *warm[PROF_DEPTH];
+
+  if ( hz < 0 || hz > 1000000 )
+    return(-1);
+  if ( !hz )
+    hz = PROF_HZ;
+
+  // backtrace() carrega o desenrolador de pilha na primeira chamada; isso
+  // nao pode acontecer dentro do tratador
+  backtrace(warm, PROF_DEPTH);
+
+  profAction.sa_handler = prof_handler;
+  sigemptyset(&profAction.sa_mask);
+  profAction.sa_flags = SA_RESTART;
+  if ( sigaction(SIGPROF, &profAction, 0) < 0 ) {
+    perror("[PPOS error] prof_start: sigaction");
+    return(-1);
+  }
+
+  // tarefa de servico, que nao conta como tarefa de usuario
+  profOn = 1;
+  profHz = hz;
+  if ( !profTaskOn ) {
+    if ( task_create(&profTask, prof_body, NULL) < 0 ) {
+      profOn = 0;
+      return(-1);
+    }
+    userTasks--;
+    profTaskOn = 1;
+  }
+
+  // ITIMER_PROF conta o tempo de CPU do processo
+  timer.it_value.tv_sec = timer.it_interval.tv_sec = 1 / hz;
+  timer.it_value.tv_usec = timer.it_interval.tv_usec = ( 1000000 / hz ) % 1000000;
+  if ( setitimer(ITIMER_PROF, &timer, 0) < 0 ) {
+    perror("[PPOS error] prof_start: setitimer");
+    profOn = 0;
+    return(-1);
+  }
+
+  return(0);
+}
+
+/*!
+  \brief Desliga a amostragem e agrega as amostras restantes do anel
+
+  \return 0
+*/
+int prof_stop () {
+  struct itimerval timer;
+
+  memset(&timer, 0, sizeof(timer));
+  setitimer(ITIMER_PROF, &timer, 0);
+  profOn = 0;
+  prof_drain();
+
+  return(0);
+}
+
+/*!
+  \brief Descarta as amostras agregadas e as do anel
+
+  \return 0
+*/
+int prof_clear () {
+  prof_stack_t *st, *next;
+  int h;
+
+  preemptLock++;
+  profTail = profHead;
+  for ( h = 0; h < PROF_HASH; h++ ) {
+    for ( st = profTable[h]; st; st = next ) {
+      next = st->next;
+      free(st);
+    }
+    profTable[h] = NULL;
+  }
+  profStacks = profLost = 0;
+  profTotal = 0;
+  preemptLock--;
+
+  return(0);
+}
+
+/*!
+  \brief Consulta os contadores do perfilador
+
+  \param stats Contadores
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int prof_stats (prof_stats_t *stats) {
+  if ( !stats )
+    return(-1);
+
+  stats->samples = profTotal;
+  stats->lost = profLost;
+  stats->stacks = profStacks;
+  stats->hz = profHz;
+
+  return(0);
+}
+
+/*!
+  \brief Amostras agregadas de uma tarefa
+
+  \param id Tarefa (-1 = todas)
+
+  \return Numero de amostras
+*/
+unsigned long long prof_samples (int id) {
+  unsigned long long n = 0;
+  prof_stack_t *st;
+  int h;
+
+  if ( id < 0 )
+    return(profTotal);
+  for ( h = 0; h < PROF_HASH; h++ )
+    for ( st = profTable[h]; st; st = st->next )
+      if ( st->sample.task == id )
+        n += st->count;
+  return(n);
+}
+
+/*!
+  \brief Escreve as amostras por tarefa e as funcoes com mais amostras
+
+  \param f Arquivo de saida
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int prof_report (FILE *f) {
+  prof_func_t *funcs = NULL, *fn;
+  unsigned long long *tasks;
+  prof_stack_t *st;
+  char name[PROF_NAME];
+  void *addr, *seen[PROF_DEPTH];
+  int h, i, j, k, nfuncs = 0, maxfuncs = 0, maxtask = -1;
+  double total;
+
+  if ( !f )
+    return(-1);
+
+  total = profTotal ? profTotal : 1;
+  fprintf(f, "%llu amostras a %d Hz (%u perdidas), %u pilhas\n", profTotal, profHz,
+          profLost, profStacks);
+
+  // amostras por tarefa (a posicao 0 conta as amostras sem tarefa)
+  for ( h = 0; h < PROF_HASH; h++ )
+    for ( st = profTable[h]; st; st = st->next )
+      if ( st->sample.task > maxtask )
+        maxtask = st->sample.task;
+  if ( !(tasks = calloc(maxtask + 2, sizeof(unsigned long long))) )
+    return(-1);
+  for ( h = 0; h < PROF_HASH; h++ )
+    for ( st = profTable[h]; st; st = st->next )
+      tasks[st->sample.task + 1] += st->count;
+  fprintf(f, "%-8s %10s %7s\n", "tarefa", "amostras", "%");
+  for ( i = 0; i <= maxtask + 1; i++ )
+    if ( tasks[i] )
+      fprintf(f, "%-8d %10llu %7.1f\n", i - 1, tasks[i], 100.0 * tasks[i] / total);
+  free(tasks);
+
+  // amostras por funcao: propria para a interrompida, total para cada
+  // funcao distinta da pilha
+  for ( h = 0; h < PROF_HASH; h++ )
+    for ( st = profTable[h]; st; st = st->next )
+      for ( i = 0; i < st->sample.depth; i++ ) {
+        addr = prof_symbol(st->sample.pc[i], i > 0, name);
+        for ( k = 0; k < i && seen[k] != addr; k++ ) ;
+        seen[i] = addr;
+        for ( j = 0; j < nfuncs && funcs[j].addr != addr; j++ ) ;
+        if ( j == nfuncs ) {
+          if ( nfuncs == maxfuncs ) {
+            maxfuncs = maxfuncs ? 2 * maxfuncs : 64;
+            if ( !(fn = realloc(funcs, maxfuncs * sizeof(prof_func_t))) ) {
+              free(funcs);
+              return(-1);
+            }
+            funcs = fn;
+          }
+          memset(&funcs[j], 0, sizeof(prof_func_t));
+          funcs[j].addr = addr;
+          strcpy(funcs[j].name, name);
+          nfuncs++;
+        }
+        if ( !i )
+          funcs[j].self += st->count;
+        if ( k == i )
+          funcs[j].total += st->count;
+      }
+
+  qsort(funcs, nfuncs, sizeof(prof_func_t), prof_cmp_self);
+  fprintf(f, "%-32s %10s %7s\n", "funcao (propria)", "amostras", "%");
+  for ( i = 0; i < nfuncs && i < PROF_TOP && funcs[i].self; i++ )
+    fprintf(f, "%-32s %10llu %7.1f\n", funcs[i].name, funcs[i].self, 100.0 * funcs[i].self / total);
+
+  qsort(funcs, nfuncs, sizeof(prof_func_t), prof_cmp_total);
+  fprintf(f, "%-32s %10s %7s\n", "funcao (total)", "amostras", "%");
+  for ( i = 0; i < nfuncs && i < PROF_TOP; i++ )
+    fprintf(f, "%-32s %10llu %7.1f\n", funcs[i].name, funcs[i].total, 100.0 * funcs[i].total / total);
+
+  free(funcs);
+  return(0);
+}
+
+/*!
+  \brief Escreve as pilhas no formato folded dos flamegraphs: a tarefa e as
+  funcoes, da mais externa para a interrompida, e o numero de amostras
+
+  \param f Arquivo de saida
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int prof_folded (FILE *f) {
+  prof_stack_t *st;
+  char name[PROF_NAME];
+  int h, i;
+
+  if ( !f )
+    return(-1);
+
+  for ( h = 0; h < PROF_HASH; h++ )
+    for ( st = profTable[h]; st; st = st->next ) {
+      fprintf(f, "task%d", st->sample.task);
+      for ( i = st->sample.depth - 1; i >= 0; i-- ) {
+        prof_symbol(st->sample.pc[i], i > 0, name);
+        fprintf(f, ";%s", name);
+      }
+      fprintf(f, " %llu\n", st->count);
+    }
+
+  return(0);
+}
+
+/*!
+  \brief Liga o perfilador se a variavel de ambiente PPOS_PROF estiver
+  definida (chamada por ppos_init()); as pilhas sao gravadas no arquivo
+  indicado ao fim do programa
+*/
+void prof_init () {
+  char *file = getenv("PPOS_PROF");
+
+  if ( !file || !*file || profFile )
+    return;
+
+  profFile = file;
+  if ( prof_start(0) == 0 )
+    atexit(prof_atexit);
+}
@@ -0,0 +1,75 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Perfilador por amostragem: o sinal SIGPROF interrompe o processo a cada
+// 1/hz s de CPU e registra a tarefa corrente e a pilha de chamadas dela,
+// atribuindo o tempo de CPU as tarefas do ppos (que o perfilador do sistema
+// hospedeiro enxerga como uma unica thread)
+
+#ifndef __PPOS_PROF__
+#define __PPOS_PROF__
+
+#include <stdio.h>
+
+// O tratador de sinal apenas copia a tarefa e os enderecos de retorno da
+// pilha para um anel de tamanho fixo, sem alocar memoria; uma tarefa de
+// servico esvazia o anel periodicamente, agregando as amostras por pilha.
+// Os nomes das funcoes sao obtidos com dladdr() na hora dos relatorios (o
+// programa deve ser ligado com -rdynamic). Se a variavel de ambiente
+// PPOS_PROF estiver definida, ppos_init() liga o perfilador e as pilhas sao
+// gravadas no arquivo indicado ao fim do programa, no formato "folded" dos
+// flamegraphs (uma linha "tarefa;funcao;...;funcao amostras" por pilha).
+
+#define PROF_HZ     1000    // amostras por segundo de CPU, se nao informado
+#define PROF_DEPTH  16      // enderecos guardados de cada pilha
+#define PROF_RING   4096    // amostras do anel
+#define PROF_DRAIN  10      // intervalo (ms) da tarefa que esvazia o anel
+#define PROF_TOP    20      // funcoes listadas por prof_report()
+
+// amostra: tarefa corrente e pilha, da funcao interrompida para as chamadoras
+typedef struct
+{
+  int task;                   // tarefa corrente (-1 = nenhuma)
+  int depth;                  // enderecos validos em pc
+  void *pc[PROF_DEPTH];       // enderecos da pilha
+} prof_sample_t ;
+
+// contadores do perfilador
+typedef struct
+{
+  unsigned long long samples;  // amostras agregadas desde prof_clear()
+  unsigned int lost;           // amostras descartadas com o anel cheio
+  unsigned int stacks;         // pilhas distintas
+  int hz;                      // frequencia de amostragem
+} prof_stats_t ;
+
+// Todas as funcoes retornam -1 em erro ou 0 em sucesso, exceto quando
+// indicado.
+
+// liga o perfilador se PPOS_PROF estiver definida (chamada por ppos_init())
+void prof_init () ;
+
+// liga a amostragem com hz amostras por segundo de CPU (0 = PROF_HZ)
+int prof_start (int hz) ;
+
+// desliga a amostragem e agrega as amostras que ainda estao no anel
+int prof_stop () ;
+
+// descarta as amostras agregadas
+int prof_clear () ;
+
+// consulta os contadores do perfilador
+int prof_stats (prof_stats_t *stats) ;
+
+// amostras agregadas da tarefa id (-1 = todas)
+unsigned long long prof_samples (int id) ;
+
+// escreve em f as amostras por tarefa e as PROF_TOP funcoes com mais
+// amostras, proprias (funcao interrompida) e totais (funcao na pilha)
+int prof_report (FILE *f) ;
+
+// escreve em f as pilhas no formato folded, com a tarefa como raiz
+int prof_folded (FILE *f) ;
+
+#endif
@@ -0,0 +1,156 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "ppos.h"
+#include "ppos_raid.h"
+
+// funções locais ==============================================================
+
+/*!
+  \brief Traduz um bloco logico do volume para disco e bloco fisico
+
+  \param vol Volume
+  \param block Bloco logico
+  \param dev Recebe o numero do disco
+  \param phys Recebe o bloco no disco
+
+  \return Blocos restantes na unidade de distribuicao a partir de block
+*/
+static int raid0_map (raid0_t *vol, int block, int *dev, int *phys) {
+  int unit = block / vol->stripe, offset = block % vol->stripe;
+
+  *dev = vol->devs[unit % vol->ndevs];
+  *phys = (unit / vol->ndevs) * vol->stripe + offset;
+
+  return ( vol->stripe - offset );
+}
+
+/*!
+  \brief Divide uma faixa de blocos em pedidos por disco, envia todos e
+  aguarda a conclusao de todos
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int raid0_request (raid0_t *vol, int type, int block, int count, void **buffers) {
+  request_t *reqs;
+  int i, n, nreqs, dev, phys, result = 0;
+
+  if ( !vol || !buffers || count < 1 || block < 0 || block + count > vol->numBlocks )
+    return(-1);
+
+  // um pedido por unidade tocada, unidades maiores que DISK_VEC_MAX divididas
+  n = ( vol->stripe < DISK_VEC_MAX ) ? vol->stripe : DISK_VEC_MAX;
+  nreqs = count / n + count / vol->stripe + 2;
+  reqs = malloc(nreqs * sizeof(request_t));
+  if ( !reqs )
+    return(-1);
+
+  for ( i = 0; count > 0; i++ ) {
+    n = raid0_map(vol, block, &dev, &phys);
+    if ( n > count )
+      n = count;
+    if ( n > DISK_VEC_MAX )
+      n = DISK_VEC_MAX;
+    if ( disk_dev_submit(dev, &reqs[i], type, phys, n, buffers) ) {
+      result = -1;
+      break;
+    }
+    block += n;
+    buffers += n;
+    count -= n;
+  }
+
+  // aguarda os pedidos enviados
+  nreqs = i;
+  for ( i = 0; i < nreqs; i++ )
+    if ( disk_dev_wait(&reqs[i]) )
+      result = -1;
+
+  free(reqs);
+
+  return(result);
+}
+
+// funções gerais ==============================================================
+
+/*!
+  \brief Cria um volume RAID-0
+
+  \param vol Volume a ser criado
+  \param ndevs Quantidade de discos
+  \param devs Numeros dos discos, ja inicializados
+  \param stripe Blocos por unidade de distribuicao
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int raid0_create (raid0_t *vol, int ndevs, int *devs, int stripe) {
+  int i, numBlocks, blockSize, minBlocks = 0;
+
+  if ( !vol || !devs || ndevs < 1 || ndevs > DISK_MAX_DEVICES || stripe < 1 )
+    return(-1);
+
+  vol->ndevs = ndevs;
+  vol->stripe = stripe;
+  vol->blockSize = 0;
+
+  for ( i = 0; i < ndevs; i++ ) {
+    if ( disk_dev_geometry(devs[i], &numBlocks, &blockSize) ) {
+      fprintf(stderr, "[PPOS error] raid0_create: disk %d not initialized\n", devs[i]);
+      return(-1);
+    }
+    if ( vol->blockSize && blockSize != vol->blockSize ) {
+      fprintf(stderr, "[PPOS error] raid0_create: disk %d block size mismatch\n", devs[i]);
+      return(-1);
+    }
+    vol->blockSize = blockSize;
+    vol->devs[i] = devs[i];
+    if ( i == 0 || numBlocks < minBlocks )
+      minBlocks = numBlocks;
+  }
+
+  // apenas unidades completas em todos os discos sao usadas
+  vol->numBlocks = (minBlocks / stripe) * stripe * ndevs;
+  if ( vol->numBlocks == 0 )
+    return(-1);
+
+  return(0);
+}
+
+/*!
+  \brief Leitura de um bloco do volume
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int raid0_block_read (raid0_t *vol, int block, void *buffer) {
+  return ( raid0_request(vol, READ_OPERATION, block, 1, &buffer) );
+}
+
+/*!
+  \brief Escrita de um bloco do volume
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int raid0_block_write (raid0_t *vol, int block, void *buffer) {
+  return ( raid0_request(vol, WRITE_OPERATION, block, 1, &buffer) );
+}
+
+/*!
+  \brief Leitura de blocos contiguos do volume
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int raid0_block_readv (raid0_t *vol, int block, int count, void **buffers) {
+  return ( raid0_request(vol, READ_OPERATION, block, count, buffers) );
+}
+
+/*!
+  \brief Escrita de blocos contiguos do volume
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int raid0_block_writev (raid0_t *vol, int block, int count, void **buffers) {
+  return ( raid0_request(vol, WRITE_OPERATION, block, count, buffers) );
+}
@@ -0,0 +1,39 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Volume RAID-0 (striping) sobre vários discos do gerente de disco
+
+#ifndef __PPOS_RAID__
+#define __PPOS_RAID__
+
+#include "ppos_disk.h"
+
+// Os blocos lógicos do volume são distribuídos em unidades de "stripe"
+// blocos consecutivos, alternadas entre os discos: a unidade u fica no disco
+// u % ndevs, a partir do bloco (u / ndevs) * stripe. Operações sobre faixas
+// de blocos são enviadas a todos os discos envolvidos ao mesmo tempo.
+
+// estrutura que representa um volume RAID-0
+typedef struct
+{
+  int ndevs;                    // quantidade de discos do volume
+  int devs[DISK_MAX_DEVICES];   // discos do volume, na ordem de distribuicao
+  int stripe;                   // blocos por unidade de distribuicao
+  int numBlocks;                // tamanho do volume, em blocos
+  int blockSize;                // tamanho de cada bloco, em bytes
+} raid0_t ;
+
+// cria um volume sobre ndevs discos ja inicializados (disk_dev_mgr_init),
+// todos com o mesmo tamanho de bloco; retorna -1 em erro ou 0 em sucesso
+int raid0_create (raid0_t *vol, int ndevs, int *devs, int stripe) ;
+
+// leitura/escrita de um bloco do volume
+int raid0_block_read (raid0_t *vol, int block, void *buffer) ;
+int raid0_block_write (raid0_t *vol, int block, void *buffer) ;
+
+// leitura/escrita de count blocos contiguos do volume, um buffer por bloco
+int raid0_block_readv (raid0_t *vol, int block, int count, void **buffers) ;
+int raid0_block_writev (raid0_t *vol, int block, int count, void **buffers) ;
+
+#endif
@@ -0,0 +1,385 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+#define _GNU_SOURCE     // dladdr()
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <dlfcn.h>
+#undef _XOPEN_SOURCE    // redefinido por ppos.h
+#include "ppos.h"
+#include "ppos_stack.h"
+
+// variáveis globais e constantes ==============================================
+
+extern task_t *taskList;
+extern int preemptLock;
+
+static stack_entry_t stackTable[STACK_ENTRIES];  // funcoes de entrada
+static int stackCount = 0;                       // funcoes na tabela
+static int stackAuto = 0;                        // dimensionamento ligado?
+static int stackMeasure = 0;                     // medicao ligada?
+static char *stackFile = NULL;                   // arquivo de PPOS_STACK
+
+// funções locais ==============================================================
+
+/*!
+  \brief Nome de uma funcao de entrada; funcoes sem simbolo exportado
+  (static) recebem o endereco, que nao vale entre execucoes
+*/
+static void stack_name (void *entry, char *name) {
+  Dl_info info;
+
+  if ( dladdr(entry, &info) && info.dli_sname && info.dli_saddr == entry )
+    snprintf(name, STACK_NAME, "%s", info.dli_sname);
+  else
+    snprintf(name, STACK_NAME, "%p", entry);
+}
+
+/*!
+  \brief Procura uma funcao na tabela pelo endereco ou, se entry for NULL,
+  pelo nome; uma funcao carregada pelo nome recebe o endereco aqui. Deve
+  ser chamada com a preempcao suspensa
+
+  \param create 1 para incluir a funcao se ela nao estiver na tabela
+  \return entrada da funcao ou NULL (nao encontrada ou tabela cheia)
+*/
+static stack_entry_t *stack_entry (void *entry, const char *name, int create) {
+  char buf[STACK_NAME];
+  stack_entry_t *e;
+  int i;
+
+  for ( i = 0; entry && i < stackCount; i++ )
+    if ( stackTable[i].entry == entry )
+      return(&stackTable[i]);
+
+  if ( !name ) {
+    stack_name(entry, buf);
+    name = buf;
+  }
+  // pelo nome: funcao carregada de outra execucao, ainda sem endereco
+  for ( i = 0; i < stackCount; i++ )
+    if ( ( !entry || !stackTable[i].entry ) && !strcmp(stackTable[i].name, name) ) {
+      if ( entry )
+        stackTable[i].entry = entry;
+      return(&stackTable[i]);
+    }
+
+  if ( !create || stackCount == STACK_ENTRIES )
+    return(NULL);
+  e = &stackTable[stackCount++];
+  memset(e, 0, sizeof(stack_entry_t));
+  e->entry = entry;
+  snprintf(e->name, STACK_NAME, "%s", name);
+  return(e);
+}
+
+/*!
+  \brief Tamanho de pilha para um pico de max bytes
+*/
+static unsigned int stack_learn (unsigned int max) {
+  unsigned int size = max * STACK_MARGIN;
+
+  size = ( size + STACK_ROUND - 1 ) / STACK_ROUND * STACK_ROUND;
+  if ( size < STACK_MIN )
+    size = STACK_MIN;
+  if ( size > STACKSIZE )
+    size = STACKSIZE;
+  return(size);
+}
+
+/*!
+  \brief Bytes sobrescritos de uma pilha pintada, do topo ate o ponto mais
+  fundo que ja foi usado
+*/
+static unsigned int stack_scan (const char *base, unsigned int size) {
+  const unsigned long paint = ~0UL / 0xff * STACK_PAINT;
+  unsigned int i = 0;
+
+  while ( i + sizeof(long) <= size && *(const unsigned long *) (base + i) == paint )
+    i += sizeof(long);
+  while ( i < size && (unsigned char) base[i] == STACK_PAINT )
+    i++;
+  return(size - i);
+}
+
+/*!
+  \brief Grava os tamanhos aprendidos ao fim do programa
+*/
+static void stack_atexit () {
+  if ( stackFile && stack_save(stackFile) )
+    fprintf(stderr, "[PPOS error]: stack: saving %s\n", stackFile);
+}
+
+// funções gerais ==============================================================
+
+/*!
+  \brief Liga o dimensionamento automatico se a variavel de ambiente
+  PPOS_STACK indicar um arquivo, carregando os tamanhos ja aprendidos
+*/
+void stack_init () {
+  char *file = getenv("PPOS_STACK");
+
+  if ( !file || !*file )
+    return;
+  stackFile = file;
+  stack_autosize(1);
+  stack_load(file);   // o arquivo ainda nao existe na primeira execucao
+  atexit(stack_atexit);
+}
+
+/*!
+  \brief Aloca a pilha de uma nova tarefa, pintada inteira com a medicao
+  ligada ou apenas no fundo (STACK_GUARD bytes) com ela desligada
+
+  \param task Tarefa criada, com a funcao de entrada ja definida
+  \param size Tamanho da pilha alocada
+
+  \return pilha alocada ou NULL em erro
+*/
+void *stack_alloc (task_t *task, unsigned int *size) {
+  stack_entry_t *e;
+  char *stack;
+
+  *size = STACKSIZE;
+  if ( stackAuto ) {
+    preemptLock++;
+    e = stack_entry(task->entry, NULL, 1);
+    if ( e && e->size )
+      *size = e->size;
+    preemptLock--;
+  }
+
+  if ( !(stack = malloc(*size)) )
+    return(NULL);
+  task->stack_paint = stackMeasure;
+  memset(stack, STACK_PAINT, stackMeasure ? *size : STACK_GUARD);
+  return(stack);
+}
+
+/*!
+  \brief Mede o pico de uso da pilha de uma tarefa terminada e o agrega a
+  funcao de entrada dela; avisa se a tarefa chegou ao fundo da pilha.
+  Chamada pelo despachante, que nao eh preemptado, antes de liberar a pilha
+
+  \param task Tarefa terminada (a pilha ainda existe)
+*/
+void stack_exit (task_t *task) {
+  unsigned int size = task->context.uc_stack.ss_size;
+  stack_entry_t *e;
+  int overflow;
+
+  if ( !task->context.uc_stack.ss_sp || !size || !task->entry )
+    return;
+
+  // sem a medicao, so o fundo da pilha foi pintado
+  if ( task->stack_paint ) {
+    task->stack_max = stack_scan(task->context.uc_stack.ss_sp, size);
+    overflow = ( task->stack_max > size - STACK_GUARD );
+  } else
+    overflow = ( stack_scan(task->context.uc_stack.ss_sp, STACK_GUARD) > 0 );
+  if ( !task->stack_paint && !overflow )
+    return;
+
+  preemptLock++;
+  if ( (e = stack_entry(task->entry, NULL, 1)) ) {
+    if ( task->stack_paint ) {
+      e->tasks++;
+      e->sum += task->stack_max;
+      if ( task->stack_max > e->max )
+        e->max = task->stack_max;
+    }
+    if ( overflow ) {
+      e->overflows++;
+      fprintf(stderr, "[PPOS error]: stack: task %d (%s) reached the bottom of its %u-byte stack\n",
+              task->id, e->name, size);
+    }
+    // depois de um estouro, a funcao volta a receber a pilha padrao
+    e->size = e->overflows ? STACKSIZE : stack_learn(e->max);
+  }
+  preemptLock--;
+}
+
+/*!
+  \brief Pico de uso da pilha de uma tarefa
+
+  \param task Tarefa consultada
+
+  \return bytes usados ou -1 se a pilha nao foi pintada (tarefa main ou
+  criada com a medicao desligada)
+*/
+long stack_used (task_t *task) {
+  if ( !task || !task->entry || !task->stack_paint )
+    return(-1);
+  if ( task->context.uc_stack.ss_sp && task->context.uc_stack.ss_size )
+    return(stack_scan(task->context.uc_stack.ss_sp, task->context.uc_stack.ss_size));
+  return(task->stack_max);
+}
+
+/*!
+  \brief Liga ou desliga a medicao (pintura completa) das pilhas das
+  tarefas criadas a partir de agora
+
+  \param on 1 para ligar, 0 para desligar
+
+  \return 0 em sucesso e -1 em erro
+*/
+int stack_measure (int on) {
+  if ( on != 0 && on != 1 )
+    return(-1);
+  stackMeasure = on;
+  return(0);
+}
+
+/*!
+  \brief Liga ou desliga o dimensionamento automatico das pilhas; ligar o
+  dimensionamento liga tambem a medicao, que fornece os picos
+
+  \param on 1 para ligar, 0 para desligar
+
+  \return 0 em sucesso e -1 em erro
+*/
+int stack_autosize (int on) {
+  if ( on != 0 && on != 1 )
+    return(-1);
+  stackAuto = on;
+  if ( on )
+    stackMeasure = 1;
+  return(0);
+}
+
+/*!
+  \brief Copia as funcoes de entrada acompanhadas
+
+  \param entries Vetor de saida
+  \param max Tamanho do vetor
+
+  \return quantidade de funcoes acompanhadas ou -1 em erro
+*/
+int stack_stats (stack_entry_t *entries, int max) {
+  int n;
+
+  if ( !entries || max < 0 )
+    return(-1);
+  preemptLock++;
+  n = stackCount;
+  memcpy(entries, stackTable, ( n < max ? n : max ) * sizeof(stack_entry_t));
+  preemptLock--;
+  return(n);
+}
+
+/*!
+  \brief Escreve o uso de pilha por funcao de entrada: tarefas terminadas
+  (pico maximo e medio) e tarefas vivas (pico ate agora)
+
+  \param f Arquivo de saida
+
+  \return 0 em sucesso e -1 em erro
+*/
+int stack_report (FILE *f) {
+  stack_entry_t *table;
+  unsigned int *live, *liveMax;
+  task_t *task;
+  long used;
+  int i, n;
+
+  if ( !f )
+    return(-1);
+
+  table = malloc(STACK_ENTRIES * sizeof(stack_entry_t));
+  live = calloc(STACK_ENTRIES, sizeof(unsigned int));
+  liveMax = calloc(STACK_ENTRIES, sizeof(unsigned int));
+  if ( !table || !live || !liveMax ) {
+    free(table);
+    free(live);
+    free(liveMax);
+    return(-1);
+  }
+
+  preemptLock++;
+  n = stack_stats(table, STACK_ENTRIES);
+  for ( task = taskList; task; task = task->reg_next ) {
+    if ( task->status == 2 || (used = stack_used(task)) < 0 )
+      continue;
+    for ( i = 0; i < n && table[i].entry != task->entry; i++ )
+      ;
+    if ( i < n ) {
+      live[i]++;
+      if ( used > liveMax[i] )
+        liveMax[i] = used;
+    }
+  }
+  preemptLock--;
+
+  fprintf(f, "%-24s %7s %7s %7s %6s %7s %8s %8s\n", "funcao", "tarefas", "pico",
+          "medio", "vivas", "pico", "proxima", "estouros");
+  for ( i = 0; i < n; i++ )
+    fprintf(f, "%-24s %7u %7u %7llu %6u %7u %8u %8u\n", table[i].name, table[i].tasks,
+            table[i].max, table[i].tasks ? table[i].sum / table[i].tasks : 0, live[i],
+            liveMax[i], ( stackAuto && table[i].size ) ? table[i].size : STACKSIZE,
+            table[i].overflows);
+
+  free(table);
+  free(live);
+  free(liveMax);
+  return(0);
+}
+
+/*!
+  \brief Carrega tamanhos aprendidos em outra execucao
+
+  \param file Arquivo com linhas "funcao tamanho pico"
+
+  \return 0 em sucesso e -1 em erro
+*/
+int stack_load (const char *file) {
+  char name[STACK_NAME];
+  unsigned int size, max;
+  stack_entry_t *e;
+  FILE *f;
+
+  if ( !file || !(f = fopen(file, "r")) )
+    return(-1);
+
+  preemptLock++;
+  while ( fscanf(f, "%63s %u %u", name, &size, &max) == 3 ) {
+    if ( size < STACK_MIN || size > STACKSIZE )
+      continue;
+    if ( !(e = stack_entry(NULL, name, 0)) ) {
+      // ainda sem endereco: associada pelo nome na primeira task_create()
+      if ( stackCount == STACK_ENTRIES )
+        break;
+      e = &stackTable[stackCount++];
+      memset(e, 0, sizeof(stack_entry_t));
+      snprintf(e->name, STACK_NAME, "%s", name);
+    }
+    e->size = size;
+    if ( max > e->max )
+      e->max = max;
+  }
+  preemptLock--;
+
+  fclose(f);
+  return(0);
+}
+
+/*!
+  \brief Grava os tamanhos aprendidos das funcoes com nome
+
+  \param file Arquivo de saida
+
+  \return 0 em sucesso e -1 em erro
+*/
+int stack_save (const char *file) {
+  FILE *f;
+  int i;
+
+  if ( !file || !(f = fopen(file, "w")) )
+    return(-1);
+  for ( i = 0; i < stackCount; i++ )
+    if ( stackTable[i].size && strncmp(stackTable[i].name, "0x", 2) )
+      fprintf(f, "%s %u %u\n", stackTable[i].name, stackTable[i].size, stackTable[i].max);
+  return( fclose(f) ? -1 : 0 );
+}
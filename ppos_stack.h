@@ -0,0 +1,89 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Medicao do uso de pilha das tarefas e dimensionamento automatico: com a
+// medicao ligada, as pilhas sao pintadas em task_create() e o pico de uso
+// (a parte da pintura que foi sobrescrita) eh medido pelo despachante
+// quando a tarefa termina e sob demanda, agregado por funcao de entrada
+// das tarefas. Com a medicao desligada (padrao), apenas os STACK_GUARD
+// bytes do fundo sao pintados e task_create() custa o mesmo que sem este
+// modulo.
+
+#ifndef __PPOS_STACK__
+#define __PPOS_STACK__
+
+#include <stdio.h>
+#include "ppos_data.h"
+
+// Com o dimensionamento automatico ligado, task_create() aloca para cada
+// funcao de entrada STACK_MARGIN vezes o maior pico ja observado nas
+// tarefas dela, arredondado para STACK_ROUND e limitado a STACK_MIN e
+// STACKSIZE. Os tratadores de sinal rodam na pilha da tarefa interrompida,
+// entao o pico inclui os quadros deles quando chegaram no ponto mais
+// fundo. Se uma tarefa tocar os STACK_GUARD bytes do fundo da pilha, o
+// estouro eh avisado e a funcao volta a receber STACKSIZE (o aviso vale
+// tambem com a medicao desligada). O dimensionamento liga a medicao. Se a
+// variavel de ambiente PPOS_STACK indicar um arquivo, ppos_init() liga o
+// dimensionamento, carrega os tamanhos aprendidos em execucoes anteriores
+// (pelo nome das funcoes, o programa deve ser ligado com -rdynamic) e os
+// grava de volta ao fim do programa.
+
+#define STACKSIZE     (64*1024)  // tamanho padrao da pilha das tarefas
+#define STACK_MIN     (16*1024)  // menor pilha alocada automaticamente
+#define STACK_MARGIN  2          // fator sobre o pico observado
+#define STACK_ROUND   4096       // granularidade das pilhas automaticas
+#define STACK_GUARD   256        // fundo da pilha que nunca deve ser tocado
+#define STACK_PAINT   0xa5       // byte de pintura das pilhas
+#define STACK_ENTRIES 256        // funcoes de entrada acompanhadas
+#define STACK_NAME    64         // tamanho dos nomes das funcoes
+
+// uso de pilha das tarefas de uma funcao de entrada
+typedef struct
+{
+  void *entry;                // funcao de entrada (NULL = so carregada)
+  char name[STACK_NAME];      // nome da funcao
+  unsigned int tasks;         // tarefas terminadas
+  unsigned int max;           // maior pico (bytes)
+  unsigned long long sum;     // soma dos picos (bytes)
+  unsigned int size;          // pilha alocada as novas tarefas (bytes)
+  unsigned int overflows;     // tarefas que tocaram o fundo da pilha
+} stack_entry_t ;
+
+// Todas as funcoes retornam -1 em erro ou 0 em sucesso, exceto quando
+// indicado.
+
+// liga o dimensionamento conforme PPOS_STACK (chamada por ppos_init())
+void stack_init () ;
+
+// aloca e pinta a pilha de uma tarefa com task->entry ja definida;
+// retorna a pilha (ou NULL) e o tamanho dela em size
+void *stack_alloc (task_t *task, unsigned int *size) ;
+
+// mede o pico da tarefa terminada e o agrega a sua funcao de entrada;
+// chamada pelo despachante antes de liberar a pilha
+void stack_exit (task_t *task) ;
+
+// retorna o pico de uso da pilha da tarefa (bytes), medido na hora se ela
+// nao terminou, ou -1 se a pilha nao foi pintada (tarefa main ou criada
+// com a medicao desligada)
+long stack_used (task_t *task) ;
+
+// liga (1) ou desliga (0) a medicao das pilhas das novas tarefas
+int stack_measure (int on) ;
+
+// liga (1) ou desliga (0) o dimensionamento automatico
+int stack_autosize (int on) ;
+
+// copia ate max funcoes de entrada para entries; retorna a quantidade de
+// funcoes acompanhadas ou -1 em erro
+int stack_stats (stack_entry_t *entries, int max) ;
+
+// escreve em f o uso de pilha por funcao de entrada
+int stack_report (FILE *f) ;
+
+// carrega/grava os tamanhos aprendidos (linhas "funcao tamanho pico")
+int stack_load (const char *file) ;
+int stack_save (const char *file) ;
+
+#endif
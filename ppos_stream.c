@@ -0,0 +1,286 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ppos.h"
+#include "ppos_stream.h"
+
+// variáveis globais e constantes ==============================================
+
+// estados de um buffer
+#define SB_FREE    0   // sem pedaco (fim do fluxo)
+#define SB_READING 1   // leitura enviada
+#define SB_HELD    2   // entregue a tarefa
+#define SB_WRITING 3   // escrita enviada (copia)
+
+// funções locais ==============================================================
+
+/*!
+  \brief Envia a leitura do proximo pedaco da faixa para o buffer i
+
+  \return -1 em erro ou 0 em sucesso (inclusive no fim da faixa)
+*/
+static int stream_read (stream_t *s, int i) {
+  stream_buf_t *b = &s->bufs[i];
+
+  if ( s->next >= s->end ) {
+    b->state = SB_FREE;
+    return(0);
+  }
+
+  b->block = s->next;
+  b->count = ( s->end - s->next < s->chunk ) ? s->end - s->next : s->chunk;
+  if ( disk_dev_submit(s->src, &b->req, READ_OPERATION, b->block, b->count, b->vec) ) {
+    b->state = SB_FREE;
+    s->error = 1;
+    return(-1);
+  }
+  b->state = SB_READING;
+  s->next += b->count;
+
+  return(0);
+}
+
+/*!
+  \brief Aguarda o pedido em andamento do buffer i
+
+  \return Resultado do pedido
+*/
+static int stream_wait (stream_t *s, int i) {
+  unsigned int start = systime();
+  int result = disk_dev_wait(&s->bufs[i].req);
+
+  s->stats.waited += systime() - start;
+  if ( result )
+    s->error = 1;
+  return(result);
+}
+
+/*!
+  \brief Aguarda a escrita do buffer i e o reutiliza para o proximo pedaco
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int stream_reap (stream_t *s, int i) {
+  int result = stream_wait(s, i);
+
+  s->writes--;
+  s->bufs[i].state = SB_FREE;
+  if ( result )
+    return(-1);
+  return( stream_read(s, i) );
+}
+
+/*!
+  \brief Devolve ao fluxo o buffer com a tarefa: na leitura, o buffer recebe
+  o proximo pedaco; na copia, eh escrito no destino e reutilizado quando a
+  escrita terminar. No maximo metade dos buffers fica em escrita.
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int stream_release (stream_t *s) {
+  stream_buf_t *b;
+  int i = s->held, limit;
+
+  if ( i < 0 )
+    return(0);
+  s->held = -1;
+  b = &s->bufs[i];
+
+  if ( s->dst < 0 )
+    return( stream_read(s, i) );
+
+  if ( disk_dev_submit(s->dst, &b->req, WRITE_OPERATION, s->dstFirst + b->block - s->first,
+                       b->count, b->vec) ) {
+    b->state = SB_FREE;
+    s->error = 1;
+    return(-1);
+  }
+  b->state = SB_WRITING;
+  s->writes++;
+
+  // reutiliza os buffers com as escritas mais antigas
+  limit = ( s->depth > 1 ) ? s->depth / 2 : 1;
+  while ( s->writes > limit || (s->depth == 1 && s->writes) )
+    if ( stream_reap(s, (i - s->writes + 1 + s->depth) % s->depth) )
+      return(-1);
+
+  return(0);
+}
+
+/*!
+  \brief Inicializa um fluxo e envia as leituras dos primeiros pedacos
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int stream_init (stream_t *s, int src, int first, int count, int dst, int dstFirst,
+                        int chunk, int depth) {
+  int numBlocks, blockSize, dstBlocks, dstSize, i, j;
+
+  if ( !s || count < 1 || chunk < 1 || chunk > DISK_VEC_MAX || depth < 1 ||
+       depth > STREAM_DEPTH_MAX || disk_dev_geometry(src, &numBlocks, &blockSize) ||
+       first < 0 || first + count > numBlocks )
+    return(-1);
+  if ( dst >= 0 && (disk_dev_geometry(dst, &dstBlocks, &dstSize) || dstSize != blockSize ||
+                    dstFirst < 0 || dstFirst + count > dstBlocks) )
+    return(-1);
+
+  memset(s, 0, sizeof(stream_t));
+  s->src = src;
+  s->dst = dst;
+  s->first = s->next = first;
+  s->end = first + count;
+  s->dstFirst = dstFirst;
+  s->chunk = chunk;
+  s->depth = depth;
+  s->blockSize = blockSize;
+  s->held = -1;
+
+  for ( i = 0; i < depth; i++ ) {
+    s->bufs[i].data = malloc(chunk * blockSize);
+    if ( !s->bufs[i].data ) {
+      for ( j = 0; j < i; j++ )
+        free(s->bufs[j].data);
+      return(-1);
+    }
+    for ( j = 0; j < chunk; j++ )
+      s->bufs[i].vec[j] = s->bufs[i].data + j * blockSize;
+  }
+
+  // todos os buffers comecam em leitura
+  for ( i = 0; i < depth; i++ )
+    if ( stream_read(s, i) ) {
+      stream_close(s);
+      return(-1);
+    }
+
+  return(0);
+}
+
+// funções gerais ==============================================================
+
+/*!
+  \brief Abre um fluxo de leitura de uma faixa de blocos
+
+  \param s Estrutura do fluxo a preencher
+  \param dev Disco, ja inicializado com disk_dev_mgr_init()
+  \param first Primeiro bloco da faixa
+  \param count Blocos da faixa
+  \param chunk Blocos por pedaco (ate DISK_VEC_MAX)
+  \param depth Buffers em rodizio (ate STREAM_DEPTH_MAX)
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int stream_open (stream_t *s, int dev, int first, int count, int chunk, int depth) {
+  return( stream_init(s, dev, first, count, -1, 0, chunk, depth) );
+}
+
+/*!
+  \brief Abre um fluxo de copia de uma faixa de blocos para outro disco (ou
+  outra faixa do mesmo disco, sem sobreposicao)
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int stream_copy (stream_t *s, int src, int first, int count, int dst, int dstFirst,
+                 int chunk, int depth) {
+  if ( dst < 0 )
+    return(-1);
+  return( stream_init(s, src, first, count, dst, dstFirst, chunk, depth) );
+}
+
+/*!
+  \brief Entrega o proximo pedaco do fluxo, devolvendo o anterior
+
+  \param data Recebe o buffer do pedaco (valido ate a proxima chamada)
+  \param block Recebe o primeiro bloco de origem do pedaco
+  \param count Recebe os blocos do pedaco
+
+  \return 1 se entregou um pedaco, 0 no fim do fluxo ou -1 em erro
+*/
+int stream_next (stream_t *s, void **data, int *block, int *count) {
+  stream_buf_t *b;
+  int i;
+
+  if ( !s || !data || !block || !count || !s->bufs[0].data || s->error )
+    return(-1);
+
+  if ( stream_release(s) )
+    return(-1);
+
+  i = s->head;
+  b = &s->bufs[i];
+  if ( b->state == SB_WRITING && stream_reap(s, i) )
+    return(-1);
+  if ( b->state == SB_FREE )
+    return(0);
+
+  // leitura ainda nao concluida: a tarefa aguarda o disco
+  if ( b->req.wait.count <= 0 )
+    s->stats.stalls++;
+  if ( stream_wait(s, i) ) {
+    b->state = SB_FREE;
+    return(-1);
+  }
+
+  b->state = SB_HELD;
+  s->held = i;
+  s->head = (i + 1) % s->depth;
+  s->stats.chunks++;
+  s->stats.blocks += b->count;
+
+  *data = b->data;
+  *block = b->block;
+  *count = b->count;
+
+  return(1);
+}
+
+/*!
+  \brief Fecha o fluxo: o buffer com a tarefa eh devolvido (escrito, na
+  copia), as escritas em andamento sao aguardadas e as leituras nao
+  entregues sao canceladas ou aguardadas
+
+  \return -1 se houve erro em alguma transferencia, 0 em sucesso
+*/
+int stream_close (stream_t *s) {
+  int i;
+
+  if ( !s || !s->bufs[0].data )
+    return(-1);
+
+  // o ultimo pedaco entregue ainda deve ser escrito
+  if ( s->dst >= 0 && s->held >= 0 )
+    stream_release(s);
+  s->held = -1;
+  s->next = s->end;
+
+  for ( i = 0; i < s->depth; i++ ) {
+    if ( s->bufs[i].state == SB_READING ) {
+      disk_dev_cancel(s->src, &s->bufs[i].req);
+      disk_dev_wait(&s->bufs[i].req);
+    }
+    else if ( s->bufs[i].state == SB_WRITING )
+      stream_reap(s, i);
+    free(s->bufs[i].data);
+    s->bufs[i].data = NULL;
+  }
+
+  return( s->error ? -1 : 0 );
+}
+
+/*!
+  \brief Consulta os contadores do fluxo
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int stream_stats (stream_t *s, stream_stats_t *stats) {
+  if ( !s || !stats )
+    return(-1);
+
+  *stats = s->stats;
+
+  return(0);
+}
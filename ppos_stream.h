@@ -0,0 +1,87 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Fluxos de transferencia em massa: leitura e copia de faixas de blocos com
+// varios buffers em andamento
+
+#ifndef __PPOS_STREAM__
+#define __PPOS_STREAM__
+
+#include "ppos_disk.h"
+
+// Um fluxo percorre uma faixa de blocos de um disco em pedaços de até
+// DISK_VEC_MAX blocos, com depth buffers em rodízio: enquanto a tarefa
+// consome um buffer, as leituras dos pedaços seguintes (e, na cópia, as
+// escritas dos já consumidos) estão na fila do disco. stream_next() entrega
+// o próximo pedaço diretamente no buffer do fluxo (sem cópia), válido até a
+// chamada seguinte; na cópia, o conteúdo do buffer (possivelmente alterado
+// pela tarefa) é então escrito no disco de destino.
+
+#define STREAM_DEPTH_MAX 16   // buffers de um fluxo
+
+// contadores de um fluxo
+typedef struct
+{
+  unsigned int chunks;      // pedacos entregues
+  unsigned int blocks;      // blocos entregues
+  unsigned int stalls;      // entregas que aguardaram a leitura
+  unsigned int waited;      // tempo aguardando leituras e escritas (ms)
+} stream_stats_t ;
+
+// buffer de um fluxo
+typedef struct
+{
+  request_t req;            // leitura ou escrita em andamento
+  int state;                // livre, lendo, com a tarefa ou escrevendo
+  int block;                // primeiro bloco de origem do pedaco
+  int count;                // blocos do pedaco
+  char *data;               // blocos do pedaco, contiguos
+  void *vec[DISK_VEC_MAX];  // enderecos dos blocos em data
+} stream_buf_t ;
+
+// estrutura que representa um fluxo aberto
+typedef struct
+{
+  int src;                  // disco de origem
+  int dst;                  // disco de destino (-1 = fluxo de leitura)
+  int first;                // primeiro bloco de origem
+  int end;                  // bloco de origem apos o ultimo
+  int dstFirst;             // primeiro bloco de destino
+  int chunk;                // blocos por pedaco
+  int depth;                // buffers em rodizio
+  int blockSize;            // tamanho de cada bloco, em bytes
+  int next;                 // proximo bloco de origem a ler
+  int head;                 // proximo buffer a entregar
+  int held;                 // buffer com a tarefa (-1 = nenhum)
+  int writes;               // escritas em andamento
+  int error;                // houve erro em alguma transferencia
+  stream_buf_t bufs[STREAM_DEPTH_MAX];  // buffers
+  stream_stats_t stats;     // contadores
+} stream_t ;
+
+// Todas as funcoes retornam -1 em erro ou 0 em sucesso, exceto quando
+// indicado.
+
+// abre um fluxo de leitura dos blocos [first, first + count) do disco dev,
+// com pedacos de chunk blocos e depth buffers
+int stream_open (stream_t *s, int dev, int first, int count, int chunk, int depth) ;
+
+// abre um fluxo de copia dos blocos [first, first + count) do disco src para
+// os blocos a partir de dstFirst do disco dst
+int stream_copy (stream_t *s, int src, int first, int count, int dst, int dstFirst,
+                 int chunk, int depth) ;
+
+// entrega o proximo pedaco: *data recebe o buffer, *block o primeiro bloco
+// de origem e *count a quantidade de blocos; retorna 1 se entregou, 0 no
+// fim do fluxo ou -1 em erro
+int stream_next (stream_t *s, void **data, int *block, int *count) ;
+
+// fecha o fluxo, aguardando as escritas em andamento e descartando as
+// leituras nao entregues
+int stream_close (stream_t *s) ;
+
+// consulta os contadores do fluxo
+int stream_stats (stream_t *s, stream_stats_t *stats) ;
+
+#endif
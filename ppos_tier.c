@@ -0,0 +1,478 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ppos.h"
+#include "ppos_tier.h"
+
+// variáveis globais e constantes ==============================================
+
+#define TIER_MAGIC 0x54495231  // cabecalho da cache ("TIR1")
+
+// campos (inteiros) do cabecalho
+#define TH_MAGIC  0
+#define TH_BLOCKS 1
+#define TH_BSIZE  2
+#define TH_SLOTS  3
+
+// entrada do mapa: bloco logico e indicador de alteracao
+#define TE_BLOCK  0
+#define TE_DIRTY  1
+#define TE_SIZE   2
+
+#define TIER_FREQ_MAX 65535    // frequencia maxima (saturacao)
+
+// funções locais ==============================================================
+
+/*!
+  \brief Le ou escreve count blocos contiguos de um disco a partir de uma
+  area contigua de memoria
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int tier_io (tier_t *tier, int dev, int type, int block, int count, void *area) {
+  void **buffers;
+  int i, result;
+
+  buffers = malloc(count * sizeof(void *));
+  if ( !buffers )
+    return(-1);
+  for ( i = 0; i < count; i++ )
+    buffers[i] = (char *) area + i * tier->blockSize;
+
+  if ( type == READ_OPERATION )
+    result = disk_dev_block_readv(dev, block, count, buffers);
+  else
+    result = disk_dev_block_writev(dev, block, count, buffers);
+
+  free(buffers);
+  return(result);
+}
+
+/*!
+  \brief Calcula a disposicao da cache a partir da geometria dos discos
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int tier_layout (tier_t *tier, int fast, int slow) {
+  int fastBlocks, fastSize, slowBlocks, slowSize;
+
+  if ( disk_dev_geometry(fast, &fastBlocks, &fastSize) ||
+       disk_dev_geometry(slow, &slowBlocks, &slowSize) )
+    return(-1);
+  if ( fastSize != slowSize || fastSize < (int) (TE_SIZE * sizeof(int)) ) {
+    fprintf(stderr, "[PPOS error] tier_layout: disks %d and %d have different block sizes\n",
+            fast, slow);
+    return(-1);
+  }
+
+  tier->fast = fast;
+  tier->slow = slow;
+  tier->numBlocks = slowBlocks;
+  tier->blockSize = fastSize;
+  tier->perBlock = fastSize / (TE_SIZE * sizeof(int));
+
+  // posicoes e mapa devem caber no disco rapido
+  tier->slots = fastBlocks - 1;
+  while ( tier->slots > 0 &&
+          1 + (tier->slots + tier->perBlock - 1) / tier->perBlock + tier->slots > fastBlocks )
+    tier->slots--;
+  if ( tier->slots > slowBlocks )
+    tier->slots = slowBlocks;
+  if ( tier->slots < 1 )
+    return(-1);
+
+  tier->mapStart = 1;
+  tier->mapBlocks = (tier->slots + tier->perBlock - 1) / tier->perBlock;
+  tier->slotStart = tier->mapStart + tier->mapBlocks;
+
+  return(0);
+}
+
+/*!
+  \brief Entrada do mapa da posicao s
+*/
+static int *tier_entry (tier_t *tier, int s) {
+  return( tier->map + (s / tier->perBlock) * (tier->blockSize / sizeof(int)) +
+          (s % tier->perBlock) * TE_SIZE );
+}
+
+/*!
+  \brief Grava o bloco do mapa que contem a entrada da posicao s
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int tier_save (tier_t *tier, int s) {
+  int b = s / tier->perBlock;
+
+  tier->stats.mapwrites++;
+  return( disk_dev_block_write(tier->fast, tier->mapStart + b,
+                               (char *) tier->map + b * tier->blockSize) );
+}
+
+/*!
+  \brief Libera as estruturas em memoria da camada
+*/
+static void tier_release (tier_t *tier) {
+  free(tier->map);
+  free(tier->where);
+  free(tier->freq);
+  free(tier->buffer);
+  memset(tier, 0, sizeof(tier_t));
+}
+
+/*!
+  \brief Conta um acesso ao bloco; a cada TIER_DECAY acessos as frequencias
+  sao divididas por 2, para que blocos que deixaram de ser usados esfriem
+*/
+static void tier_touch (tier_t *tier, int block) {
+  int i;
+
+  if ( tier->freq[block] < TIER_FREQ_MAX )
+    tier->freq[block]++;
+
+  if ( ++tier->accesses >= TIER_DECAY ) {
+    for ( i = 0; i < tier->numBlocks; i++ )
+      tier->freq[i] /= 2;
+    tier->accesses = 0;
+  }
+}
+
+/*!
+  \brief Retira da cache o bloco da posicao s, copiando-o para o disco lento
+  se alterado; a posicao livre eh gravada no mapa antes de ser reutilizada
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int tier_evict (tier_t *tier, int s) {
+  int *entry = tier_entry(tier, s);
+
+  if ( entry[TE_DIRTY] ) {
+    if ( disk_dev_block_read(tier->fast, tier->slotStart + s, tier->buffer) ||
+         disk_dev_block_write(tier->slow, entry[TE_BLOCK], tier->buffer) )
+      return(-1);
+    tier->stats.writebacks++;
+  }
+
+  tier->where[entry[TE_BLOCK]] = -1;
+  entry[TE_BLOCK] = -1;
+  entry[TE_DIRTY] = 0;
+  tier->stats.evictions++;
+
+  return( tier_save(tier, s) );
+}
+
+/*!
+  \brief Copia um bloco para o disco rapido, em uma posicao livre ou no lugar
+  do bloco em cache menos acessado, se este for menos acessado que o novo
+
+  \param data Conteudo do bloco
+  \param dirty Bloco mais novo que o do disco lento
+
+  \return 1 se o bloco foi promovido, 0 se nao ou -1 em erro
+*/
+static int tier_promote (tier_t *tier, int block, void *data, int dirty) {
+  int s, victim = -1, *entry;
+
+  for ( s = 0; s < tier->slots; s++ ) {
+    entry = tier_entry(tier, s);
+    if ( entry[TE_BLOCK] < 0 ) {
+      victim = s;
+      break;
+    }
+    if ( victim < 0 ||
+         tier->freq[entry[TE_BLOCK]] < tier->freq[tier_entry(tier, victim)[TE_BLOCK]] )
+      victim = s;
+  }
+
+  entry = tier_entry(tier, victim);
+  if ( entry[TE_BLOCK] >= 0 ) {
+    if ( tier->freq[entry[TE_BLOCK]] >= tier->freq[block] )
+      return(0);
+    if ( tier_evict(tier, victim) )
+      return(-1);
+  }
+
+  // conteudo antes da entrada do mapa
+  if ( disk_dev_block_write(tier->fast, tier->slotStart + victim, data) )
+    return(-1);
+  entry[TE_BLOCK] = block;
+  entry[TE_DIRTY] = dirty;
+  if ( tier_save(tier, victim) ) {
+    entry[TE_BLOCK] = -1;
+    return(-1);
+  }
+  tier->where[block] = victim;
+  tier->stats.promotions++;
+
+  return(1);
+}
+
+// funções gerais ==============================================================
+
+/*!
+  \brief Formata o disco rapido como cache vazia do disco lento
+
+  \param fast Disco rapido, ja inicializado com disk_dev_mgr_init()
+  \param slow Disco lento, ja inicializado com disk_dev_mgr_init()
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int tier_format (int fast, int slow) {
+  tier_t tier;
+  int *hdr, s, result;
+
+  memset(&tier, 0, sizeof(tier_t));
+  if ( tier_layout(&tier, fast, slow) ) {
+    fprintf(stderr, "[PPOS error] tier_format: disk %d too small\n", fast);
+    return(-1);
+  }
+
+  tier.map = calloc(tier.mapBlocks, tier.blockSize);
+  hdr = calloc(1, tier.blockSize);
+  if ( !tier.map || !hdr ) {
+    free(tier.map);
+    free(hdr);
+    return(-1);
+  }
+
+  for ( s = 0; s < tier.slots; s++ )
+    tier_entry(&tier, s)[TE_BLOCK] = -1;
+  hdr[TH_MAGIC] = TIER_MAGIC;
+  hdr[TH_BLOCKS] = tier.numBlocks;
+  hdr[TH_BSIZE] = tier.blockSize;
+  hdr[TH_SLOTS] = tier.slots;
+
+  result = tier_io(&tier, fast, WRITE_OPERATION, tier.mapStart, tier.mapBlocks, tier.map) ||
+           disk_dev_block_write(fast, 0, hdr);
+
+  free(tier.map);
+  free(hdr);
+  return( result ? -1 : 0 );
+}
+
+/*!
+  \brief Monta o armazenamento em camadas, recuperando o mapa da cache
+
+  Os blocos em cache recebem frequencia TIER_PROMOTE, para nao serem
+  substituidos antes de blocos nunca acessados.
+
+  \param tier Estrutura da camada a preencher
+  \param fast Disco rapido, formatado com tier_format()
+  \param slow Disco lento
+  \param policy TIER_WRITE_THROUGH ou TIER_WRITE_BACK
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int tier_mount (tier_t *tier, int fast, int slow, int policy) {
+  int *entry, s, b;
+
+  if ( !tier || (policy != TIER_WRITE_THROUGH && policy != TIER_WRITE_BACK) )
+    return(-1);
+  memset(tier, 0, sizeof(tier_t));
+  if ( tier_layout(tier, fast, slow) )
+    return(-1);
+  tier->policy = policy;
+
+  tier->map = malloc(tier->mapBlocks * tier->blockSize);
+  tier->where = malloc(tier->numBlocks * sizeof(int));
+  tier->freq = calloc(tier->numBlocks, sizeof(unsigned short));
+  tier->buffer = malloc(tier->blockSize);
+  if ( !tier->map || !tier->where || !tier->freq || !tier->buffer ) {
+    tier_release(tier);
+    return(-1);
+  }
+
+  // cabecalho (lido no buffer de copia)
+  entry = (int *) tier->buffer;
+  if ( disk_dev_block_read(fast, 0, entry) || entry[TH_MAGIC] != TIER_MAGIC ||
+       entry[TH_BLOCKS] != tier->numBlocks || entry[TH_SLOTS] != tier->slots ) {
+    fprintf(stderr, "[PPOS error] tier_mount: disk %d is not formatted\n", fast);
+    tier_release(tier);
+    return(-1);
+  }
+
+  if ( tier_io(tier, fast, READ_OPERATION, tier->mapStart, tier->mapBlocks, tier->map) ) {
+    tier_release(tier);
+    return(-1);
+  }
+
+  for ( b = 0; b < tier->numBlocks; b++ )
+    tier->where[b] = -1;
+  for ( s = 0; s < tier->slots; s++ ) {
+    entry = tier_entry(tier, s);
+    if ( entry[TE_BLOCK] >= 0 && entry[TE_BLOCK] < tier->numBlocks ) {
+      tier->where[entry[TE_BLOCK]] = s;
+      tier->freq[entry[TE_BLOCK]] = TIER_PROMOTE;
+    }
+  }
+
+  if ( sem_create(&(tier->lock), 1) ) {
+    tier_release(tier);
+    return(-1);
+  }
+
+  return(0);
+}
+
+/*!
+  \brief Desmonta o armazenamento: copia os blocos alterados para o disco
+  lento
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int tier_umount (tier_t *tier) {
+  int result;
+
+  if ( !tier || !tier->map )
+    return(-1);
+
+  result = tier_sync(tier);
+
+  sem_destroy(&(tier->lock));
+  tier_release(tier);
+
+  return(result);
+}
+
+/*!
+  \brief Leitura de um bloco logico: do disco rapido, se em cache, ou do
+  disco lento, promovendo o bloco se ele for acessado com frequencia
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int tier_block_read (tier_t *tier, int block, void *buffer) {
+  int s, result;
+
+  if ( !tier || !tier->map || !buffer || block < 0 || block >= tier->numBlocks )
+    return(-1);
+
+  if ( sem_down(&(tier->lock)) )
+    return(-1);
+
+  tier_touch(tier, block);
+  tier->stats.reads++;
+
+  s = tier->where[block];
+  if ( s >= 0 ) {
+    result = disk_dev_block_read(tier->fast, tier->slotStart + s, buffer);
+    tier->stats.hits++;
+  }
+  else {
+    result = disk_dev_block_read(tier->slow, block, buffer);
+    tier->stats.misses++;
+    if ( !result && tier->freq[block] >= TIER_PROMOTE &&
+         tier_promote(tier, block, buffer, 0) < 0 )
+      result = -1;
+  }
+
+  sem_up(&(tier->lock));
+
+  return(result);
+}
+
+/*!
+  \brief Escrita de um bloco logico, conforme a politica de escrita
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int tier_block_write (tier_t *tier, int block, void *buffer) {
+  int s, *entry, result = 0;
+
+  if ( !tier || !tier->map || !buffer || block < 0 || block >= tier->numBlocks )
+    return(-1);
+
+  if ( sem_down(&(tier->lock)) )
+    return(-1);
+
+  tier_touch(tier, block);
+  tier->stats.writes++;
+
+  s = tier->where[block];
+  if ( s >= 0 ) {
+    tier->stats.hits++;
+    entry = tier_entry(tier, s);
+    if ( tier->policy == TIER_WRITE_BACK && !entry[TE_DIRTY] ) {
+      // a alteracao eh gravada no mapa antes do conteudo
+      entry[TE_DIRTY] = 1;
+      result = tier_save(tier, s);
+    }
+    if ( !result )
+      result = disk_dev_block_write(tier->fast, tier->slotStart + s, buffer);
+    if ( !result && tier->policy == TIER_WRITE_THROUGH )
+      result = disk_dev_block_write(tier->slow, block, buffer);
+  }
+  else {
+    tier->stats.misses++;
+    if ( tier->policy == TIER_WRITE_BACK && tier->freq[block] >= TIER_PROMOTE )
+      result = tier_promote(tier, block, buffer, 1);
+    // sem promocao, ou na escrita direta, o bloco vai para o disco lento
+    if ( !result )
+      result = disk_dev_block_write(tier->slow, block, buffer);
+    else if ( result > 0 )
+      result = 0;
+    if ( !result && tier->policy == TIER_WRITE_THROUGH && tier->freq[block] >= TIER_PROMOTE &&
+         tier_promote(tier, block, buffer, 0) < 0 )
+      result = -1;
+  }
+
+  sem_up(&(tier->lock));
+
+  return(result);
+}
+
+/*!
+  \brief Copia os blocos alterados para o disco lento
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int tier_sync (tier_t *tier) {
+  int s, *entry, result = 0, changed = 0;
+
+  if ( !tier || !tier->map )
+    return(-1);
+
+  if ( sem_down(&(tier->lock)) )
+    return(-1);
+
+  for ( s = 0; !result && s < tier->slots; s++ ) {
+    entry = tier_entry(tier, s);
+    if ( entry[TE_BLOCK] < 0 || !entry[TE_DIRTY] )
+      continue;
+    result = disk_dev_block_read(tier->fast, tier->slotStart + s, tier->buffer) ||
+             disk_dev_block_write(tier->slow, entry[TE_BLOCK], tier->buffer);
+    if ( !result ) {
+      entry[TE_DIRTY] = 0;
+      tier->stats.writebacks++;
+      changed = 1;
+    }
+  }
+
+  // os blocos copiados deixam de constar como alterados
+  if ( changed && tier_io(tier, tier->fast, WRITE_OPERATION, tier->mapStart,
+                          tier->mapBlocks, tier->map) )
+    result = -1;
+  if ( changed )
+    tier->stats.mapwrites += tier->mapBlocks;
+
+  sem_up(&(tier->lock));
+
+  return( result ? -1 : 0 );
+}
+
+/*!
+  \brief Consulta os contadores da camada
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int tier_stats (tier_t *tier, tier_stats_t *stats) {
+  if ( !tier || !stats )
+    return(-1);
+
+  *stats = tier->stats;
+
+  return(0);
+}
@@ -0,0 +1,91 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Armazenamento em camadas: um disco rapido (perfil SSD) como cache dos
+// blocos mais acessados de um disco lento (perfil HDD)
+
+#ifndef __PPOS_TIER__
+#define __PPOS_TIER__
+
+#include "ppos_disk.h"
+
+// Os blocos lógicos são os blocos do disco lento. A camada conta os acessos
+// a cada bloco (com envelhecimento periódico) e promove ao disco rápido os
+// blocos acessados ao menos TIER_PROMOTE vezes, substituindo o bloco em
+// cache de menor frequência, se ele for menos acessado. As escritas vão
+// para os dois discos (TIER_WRITE_THROUGH) ou apenas para o disco rápido,
+// quando o bloco está em cache (TIER_WRITE_BACK); blocos alterados são
+// copiados para o disco lento na substituição ou em tier_sync().
+//
+// O mapa das posições de cache fica no disco rápido e cada alteração é
+// gravada antes de ser usada, de modo que a cache sobrevive a reinícios
+// (inclusive sem tier_umount()) sem perder blocos alterados.
+//
+// Disposição no disco rápido:
+//   [cabeçalho][mapa][posições de cache...]
+
+#define TIER_WRITE_THROUGH 0   // escritas nos dois discos
+#define TIER_WRITE_BACK    1   // escritas no disco rapido, se em cache
+
+#define TIER_PROMOTE       2   // acessos para promover um bloco
+#define TIER_DECAY      4096   // acessos entre envelhecimentos das frequencias
+
+// contadores da camada
+typedef struct
+{
+  unsigned int reads;       // blocos lidos pelas aplicacoes
+  unsigned int writes;      // blocos escritos pelas aplicacoes
+  unsigned int hits;        // acessos a blocos no disco rapido
+  unsigned int misses;      // acessos a blocos so no disco lento
+  unsigned int promotions;  // blocos copiados para o disco rapido
+  unsigned int evictions;   // blocos retirados do disco rapido
+  unsigned int writebacks;  // blocos alterados copiados para o disco lento
+  unsigned int mapwrites;   // gravacoes de blocos do mapa
+} tier_stats_t ;
+
+// estrutura que representa um armazenamento em camadas montado
+typedef struct
+{
+  int fast;                 // disco rapido (cache)
+  int slow;                 // disco lento
+  int policy;               // TIER_WRITE_THROUGH ou TIER_WRITE_BACK
+  int numBlocks;            // blocos logicos (do disco lento)
+  int blockSize;            // tamanho de cada bloco, em bytes
+  int slots;                // posicoes de cache no disco rapido
+  int perBlock;             // entradas do mapa por bloco
+  int mapStart;             // primeiro bloco do mapa
+  int mapBlocks;            // blocos do mapa
+  int slotStart;            // primeira posicao de cache
+  int *map;                 // por posicao: bloco logico (-1 = livre) e alterado
+  int *where;               // bloco logico -> posicao (-1 = fora da cache)
+  unsigned short *freq;     // frequencia de acesso de cada bloco logico
+  int accesses;             // acessos desde o ultimo envelhecimento
+  char *buffer;             // copia de blocos entre os discos
+  semaphore_t lock;         // acesso exclusivo a camada
+  tier_stats_t stats;       // contadores
+} tier_t ;
+
+// Todas as funcoes retornam -1 em erro ou 0 em sucesso.
+
+// formata o disco rapido fast como cache (vazia) do disco lento slow (ambos
+// ja inicializados com disk_dev_mgr_init)
+int tier_format (int fast, int slow) ;
+
+// monta o armazenamento, recuperando a cache gravada no disco rapido
+int tier_mount (tier_t *tier, int fast, int slow, int policy) ;
+
+// copia os blocos alterados para o disco lento e desmonta o armazenamento
+int tier_umount (tier_t *tier) ;
+
+// leitura/escrita de um bloco logico
+int tier_block_read (tier_t *tier, int block, void *buffer) ;
+int tier_block_write (tier_t *tier, int block, void *buffer) ;
+
+// copia os blocos alterados para o disco lento
+int tier_sync (tier_t *tier) ;
+
+// consulta os contadores
+int tier_stats (tier_t *tier, tier_stats_t *stats) ;
+
+#endif
@@ -0,0 +1,431 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "ppos.h"
+#include "ppos_disk.h"
+#include "ppos_trace.h"
+
+// variáveis globais e constantes ==============================================
+
+extern task_t *currentTask;
+
+volatile int trace_on = 0;               // rastreamento ligado?
+static trace_event_t *traceRing = NULL;  // anel de eventos
+static unsigned int traceSize = 0;       // capacidade do anel
+static unsigned long long traceHead = 0; // eventos registrados
+static unsigned long long traceBase = 0; // inicio do rastreamento (ns)
+static char *traceFile = NULL;           // arquivo de PPOS_TRACE
+
+// pids das trilhas no JSON
+#define JSON_TASKS 1
+#define JSON_DISKS 2
+
+// funções locais ==============================================================
+
+/*!
+  \brief Relogio do rastreamento, em ns (o do nucleo, virtual no modo de
+  simulacao)
+*/
+static unsigned long long trace_clock () {
+  return( ppos_clock() );
+}
+
+/*!
+  \brief Grava o arquivo de PPOS_TRACE ao fim do programa
+*/
+static void trace_atexit () {
+  trace_stop();
+  if ( trace_dump(traceFile) )
+    fprintf(stderr, "[PPOS error] trace_atexit: fail to write %s\n", traceFile);
+}
+
+/*!
+  \brief Inicia um evento JSON, separando-o do anterior
+
+  \param json Arquivo JSON
+  \param n Eventos ja gravados (incrementado)
+  \param name Nome do evento
+  \param ph Fase do evento no formato do Chrome
+  \param pid Trilha (JSON_TASKS ou JSON_DISKS)
+  \param tid Tarefa ou disco
+  \param ts Instante do evento (ns)
+*/
+static void json_event (FILE *json, int *n, const char *name, const char *ph, int pid,
+                        int tid, unsigned long long ts) {
+  fprintf(json, "%s{\"name\":\"%s\",\"ph\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%llu.%03llu",
+          (*n)++ ? ",\n" : "", name, ph, pid, tid, ts / 1000, ts % 1000);
+}
+
+/*!
+  \brief Maior identificador de tarefa presente nos eventos
+*/
+static int trace_max_task (trace_event_t *events, unsigned int count) {
+  unsigned int i;
+  int max = 1;
+
+  for ( i = 0; i < count; i++ ) {
+    if ( events[i].task > max )
+      max = events[i].task;
+    if ( (events[i].type == TRACE_SWITCH || events[i].type == TRACE_WAKEUP ||
+          events[i].type == TRACE_CREATE) && events[i].a > max )
+      max = events[i].a;
+  }
+  return(max);
+}
+
+// funções gerais ==============================================================
+
+/*!
+  \brief Registra um evento no anel (chamada pela macro TRACE)
+
+  Pode ser chamada por tratadores de sinal: a posicao do evento eh reservada
+  atomicamente, entao um evento interrompido nao eh sobrescrito pelo
+  tratador.
+*/
+void trace_event (int type, int op, unsigned long long obj, int a, int b, int c, int d) {
+  trace_event_t *e;
+  unsigned long long n;
+
+  if ( !traceRing )
+    return;
+
+  n = __sync_fetch_and_add(&traceHead, 1);
+  e = &traceRing[n % traceSize];
+  e->ts = trace_clock() - traceBase;
+  e->obj = obj;
+  e->task = currentTask ? currentTask->id : -1;
+  e->type = type;
+  e->op = op;
+  e->a = a;
+  e->b = b;
+  e->c = c;
+  e->d = d;
+}
+
+/*!
+  \brief Liga o rastreamento
+
+  \param size Capacidade do anel em eventos (0 = anel atual ou TRACE_DEFAULT)
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int trace_start (int size) {
+  trace_event_t *ring;
+
+  if ( size < 0 )
+    return(-1);
+  if ( !size )
+    size = traceRing ? traceSize : TRACE_DEFAULT;
+
+  if ( !traceRing || (unsigned int) size != traceSize ) {
+    trace_on = 0;
+    ring = malloc(size * sizeof(trace_event_t));
+    if ( !ring ) {
+      fprintf(stderr, "[PPOS error] trace_start: fail to allocate %d events\n", size);
+      return(-1);
+    }
+    free(traceRing);
+    traceRing = ring;
+    traceSize = size;
+    trace_clear();
+  }
+
+  trace_on = 1;
+
+  return(0);
+}
+
+/*!
+  \brief Desliga o rastreamento, mantendo os eventos do anel
+
+  \return 0
+*/
+int trace_stop () {
+  trace_on = 0;
+  return(0);
+}
+
+/*!
+  \brief Descarta os eventos do anel e reinicia o relogio do rastreamento
+
+  \return 0
+*/
+int trace_clear () {
+  int on = trace_on;
+
+  trace_on = 0;
+  traceHead = 0;
+  traceBase = trace_clock();
+  trace_on = on;
+
+  return(0);
+}
+
+/*!
+  \brief Consulta os contadores do rastreamento
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int trace_stats (trace_stats_t *stats) {
+  if ( !stats )
+    return(-1);
+
+  stats->events = traceHead;
+  stats->size = traceSize;
+  stats->kept = ( traceHead < traceSize ) ? traceHead : traceSize;
+  stats->lost = traceHead - stats->kept;
+
+  return(0);
+}
+
+/*!
+  \brief Grava os eventos do anel, do mais antigo ao mais recente
+
+  O rastreamento fica desligado durante a gravacao.
+
+  \param file Arquivo binario de destino
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int trace_dump (const char *file) {
+  trace_header_t header;
+  trace_stats_t stats;
+  unsigned int first;
+  int on = trace_on, result = 0;
+  FILE *f;
+
+  if ( !file || !(f = fopen(file, "w")) )
+    return(-1);
+
+  trace_on = 0;
+  trace_stats(&stats);
+  header.magic = TRACE_MAGIC;
+  header.version = TRACE_VERSION;
+  header.count = stats.kept;
+  header.lost = stats.lost;
+
+  // o evento mais antigo fica na posicao seguinte ao mais recente
+  first = ( stats.kept < traceSize ) ? 0 : traceHead % traceSize;
+  if ( fwrite(&header, sizeof(header), 1, f) != 1 ||
+       fwrite(traceRing + first, sizeof(trace_event_t), stats.kept - first, f) !=
+         stats.kept - first ||
+       fwrite(traceRing, sizeof(trace_event_t), first, f) != first )
+    result = -1;
+
+  trace_on = on;
+  if ( fclose(f) )
+    result = -1;
+
+  return(result);
+}
+
+/*!
+  \brief Converte um arquivo binario de eventos para o formato JSON do Chrome
+
+  Cada tarefa vira uma trilha com suas fatias de execucao (entre trocas de
+  contexto) e uma seta de cada despertar ate a tarefa voltar a executar;
+  semaforos, filas e criacao/fim de tarefas sao eventos instantaneos. Cada
+  disco vira uma trilha com os pedidos como eventos assincronos (do envio a
+  conclusao). Os ticks formam o contador "quantum".
+
+  \param bin Arquivo gravado com trace_dump()
+  \param json Arquivo JSON de destino
+
+  \return Numero de eventos JSON gravados ou -1 em erro
+*/
+int trace_convert (const char *bin, const char *json) {
+  static const char *semNames[2] = { "sem_down", "sem_up" };
+  static const char *mqNames[2] = { "mqueue_send", "mqueue_recv" };
+  static const char *diskNames[2] = { "leitura", "escrita" };
+  trace_header_t header;
+  trace_event_t *events = NULL, *e;
+  unsigned long long *running = NULL, last = 0;
+  int *flow = NULL, *seen = NULL, disksSeen[DISK_MAX_DEVICES];
+  int n = 0, flows = 0, max, t;
+  unsigned int i;
+  FILE *in, *out = NULL;
+
+  if ( !bin || !json || !(in = fopen(bin, "r")) )
+    return(-1);
+
+  // le o arquivo binario inteiro
+  if ( fread(&header, sizeof(header), 1, in) != 1 || header.magic != TRACE_MAGIC ||
+       header.version != TRACE_VERSION ||
+       !(events = malloc((header.count + 1) * sizeof(trace_event_t))) ||
+       fread(events, sizeof(trace_event_t), header.count, in) != header.count ) {
+    fprintf(stderr, "[PPOS error] trace_convert: invalid trace file %s\n", bin);
+    fclose(in);
+    free(events);
+    return(-1);
+  }
+  fclose(in);
+
+  // estado de cada tarefa: inicio da fatia em execucao e seta pendente
+  max = trace_max_task(events, header.count) + 1;
+  running = calloc(max, sizeof(unsigned long long));
+  flow = calloc(max, sizeof(int));
+  seen = calloc(max, sizeof(int));
+  if ( !running || !flow || !seen || !(out = fopen(json, "w")) ) {
+    free(events);
+    free(running);
+    free(flow);
+    free(seen);
+    return(-1);
+  }
+  memset(disksSeen, 0, sizeof(disksSeen));
+
+  fprintf(out, "{\"traceEvents\":[\n");
+  for ( i = 0; i < header.count; i++ ) {
+    e = &events[i];
+    t = e->task;
+    last = e->ts;
+    if ( t >= 0 )
+      seen[t] = 1;
+
+    switch ( e->type ) {
+    case TRACE_SWITCH:
+      // fecha a fatia da tarefa que sai (running guarda ts + 1)
+      if ( t >= 0 && running[t] ) {
+        json_event(out, &n, t == 1 ? "dispatcher" : "executando", "X", JSON_TASKS, t,
+                   running[t] - 1);
+        fprintf(out, ",\"dur\":%llu.%03llu}", (e->ts - running[t] + 1) / 1000,
+                (e->ts - running[t] + 1) % 1000);
+        running[t] = 0;
+      }
+      seen[e->a] = 1;
+      running[e->a] = e->ts + 1;
+      if ( flow[e->a] ) {
+        json_event(out, &n, "despertar", "f", JSON_TASKS, e->a, e->ts);
+        fprintf(out, ",\"cat\":\"sched\",\"bp\":\"e\",\"id\":%d}", flow[e->a]);
+        flow[e->a] = 0;
+      }
+      break;
+    case TRACE_WAKEUP:
+      seen[e->a] = 1;
+      json_event(out, &n, "despertar", "i", JSON_TASKS, e->a, e->ts);
+      fprintf(out, ",\"s\":\"t\",\"args\":{\"por\":%d}}", t);
+      if ( t >= 0 ) {
+        flow[e->a] = ++flows;
+        json_event(out, &n, "despertar", "s", JSON_TASKS, t, e->ts);
+        fprintf(out, ",\"cat\":\"sched\",\"id\":%d}", flows);
+      }
+      break;
+    case TRACE_BLOCK:
+      json_event(out, &n, "suspensa", "i", JSON_TASKS, t, e->ts);
+      fprintf(out, ",\"s\":\"t\",\"args\":{\"fila\":\"0x%llx\"}}", e->obj);
+      break;
+    case TRACE_CREATE:
+      seen[e->a] = 1;
+      json_event(out, &n, "task_create", "i", JSON_TASKS, t, e->ts);
+      fprintf(out, ",\"s\":\"t\",\"args\":{\"tarefa\":%d}}", e->a);
+      break;
+    case TRACE_EXIT:
+      json_event(out, &n, "task_exit", "i", JSON_TASKS, t, e->ts);
+      fprintf(out, ",\"s\":\"t\",\"args\":{\"codigo\":%d}}", e->a);
+      break;
+    case TRACE_SEM_DOWN:
+    case TRACE_SEM_UP:
+      json_event(out, &n, semNames[e->type - TRACE_SEM_DOWN], "i", JSON_TASKS, t, e->ts);
+      fprintf(out, ",\"s\":\"t\",\"cat\":\"sync\",\"args\":{\"sem\":\"0x%llx\",\"contador\":%d",
+              e->obj, e->a);
+      if ( e->type == TRACE_SEM_DOWN )
+        fprintf(out, ",\"bloqueou\":%d}}", e->op);
+      else
+        fprintf(out, ",\"acordou\":%d}}", e->b);
+      break;
+    case TRACE_MQ_SEND:
+    case TRACE_MQ_RECV:
+      json_event(out, &n, mqNames[e->type - TRACE_MQ_SEND], "i", JSON_TASKS, t, e->ts);
+      fprintf(out, ",\"s\":\"t\",\"cat\":\"sync\",\"args\":{\"fila\":\"0x%llx\",\"mensagens\":%d}}",
+              e->obj, e->a);
+      break;
+    case TRACE_DISK_SUBMIT:
+    case TRACE_DISK_DONE:
+      if ( e->a >= 0 && e->a < DISK_MAX_DEVICES )
+        disksSeen[e->a] = 1;
+      json_event(out, &n, diskNames[e->op == WRITE_OPERATION], e->type == TRACE_DISK_SUBMIT ? "b" : "e",
+                 JSON_DISKS, e->a, e->ts);
+      fprintf(out, ",\"cat\":\"disk\",\"id\":\"0x%llx\",\"args\":{\"bloco\":%d,\"blocos\":%d",
+              e->obj, e->b, e->c);
+      if ( e->type == TRACE_DISK_SUBMIT )
+        fprintf(out, ",\"tarefa\":%d}}", t);
+      else
+        fprintf(out, ",\"resultado\":%d}}", e->d);
+      break;
+    case TRACE_DISK_ISSUE:
+      if ( e->a >= 0 && e->a < DISK_MAX_DEVICES )
+        disksSeen[e->a] = 1;
+      json_event(out, &n, "envio", "i", JSON_DISKS, e->a, e->ts);
+      fprintf(out, ",\"s\":\"t\",\"cat\":\"disk\",\"args\":{\"operacao\":\"%s\",\"bloco\":%d,"
+              "\"blocos\":%d}}", diskNames[e->op == WRITE_OPERATION], e->b, e->c);
+      break;
+    case TRACE_TICK:
+      json_event(out, &n, "quantum", "C", JSON_TASKS, 0, e->ts);
+      fprintf(out, ",\"args\":{\"quantum\":%d}}", e->op ? 0 : e->b);
+      break;
+    default:
+      break;
+    }
+  }
+
+  // fecha as fatias ainda em execucao no ultimo evento
+  for ( t = 0; t < max; t++ )
+    if ( running[t] ) {
+      json_event(out, &n, t == 1 ? "dispatcher" : "executando", "X", JSON_TASKS, t,
+                 running[t] - 1);
+      fprintf(out, ",\"dur\":%llu.%03llu}", (last - running[t] + 1) / 1000,
+              (last - running[t] + 1) % 1000);
+    }
+
+  // nomes das trilhas
+  json_event(out, &n, "process_name", "M", JSON_TASKS, 0, 0);
+  fprintf(out, ",\"args\":{\"name\":\"tarefas\"}}");
+  json_event(out, &n, "process_name", "M", JSON_DISKS, 0, 0);
+  fprintf(out, ",\"args\":{\"name\":\"discos\"}}");
+  for ( t = 0; t < max; t++ )
+    if ( seen[t] ) {
+      json_event(out, &n, "thread_name", "M", JSON_TASKS, t, 0);
+      if ( t < 2 )
+        fprintf(out, ",\"args\":{\"name\":\"%s\"}}", t ? "dispatcher" : "main");
+      else
+        fprintf(out, ",\"args\":{\"name\":\"tarefa %d\"}}", t);
+    }
+  for ( t = 0; t < DISK_MAX_DEVICES; t++ )
+    if ( disksSeen[t] ) {
+      json_event(out, &n, "thread_name", "M", JSON_DISKS, t, 0);
+      fprintf(out, ",\"args\":{\"name\":\"disco %d\"}}", t);
+    }
+
+  fprintf(out, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"perdidos\":%u}}\n",
+          header.lost);
+
+  free(events);
+  free(running);
+  free(flow);
+  free(seen);
+  if ( fclose(out) )
+    return(-1);
+
+  return(n);
+}
+
+/*!
+  \brief Liga o rastreamento se a variavel de ambiente PPOS_TRACE estiver
+  definida (chamada por ppos_init()); o anel eh gravado no arquivo indicado
+  ao fim do programa
+*/
+void trace_init () {
+  char *file = getenv("PPOS_TRACE");
+
+  if ( !file || !*file || traceFile )
+    return;
+
+  traceFile = file;
+  if ( trace_start(0) == 0 )
+    atexit(trace_atexit);
+}
@@ -0,0 +1,103 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Rastreamento de eventos do sistema: anel binario de eventos de tamanho
+// fixo, sempre compilado e ligado/desligado em tempo de execucao, com
+// conversao para o formato JSON do Chrome (chrome://tracing, Perfetto)
+
+#ifndef __PPOS_TRACE__
+#define __PPOS_TRACE__
+
+// Cada evento ocupa um registro fixo no anel; com o rastreamento desligado,
+// um ponto de rastreamento custa apenas o teste de trace_on. Quando o anel
+// enche, os eventos mais antigos sao sobrescritos. Se a variavel de ambiente
+// PPOS_TRACE estiver definida, ppos_init() liga o rastreamento e os eventos
+// sao gravados no arquivo indicado ao fim do programa.
+
+#define TRACE_DEFAULT  65536        // eventos do anel, se nao informado
+#define TRACE_MAGIC    0x52545050   // "PPTR"
+#define TRACE_VERSION  1
+
+// tipos de evento (campos usados entre parenteses)
+#define TRACE_SWITCH       1   // troca de contexto (a = tarefa que assume)
+#define TRACE_WAKEUP       2   // tarefa acordada (a = tarefa, obj = fila)
+#define TRACE_BLOCK        3   // tarefa corrente suspensa (obj = fila)
+#define TRACE_CREATE       4   // tarefa criada (a = nova tarefa)
+#define TRACE_EXIT         5   // tarefa encerrada (a = codigo de saida)
+#define TRACE_SEM_DOWN     6   // sem_down (obj = semaforo, a = contador, op = bloqueou)
+#define TRACE_SEM_UP       7   // sem_up (obj = semaforo, a = contador, b = tarefa acordada ou -1)
+#define TRACE_MQ_SEND      8   // mqueue_send (obj = fila, a = mensagens)
+#define TRACE_MQ_RECV      9   // mqueue_recv (obj = fila, a = mensagens)
+#define TRACE_DISK_SUBMIT 10   // pedido de disco (obj = pedido, op = tipo, a = disco, b = bloco, c = blocos)
+#define TRACE_DISK_ISSUE  11   // operacao enviada ao disco (op = tipo, a = disco, b = bloco, c = blocos)
+#define TRACE_DISK_DONE   12   // pedido concluido (obj = pedido, op = tipo, a = disco, b = bloco, c = blocos, d = resultado)
+#define TRACE_TICK        13   // tick do relogio (a = ticks, b = quantum restante, op = tarefa de sistema)
+#define TRACE_TYPES       14
+
+// registro de um evento
+typedef struct
+{
+  unsigned long long ts;    // instante (ns desde o inicio do rastreamento)
+  unsigned long long obj;   // endereco do objeto envolvido
+  int task;                 // tarefa corrente (-1 = nenhuma)
+  unsigned short type;      // tipo do evento
+  unsigned short op;        // tipo de operacao ou indicador
+  int a, b, c, d;           // argumentos, conforme o tipo
+} trace_event_t ;
+
+// cabecalho do arquivo binario, seguido de count registros em ordem
+typedef struct
+{
+  unsigned int magic;       // TRACE_MAGIC
+  unsigned int version;     // TRACE_VERSION
+  unsigned int count;       // eventos no arquivo
+  unsigned int lost;        // eventos sobrescritos antes da gravacao
+} trace_header_t ;
+
+// contadores do rastreamento
+typedef struct
+{
+  unsigned long long events;   // eventos registrados desde trace_clear()
+  unsigned int kept;           // eventos ainda no anel
+  unsigned int lost;           // eventos sobrescritos
+  unsigned int size;           // capacidade do anel
+} trace_stats_t ;
+
+extern volatile int trace_on;   // rastreamento ligado?
+
+// ponto de rastreamento: registra o evento apenas se o rastreamento estiver ligado
+#define TRACE(type, op, obj, a, b, c, d) \
+  do { if ( trace_on ) trace_event(type, op, (unsigned long long) (obj), a, b, c, d); } while (0)
+
+// Todas as funcoes retornam -1 em erro ou 0 em sucesso, exceto quando
+// indicado.
+
+// liga o rastreamento se PPOS_TRACE estiver definida (chamada por ppos_init())
+void trace_init () ;
+
+// registra um evento no anel (use a macro TRACE)
+void trace_event (int type, int op, unsigned long long obj, int a, int b, int c, int d) ;
+
+// liga o rastreamento; size eh a capacidade do anel em eventos (0 = mantem
+// o anel atual ou TRACE_DEFAULT). Trocar a capacidade descarta os eventos.
+int trace_start (int size) ;
+
+// desliga o rastreamento, mantendo os eventos do anel
+int trace_stop () ;
+
+// descarta os eventos do anel e reinicia o relogio do rastreamento
+int trace_clear () ;
+
+// consulta os contadores do rastreamento
+int trace_stats (trace_stats_t *stats) ;
+
+// grava os eventos do anel, do mais antigo ao mais recente, no arquivo
+// binario file
+int trace_dump (const char *file) ;
+
+// converte o arquivo binario bin para o formato JSON do Chrome, gravado em
+// json; retorna o numero de eventos JSON gravados ou -1 em erro
+int trace_convert (const char *bin, const char *json) ;
+
+#endif
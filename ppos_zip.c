@@ -0,0 +1,637 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ppos.h"
+#include "ppos_zip.h"
+
+// variáveis globais e constantes ==============================================
+
+#define ZIP_MAGIC 0x5a495031  // cabecalho do volume ("ZIP1")
+
+// campos (inteiros) do cabecalho
+#define ZH_MAGIC  0
+#define ZH_BLOCKS 1
+#define ZH_BSIZE  2
+#define ZH_CHUNK  3
+
+// entrada do mapa: tamanho comprimido (0 = nunca gravada, chunkBytes = sem
+// compressao) seguido dos blocos fisicos da unidade
+#define ZE_LEN  0
+#define ZE_SIZE (1 + ZIP_CHUNK)
+
+// compressor: janela e tamanhos de coincidencia (LZ77 com codigos de 2 bytes)
+#define LZ_WINDOW 4095
+#define LZ_MIN    3
+#define LZ_MAX    18
+#define LZ_HASH   4096
+
+// funções locais ==============================================================
+
+/*!
+  \brief Comprime n bytes de in em out (no maximo max bytes)
+
+  A saida eh uma sequencia de grupos: um byte de controle seguido de ate 8
+  itens; o bit i do controle indica se o item i eh um literal (1 byte) ou
+  uma coincidencia (2 bytes: 12 bits de distancia, 4 bits de tamanho).
+
+  \return Tamanho comprimido, ou -1 se nao coube em max bytes
+*/
+static int zip_compress (const unsigned char *in, int n, unsigned char *out, int max) {
+  int table[LZ_HASH];
+  int i = 0, o = 0, ctrl = 0, bit = 8, h, cand = -1, len, off;
+
+  for ( h = 0; h < LZ_HASH; h++ )
+    table[h] = -1;
+
+  while ( i < n ) {
+    if ( bit == 8 ) {
+      if ( o >= max )
+        return(-1);
+      ctrl = o++;
+      out[ctrl] = 0;
+      bit = 0;
+    }
+
+    // procura a sequencia de 3 bytes anterior com o mesmo hash
+    len = 0;
+    if ( i + LZ_MIN <= n ) {
+      h = (((in[i] << 16) | (in[i + 1] << 8) | in[i + 2]) * 2654435761u) >> 20;
+      cand = table[h];
+      table[h] = i;
+      if ( cand >= 0 && i - cand <= LZ_WINDOW && !memcmp(in + cand, in + i, LZ_MIN) )
+        for ( len = LZ_MIN; len < LZ_MAX && i + len < n && in[cand + len] == in[i + len]; len++ ) ;
+    }
+
+    if ( len ) {
+      if ( o + 2 > max )
+        return(-1);
+      off = i - cand;
+      out[o++] = ((off >> 8) << 4) | (len - LZ_MIN);
+      out[o++] = off & 0xff;
+      out[ctrl] |= 1 << bit;
+      i += len;
+    }
+    else {
+      if ( o + 1 > max )
+        return(-1);
+      out[o++] = in[i++];
+    }
+    bit++;
+  }
+
+  return(o);
+}
+
+/*!
+  \brief Descomprime n bytes de in em exatamente size bytes de out
+
+  \return -1 se os dados comprimidos sao invalidos, 0 em sucesso
+*/
+static int zip_expand (const unsigned char *in, int n, unsigned char *out, int size) {
+  int i = 0, o = 0, ctrl = 0, bit = 8, len, off;
+
+  while ( i < n && o < size ) {
+    if ( bit == 8 ) {
+      ctrl = in[i++];
+      bit = 0;
+      continue;
+    }
+    if ( ctrl & (1 << bit) ) {
+      if ( i + 2 > n )
+        return(-1);
+      len = (in[i] & 15) + LZ_MIN;
+      off = ((in[i] >> 4) << 8) | in[i + 1];
+      i += 2;
+      if ( !off || off > o || o + len > size )
+        return(-1);
+      // copia byte a byte: a origem pode sobrepor o destino
+      for ( ; len > 0; len--, o++ )
+        out[o] = out[o - off];
+    }
+    else
+      out[o++] = in[i++];
+    bit++;
+  }
+
+  return( (o == size) ? 0 : -1 );
+}
+
+/*!
+  \brief Le ou escreve count blocos contiguos do disco a partir de uma area
+  contigua de memoria
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int zip_io (zip_t *zip, int type, int block, int count, void *area) {
+  void **buffers;
+  int i, result;
+
+  buffers = malloc(count * sizeof(void *));
+  if ( !buffers )
+    return(-1);
+  for ( i = 0; i < count; i++ )
+    buffers[i] = (char *) area + i * zip->blockSize;
+
+  if ( type == READ_OPERATION )
+    result = disk_dev_block_readv(zip->dev, block, count, buffers);
+  else
+    result = disk_dev_block_writev(zip->dev, block, count, buffers);
+
+  free(buffers);
+  return(result);
+}
+
+/*!
+  \brief Le ou escreve os count blocos fisicos listados em blocks, com um
+  acesso por trecho contiguo
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int zip_io_list (zip_t *zip, int type, int *blocks, int count, char *area) {
+  int i, run;
+
+  for ( i = 0; i < count; i += run ) {
+    for ( run = 1; i + run < count && blocks[i + run] == blocks[i] + run; run++ ) ;
+    if ( zip_io(zip, type, blocks[i], run, area + i * zip->blockSize) )
+      return(-1);
+  }
+  return(0);
+}
+
+/*!
+  \brief Calcula a disposicao do volume a partir da geometria do disco
+
+  Uma unidade de blocos de dados fica de reserva, para que a gravacao de uma
+  unidade sempre encontre espaco depois da liberacao dos blocos antigos.
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int zip_layout (zip_t *zip, int dev) {
+  int numBlocks, blockSize;
+
+  if ( disk_dev_geometry(dev, &numBlocks, &blockSize) ||
+       blockSize < (int) (ZE_SIZE * sizeof(int)) )
+    return(-1);
+
+  zip->dev = dev;
+  zip->blockSize = blockSize;
+  zip->chunkBytes = ZIP_CHUNK * blockSize;
+  zip->perBlock = blockSize / (ZE_SIZE * sizeof(int));
+  zip->mapStart = 1;
+  zip->mapBlocks = ((numBlocks - 1) / ZIP_CHUNK + zip->perBlock - 1) / zip->perBlock;
+  zip->dataStart = zip->mapStart + zip->mapBlocks;
+  zip->dataBlocks = numBlocks - zip->dataStart;
+  zip->nchunks = zip->dataBlocks / ZIP_CHUNK - 1;
+  if ( zip->nchunks < 1 )
+    return(-1);
+  zip->numBlocks = zip->nchunks * ZIP_CHUNK;
+
+  return(0);
+}
+
+/*!
+  \brief Entrada do mapa da unidade c
+*/
+static int *zip_entry (zip_t *zip, int c) {
+  return( zip->map + (c / zip->perBlock) * (zip->blockSize / sizeof(int)) +
+          (c % zip->perBlock) * ZE_SIZE );
+}
+
+/*!
+  \brief Blocos fisicos ocupados por size bytes
+*/
+static int zip_span (zip_t *zip, int size) {
+  return( (size + zip->blockSize - 1) / zip->blockSize );
+}
+
+/*!
+  \brief Aloca as estruturas em memoria do volume
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int zip_alloc (zip_t *zip) {
+  int i;
+
+  zip->map = malloc(zip->mapBlocks * zip->blockSize);
+  zip->mapDirty = calloc(zip->mapBlocks, 1);
+  zip->used = calloc(zip->dataBlocks, 1);
+  zip->deferred = malloc(zip->dataBlocks * sizeof(int));
+  // a saida do compressor pode passar um pouco do limite antes de desistir
+  zip->packed = malloc(zip->chunkBytes + zip->blockSize);
+  if ( !zip->map || !zip->mapDirty || !zip->used || !zip->deferred || !zip->packed )
+    return(-1);
+
+  for ( i = 0; i < ZIP_CACHE; i++ ) {
+    zip->cache[i].chunk = -1;
+    zip->cache[i].data = malloc(zip->chunkBytes);
+    if ( !zip->cache[i].data )
+      return(-1);
+  }
+  zip->nfree = zip->dataBlocks;
+
+  return(0);
+}
+
+/*!
+  \brief Libera as estruturas em memoria do volume
+*/
+static void zip_release (zip_t *zip) {
+  int i;
+
+  free(zip->map);
+  free(zip->mapDirty);
+  free(zip->used);
+  free(zip->deferred);
+  free(zip->packed);
+  for ( i = 0; i < ZIP_CACHE; i++ )
+    free(zip->cache[i].data);
+  memset(zip, 0, sizeof(zip_t));
+}
+
+/*!
+  \brief Grava os blocos alterados do mapa e libera os blocos antigos das
+  unidades regravadas
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int zip_flush_map (zip_t *zip) {
+  int b, run, i;
+
+  for ( b = 0; b < zip->mapBlocks; b += run ) {
+    if ( !zip->mapDirty[b] ) {
+      run = 1;
+      continue;
+    }
+    for ( run = 1; b + run < zip->mapBlocks && zip->mapDirty[b + run]; run++ ) ;
+    if ( zip_io(zip, WRITE_OPERATION, zip->mapStart + b, run,
+                (char *) zip->map + b * zip->blockSize) )
+      return(-1);
+    memset(zip->mapDirty + b, 0, run);
+  }
+
+  // o mapa no disco nao aponta mais para os blocos antigos
+  for ( i = 0; i < zip->ndeferred; i++ )
+    zip->used[zip->deferred[i] - zip->dataStart] = 0;
+  zip->nfree += zip->ndeferred;
+  zip->ndeferred = 0;
+
+  return(0);
+}
+
+/*!
+  \brief Escolhe count blocos de dados livres: o primeiro trecho contiguo a
+  partir da ultima alocacao ou, se nao houver, blocos esparsos
+
+  \return -1 se nao ha blocos livres suficientes, 0 em sucesso
+*/
+static int zip_take (zip_t *zip, int count, int *blocks) {
+  int i, b, run = 0;
+
+  if ( zip->nfree < count )
+    return(-1);
+
+  for ( i = 0; i < zip->dataBlocks && run < count; i++ ) {
+    b = (zip->next + i) % zip->dataBlocks;
+    if ( !b )
+      run = 0;
+    run = zip->used[b] ? 0 : run + 1;
+  }
+  if ( run == count )
+    for ( i = 0, b = (b - count + 1); i < count; i++ )
+      blocks[i] = b + i;
+  else
+    for ( i = 0, b = 0; i < count; b++ )
+      if ( !zip->used[b] )
+        blocks[i++] = b;
+
+  for ( i = 0; i < count; i++ ) {
+    zip->used[blocks[i]] = 1;
+    blocks[i] += zip->dataStart;
+  }
+  zip->nfree -= count;
+  zip->next = (blocks[count - 1] - zip->dataStart + 1) % zip->dataBlocks;
+
+  return(0);
+}
+
+/*!
+  \brief Comprime e grava uma unidade da cache em blocos novos
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int zip_writeback (zip_t *zip, zip_chunk_t *slot) {
+  int *entry = zip_entry(zip, slot->chunk), blocks[ZIP_CHUNK];
+  int size, count, i;
+  char *src;
+
+  // a compressao deve economizar ao menos um bloco
+  size = zip_compress((unsigned char *) slot->data, zip->chunkBytes,
+                      (unsigned char *) zip->packed, zip->chunkBytes - zip->blockSize);
+  if ( size < 0 ) {
+    size = zip->chunkBytes;
+    src = slot->data;
+    zip->stats.raw++;
+  }
+  else {
+    src = zip->packed;
+    memset(zip->packed + size, 0, zip_span(zip, size) * zip->blockSize - size);
+  }
+  count = zip_span(zip, size);
+
+  // sem espaco: grava o mapa para liberar os blocos antigos
+  if ( zip_take(zip, count, blocks) &&
+       (zip_flush_map(zip) || zip_take(zip, count, blocks)) ) {
+    fprintf(stderr, "[PPOS error] zip_writeback: no space on disk %d\n", zip->dev);
+    return(-1);
+  }
+
+  if ( zip_io_list(zip, WRITE_OPERATION, blocks, count, src) ) {
+    for ( i = 0; i < count; i++ )
+      zip->used[blocks[i] - zip->dataStart] = 0;
+    zip->nfree += count;
+    return(-1);
+  }
+
+  // os blocos antigos sao liberados apos a gravacao do mapa
+  for ( i = 0; i < zip_span(zip, entry[ZE_LEN]); i++ )
+    zip->deferred[zip->ndeferred++] = entry[1 + i];
+  entry[ZE_LEN] = size;
+  for ( i = 0; i < ZIP_CHUNK; i++ )
+    entry[1 + i] = ( i < count ) ? blocks[i] : -1;
+  zip->mapDirty[slot->chunk / zip->perBlock] = 1;
+
+  slot->dirty = 0;
+  zip->stats.chunks++;
+  zip->stats.physwrites += count;
+  zip->stats.bytesIn += zip->chunkBytes;
+  zip->stats.bytesOut += size;
+
+  return(0);
+}
+
+/*!
+  \brief Unidade c na cache, carregada (e descomprimida) do disco se preciso
+
+  \return Posicao da unidade na cache, ou NULL em erro
+*/
+static zip_chunk_t *zip_load (zip_t *zip, int c) {
+  zip_chunk_t *slot = &zip->cache[0];
+  int *entry, i, count;
+
+  for ( i = 0; i < ZIP_CACHE; i++ )
+    if ( zip->cache[i].chunk == c ) {
+      zip->cache[i].used = ++zip->clock;
+      zip->stats.hits++;
+      return( &zip->cache[i] );
+    }
+
+  // substitui a unidade livre ou menos usada
+  for ( i = 1; i < ZIP_CACHE && slot->chunk >= 0; i++ )
+    if ( zip->cache[i].chunk < 0 || zip->cache[i].used < slot->used )
+      slot = &zip->cache[i];
+  if ( slot->dirty && zip_writeback(zip, slot) )
+    return(NULL);
+  slot->chunk = -1;
+
+  entry = zip_entry(zip, c);
+  if ( !entry[ZE_LEN] )
+    // unidade nunca gravada
+    memset(slot->data, 0, zip->chunkBytes);
+  else {
+    count = zip_span(zip, entry[ZE_LEN]);
+    if ( zip_io_list(zip, READ_OPERATION, entry + 1, count,
+                     ( entry[ZE_LEN] == zip->chunkBytes ) ? slot->data : zip->packed) )
+      return(NULL);
+    zip->stats.physreads += count;
+    if ( entry[ZE_LEN] < zip->chunkBytes &&
+         zip_expand((unsigned char *) zip->packed, entry[ZE_LEN],
+                    (unsigned char *) slot->data, zip->chunkBytes) ) {
+      fprintf(stderr, "[PPOS error] zip_load: corrupted chunk %d on disk %d\n", c, zip->dev);
+      return(NULL);
+    }
+  }
+
+  slot->chunk = c;
+  slot->dirty = 0;
+  slot->used = ++zip->clock;
+  zip->stats.misses++;
+
+  return(slot);
+}
+
+/*!
+  \brief Grava as unidades alteradas da cache e o mapa
+
+  \return -1 em erro ou 0 em sucesso
+*/
+static int zip_flush (zip_t *zip) {
+  int i;
+
+  for ( i = 0; i < ZIP_CACHE; i++ )
+    if ( zip->cache[i].chunk >= 0 && zip->cache[i].dirty &&
+         zip_writeback(zip, &zip->cache[i]) )
+      return(-1);
+
+  return( zip_flush_map(zip) );
+}
+
+// funções gerais ==============================================================
+
+/*!
+  \brief Formata um disco como volume comprimido (todas as unidades vazias)
+
+  \param dev Disco, ja inicializado com disk_dev_mgr_init()
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int zip_format (int dev) {
+  zip_t zip;
+  int *hdr, c, result;
+
+  memset(&zip, 0, sizeof(zip_t));
+  if ( zip_layout(&zip, dev) ) {
+    fprintf(stderr, "[PPOS error] zip_format: disk %d too small\n", dev);
+    return(-1);
+  }
+
+  zip.map = calloc(zip.mapBlocks, zip.blockSize);
+  hdr = calloc(1, zip.blockSize);
+  if ( !zip.map || !hdr ) {
+    free(zip.map);
+    free(hdr);
+    return(-1);
+  }
+
+  for ( c = 0; c < zip.nchunks; c++ )
+    memset(zip_entry(&zip, c) + 1, 0xff, ZIP_CHUNK * sizeof(int));
+  hdr[ZH_MAGIC] = ZIP_MAGIC;
+  hdr[ZH_BLOCKS] = zip.numBlocks;
+  hdr[ZH_BSIZE] = zip.blockSize;
+  hdr[ZH_CHUNK] = ZIP_CHUNK;
+
+  result = zip_io(&zip, WRITE_OPERATION, zip.mapStart, zip.mapBlocks, zip.map) ||
+           disk_dev_block_write(dev, 0, hdr);
+
+  free(zip.map);
+  free(hdr);
+  return( result ? -1 : 0 );
+}
+
+/*!
+  \brief Monta o volume comprimido de um disco
+
+  \param zip Estrutura do volume a preencher
+  \param dev Disco, ja inicializado e formatado com zip_format()
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int zip_mount (zip_t *zip, int dev) {
+  int *entry, c, i;
+
+  if ( !zip )
+    return(-1);
+  memset(zip, 0, sizeof(zip_t));
+  if ( zip_layout(zip, dev) || zip_alloc(zip) ) {
+    zip_release(zip);
+    return(-1);
+  }
+
+  // cabecalho (lido na area da unidade comprimida)
+  entry = (int *) zip->packed;
+  if ( disk_dev_block_read(dev, 0, entry) || entry[ZH_MAGIC] != ZIP_MAGIC ||
+       entry[ZH_BLOCKS] != zip->numBlocks || entry[ZH_CHUNK] != ZIP_CHUNK ) {
+    fprintf(stderr, "[PPOS error] zip_mount: disk %d is not formatted\n", dev);
+    zip_release(zip);
+    return(-1);
+  }
+
+  if ( zip_io(zip, READ_OPERATION, zip->mapStart, zip->mapBlocks, zip->map) ) {
+    zip_release(zip);
+    return(-1);
+  }
+
+  // blocos de dados em uso, a partir do mapa
+  for ( c = 0; c < zip->nchunks; c++ ) {
+    entry = zip_entry(zip, c);
+    for ( i = 0; i < zip_span(zip, entry[ZE_LEN]); i++ ) {
+      zip->used[entry[1 + i] - zip->dataStart] = 1;
+      zip->nfree--;
+    }
+  }
+
+  if ( sem_create(&(zip->lock), 1) ) {
+    zip_release(zip);
+    return(-1);
+  }
+
+  return(0);
+}
+
+/*!
+  \brief Desmonta o volume: grava as unidades alteradas e o mapa
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int zip_umount (zip_t *zip) {
+  int result;
+
+  if ( !zip || !zip->map )
+    return(-1);
+
+  result = zip_sync(zip);
+
+  sem_destroy(&(zip->lock));
+  zip_release(zip);
+
+  return(result);
+}
+
+/*!
+  \brief Leitura de um bloco logico do volume, a partir da unidade
+  descomprimida na cache
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int zip_block_read (zip_t *zip, int block, void *buffer) {
+  zip_chunk_t *slot;
+
+  if ( !zip || !zip->map || !buffer || block < 0 || block >= zip->numBlocks )
+    return(-1);
+
+  if ( sem_down(&(zip->lock)) )
+    return(-1);
+
+  slot = zip_load(zip, block / ZIP_CHUNK);
+  if ( slot )
+    memcpy(buffer, slot->data + (block % ZIP_CHUNK) * zip->blockSize, zip->blockSize);
+  zip->stats.reads++;
+
+  sem_up(&(zip->lock));
+
+  return( slot ? 0 : -1 );
+}
+
+/*!
+  \brief Escrita de um bloco logico do volume, na unidade da cache
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int zip_block_write (zip_t *zip, int block, void *buffer) {
+  zip_chunk_t *slot;
+
+  if ( !zip || !zip->map || !buffer || block < 0 || block >= zip->numBlocks )
+    return(-1);
+
+  if ( sem_down(&(zip->lock)) )
+    return(-1);
+
+  slot = zip_load(zip, block / ZIP_CHUNK);
+  if ( slot ) {
+    memcpy(slot->data + (block % ZIP_CHUNK) * zip->blockSize, buffer, zip->blockSize);
+    slot->dirty = 1;
+  }
+  zip->stats.writes++;
+
+  sem_up(&(zip->lock));
+
+  return( slot ? 0 : -1 );
+}
+
+/*!
+  \brief Grava as unidades alteradas e o mapa
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int zip_sync (zip_t *zip) {
+  int result;
+
+  if ( !zip || !zip->map )
+    return(-1);
+
+  if ( sem_down(&(zip->lock)) )
+    return(-1);
+
+  result = zip_flush(zip);
+
+  sem_up(&(zip->lock));
+
+  return(result);
+}
+
+/*!
+  \brief Consulta os contadores do volume
+
+  \return -1 em erro ou 0 em sucesso
+*/
+int zip_stats (zip_t *zip, zip_stats_t *stats) {
+  if ( !zip || !stats )
+    return(-1);
+
+  *stats = zip->stats;
+
+  return(0);
+}
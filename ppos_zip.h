@@ -0,0 +1,107 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Camada de compressao transparente de blocos sobre um disco do gerente de
+// disco
+
+#ifndef __PPOS_ZIP__
+#define __PPOS_ZIP__
+
+#include "ppos_disk.h"
+
+// Os blocos lógicos são agrupados em unidades de ZIP_CHUNK blocos
+// consecutivos, comprimidas em conjunto (LZ77 simples) e gravadas em tantos
+// blocos físicos quanto necessário; um mapa indica, para cada unidade, o
+// tamanho comprimido e os blocos físicos usados (contíguos sempre que
+// possível, para um único acesso). Leituras descomprimem a unidade inteira
+// em uma cache de unidades; escritas alteram a unidade na cache, que é
+// comprimida e gravada na substituição ou em zip_sync(). Unidades que não
+// diminuem ao menos um bloco são gravadas sem compressão.
+//
+// A gravação de uma unidade usa blocos novos; os blocos antigos só são
+// liberados depois que o mapa é gravado, de modo que o mapa no disco sempre
+// aponta para dados válidos. A capacidade lógica não depende da taxa de
+// compressão.
+//
+// Disposição no disco:
+//   [cabeçalho][mapa][dados...]
+//
+// Escritas só são duráveis após zip_sync().
+
+#define ZIP_CHUNK   8   // blocos logicos por unidade de compressao
+#define ZIP_CACHE  16   // unidades descomprimidas na cache
+
+// contadores da camada de compressao
+typedef struct
+{
+  unsigned int reads;       // blocos lidos pelas aplicacoes
+  unsigned int writes;      // blocos escritos pelas aplicacoes
+  unsigned int hits;        // acessos a unidades na cache
+  unsigned int misses;      // unidades carregadas do disco
+  unsigned int physreads;   // blocos fisicos lidos
+  unsigned int physwrites;  // blocos fisicos gravados (dados)
+  unsigned int chunks;      // unidades gravadas
+  unsigned int raw;         // unidades gravadas sem compressao
+  unsigned long bytesIn;    // bytes das unidades gravadas
+  unsigned long bytesOut;   // bytes comprimidos das unidades gravadas
+} zip_stats_t ;
+
+// unidade descomprimida na cache
+typedef struct
+{
+  int chunk;                // unidade (-1 = livre)
+  int dirty;                // alterada desde a ultima gravacao
+  unsigned int used;        // ultimo uso (LRU)
+  char *data;               // ZIP_CHUNK blocos logicos
+} zip_chunk_t ;
+
+// estrutura que representa um volume comprimido montado
+typedef struct
+{
+  int dev;                  // disco do volume
+  int numBlocks;            // blocos logicos do volume
+  int blockSize;            // tamanho de cada bloco, em bytes
+  int chunkBytes;           // bytes por unidade
+  int nchunks;              // quantidade de unidades
+  int perBlock;             // entradas do mapa por bloco
+  int mapStart;             // primeiro bloco do mapa
+  int mapBlocks;            // blocos do mapa
+  int dataStart;            // primeiro bloco de dados
+  int dataBlocks;           // blocos de dados
+  int *map;                 // mapa: por unidade, tamanho e blocos fisicos
+  char *mapDirty;           // blocos do mapa alterados
+  char *used;               // blocos de dados em uso
+  int nfree;                // blocos de dados livres
+  int next;                 // inicio da busca por blocos livres
+  int *deferred;            // blocos a liberar depois da gravacao do mapa
+  int ndeferred;            // blocos em deferred
+  zip_chunk_t cache[ZIP_CACHE];  // cache de unidades
+  unsigned int clock;       // relogio do LRU da cache
+  char *packed;             // unidade comprimida
+  semaphore_t lock;         // acesso exclusivo ao volume
+  zip_stats_t stats;        // contadores
+} zip_t ;
+
+// Todas as funcoes retornam -1 em erro ou 0 em sucesso.
+
+// formata o disco dev (ja inicializado com disk_dev_mgr_init)
+int zip_format (int dev) ;
+
+// monta o volume comprimido do disco dev
+int zip_mount (zip_t *zip, int dev) ;
+
+// grava as unidades alteradas e o mapa e desmonta o volume
+int zip_umount (zip_t *zip) ;
+
+// leitura/escrita de um bloco logico do volume
+int zip_block_read (zip_t *zip, int block, void *buffer) ;
+int zip_block_write (zip_t *zip, int block, void *buffer) ;
+
+// grava as unidades alteradas e o mapa
+int zip_sync (zip_t *zip) ;
+
+// consulta os contadores do volume
+int zip_stats (zip_t *zip, zip_stats_t *stats) ;
+
+#endif
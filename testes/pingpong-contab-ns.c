@@ -0,0 +1,141 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste da contabilização em nanossegundos (task_stats e ppos_stats): duas
+// tarefas de CPU disputam o processador ate acumular CPUTIME ms cada, uma
+// tarefa dorme SLEEPS vezes e duas tarefas trocam ROUNDS mensagens por
+// semaforos (rajadas muito menores que um tick). A main consulta o sistema
+// periodicamente e confere que, para cada tarefa, execucao + espera na fila
+// de prontas + suspensao somam o tempo desde a criacao.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "ppos.h"
+
+#define CPUTIME 100		// tempo de CPU de cada tarefa de CPU (ms)
+#define SLEEPS  50		// cochilos da tarefa dorminhoca
+#define ROUNDS  500		// trocas entre Ping e Pong
+#define MAXTASKS 16
+
+task_t cpu1, cpu2, sleeper, ping, pong ;
+semaphore_t sPing, sPong ;
+int errors = 0 ;
+
+// consome CPU ate a tarefa acumular CPUTIME ms de execucao
+void cpuBody (void *arg)
+{
+  task_stats_t st ;
+
+  do
+    task_stats (NULL, &st) ;
+  while (st.run_ns < CPUTIME * 1000000ULL) ;
+  task_exit (0) ;
+}
+
+// dorme SLEEPS vezes por 2 ms
+void sleepBody (void *arg)
+{
+  int i ;
+
+  for (i = 0; i < SLEEPS; i++)
+    task_sleep (2) ;
+  task_exit (0) ;
+}
+
+// troca a vez com a outra tarefa ROUNDS vezes
+void pingBody (void *arg)
+{
+  int i ;
+
+  for (i = 0; i < ROUNDS; i++)
+  {
+    sem_down (arg == &ping ? &sPing : &sPong) ;
+    sem_up (arg == &ping ? &sPong : &sPing) ;
+  }
+  task_exit (0) ;
+}
+
+// mostra os contadores de uma tarefa
+void show (char *name, task_stats_t *st)
+{
+  printf ("%-8s %9.3f ms executando, %9.3f ms pronta, %9.3f ms suspensa, "
+          "%4u voluntarias, %3u preempcoes\n", name, st->run_ns / 1e6, st->ready_ns / 1e6,
+          st->blocked_ns / 1e6, st->vol_switches, st->invol_switches) ;
+}
+
+int main (int argc, char *argv[])
+{
+  task_stats_t tasks[MAXTASKS], st ;
+  ppos_stats_t sys ;
+  unsigned long long run ;
+  int i, n, snapshots = 0, bad = 0 ;
+
+  printf ("main: inicio\n") ;
+
+  ppos_init () ;
+
+  sem_create (&sPing, 1) ;
+  sem_create (&sPong, 0) ;
+  task_create (&cpu1, cpuBody, NULL) ;
+  task_create (&cpu2, cpuBody, NULL) ;
+  task_create (&sleeper, sleepBody, NULL) ;
+  task_create (&ping, pingBody, &ping) ;
+  task_create (&pong, pingBody, &pong) ;
+
+  // consultas periodicas do sistema inteiro
+  while (cpu1.status != 2 || cpu2.status != 2 || sleeper.status != 2 ||
+         ping.status != 2 || pong.status != 2)
+  {
+    n = ppos_stats (&sys, tasks, MAXTASKS) ;
+    snapshots++ ;
+    run = 0 ;
+    for (i = 0; i < n && i < MAXTASKS; i++)
+    {
+      run += tasks[i].run_ns ;
+      if (tasks[i].run_ns + tasks[i].ready_ns + tasks[i].blocked_ns != tasks[i].elapsed_ns)
+        bad++ ;
+    }
+    if (n < 3 || n > 7 || run > sys.uptime_ns)
+      bad++ ;
+    task_sleep (10) ;
+  }
+  printf ("%d consultas do sistema, %d inconsistentes\n", snapshots, bad) ;
+  errors += bad ;
+
+  // contadores finais de cada tarefa
+  task_stats (&cpu1, &st) ;
+  show ("cpu1", &st) ;
+  if (st.run_ns < CPUTIME * 1000000ULL || st.invol_switches < 1)
+    errors++ ;
+  task_stats (&cpu2, &st) ;
+  show ("cpu2", &st) ;
+  if (st.run_ns < CPUTIME * 1000000ULL || st.invol_switches < 1)
+    errors++ ;
+  task_stats (&sleeper, &st) ;
+  show ("sleeper", &st) ;
+  if (st.blocked_ns < SLEEPS * 1000000ULL || st.vol_switches < SLEEPS || !st.run_ns)
+    errors++ ;
+  task_stats (&ping, &st) ;
+  show ("ping", &st) ;
+  if (st.vol_switches < ROUNDS - 1 || !st.run_ns || st.run_ns > CPUTIME * 1000000ULL)
+    errors++ ;
+  task_stats (&pong, &st) ;
+  show ("pong", &st) ;
+  if (st.vol_switches < ROUNDS - 1 || !st.run_ns)
+    errors++ ;
+  task_stats (NULL, &st) ;
+  show ("main", &st) ;
+
+  // apenas a main e o dispatcher continuam no registro
+  n = ppos_stats (&sys, NULL, 0) ;
+  printf ("sistema: %d tarefas, %llu trocas de contexto, %llu preempcoes, %.1f ms\n", n,
+          sys.switches, sys.preemptions, sys.uptime_ns / 1e6) ;
+  if (n != 2 || sys.preemptions < 2 || sys.switches < 2 * ROUNDS)
+    errors++ ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
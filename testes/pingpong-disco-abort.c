@@ -0,0 +1,153 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste do abandono de pedidos de disco: cancela pedidos ainda na fila e
+// compara a latência de cauda dos pedidos atendidos sob sobrecarga (rajadas
+// de leituras muito acima da capacidade do disco), sem prazo de abandono
+// (disco 0) e com prazo de EXPIRE ms (disco 1).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_disk.h"
+
+#define DISKBLOCKS 1024		// blocos de cada disco
+#define NUMTASKS   8		// tarefas geradoras de carga
+#define ROUNDS     6		// rajadas por tarefa
+#define BURST      8		// leituras por rajada
+#define EXPIRE     60		// prazo de abandono (ms)
+
+task_t tasks[NUMTASKS] ;
+int device, timeout ;		// disco e prazo em teste
+int blocksize ;
+int done, expired, errors = 0 ;
+
+// envia rajadas de leituras assincronas e aguarda cada rajada
+void loadBody (void * arg)
+{
+  request_t reqs[BURST] ;
+  void *buffers[BURST] ;
+  int i, r, result ;
+
+  for (i = 0; i < BURST; i++)
+    buffers[i] = malloc (blocksize) ;
+
+  for (r = 0; r < ROUNDS; r++)
+  {
+    for (i = 0; i < BURST; i++)
+      if (disk_dev_submit_timed (device, &reqs[i], READ_OPERATION,
+                                 random () % DISKBLOCKS, 1, &buffers[i], timeout))
+        errors++ ;
+    for (i = 0; i < BURST; i++)
+    {
+      result = disk_dev_wait (&reqs[i]) ;
+      if (result == 0)
+        done++ ;
+      else if (result == DISK_ETIMEDOUT)
+        expired++ ;
+      else
+        errors++ ;
+    }
+  }
+
+  for (i = 0; i < BURST; i++)
+    free (buffers[i]) ;
+  task_exit (0) ;
+}
+
+// executa a carga de sobrecarga no disco dev com o prazo indicado
+void overload (int dev, int tmo)
+{
+  unsigned int start ;
+  int i ;
+
+  device = dev ;
+  timeout = tmo ;
+  done = expired = 0 ;
+  srandom (42) ;
+
+  start = systime () ;
+  for (i = 0; i < NUMTASKS; i++)
+    task_create (&tasks[i], loadBody, NULL) ;
+  for (i = 0; i < NUMTASKS; i++)
+    task_join (&tasks[i]) ;
+
+  printf ("prazo %3d ms: %4d ms, %3d atendidos, %3d abandonados, latencia "
+          "p50 %4d ms  p99 %4d ms  max %4d ms\n", tmo, systime () - start,
+          done, expired, disk_dev_latency (dev, DISK_CLASS_NORMAL, 50),
+          disk_dev_latency (dev, DISK_CLASS_NORMAL, 99),
+          disk_dev_latency (dev, DISK_CLASS_NORMAL, 100)) ;
+}
+
+// envia leituras e cancela a segunda metade delas
+void cancel (int dev)
+{
+  request_t reqs[16] ;
+  void *buffers[16] ;
+  int i, ok = 0, canceled = 0, result ;
+
+  for (i = 0; i < 16; i++)
+  {
+    buffers[i] = malloc (blocksize) ;
+    if (disk_dev_submit (dev, &reqs[i], READ_OPERATION, i * 32, 1, &buffers[i]))
+      errors++ ;
+  }
+  for (i = 8; i < 16; i++)
+    if (disk_dev_cancel (dev, &reqs[i]) == 0)
+      canceled++ ;
+  for (i = 0; i < 16; i++)
+  {
+    result = disk_dev_wait (&reqs[i]) ;
+    if (result == 0)
+      ok++ ;
+    else if (result != DISK_ECANCELED || i < 8)
+      errors++ ;
+    free (buffers[i]) ;
+  }
+  printf ("cancelamento: %d pedidos, %d cancelados, %d atendidos\n", 16,
+          canceled, ok) ;
+}
+
+int main (int argc, char *argv[])
+{
+  disk_config_t cfg ;
+  int i, numblocks ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // cria e inicializa os discos, com tempos de acesso reduzidos
+  for (i = 0; i < 2; i++)
+  {
+    disk_config_init (&cfg) ;
+    sprintf (cfg.image, "disk-abort%d.dat", i) ;
+    cfg.numblocks = DISKBLOCKS ;
+    cfg.seek_min_us = 2000 ;
+    cfg.seek_max_us = 20000 ;
+    cfg.jitter_us = 2000 ;
+    cfg.xfer_rate = 640000 ;
+    if (disk_dev_config (i, &cfg) < 0 ||
+        disk_dev_mgr_init (i, &numblocks, &blocksize) < 0)
+    {
+      printf ("Erro na abertura do disco %d\n", i) ;
+      exit (1) ;
+    }
+  }
+
+  cancel (0) ;
+  overload (0, 0) ;
+  overload (1, EXPIRE) ;
+
+  unlink ("disk-abort0.dat") ;
+  unlink ("disk-abort1.dat") ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
@@ -0,0 +1,150 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste da configuração do disco simulado: cria uma imagem com blocos de
+// 4 KiB no perfil SSD, escreve e relê todos os blocos conferindo o conteúdo.
+// A configuração pode ser ajustada pela variável de ambiente PPOS_DISK.
+// Por fim, um segundo disco sem gerente recebe comandos brutos (disk_cmd)
+// seguidos, cada um apos a conclusao do anterior.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "disk.h"
+#include "ppos_disk.h"
+
+#define IMAGE     "disk-config.dat"	// imagem criada pelo teste
+#define RAWIMAGE  "disk-config1.dat"	// imagem do disco sem gerente
+#define RAWBLOCKS 3			// comandos brutos de cada tipo
+#define BLOCKSIZE 4096
+#define NUMBLOCKS 256
+
+int numblocks ;			// numero de blocos no disco
+int blocksize ;			// tamanho de cada bloco (bytes)
+
+// aguarda o disco dev concluir o comando bruto em andamento
+int raw_wait (int dev)
+{
+  int i ;
+
+  for (i = 0; i < 1000 && disk_dev_cmd (dev, DISK_CMD_STATUS, 0, 0) != DISK_STATUS_IDLE; i++)
+    task_sleep (1) ;
+  return (i < 1000) ? 0 : -1 ;
+}
+
+// escreve e rele RAWBLOCKS blocos do disco dev com comandos brutos
+int raw_commands (int dev)
+{
+  char *buffer = malloc (BLOCKSIZE) ;
+  int i, errors = 0 ;
+
+  for (i = 0; i < RAWBLOCKS; i++)
+  {
+    memset (buffer, 'a' + i, BLOCKSIZE) ;
+    if (disk_dev_cmd (dev, DISK_CMD_WRITE, i, buffer) || raw_wait (dev))
+    {
+      printf ("comando bruto: escrita %d recusada\n", i) ;
+      errors++ ;
+    }
+  }
+  for (i = 0; i < RAWBLOCKS; i++)
+  {
+    memset (buffer, 0, BLOCKSIZE) ;
+    if (disk_dev_cmd (dev, DISK_CMD_READ, i, buffer) || raw_wait (dev) ||
+        buffer[0] != 'a' + i || buffer[BLOCKSIZE - 1] != 'a' + i)
+    {
+      printf ("comando bruto: leitura %d recusada ou incorreta\n", i) ;
+      errors++ ;
+    }
+  }
+  free (buffer) ;
+  return errors ;
+}
+
+int main (int argc, char *argv[])
+{
+  int i, errors = 0 ;
+  unsigned int start, wtime, rtime ;
+  char *buffer ;
+  disk_config_t cfg ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // configura o disco antes de inicializar o gerente
+  disk_config_init (&cfg) ;
+  disk_config_profile (&cfg, DISK_PROFILE_SSD) ;
+  strcpy (cfg.image, IMAGE) ;
+  cfg.blocksize = BLOCKSIZE ;
+  cfg.numblocks = NUMBLOCKS ;
+  if (disk_config (&cfg) < 0)
+  {
+    printf ("Erro na configuracao do disco\n") ;
+    exit (1) ;
+  }
+
+  // inicializa o gerente de disco
+  if (disk_mgr_init (&numblocks, &blocksize) < 0)
+  {
+    printf ("Erro na abertura do disco\n") ;
+    exit (1) ;
+  }
+  printf ("Disco contem %d blocos de %d bytes cada, atraso %d-%d ms\n",
+          numblocks, blocksize, disk_cmd (DISK_CMD_DELAYMIN, 0, 0),
+          disk_cmd (DISK_CMD_DELAYMAX, 0, 0)) ;
+
+  buffer = malloc (blocksize) ;
+
+  // escreve em cada bloco o seu numero
+  start = systime () ;
+  for (i = 0; i < numblocks; i++)
+  {
+    memset (buffer, 'A' + i % 26, blocksize) ;
+    sprintf (buffer, "<bloco %04d>", i) ;
+    if (disk_block_write (i, buffer))
+      errors++ ;
+  }
+  wtime = systime () - start ;
+
+  // le e confere cada bloco
+  start = systime () ;
+  for (i = 0; i < numblocks; i++)
+  {
+    char expected[32] ;
+
+    if (disk_block_read (i, buffer))
+      errors++ ;
+    sprintf (expected, "<bloco %04d>", i) ;
+    if (strcmp (buffer, expected) || buffer[blocksize - 1] != 'A' + i % 26)
+      errors++ ;
+  }
+  rtime = systime () - start ;
+
+  printf ("escrita: %d blocos em %d ms, leitura: %d blocos em %d ms\n",
+          numblocks, wtime, numblocks, rtime) ;
+
+  free (buffer) ;
+  unlink (IMAGE) ;
+
+  // disco 1, sem gerente: comandos brutos em sequencia
+  disk_config_init (&cfg) ;
+  disk_config_profile (&cfg, DISK_PROFILE_SSD) ;
+  strcpy (cfg.image, RAWIMAGE) ;
+  cfg.blocksize = BLOCKSIZE ;
+  cfg.numblocks = NUMBLOCKS ;
+  if (disk_dev_config (1, &cfg) < 0 || disk_dev_cmd (1, DISK_CMD_INIT, 0, 0) < 0)
+    errors++ ;
+  else
+    errors += raw_commands (1) ;
+  unlink (RAWIMAGE) ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
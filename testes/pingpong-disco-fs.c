@@ -0,0 +1,299 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste do sistema de arquivos com extents: mede a vazão de escrita e de
+// leitura de arquivos (leitura inteira, em um acesso por extent, e leitura
+// bloco a bloco), confere que os arquivos ficam contíguos e que arquivos
+// pequenos ficam no inode, remove arquivos e reusa o espaço, confere que um
+// arquivo pequeno que não consegue crescer com o disco cheio continua
+// intacto no inode, e remonta o sistema de arquivos conferindo o conteúdo.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_fs.h"
+
+#define DISKBLOCKS 4096		// blocos do disco
+#define BLOCKSIZE  512		// tamanho dos blocos
+#define NUMFILES   8		// arquivos grandes
+#define FILESIZE   (64 * 1024)	// tamanho dos arquivos grandes
+#define CHUNK      4096		// tamanho de cada escrita
+#define NUMSMALL   32		// arquivos pequenos
+#define SMALLSIZE  100		// tamanho dos arquivos pequenos
+
+fs_t fs ;
+char *data ;			// conteudo esperado dos arquivos grandes
+int errors = 0 ;
+
+// conteudo esperado do byte pos do arquivo f
+char expected (int f, int pos)
+{
+  return ((f * 31 + pos / 7) & 0xff) ;
+}
+
+// cria os arquivos grandes com escritas de CHUNK bytes
+void write_files (void)
+{
+  fs_file_t file ;
+  fs_stat_t st ;
+  unsigned int start ;
+  int f, pos, extents = 0 ;
+  char name[16] ;
+
+  start = systime () ;
+  for (f = 0; f < NUMFILES; f++)
+  {
+    sprintf (name, "big%d", f) ;
+    for (pos = 0; pos < FILESIZE; pos++)
+      data[pos] = expected (f, pos) ;
+    if (fs_create (&fs, name) || fs_open (&fs, &file, name))
+    {
+      errors++ ;
+      continue ;
+    }
+    for (pos = 0; pos < FILESIZE; pos += CHUNK)
+      if (fs_write (&file, data + pos, CHUNK) != CHUNK)
+        errors++ ;
+    fs_close (&file) ;
+    if (fs_stat (&fs, name, &st) || st.size != FILESIZE)
+      errors++ ;
+    extents += st.extents ;
+  }
+  printf ("escrita:        %d arquivos de %d KB em %5d ms: %7.1f KB/s, "
+          "%d extents\n", NUMFILES, FILESIZE / 1024, systime () - start,
+          NUMFILES * FILESIZE / 1024 * 1000.0 / (systime () - start + 1),
+          extents) ;
+}
+
+// le os arquivos grandes em pedacos de size bytes e confere o conteudo
+void read_files (int size, char *name)
+{
+  fs_file_t file ;
+  fs_stats_t before, after ;
+  unsigned int start ;
+  int f, pos, n, bad = 0 ;
+  char fname[16] ;
+
+  fs_stats (&fs, &before, NULL) ;
+  start = systime () ;
+  for (f = 0; f < NUMFILES; f++)
+  {
+    sprintf (fname, "big%d", f) ;
+    if (fs_open (&fs, &file, fname))
+    {
+      errors++ ;
+      continue ;
+    }
+    for (pos = 0; pos < FILESIZE; pos += n)
+    {
+      n = fs_read (&file, data + pos, size) ;
+      if (n <= 0)
+      {
+        errors++ ;
+        break ;
+      }
+    }
+    if (fs_read (&file, data, size) != 0)
+      errors++ ;
+    fs_close (&file) ;
+    for (pos = 0; pos < FILESIZE; pos++)
+      if (data[pos] != expected (f, pos))
+      {
+        bad++ ;
+        break ;
+      }
+  }
+  fs_stats (&fs, &after, NULL) ;
+  printf ("leitura %-6s: %d arquivos de %d KB em %5d ms: %7.1f KB/s, "
+          "%4u acessos, %d incorretos\n", name, NUMFILES, FILESIZE / 1024,
+          systime () - start,
+          NUMFILES * FILESIZE / 1024 * 1000.0 / (systime () - start + 1),
+          after.ios - before.ios, bad) ;
+  errors += bad ;
+}
+
+// cria ou confere os arquivos pequenos
+void small_files (int create, char *name)
+{
+  fs_file_t file ;
+  fs_stat_t st ;
+  char buffer[SMALLSIZE], fname[16] ;
+  int f, i, inlined = 0, bad = 0 ;
+
+  for (f = 0; f < NUMSMALL; f++)
+  {
+    sprintf (fname, "small%d", f) ;
+    for (i = 0; i < SMALLSIZE; i++)
+      buffer[i] = f + i ;
+    if (create)
+    {
+      if (fs_create (&fs, fname) || fs_open (&fs, &file, fname) ||
+          fs_write (&file, buffer, SMALLSIZE / 2) != SMALLSIZE / 2 ||
+          fs_write (&file, buffer + SMALLSIZE / 2, SMALLSIZE / 2) != SMALLSIZE / 2)
+        errors++ ;
+    }
+    else
+    {
+      if (fs_open (&fs, &file, fname) ||
+          fs_read (&file, buffer, SMALLSIZE) != SMALLSIZE)
+        errors++ ;
+      for (i = 0; i < SMALLSIZE; i++)
+        if (buffer[i] != (char) (f + i))
+        {
+          bad++ ;
+          break ;
+        }
+    }
+    fs_close (&file) ;
+    if (!fs_stat (&fs, fname, &st) && st.inlined && !st.blocks)
+      inlined++ ;
+  }
+  printf ("%s: %d arquivos de %d bytes, %d no inode, %d incorretos\n",
+          name, NUMSMALL, SMALLSIZE, inlined, bad) ;
+  if (inlined != NUMSMALL)
+    errors++ ;
+  errors += bad ;
+}
+
+// enche o disco e tenta passar um arquivo pequeno para blocos: a escrita
+// deve falhar sem perder os dados que estao no inode
+void full (void)
+{
+  fs_file_t file ;
+  fs_stat_t st ;
+  fs_stats_t stats ;
+  char buffer[2 * SMALLSIZE], *fill ;
+  int nfree, i, bad = 0 ;
+
+  fs_stats (&fs, &stats, &nfree) ;
+  fill = calloc (nfree, BLOCKSIZE) ;
+  if (fs_create (&fs, "cheio") || fs_open (&fs, &file, "cheio") ||
+      fs_write (&file, fill, nfree * BLOCKSIZE) != nfree * BLOCKSIZE)
+    errors++ ;
+  fs_close (&file) ;
+  free (fill) ;
+  fs_stats (&fs, &stats, &nfree) ;
+
+  memset (buffer, 0, sizeof (buffer)) ;
+  if (fs_open (&fs, &file, "small0") || fs_seek (&file, SMALLSIZE) ||
+      fs_write (&file, buffer, SMALLSIZE) != -1)
+    errors++ ;
+  fs_close (&file) ;
+
+  if (fs_open (&fs, &file, "small0") ||
+      fs_read (&file, buffer, sizeof (buffer)) != SMALLSIZE)
+    errors++ ;
+  fs_close (&file) ;
+  for (i = 0; i < SMALLSIZE; i++)
+    if (buffer[i] != (char) i)
+      bad++ ;
+  if (fs_stat (&fs, "small0", &st) || !st.inlined || st.blocks || st.size != SMALLSIZE)
+    bad++ ;
+  printf ("disco cheio: %d blocos livres, arquivo pequeno %s\n", nfree,
+          bad ? "corrompido" : "intacto no inode") ;
+  errors += bad ;
+
+  if (fs_unlink (&fs, "cheio"))
+    errors++ ;
+}
+
+int main (int argc, char *argv[])
+{
+  disk_config_t cfg ;
+  fs_file_t file ;
+  fs_stat_t st ;
+  fs_stats_t stats ;
+  int numblocks, blocksize, free0, free1, f ;
+  char name[16] ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // cria e inicializa o disco, com tempos de acesso reduzidos
+  disk_config_init (&cfg) ;
+  strcpy (cfg.image, "disk-fs.dat") ;
+  cfg.numblocks = DISKBLOCKS ;
+  cfg.blocksize = BLOCKSIZE ;
+  cfg.seek_min_us = 2000 ;
+  cfg.seek_max_us = 20000 ;
+  cfg.jitter_us = 2000 ;
+  cfg.xfer_rate = 6400000 ;
+  if (disk_dev_config (0, &cfg) < 0 ||
+      disk_dev_mgr_init (0, &numblocks, &blocksize) < 0)
+  {
+    printf ("Erro na abertura do disco\n") ;
+    exit (1) ;
+  }
+
+  if (fs_format (0, 64) || fs_mount (&fs, 0))
+  {
+    printf ("Erro na criacao do sistema de arquivos\n") ;
+    exit (1) ;
+  }
+  data = malloc (FILESIZE) ;
+
+  fs_stats (&fs, &stats, &free0) ;
+  small_files (1, "pequenos") ;
+  fs_stats (&fs, &stats, &free1) ;
+  if (free1 != free0)
+    errors++ ;
+
+  write_files () ;
+  read_files (FILESIZE, "inteira") ;
+  read_files (BLOCKSIZE, "blocos") ;
+
+  // remove metade dos arquivos e cria um arquivo que ocupa o espaco liberado
+  for (f = 0; f < NUMFILES; f += 2)
+  {
+    sprintf (name, "big%d", f) ;
+    if (fs_unlink (&fs, name))
+      errors++ ;
+  }
+  if (fs_create (&fs, "novo") || fs_open (&fs, &file, "novo"))
+    errors++ ;
+  for (f = 0; f < 2 * FILESIZE / CHUNK; f++)
+    if (fs_write (&file, data, CHUNK) != CHUNK)
+      errors++ ;
+  fs_close (&file) ;
+  fs_stat (&fs, "novo", &st) ;
+  fs_stats (&fs, &stats, &free1) ;
+  printf ("reuso: arquivo de %d KB em %d extents, %d blocos livres\n",
+          st.size / 1024, st.extents, free1) ;
+
+  full () ;
+  fs_stats (&fs, &stats, &free1) ;
+
+  // remonta e confere os arquivos restantes
+  if (fs_umount (&fs) || fs_mount (&fs, 0))
+  {
+    printf ("Erro na remontagem do sistema de arquivos\n") ;
+    exit (1) ;
+  }
+  fs_stats (&fs, &stats, &free0) ;
+  if (free0 != free1)
+    errors++ ;
+  small_files (0, "remontagem") ;
+  for (f = 1; f < NUMFILES; f += 2)
+  {
+    sprintf (name, "big%d", f) ;
+    if (fs_open (&fs, &file, name) || fs_read (&file, data, FILESIZE) != FILESIZE ||
+        data[FILESIZE - 1] != expected (f, FILESIZE - 1))
+      errors++ ;
+    fs_close (&file) ;
+  }
+  if (fs_umount (&fs))
+    errors++ ;
+
+  unlink ("disk-fs.dat") ;
+  free (data) ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
@@ -0,0 +1,222 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste do journal com commit em grupo: tarefas concorrentes fazem
+// transações de TXBLOCKS blocos aleatórios, gravados diretamente (uma
+// escrita síncrona por bloco, disco 0) ou pelo journal (disco 1), e a vazão
+// de commits é medida com 1, 4 e 16 tarefas. O log é pequeno para a carga:
+// o checkpoint em segundo plano deve rodar durante a carga e commits devem
+// aguardar espaço no log cheio. Depois, para a tarefa de checkpoint, faz
+// mais transações, simula a perda da memória (sem checkpoint final), reabre
+// o journal e confere que todos os registros novos foram reaplicados.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_journal.h"
+
+#define DISKBLOCKS 4096		// blocos de cada disco
+#define BLOCKSIZE  512		// tamanho dos blocos
+#define JSTART     0		// regiao do journal no disco 1
+#define JBLOCKS    256		// log menor que a carga: exige checkpoints
+#define AREA       2048		// primeiro bloco da area de destino
+#define SPAN       64		// blocos de destino de cada tarefa
+#define MAXTASKS   16		// maximo de tarefas concorrentes
+#define COMMITS    16		// transacoes por tarefa
+#define TXBLOCKS   2		// blocos por transacao
+
+task_t tasks[MAXTASKS] ;
+journal_t journal ;
+int use_journal ;		// 1 = transacoes pelo journal
+int version[MAXTASKS * SPAN] ;	// ultima versao gravada de cada bloco
+int stamp = 0 ;			// gerador de versoes
+int errors = 0 ;
+
+// preenche o buffer com o conteudo esperado do bloco
+void fill (int *buffer, int block, int ver)
+{
+  memset (buffer, 0, BLOCKSIZE) ;
+  buffer[0] = block ;
+  buffer[1] = ver ;
+}
+
+// faz COMMITS transacoes em blocos proprios da tarefa
+void txBody (void * arg)
+{
+  int id = (long) arg ;
+  int buffer[BLOCKSIZE / sizeof (int)] ;
+  int vers[TXBLOCKS], blocks[TXBLOCKS] ;
+  journal_tx_t tx ;
+  int c, i, ok ;
+
+  for (c = 0; c < COMMITS; c++)
+  {
+    if (use_journal && journal_begin (&journal, &tx))
+      errors++ ;
+    ok = 1 ;
+    for (i = 0; i < TXBLOCKS; i++)
+    {
+      blocks[i] = id * SPAN + (random () % SPAN) ;
+      vers[i] = ++stamp ;
+      fill (buffer, AREA + blocks[i], vers[i]) ;
+      if (use_journal)
+        ok &= !journal_write (&tx, AREA + blocks[i], buffer) ;
+      else
+        ok &= !disk_dev_block_write (0, AREA + blocks[i], buffer) ;
+    }
+    if (use_journal)
+      ok &= !journal_commit (&tx) ;
+    if (!ok)
+      errors++ ;
+    // o ultimo bloco repetido na transacao tem a versao mais nova
+    for (i = 0; i < TXBLOCKS; i++)
+      version[blocks[i]] = vers[i] ;
+  }
+  task_exit (0) ;
+}
+
+// executa ntasks tarefas concorrentes e mostra a vazao de commits
+void run (int ntasks)
+{
+  journal_stats_t before, after ;
+  unsigned int start, elapsed ;
+  long i ;
+
+  journal_stats (&journal, &before) ;
+  start = systime () ;
+  for (i = 0; i < ntasks; i++)
+    task_create (&tasks[i], txBody, (void *) i) ;
+  for (i = 0; i < ntasks; i++)
+    task_join (&tasks[i]) ;
+  elapsed = systime () - start ;
+  journal_stats (&journal, &after) ;
+
+  if (use_journal)
+    printf ("journal %2d tarefas: %4d commits em %5d ms: %6.1f commits/s, "
+            "%3u gravacoes do journal (%4.1f commits/gravacao)\n", ntasks,
+            ntasks * COMMITS, elapsed, ntasks * COMMITS * 1000.0 / elapsed,
+            after.writes - before.writes,
+            (double) (after.commits - before.commits) / (after.writes - before.writes)) ;
+  else
+    printf ("direto  %2d tarefas: %4d commits em %5d ms: %6.1f commits/s\n",
+            ntasks, ntasks * COMMITS, elapsed, ntasks * COMMITS * 1000.0 / elapsed) ;
+}
+
+// confere os blocos escritos, pelo journal ou direto no disco 1
+void check (int direct, char *name)
+{
+  int buffer[BLOCKSIZE / sizeof (int)], expected[BLOCKSIZE / sizeof (int)] ;
+  int b, bad = 0, count = 0 ;
+
+  for (b = 0; b < MAXTASKS * SPAN; b++)
+  {
+    if (!version[b])
+      continue ;
+    count++ ;
+    fill (expected, AREA + b, version[b]) ;
+    if ((direct ? disk_dev_block_read (1, AREA + b, buffer)
+                : journal_read (&journal, AREA + b, buffer)) ||
+        memcmp (buffer, expected, BLOCKSIZE))
+      bad++ ;
+  }
+  printf ("%s: %d blocos conferidos, %d incorretos\n", name, count, bad) ;
+  errors += bad ;
+}
+
+int main (int argc, char *argv[])
+{
+  disk_config_t cfg ;
+  journal_stats_t stats, before, after ;
+  int i, n, numblocks, blocksize ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // cria e inicializa os discos, com tempos de acesso reduzidos
+  for (i = 0; i < 2; i++)
+  {
+    disk_config_init (&cfg) ;
+    sprintf (cfg.image, "disk-journal%d.dat", i) ;
+    cfg.numblocks = DISKBLOCKS ;
+    cfg.blocksize = BLOCKSIZE ;
+    cfg.seek_min_us = 2000 ;
+    cfg.seek_max_us = 20000 ;
+    cfg.jitter_us = 2000 ;
+    cfg.xfer_rate = 640000 ;
+    if (disk_dev_config (i, &cfg) < 0 ||
+        disk_dev_mgr_init (i, &numblocks, &blocksize) < 0)
+    {
+      printf ("Erro na abertura do disco %d\n", i) ;
+      exit (1) ;
+    }
+  }
+
+  if (journal_format (1, JSTART, JBLOCKS) || journal_open (&journal, 1, JSTART, JBLOCKS))
+  {
+    printf ("Erro na criacao do journal\n") ;
+    exit (1) ;
+  }
+
+  for (use_journal = 0; use_journal < 2; use_journal++)
+  {
+    // confere apenas os blocos gravados pelo journal
+    memset (version, 0, sizeof (version)) ;
+    for (n = 1; n <= MAXTASKS; n *= 4)
+      run (n) ;
+  }
+  journal_stats (&journal, &stats) ;
+  printf ("journal: %u commits, %u registros, %u blocos, %u absorvidos, "
+          "%u checkpoints, %u esperas por espaco\n", stats.commits,
+          stats.records, stats.blocks, stats.absorbed, stats.checkpoints,
+          stats.stalls) ;
+  // depois do fim da carga so o checkpoint ja acordado pode terminar: com
+  // dois ou mais, ao menos um rodou durante a carga
+  if (stats.checkpoints < 2 || !stats.stalls)
+  {
+    printf ("journal: checkpoint nao acompanhou a carga\n") ;
+    errors++ ;
+  }
+  check (0, "antes de reabrir") ;
+
+  // para a tarefa de checkpoint, esvazia o log e grava novas transacoes,
+  // que ficam so no journal
+  journal.stop = 1 ;
+  sem_up (&journal.kick) ;
+  task_join (&journal.task) ;
+  if (journal_checkpoint (&journal))
+    errors++ ;
+  journal_stats (&journal, &before) ;
+  run (1) ;
+  journal_stats (&journal, &stats) ;
+  if (stats.checkpoints != before.checkpoints)
+    errors++ ;
+
+  // simula a perda da memoria: reabre sem o checkpoint final
+  if (journal_open (&journal, 1, JSTART, JBLOCKS))
+  {
+    printf ("Erro na reabertura do journal\n") ;
+    exit (1) ;
+  }
+  journal_stats (&journal, &after) ;
+  printf ("reabertura: %u de %u registros reaplicados\n", after.replayed,
+          stats.records - before.records) ;
+  if (after.replayed != stats.records - before.records)
+    errors++ ;
+  check (1, "depois de reabrir") ;
+
+  if (journal_close (&journal))
+    errors++ ;
+
+  unlink ("disk-journal0.dat") ;
+  unlink ("disk-journal1.dat") ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
@@ -0,0 +1,306 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste do armazenamento chave-valor (ppos_kv.h) no estilo do YCSB, em um
+// disco de blocos de 64 bytes: carrega RECORDS pares e executa as cargas
+// A (50% leituras, 50% escritas), B (95%/5%), C (so leituras) e E (95%
+// varreduras curtas, 5% insercoes) com TASKS tarefas concorrentes e chaves
+// em distribuicao de Zipf. Depois, escreve e remove chaves, simula a perda
+// da memoria, reabre o armazenamento e confere o conteudo.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_kv.h"
+
+#define DISKBLOCKS 32768	// blocos do disco
+#define BLOCKSIZE  64		// tamanho dos blocos
+#define RECORDS    1000		// pares carregados
+#define TASKS      8		// tarefas concorrentes
+#define OPS        100		// operacoes por tarefa em cada carga
+#define VALSIZE    100		// tamanho dos valores
+#define FINAL      256		// chaves reescritas antes da perda da memoria
+#define REMOVED    32		// chaves removidas antes da perda da memoria
+
+// carga de trabalho: porcentagens de leitura e varredura (resto: escritas)
+typedef struct
+{
+  char *name ;
+  int read ;
+  int scan ;
+} workload_t ;
+
+workload_t workloads[] = {
+  { "A (50% leitura, 50% escrita)", 50, 0 },
+  { "B (95% leitura, 5% escrita) ", 95, 0 },
+  { "C (100% leitura)            ", 100, 0 },
+  { "E (95% varredura, 5% insercao)", 0, 95 },
+} ;
+
+task_t tasks[TASKS] ;
+kv_t kv ;
+workload_t *current ;		// carga em execucao
+double zipf[RECORDS + 1] ;	// distribuicao acumulada de Zipf (s = 1)
+int inserted = 0 ;		// chaves inseridas alem das carregadas
+int version = 0 ;		// gerador de versoes dos valores
+int errors = 0 ;
+
+// chave do registro i
+int key (int i, char *buf)
+{
+  return sprintf (buf, "user%06d", i) ;
+}
+
+// valor do registro: chave, versao e preenchimento
+void value (int i, int ver, char *buf)
+{
+  int n = sprintf (buf, "user%06d:%d:", i, ver) ;
+
+  memset (buf + n, 'a' + (i % 26), VALSIZE - n) ;
+}
+
+// sorteia um registro carregado com distribuicao de Zipf, espalhando os
+// registros mais populares por todo o espaco de chaves
+int zipf_next ()
+{
+  double u = (double) random () / RAND_MAX * zipf[RECORDS] ;
+  int lo = 1, hi = RECORDS, mid ;
+
+  while (lo < hi)
+  {
+    mid = (lo + hi) / 2 ;
+    if (zipf[mid] < u)
+      lo = mid + 1 ;
+    else
+      hi = mid ;
+  }
+  return ((long) lo * 7919) % RECORDS ;
+}
+
+// confere um valor lido: deve comecar pela chave
+void verify (int i, char *val, int len)
+{
+  char k[KV_KEY_MAX] ;
+  int n = key (i, k) ;
+
+  if (len != VALSIZE || memcmp (val, k, n) || val[n] != ':')
+  {
+    printf ("valor incorreto para %s\n", k) ;
+    errors++ ;
+  }
+}
+
+// funcao de varredura: conta os pares
+int counter (const void *k, int klen, const void *val, int vlen, void *arg)
+{
+  (*(int *) arg)++ ;
+  return 0 ;
+}
+
+// carrega os registros first, first + TASKS, ...
+void loadBody (void * arg)
+{
+  char k[KV_KEY_MAX], val[VALSIZE] ;
+  int i, n ;
+
+  for (i = (long) arg; i < RECORDS; i += TASKS)
+  {
+    n = key (i, k) ;
+    value (i, 0, val) ;
+    if (kv_put (&kv, k, n, val, VALSIZE))
+      errors++ ;
+  }
+  task_exit (0) ;
+}
+
+// executa OPS operacoes da carga corrente
+void workBody (void * arg)
+{
+  char k[KV_KEY_MAX], hi[KV_KEY_MAX], val[KV_VAL_MAX] ;
+  int op, i, n, r, len, count ;
+
+  for (op = 0; op < OPS; op++)
+  {
+    r = random () % 100 ;
+    i = zipf_next () ;
+    n = key (i, k) ;
+    if (r < current->read)
+    {
+      len = kv_get (&kv, k, n, val) ;
+      if (len < 0)
+      {
+        printf ("%s nao encontrada\n", k) ;
+        errors++ ;
+      }
+      else
+        verify (i, val, len) ;
+    }
+    else if (r < current->read + current->scan)
+    {
+      // varredura de 1 a 10 registros carregados a partir de i
+      len = 1 + random () % 10 ;
+      if (i + len > RECORDS)
+        len = RECORDS - i ;
+      key (i + len - 1, hi) ;
+      count = 0 ;
+      if (kv_scan (&kv, k, n, hi, n, counter, &count) < len || count < len)
+        errors++ ;
+    }
+    else if (current->scan)
+    {
+      // insercao de uma chave nova
+      i = RECORDS + inserted++ ;
+      n = key (i, k) ;
+      value (i, 0, val) ;
+      if (kv_put (&kv, k, n, val, VALSIZE))
+        errors++ ;
+    }
+    else
+    {
+      value (i, ++version, val) ;
+      if (kv_put (&kv, k, n, val, VALSIZE))
+        errors++ ;
+    }
+  }
+  task_exit (0) ;
+}
+
+// executa TASKS tarefas com o corpo dado e retorna a duracao (ms)
+unsigned int run (void (*body) (void *))
+{
+  unsigned int start ;
+  long i ;
+
+  start = systime () ;
+  for (i = 0; i < TASKS; i++)
+    task_create (&tasks[i], body, (void *) i) ;
+  for (i = 0; i < TASKS; i++)
+    task_join (&tasks[i]) ;
+  return systime () - start ;
+}
+
+int main (int argc, char *argv[])
+{
+  disk_config_t cfg ;
+  kv_stats_t before, after ;
+  char k[KV_KEY_MAX], lo[KV_KEY_MAX], hi[KV_KEY_MAX], val[KV_VAL_MAX], expected[VALSIZE] ;
+  unsigned int elapsed ;
+  int i, n, w, len, count, bad, numblocks, blocksize ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // cria e inicializa o disco, com tempos de acesso reduzidos
+  disk_config_init (&cfg) ;
+  strcpy (cfg.image, "disk-kv.dat") ;
+  cfg.numblocks = DISKBLOCKS ;
+  cfg.blocksize = BLOCKSIZE ;
+  cfg.seek_min_us = 2000 ;
+  cfg.seek_max_us = 20000 ;
+  cfg.jitter_us = 2000 ;
+  cfg.xfer_rate = 640000 ;
+  if (disk_dev_config (0, &cfg) < 0 || disk_dev_mgr_init (0, &numblocks, &blocksize) < 0)
+  {
+    printf ("Erro na abertura do disco\n") ;
+    exit (1) ;
+  }
+
+  if (kv_format (0) || kv_open (&kv, 0))
+  {
+    printf ("Erro na criacao do armazenamento\n") ;
+    exit (1) ;
+  }
+
+  // distribuicao acumulada de Zipf: soma de 1/k
+  for (i = 1; i <= RECORDS; i++)
+    zipf[i] = zipf[i - 1] + 1.0 / i ;
+
+  // carga inicial
+  elapsed = run (loadBody) ;
+  printf ("carga: %d pares em %5d ms: %6.1f escritas/s\n", RECORDS, elapsed,
+          RECORDS * 1000.0 / elapsed) ;
+
+  // cargas de trabalho
+  for (w = 0; w < sizeof (workloads) / sizeof (workload_t); w++)
+  {
+    current = &workloads[w] ;
+    kv_stats (&kv, &before) ;
+    elapsed = run (workBody) ;
+    kv_stats (&kv, &after) ;
+    printf ("carga %s: %d ops em %5d ms: %6.1f ops/s (%u na memtable, "
+            "%u runs descartadas pelo Bloom, %u paginas lidas, %u na cache)\n",
+            current->name, TASKS * OPS, elapsed, TASKS * OPS * 1000.0 / elapsed,
+            after.memhits - before.memhits, after.bloomskips - before.bloomskips,
+            after.pagereads - before.pagereads, after.cachehits - before.cachehits) ;
+  }
+  kv_stats (&kv, &after) ;
+  printf ("armazenamento: %u escritas, %u buscas, %u varreduras, %u gravacoes de "
+          "memtable, %u compactacoes\n", after.puts, after.gets, after.scans,
+          after.flushes, after.compactions) ;
+
+  // reescreve FINAL chaves e remove REMOVED, sem gravar a memtable
+  for (i = 0; i < FINAL; i++)
+  {
+    n = key (i, k) ;
+    value (i, ++version, val) ;
+    if (kv_put (&kv, k, n, val, VALSIZE))
+      errors++ ;
+  }
+  for (i = FINAL; i < FINAL + REMOVED; i++)
+  {
+    n = key (i, k) ;
+    if (kv_delete (&kv, k, n))
+      errors++ ;
+  }
+
+  // simula a perda da memoria: reabre sem gravar a memtable nem o journal
+  kv.journal.stop = 1 ;
+  sem_up (&kv.journal.kick) ;
+  task_join (&kv.journal.task) ;
+  if (kv_open (&kv, 0))
+  {
+    printf ("Erro na reabertura do armazenamento\n") ;
+    exit (1) ;
+  }
+  kv_stats (&kv, &after) ;
+  printf ("reabertura: %u escritas reaplicadas do WAL\n", after.replayed) ;
+
+  // confere as chaves reescritas e removidas
+  bad = 0 ;
+  for (i = 0; i < FINAL + REMOVED; i++)
+  {
+    n = key (i, k) ;
+    len = kv_get (&kv, k, n, val) ;
+    value (i, version - FINAL + 1 + i, expected) ;
+    if (i < FINAL ? (len != VALSIZE || memcmp (val, expected, VALSIZE))
+                  : (len != KV_NOTFOUND))
+      bad++ ;
+  }
+  printf ("depois de reabrir: %d chaves conferidas, %d incorretas\n", FINAL + REMOVED, bad) ;
+  errors += bad ;
+
+  // varredura completa
+  count = 0 ;
+  key (0, lo) ;
+  key (RECORDS + inserted, hi) ;
+  n = kv_scan (&kv, lo, strlen (lo), hi, strlen (hi), counter, &count) ;
+  printf ("varredura completa: %d pares (esperados %d)\n", n,
+          RECORDS + inserted - REMOVED) ;
+  if (n != RECORDS + inserted - REMOVED)
+    errors++ ;
+
+  if (kv_close (&kv))
+    errors++ ;
+
+  unlink ("disk-kv.dat") ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
@@ -0,0 +1,174 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste da camada com estrutura de log: compara escritas aleatórias de blocos
+// diretamente no disco 0 e no volume com estrutura de log do disco 1 (tempo,
+// operações de disco e deslocamento da cabeça), confere o conteúdo lido e
+// remonta o volume, conferindo-o de novo a partir do checkpoint e dos
+// segmentos reaplicados.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_lfs.h"
+
+#define DISKBLOCKS 1024		// blocos de cada disco
+#define NUMWRITES  1024		// escritas aleatorias
+#define NUMCHECKS  128		// blocos conferidos em cada verificacao
+
+int blocksize, numblocks ;	// blocos logicos usados nos dois discos
+int *version ;			// ultima versao escrita de cada bloco
+lfs_t lfs ;
+int errors = 0 ;
+
+// preenche o buffer com o conteudo esperado do bloco
+void fill (int *buffer, int block, int ver)
+{
+  memset (buffer, 0, blocksize) ;
+  buffer[0] = block ;
+  buffer[1] = ver ;
+}
+
+// escritas aleatorias no disco 0 (direto) ou no volume (lfs = 1)
+void writes (int use_lfs, char *name)
+{
+  disk_stats_t before, after ;
+  unsigned int start ;
+  int i, block, dev = use_lfs ? 1 : 0 ;
+  int *buffer = malloc (blocksize) ;
+
+  srandom (42) ;
+  disk_dev_mgr_stats (dev, &before) ;
+  start = systime () ;
+  for (i = 0; i < NUMWRITES; i++)
+  {
+    block = random () % numblocks ;
+    fill (buffer, block, i + 1) ;
+    if (use_lfs ? lfs_block_write (&lfs, block, buffer)
+                : disk_block_write (block, buffer))
+      errors++ ;
+    if (use_lfs)
+      version[block] = i + 1 ;
+  }
+  if (use_lfs && lfs_sync (&lfs))
+    errors++ ;
+  disk_dev_mgr_stats (dev, &after) ;
+
+  printf ("%-6s %d escritas em %5d ms: %6.1f escritas/s, %4u operacoes, "
+          "deslocamento %6u blocos\n", name, NUMWRITES, systime () - start,
+          NUMWRITES * 1000.0 / (systime () - start), after.ops - before.ops,
+          after.travel - before.travel) ;
+  free (buffer) ;
+}
+
+// confere blocos aleatorios do volume
+void check (char *name)
+{
+  int *buffer = malloc (blocksize) ;
+  int *expected = malloc (blocksize) ;
+  int i, block, bad = 0 ;
+
+  for (i = 0; i < NUMCHECKS; i++)
+  {
+    block = random () % numblocks ;
+    if (version[block])
+      fill (expected, block, version[block]) ;
+    else
+      memset (expected, 0, blocksize) ;
+    if (lfs_block_read (&lfs, block, buffer) || memcmp (buffer, expected, blocksize))
+      bad++ ;
+  }
+  printf ("%s: %d blocos conferidos, %d incorretos\n", name, NUMCHECKS, bad) ;
+  errors += bad ;
+  free (buffer) ;
+  free (expected) ;
+}
+
+int main (int argc, char *argv[])
+{
+  disk_config_t cfg ;
+  lfs_stats_t stats ;
+  int i, nb ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // cria e inicializa os discos, com tempos de acesso reduzidos
+  for (i = 0; i < 2; i++)
+  {
+    disk_config_init (&cfg) ;
+    sprintf (cfg.image, "disk-lfs%d.dat", i) ;
+    cfg.numblocks = DISKBLOCKS ;
+    cfg.seek_min_us = 2000 ;
+    cfg.seek_max_us = 20000 ;
+    cfg.jitter_us = 2000 ;
+    cfg.xfer_rate = 640000 ;
+    if (disk_dev_config (i, &cfg) < 0 ||
+        disk_dev_mgr_init (i, &nb, &blocksize) < 0)
+    {
+      printf ("Erro na abertura do disco %d\n", i) ;
+      exit (1) ;
+    }
+  }
+
+  // formata e monta o volume do disco 1
+  if (lfs_format (1) || lfs_mount (&lfs, 1))
+  {
+    printf ("Erro na criacao do volume\n") ;
+    exit (1) ;
+  }
+  numblocks = lfs.numBlocks ;
+  version = calloc (numblocks, sizeof (int)) ;
+  printf ("Volume: %d blocos logicos, %d segmentos de %d blocos\n",
+          numblocks, lfs.nsegs, lfs.segBlocks) ;
+
+  writes (0, "direto") ;
+  writes (1, "log") ;
+  lfs_stats (&lfs, &stats) ;
+  printf ("log: %u segmentos gravados, %u limpos, %u blocos copiados, "
+          "%u checkpoints\n", stats.segments, stats.cleaned, stats.moved,
+          stats.checkpoints) ;
+  check ("antes de remontar") ;
+
+  // escritas depois do ultimo checkpoint sao reaplicadas na montagem
+  for (i = 0; i < 2 * lfs.segData; i++)
+  {
+    int *buffer = malloc (blocksize) ;
+
+    fill (buffer, i, NUMWRITES + i + 1) ;
+    if (lfs_block_write (&lfs, i, buffer))
+      errors++ ;
+    version[i] = NUMWRITES + i + 1 ;
+    free (buffer) ;
+  }
+
+  // simula a perda da memoria: monta de novo sem desmontar
+  lfs.stop = 1 ;
+  sem_up (&lfs.clean) ;
+  task_join (&lfs.cleaner) ;
+  if (lfs_mount (&lfs, 1))
+  {
+    printf ("Erro na remontagem do volume\n") ;
+    exit (1) ;
+  }
+  lfs_stats (&lfs, &stats) ;
+  printf ("remontagem: %u segmentos reaplicados\n", stats.rolled) ;
+  check ("depois de remontar") ;
+
+  if (lfs_umount (&lfs))
+    errors++ ;
+
+  unlink ("disk-lfs0.dat") ;
+  unlink ("disk-lfs1.dat") ;
+  free (version) ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
@@ -0,0 +1,106 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste da união de pedidos na fila do disco: várias tarefas leem o mesmo
+// bloco, leem blocos adjacentes e reescrevem o mesmo bloco ao mesmo tempo;
+// o gerente deve atender esses pedidos com poucas operações no disco.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ppos.h"
+#include "ppos_disk.h"
+
+#define NUMTASKS  16
+
+task_t sameReader[NUMTASKS], adjReader[NUMTASKS], rewriter[NUMTASKS] ;
+int numblocks ;			// numero de blocos no disco
+int blocksize ;			// tamanho de cada bloco (bytes)
+char *original ;		// conteudo original do bloco reescrito
+int errors = 0 ;
+
+// todas as tarefas leem o bloco 0
+void sameBody (void * arg)
+{
+  char *buffer = malloc (blocksize) ;
+
+  if (disk_block_read (0, buffer))
+    errors++ ;
+  free (buffer) ;
+  task_exit (0) ;
+}
+
+// cada tarefa le um bloco da faixa [1, NUMTASKS]
+void adjBody (void * arg)
+{
+  char *buffer = malloc (blocksize) ;
+
+  if (disk_block_read (1 + (long) arg, buffer))
+    errors++ ;
+  free (buffer) ;
+  task_exit (0) ;
+}
+
+// todas as tarefas reescrevem o ultimo bloco com seu conteudo original
+void rewriteBody (void * arg)
+{
+  if (disk_block_write (numblocks - 1, original))
+    errors++ ;
+  task_exit (0) ;
+}
+
+int main (int argc, char *argv[])
+{
+  long i ;
+  unsigned int start ;
+  disk_stats_t stats ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // inicializa o gerente de disco
+  if (disk_mgr_init (&numblocks, &blocksize) < 0)
+  {
+    printf ("Erro na abertura do disco\n") ;
+    exit (1) ;
+  }
+  printf ("Disco contem %d blocos de %d bytes cada\n", numblocks, blocksize) ;
+
+  original = malloc (blocksize) ;
+  if (disk_block_read (numblocks - 1, original))
+    errors++ ;
+
+  start = systime () ;
+
+  // cria as tarefas
+  for (i = 0; i < NUMTASKS; i++)
+  {
+    task_create (&sameReader[i], sameBody, (void *) i) ;
+    task_create (&adjReader[i], adjBody, (void *) i) ;
+    task_create (&rewriter[i], rewriteBody, (void *) i) ;
+  }
+
+  // aguarda todas as tarefas encerrarem
+  for (i = 0; i < NUMTASKS; i++)
+  {
+    task_join (&sameReader[i]) ;
+    task_join (&adjReader[i]) ;
+    task_join (&rewriter[i]) ;
+  }
+
+  disk_mgr_stats (&stats) ;
+  printf ("%d pedidos atendidos em %d ms\n", 3 * NUMTASKS, systime () - start) ;
+  printf ("pedidos %u, operacoes %u, blocos %u, unidos %u, duplicados %u, absorvidos %u\n",
+          stats.requests, stats.ops, stats.blocks, stats.merged, stats.dedup,
+          stats.absorbed) ;
+
+  // encerra a thread main
+  printf ("main: fim (%d erros)\n", errors) ;
+  free (original) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
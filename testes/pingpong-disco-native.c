@@ -0,0 +1,154 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste do backend nativo de disco: grava uma imagem de 16 MiB com um padrão
+// conhecido, mede IOPS e vazão de leituras aleatórias concorrentes (conferindo
+// o conteúdo lido) e compara discos nativos com latência artificial e fila de
+// comandos de profundidade 1 e 32, mostrando as operações em andamento ao
+// mesmo tempo.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_disk.h"
+
+#define BLOCKSIZE 4096		// tamanho dos blocos
+#define NUMBLOCKS 4096		// blocos do disco principal (16 MiB)
+#define LATBLOCKS 256		// blocos dos discos com latencia
+#define LATENCY   2000		// latencia artificial (us)
+#define NUMTASKS  16		// tarefas de leitura aleatoria
+#define NUMREADS  256		// leituras por tarefa, disco principal
+#define LATREADS  16		// leituras por tarefa, discos com latencia
+
+task_t reader[NUMTASKS] ;
+int device, devblocks, numreads ;	// disco em teste
+int errors = 0 ;
+
+// le blocos aleatorios do disco em teste, conferindo o conteudo
+void readerBody (void * arg)
+{
+  char *buffer = malloc (BLOCKSIZE) ;
+  int i, block ;
+
+  for (i = 0; i < numreads; i++)
+  {
+    block = random () % devblocks ;
+    if (disk_dev_block_read (device, block, buffer) ||
+        *(int *) buffer != block)
+      errors++ ;
+  }
+  free (buffer) ;
+  task_exit (0) ;
+}
+
+// configura e inicializa um disco nativo
+void native (int dev, char *image, int numblocks, int latency, int qdepth,
+             int threads)
+{
+  disk_config_t cfg ;
+  int nb, bs ;
+
+  disk_config_init (&cfg) ;
+  strcpy (cfg.image, image) ;
+  cfg.backend = DISK_BACKEND_NATIVE ;
+  cfg.blocksize = BLOCKSIZE ;
+  cfg.numblocks = numblocks ;
+  cfg.latency_us = latency ;
+  cfg.qdepth = qdepth ;
+  cfg.threads = threads ;
+  cfg.sync = 0 ;
+  if (disk_dev_config (dev, &cfg) < 0 || disk_dev_mgr_init (dev, &nb, &bs) < 0)
+  {
+    printf ("Erro na abertura do disco %d\n", dev) ;
+    exit (1) ;
+  }
+}
+
+// grava em cada bloco do disco seu proprio numero
+void fill (int dev, int numblocks)
+{
+  void *buffers[DISK_VEC_MAX] ;
+  char *area ;
+  int i, block ;
+
+  area = calloc (DISK_VEC_MAX, BLOCKSIZE) ;
+  for (i = 0; i < DISK_VEC_MAX; i++)
+    buffers[i] = area + i * BLOCKSIZE ;
+  for (block = 0; block < numblocks; block += DISK_VEC_MAX)
+  {
+    for (i = 0; i < DISK_VEC_MAX; i++)
+      *(int *) buffers[i] = block + i ;
+    if (disk_dev_block_writev (dev, block, DISK_VEC_MAX, buffers))
+      errors++ ;
+  }
+  free (area) ;
+}
+
+// leituras aleatorias concorrentes no disco dev; retorna o tempo (ms)
+unsigned int bench (int dev, int numblocks, int reads)
+{
+  unsigned int start, time ;
+  int i ;
+
+  device = dev ;
+  devblocks = numblocks ;
+  numreads = reads ;
+  srandom (42) ;
+
+  start = systime () ;
+  for (i = 0; i < NUMTASKS; i++)
+    task_create (&reader[i], readerBody, NULL) ;
+  for (i = 0; i < NUMTASKS; i++)
+    task_join (&reader[i]) ;
+  time = systime () - start ;
+
+  return (time ? time : 1) ;
+}
+
+int main (int argc, char *argv[])
+{
+  unsigned int time ;
+  disk_stats_t stats ;
+  int n ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // disco principal, sem latencia artificial
+  native (0, "disk-native0.dat", NUMBLOCKS, 0, 32, 4) ;
+  fill (0, NUMBLOCKS) ;
+  n = NUMTASKS * NUMREADS ;
+  time = bench (0, NUMBLOCKS, NUMREADS) ;
+  disk_dev_mgr_stats (0, &stats) ;
+  printf ("nativo: %d leituras de %d bytes em %d ms: %.0f IOPS, %.1f MB/s "
+          "(%u operacoes)\n", n, BLOCKSIZE, time, n * 1000.0 / time,
+          (double) n * BLOCKSIZE / 1000.0 / time, stats.ops) ;
+
+  // discos com latencia de LATENCY us por operacao
+  native (1, "disk-native1.dat", LATBLOCKS, LATENCY, 1, 1) ;
+  native (2, "disk-native2.dat", LATBLOCKS, LATENCY, 32, 16) ;
+  fill (1, LATBLOCKS) ;
+  fill (2, LATBLOCKS) ;
+  n = NUMTASKS * LATREADS ;
+
+  time = bench (1, LATBLOCKS, LATREADS) ;
+  printf ("latencia %d us, fila  1: %d leituras em %4d ms: %6.0f IOPS\n",
+          LATENCY, n, time, n * 1000.0 / time) ;
+  time = bench (2, LATBLOCKS, LATREADS) ;
+  printf ("latencia %d us, fila 32: %d leituras em %4d ms: %6.0f IOPS\n",
+          LATENCY, n, time, n * 1000.0 / time) ;
+
+  unlink ("disk-native0.dat") ;
+  unlink ("disk-native1.dat") ;
+  unlink ("disk-native2.dat") ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
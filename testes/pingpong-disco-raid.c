@@ -0,0 +1,134 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste de vários discos e do volume RAID-0: mede a vazão de leituras
+// aleatórias concorrentes e de uma leitura sequencial longa em volumes
+// distribuídos sobre 1, 2 e 4 discos.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_raid.h"
+
+#define NUMDISKS  4		// discos criados pelo teste
+#define DISKBLOCKS 256		// blocos de cada disco
+#define STRIPE    4		// blocos por unidade de distribuicao
+#define NUMTASKS  16		// tarefas de leitura aleatoria
+#define NUMREADS  16		// leituras por tarefa
+#define SEQBLOCKS 256		// blocos da leitura sequencial
+
+task_t reader[NUMTASKS] ;
+raid0_t *volume ;		// volume em teste
+int errors = 0 ;
+
+// le blocos aleatorios do volume em teste
+void readerBody (void * arg)
+{
+  char *buffer = malloc (volume->blockSize) ;
+  int i ;
+
+  for (i = 0; i < NUMREADS; i++)
+    if (raid0_block_read (volume, random () % DISKBLOCKS, buffer))
+      errors++ ;
+  free (buffer) ;
+  task_exit (0) ;
+}
+
+// mede o volume vol: leituras aleatorias concorrentes e leitura sequencial
+void bench (raid0_t *vol)
+{
+  unsigned int start, rtime, stime ;
+  void *buffers[SEQBLOCKS] ;
+  char *area ;
+  long i ;
+
+  volume = vol ;
+  srandom (42) ;
+
+  start = systime () ;
+  for (i = 0; i < NUMTASKS; i++)
+    task_create (&reader[i], readerBody, NULL) ;
+  for (i = 0; i < NUMTASKS; i++)
+    task_join (&reader[i]) ;
+  rtime = systime () - start ;
+  if (!rtime)
+    rtime = 1 ;
+
+  area = malloc (SEQBLOCKS * vol->blockSize) ;
+  for (i = 0; i < SEQBLOCKS; i++)
+    buffers[i] = area + i * vol->blockSize ;
+  start = systime () ;
+  if (raid0_block_readv (vol, 0, SEQBLOCKS, buffers))
+    errors++ ;
+  stime = systime () - start ;
+  if (!stime)
+    stime = 1 ;
+  free (area) ;
+
+  printf ("%d disco(s): aleatorio %4d leituras em %5d ms (%6.1f ops/s), "
+          "sequencial %d blocos em %5d ms (%7.1f blocos/s)\n",
+          vol->ndevs, NUMTASKS * NUMREADS, rtime,
+          NUMTASKS * NUMREADS * 1000.0 / rtime, SEQBLOCKS, stime,
+          SEQBLOCKS * 1000.0 / stime) ;
+}
+
+int main (int argc, char *argv[])
+{
+  int i, numblocks, blocksize ;
+  int devs[NUMDISKS] ;
+  raid0_t vol1, vol2, vol4 ;
+  disk_config_t cfg ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // cria e inicializa os discos, com tempos de acesso reduzidos
+  for (i = 0; i < NUMDISKS; i++)
+  {
+    disk_config_init (&cfg) ;
+    sprintf (cfg.image, "disk-raid%d.dat", i) ;
+    cfg.numblocks = DISKBLOCKS ;
+    cfg.seek_min_us = 2000 ;
+    cfg.seek_max_us = 20000 ;
+    cfg.jitter_us = 2000 ;
+    cfg.xfer_rate = 640000 ;
+    if (disk_dev_config (i, &cfg) < 0 ||
+        disk_dev_mgr_init (i, &numblocks, &blocksize) < 0)
+    {
+      printf ("Erro na abertura do disco %d\n", i) ;
+      exit (1) ;
+    }
+    devs[i] = i ;
+  }
+
+  // volumes sobre 1, 2 e 4 discos
+  if (raid0_create (&vol1, 1, devs, STRIPE) ||
+      raid0_create (&vol2, 2, devs, STRIPE) ||
+      raid0_create (&vol4, 4, devs, STRIPE))
+  {
+    printf ("Erro na criacao dos volumes\n") ;
+    exit (1) ;
+  }
+
+  bench (&vol1) ;
+  bench (&vol2) ;
+  bench (&vol4) ;
+
+  for (i = 0; i < NUMDISKS; i++)
+  {
+    char name[DISK_PATH_MAX] ;
+
+    sprintf (name, "disk-raid%d.dat", i) ;
+    unlink (name) ;
+  }
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
@@ -0,0 +1,217 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste do escalonador de pedidos de disco: tarefas de baixa prioridade
+// enviam rajadas de escritas enquanto tarefas interativas (prioridade -20) e
+// normais fazem leituras aleatórias. A mesma carga é executada com a política
+// FIFO (disco 0) e DEADLINE (disco 1), e são comparados os percentis de
+// latência de cada classe de prioridade: com DEADLINE o p99 da classe alta
+// deve ficar abaixo do obtido com FIFO. Por fim, confere que a preferencia
+// pelas leituras e o elevador nao invertem pedidos sobre os mesmos blocos:
+// uma leitura deve ver a escrita enfileirada antes dela, e escritas
+// sobrepostas devem chegar ao disco em ordem de chegada.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_disk.h"
+
+#define DISKBLOCKS 1024		// blocos de cada disco
+#define NUMWRITERS 4		// tarefas de escrita em rajadas (prioridade +10)
+#define BURSTS     6		// rajadas por tarefa de escrita
+#define BURST      8		// escritas por rajada
+#define WBLOCKS    8		// blocos por escrita
+#define NUMINTER   4		// tarefas interativas (prioridade -20)
+#define NUMNORMAL  2		// tarefas de leitura normais (prioridade 0)
+#define NUMREADS   24		// leituras por tarefa de leitura
+#define NUMTASKS   (NUMWRITERS + NUMINTER + NUMNORMAL)
+#define ORDERS     20		// rodadas do teste de ordem
+
+task_t tasks[NUMTASKS] ;
+int device ;			// disco em teste
+int blocksize ;
+int errors = 0 ;
+
+// envia rajadas de escritas assincronas e aguarda cada rajada
+void writerBody (void * arg)
+{
+  request_t reqs[BURST] ;
+  void *buffers[BURST][WBLOCKS] ;
+  char *area ;
+  int i, j, b ;
+
+  area = malloc (WBLOCKS * blocksize) ;
+  memset (area, (long) arg, WBLOCKS * blocksize) ;
+  for (i = 0; i < BURST; i++)
+    for (j = 0; j < WBLOCKS; j++)
+      buffers[i][j] = area + j * blocksize ;
+
+  for (b = 0; b < BURSTS; b++)
+  {
+    for (i = 0; i < BURST; i++)
+      if (disk_dev_submit (device, &reqs[i], WRITE_OPERATION,
+                           random () % (DISKBLOCKS - WBLOCKS), WBLOCKS,
+                           buffers[i]))
+        errors++ ;
+    for (i = 0; i < BURST; i++)
+      if (disk_dev_wait (&reqs[i]))
+        errors++ ;
+  }
+  free (area) ;
+  task_exit (0) ;
+}
+
+// le blocos aleatorios; as tarefas interativas pensam entre as leituras
+void readerBody (void * arg)
+{
+  char *buffer = malloc (blocksize) ;
+  int i ;
+
+  for (i = 0; i < NUMREADS; i++)
+  {
+    if (disk_dev_block_read (device, random () % DISKBLOCKS, buffer))
+      errors++ ;
+    if (arg)
+      task_sleep (20) ;
+  }
+  free (buffer) ;
+  task_exit (0) ;
+}
+
+// executa a carga mista no disco dev com a politica indicada
+void bench (int dev, int policy, char *name)
+{
+  char *classes[DISK_CLASSES] = {"alta", "normal", "baixa"} ;
+  disk_sched_t sched ;
+  disk_stats_t stats ;
+  unsigned int start ;
+  int i, n = 0, cls ;
+
+  disk_dev_get_sched (dev, &sched) ;
+  sched.policy = policy ;
+  disk_dev_set_sched (dev, &sched) ;
+  device = dev ;
+  srandom (42) ;
+
+  start = systime () ;
+  for (i = 0; i < NUMWRITERS; i++, n++)
+  {
+    task_create (&tasks[n], writerBody, (void *) (long) (i + 1)) ;
+    task_setprio (&tasks[n], 10) ;
+  }
+  for (i = 0; i < NUMINTER; i++, n++)
+  {
+    task_create (&tasks[n], readerBody, (void *) 1) ;
+    task_setprio (&tasks[n], -20) ;
+  }
+  for (i = 0; i < NUMNORMAL; i++, n++)
+    task_create (&tasks[n], readerBody, NULL) ;
+  for (i = 0; i < NUMTASKS; i++)
+    task_join (&tasks[i]) ;
+
+  disk_dev_mgr_stats (dev, &stats) ;
+  printf ("%s: %d ms, %u pedidos, %u operacoes, %u por prazo vencido\n",
+          name, systime () - start, stats.requests, stats.ops, stats.expired) ;
+  for (cls = 0; cls < DISK_CLASSES; cls++)
+    printf ("  classe %-6s p50 %5d ms  p95 %5d ms  p99 %5d ms  max %5d ms\n",
+            classes[cls], disk_dev_latency (dev, cls, 50),
+            disk_dev_latency (dev, cls, 95), disk_dev_latency (dev, cls, 99),
+            disk_dev_latency (dev, cls, 100)) ;
+}
+
+// escritas assincronas seguidas de leituras e escritas sobre os mesmos
+// blocos, com uma escrita distante ocupando o disco
+void order (int dev)
+{
+  request_t far, first, second ;
+  char *area, *buffer ;
+  void *farv[WBLOCKS], *firstv[WBLOCKS], *secondv[1] ;
+  int i, k, b ;
+
+  area = malloc ((2 * WBLOCKS + 1) * blocksize) ;
+  buffer = malloc (blocksize) ;
+  for (i = 0; i < WBLOCKS; i++)
+  {
+    farv[i] = area + i * blocksize ;
+    firstv[i] = area + (WBLOCKS + i) * blocksize ;
+  }
+  secondv[0] = area + 2 * WBLOCKS * blocksize ;
+
+  for (k = 0; k < ORDERS; k++)
+  {
+    b = random () % (DISKBLOCKS / 2 - WBLOCKS) ;
+    memset (area, 0, WBLOCKS * blocksize) ;
+    memset (firstv[0], 'a' + k % 26, WBLOCKS * blocksize) ;
+    memset (secondv[0], 'A' + k % 26, blocksize) ;
+
+    // leitura depois de escrita (enfileirada)
+    disk_dev_submit (dev, &far, WRITE_OPERATION, DISKBLOCKS - WBLOCKS, WBLOCKS, farv) ;
+    disk_dev_submit (dev, &first, WRITE_OPERATION, b, WBLOCKS, firstv) ;
+    if (disk_dev_block_read (dev, b + WBLOCKS - 1, buffer) || buffer[0] != 'a' + k % 26)
+    {
+      printf ("ordem: leitura do bloco %d nao viu a escrita anterior\n", b + WBLOCKS - 1) ;
+      errors++ ;
+    }
+
+    // escrita sobre parte de outra escrita ainda enfileirada
+    disk_dev_submit (dev, &second, WRITE_OPERATION, b + WBLOCKS / 2, 1, secondv) ;
+    if (disk_dev_wait (&far) || disk_dev_wait (&first) || disk_dev_wait (&second))
+      errors++ ;
+    if (disk_dev_block_read (dev, b + WBLOCKS / 2, buffer) || buffer[0] != 'A' + k % 26)
+    {
+      printf ("ordem: escritas sobre o bloco %d invertidas\n", b + WBLOCKS / 2) ;
+      errors++ ;
+    }
+  }
+  free (area) ;
+  free (buffer) ;
+}
+
+int main (int argc, char *argv[])
+{
+  disk_config_t cfg ;
+  int i, numblocks ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // cria e inicializa os discos, com tempos de acesso reduzidos
+  for (i = 0; i < 2; i++)
+  {
+    disk_config_init (&cfg) ;
+    sprintf (cfg.image, "disk-sched%d.dat", i) ;
+    cfg.numblocks = DISKBLOCKS ;
+    cfg.seek_min_us = 2000 ;
+    cfg.seek_max_us = 20000 ;
+    cfg.jitter_us = 2000 ;
+    cfg.xfer_rate = 640000 ;
+    if (disk_dev_config (i, &cfg) < 0 ||
+        disk_dev_mgr_init (i, &numblocks, &blocksize) < 0)
+    {
+      printf ("Erro na abertura do disco %d\n", i) ;
+      exit (1) ;
+    }
+  }
+
+  bench (0, DISK_SCHED_FIFO, "FIFO") ;
+  bench (1, DISK_SCHED_DEADLINE, "DEADLINE") ;
+  if (disk_dev_latency (1, DISK_CLASS_HIGH, 99) >= disk_dev_latency (0, DISK_CLASS_HIGH, 99))
+  {
+    printf ("DEADLINE: p99 da classe alta nao ficou abaixo do FIFO\n") ;
+    errors++ ;
+  }
+  order (1) ;
+
+  unlink ("disk-sched0.dat") ;
+  unlink ("disk-sched1.dat") ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
@@ -0,0 +1,169 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste dos fluxos de transferencia em massa (ppos_stream.h): copia o disco
+// 0 inteiro para o disco 1 bloco a bloco (leitura e escrita alternadas, como
+// em pingpong-disco2, em uma amostra do disco) e com fluxos de copia de 1,
+// 2, 4 e 8 buffers; a tarefa confere o conteudo de cada pedaco (acesso sem
+// copia ao buffer) e simula processamento. Depois, le o disco 1 com um
+// fluxo de leitura e confere a copia.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_stream.h"
+
+#define DISKBLOCKS 8192		// blocos de cada disco
+#define BLOCKSIZE  512		// tamanho dos blocos
+#define SAMPLE     256		// blocos copiados bloco a bloco
+#define CHUNK      32		// blocos por pedaco
+#define WORK       5		// processamento por pedaco (ms)
+
+int errors = 0 ;
+
+// preenche o buffer com o conteudo esperado do bloco
+void fill (int *buffer, int block)
+{
+  int i ;
+
+  for (i = 0; i < BLOCKSIZE / sizeof (int); i++)
+    buffer[i] = block * 1000 + i ;
+}
+
+// confere count blocos a partir de block no buffer; retorna os incorretos
+int verify (char *data, int block, int count)
+{
+  int expected[BLOCKSIZE / sizeof (int)] ;
+  int i, bad = 0 ;
+
+  for (i = 0; i < count; i++)
+  {
+    fill (expected, block + i) ;
+    if (memcmp (data + i * BLOCKSIZE, expected, BLOCKSIZE))
+      bad++ ;
+  }
+  return bad ;
+}
+
+// mostra a vazao de uma copia ou leitura
+void report (char *name, int blocks, unsigned int elapsed, stream_stats_t *stats)
+{
+  printf ("%-22s %4d blocos em %5d ms: %5.2f MB/s", name, blocks, elapsed,
+          blocks * (double) BLOCKSIZE / 1048576 * 1000 / elapsed) ;
+  if (stats)
+    printf (" (%u pedacos, %u aguardaram o disco, %u ms aguardando)", stats->chunks,
+            stats->stalls, stats->waited) ;
+  printf ("\n") ;
+}
+
+int main (int argc, char *argv[])
+{
+  disk_config_t cfg ;
+  stream_t s ;
+  stream_stats_t stats ;
+  char buffer[BLOCKSIZE], *area ;
+  void *buffers[DISK_VEC_MAX], *data ;
+  unsigned int start ;
+  int i, b, block, count, depth, bad, numblocks, blocksize ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // cria e inicializa os discos, com tempos de acesso reduzidos
+  for (i = 0; i < 2; i++)
+  {
+    disk_config_init (&cfg) ;
+    sprintf (cfg.image, "disk-stream%d.dat", i) ;
+    cfg.numblocks = DISKBLOCKS ;
+    cfg.blocksize = BLOCKSIZE ;
+    cfg.seek_min_us = 2000 ;
+    cfg.seek_max_us = 20000 ;
+    cfg.jitter_us = 2000 ;
+    cfg.xfer_rate = 6400000 ;
+    if (disk_dev_config (i, &cfg) < 0 ||
+        disk_dev_mgr_init (i, &numblocks, &blocksize) < 0)
+    {
+      printf ("Erro na abertura do disco %d\n", i) ;
+      exit (1) ;
+    }
+  }
+
+  // conteudo do disco 0
+  area = malloc (DISK_VEC_MAX * BLOCKSIZE) ;
+  for (b = 0; b < DISKBLOCKS; b += DISK_VEC_MAX)
+  {
+    for (i = 0; i < DISK_VEC_MAX; i++)
+    {
+      buffers[i] = area + i * BLOCKSIZE ;
+      fill (buffers[i], b + i) ;
+    }
+    if (disk_dev_block_writev (0, b, DISK_VEC_MAX, buffers))
+      errors++ ;
+  }
+  free (area) ;
+
+  // copia bloco a bloco de uma amostra do disco
+  start = systime () ;
+  for (b = 0; b < SAMPLE; b++)
+    if (disk_dev_block_read (0, b, buffer) || disk_dev_block_write (1, b, buffer))
+      errors++ ;
+  report ("bloco a bloco", SAMPLE, systime () - start, NULL) ;
+
+  // copia do disco inteiro com fluxos
+  for (depth = 1; depth <= 8; depth *= 2)
+  {
+    bad = 0 ;
+    start = systime () ;
+    if (stream_copy (&s, 0, 0, DISKBLOCKS, 1, 0, CHUNK, depth))
+    {
+      printf ("Erro na abertura do fluxo de copia\n") ;
+      exit (1) ;
+    }
+    while (stream_next (&s, &data, &block, &count) > 0)
+    {
+      bad += verify (data, block, count) ;
+      task_sleep (WORK) ;
+    }
+    stream_stats (&s, &stats) ;
+    if (stream_close (&s) || stats.blocks != DISKBLOCKS)
+      errors++ ;
+    sprintf (buffer, "copia, %d buffer%s", depth, depth > 1 ? "s" : "") ;
+    report (buffer, DISKBLOCKS, systime () - start, &stats) ;
+    errors += bad ;
+  }
+
+  // leitura do disco copiado
+  bad = 0 ;
+  start = systime () ;
+  if (stream_open (&s, 1, 0, DISKBLOCKS, CHUNK, 4))
+  {
+    printf ("Erro na abertura do fluxo de leitura\n") ;
+    exit (1) ;
+  }
+  while (stream_next (&s, &data, &block, &count) > 0)
+    bad += verify (data, block, count) ;
+  stream_stats (&s, &stats) ;
+  if (stream_close (&s) || stats.blocks != DISKBLOCKS)
+    errors++ ;
+  report ("leitura, 4 buffers", DISKBLOCKS, systime () - start, &stats) ;
+  printf ("copia conferida: %d blocos incorretos\n", bad) ;
+  errors += bad ;
+
+  // fluxo fechado antes do fim
+  if (stream_open (&s, 1, 0, DISKBLOCKS, CHUNK, 8) ||
+      stream_next (&s, &data, &block, &count) != 1 || stream_close (&s))
+    errors++ ;
+
+  unlink ("disk-stream0.dat") ;
+  unlink ("disk-stream1.dat") ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
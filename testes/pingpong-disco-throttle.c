@@ -0,0 +1,149 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste da contabilidade e dos limites de E/S: tarefas de exportação em
+// massa (grupo 1) leem faixas longas do disco enquanto uma tarefa interativa
+// (grupo 0) faz leituras pequenas. A carga é executada sem limite e com o
+// grupo 1 limitado a 1 MB/s; são mostrados a vazão de cada grupo, a latência
+// da tarefa interativa e os contadores por tarefa.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_disk.h"
+
+#define BLOCKSIZE 4096		// tamanho dos blocos
+#define NUMBLOCKS 1024		// blocos do disco
+#define NUMBULK   4		// tarefas de exportacao (grupo 1)
+#define DURATION  1000		// duracao de cada fase (ms)
+#define LIMIT     (1 << 20)	// limite de banda do grupo 1 (bytes/s)
+
+task_t bulk[NUMBULK], inter ;
+unsigned int end ;		// fim da fase atual (ms)
+unsigned int reads, latency ;	// leituras e latencia total da tarefa interativa
+int errors = 0 ;
+
+// le faixas de DISK_VEC_MAX blocos ate o fim da fase
+void bulkBody (void * arg)
+{
+  void *buffers[DISK_VEC_MAX] ;
+  char *area = malloc (DISK_VEC_MAX * BLOCKSIZE) ;
+  int i, block = (long) arg * (NUMBLOCKS / NUMBULK) ;
+
+  for (i = 0; i < DISK_VEC_MAX; i++)
+    buffers[i] = area + i * BLOCKSIZE ;
+  disk_io_setgroup (NULL, 1) ;
+  while (systime () < end)
+  {
+    if (disk_block_readv (block, DISK_VEC_MAX, buffers))
+      errors++ ;
+    block = (block + DISK_VEC_MAX) % NUMBLOCKS ;
+  }
+  free (area) ;
+  task_exit (0) ;
+}
+
+// leituras pequenas e espacadas ate o fim da fase, medindo a latencia
+void interBody (void * arg)
+{
+  char buffer[BLOCKSIZE] ;
+  unsigned int start ;
+
+  while (systime () < end)
+  {
+    start = systime () ;
+    if (disk_block_read (random () % NUMBLOCKS, buffer))
+      errors++ ;
+    latency += systime () - start ;
+    reads++ ;
+    task_sleep (10) ;
+  }
+  task_exit (0) ;
+}
+
+// executa uma fase da carga e mostra os contadores
+void phase (char *name)
+{
+  disk_io_t before[2], after[2], io ;
+  unsigned int start, elapsed ;
+  int i ;
+
+  disk_io_group (0, &before[0]) ;
+  disk_io_group (1, &before[1]) ;
+  reads = latency = 0 ;
+  start = systime () ;
+  end = start + DURATION ;
+
+  for (i = 0; i < NUMBULK; i++)
+    task_create (&bulk[i], bulkBody, (void *) (long) i) ;
+  task_create (&inter, interBody, NULL) ;
+  for (i = 0; i < NUMBULK; i++)
+    task_join (&bulk[i]) ;
+  task_join (&inter) ;
+  elapsed = systime () - start ;
+
+  disk_io_group (0, &after[0]) ;
+  disk_io_group (1, &after[1]) ;
+  printf ("%s (%u ms):\n", name, elapsed) ;
+  for (i = 0; i < 2; i++)
+    printf ("  grupo %d: %5u pedidos, %8.1f KB/s, disco %6llu ms, %u retidos\n",
+            i, after[i].ops - before[i].ops,
+            (after[i].bytes - before[i].bytes) / 1024.0 * 1000.0 / elapsed,
+            (after[i].time - before[i].time) / 1000,
+            after[i].throttled - before[i].throttled) ;
+  printf ("  interativa: %u leituras, latencia media %.2f ms\n", reads,
+          reads ? (double) latency / reads : 0.0) ;
+  for (i = 0; i < NUMBULK; i++)
+  {
+    disk_io_task (&bulk[i], &io) ;
+    printf ("  tarefa %d (grupo %d): %u pedidos, %llu KB, disco %llu ms\n",
+            bulk[i].id, disk_io_getgroup (&bulk[i]), io.ops, io.bytes / 1024,
+            io.time / 1000) ;
+  }
+}
+
+int main (int argc, char *argv[])
+{
+  disk_config_t cfg ;
+  disk_limit_t limit ;
+  int numblocks, blocksize ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // disco nativo com uma operacao por vez e 2 ms de latencia por operacao
+  disk_config_init (&cfg) ;
+  strcpy (cfg.image, "disk-throttle.dat") ;
+  cfg.backend = DISK_BACKEND_NATIVE ;
+  cfg.blocksize = BLOCKSIZE ;
+  cfg.numblocks = NUMBLOCKS ;
+  cfg.latency_us = 2000 ;
+  cfg.qdepth = 1 ;
+  cfg.threads = 1 ;
+  cfg.sync = 0 ;
+  if (disk_config (&cfg) < 0 || disk_mgr_init (&numblocks, &blocksize) < 0)
+  {
+    printf ("Erro na abertura do disco\n") ;
+    exit (1) ;
+  }
+  srandom (42) ;
+
+  phase ("sem limite") ;
+
+  memset (&limit, 0, sizeof (limit)) ;
+  limit.bps = LIMIT ;
+  disk_io_setlimit (1, &limit) ;
+  phase ("grupo 1 limitado a 1 MB/s") ;
+
+  unlink ("disk-throttle.dat") ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
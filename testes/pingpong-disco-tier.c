@@ -0,0 +1,215 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste do armazenamento em camadas (ppos_tier.h): um disco rapido (perfil
+// SSD) com FASTBLOCKS blocos serve de cache de um disco lento (HDD) de
+// SLOWBLOCKS blocos. Leituras com distribuicao de Zipf sao feitas direto no
+// disco lento e pela camada com escrita direta; depois, uma carga mista
+// (80% leituras, 20% escritas) usa escrita adiada. O armazenamento eh
+// remontado sem desmontar (perda da memoria), a cache deve continuar
+// quente e os blocos alterados sao conferidos.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_tier.h"
+
+#define SLOWBLOCKS 8192		// blocos do disco lento
+#define FASTBLOCKS 128 		// blocos do disco rapido
+#define BLOCKSIZE  512		// tamanho dos blocos
+#define OPS        600		// acessos por fase
+#define WRITEPCT   20		// escritas na carga mista (%)
+
+tier_t tier ;
+double zipf[SLOWBLOCKS + 1] ;	// distribuicao acumulada de Zipf (s = 1)
+int version[SLOWBLOCKS] ;	// versao corrente de cada bloco
+int errors = 0 ;
+
+// sorteia um bloco com distribuicao de Zipf, espalhando os blocos mais
+// populares por todo o disco
+int zipf_next ()
+{
+  double u = (double) random () / RAND_MAX * zipf[SLOWBLOCKS] ;
+  int lo = 1, hi = SLOWBLOCKS, mid ;
+
+  while (lo < hi)
+  {
+    mid = (lo + hi) / 2 ;
+    if (zipf[mid] < u)
+      lo = mid + 1 ;
+    else
+      hi = mid ;
+  }
+  return ((long) lo * 7919) % SLOWBLOCKS ;
+}
+
+// preenche o buffer com o conteudo esperado do bloco
+void fill (int *buffer, int block)
+{
+  memset (buffer, 0, BLOCKSIZE) ;
+  buffer[0] = block ;
+  buffer[1] = version[block] ;
+}
+
+// executa OPS acessos (writepct% de escritas) direto no disco lento ou pela
+// camada e mostra a vazao e a taxa de acertos
+void run (char *name, int direct, int writepct)
+{
+  int buffer[BLOCKSIZE / sizeof (int)], expected[BLOCKSIZE / sizeof (int)] ;
+  tier_stats_t before, after ;
+  unsigned int start, elapsed ;
+  int i, b, write ;
+
+  tier_stats (&tier, &before) ;
+  start = systime () ;
+  for (i = 0; i < OPS; i++)
+  {
+    b = zipf_next () ;
+    write = (random () % 100) < writepct ;
+    if (write)
+    {
+      version[b]++ ;
+      fill (buffer, b) ;
+      if (tier_block_write (&tier, b, buffer))
+        errors++ ;
+    }
+    else
+    {
+      if (direct ? disk_dev_block_read (0, b, buffer) : tier_block_read (&tier, b, buffer))
+        errors++ ;
+      fill (expected, b) ;
+      if (memcmp (buffer, expected, BLOCKSIZE))
+        errors++ ;
+    }
+  }
+  elapsed = systime () - start ;
+  tier_stats (&tier, &after) ;
+
+  printf ("%-34s %d acessos em %5d ms: %6.1f acessos/s", name, OPS, elapsed,
+          OPS * 1000.0 / elapsed) ;
+  if (!direct)
+    printf (", %4.1f%% acertos, %u promocoes, %u substituicoes, %u copias para o "
+            "disco lento", 100.0 * (after.hits - before.hits) /
+            (after.hits - before.hits + after.misses - before.misses),
+            after.promotions - before.promotions, after.evictions - before.evictions,
+            after.writebacks - before.writebacks) ;
+  printf ("\n") ;
+}
+
+// confere os blocos alterados, pela camada ou direto no disco lento
+void check (int direct, char *name)
+{
+  int buffer[BLOCKSIZE / sizeof (int)], expected[BLOCKSIZE / sizeof (int)] ;
+  int b, bad = 0, count = 0 ;
+
+  for (b = 0; b < SLOWBLOCKS; b++)
+  {
+    if (!version[b])
+      continue ;
+    count++ ;
+    fill (expected, b) ;
+    if ((direct ? disk_dev_block_read (0, b, buffer) : tier_block_read (&tier, b, buffer)) ||
+        memcmp (buffer, expected, BLOCKSIZE))
+      bad++ ;
+  }
+  printf ("%s: %d blocos alterados conferidos, %d incorretos\n", name, count, bad) ;
+  errors += bad ;
+}
+
+int main (int argc, char *argv[])
+{
+  disk_config_t cfg ;
+  char *area ;
+  void *buffers[DISK_VEC_MAX] ;
+  int i, b, numblocks, blocksize ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // disco lento (HDD, tempos de acesso reduzidos) e disco rapido (SSD)
+  disk_config_init (&cfg) ;
+  strcpy (cfg.image, "disk-tier0.dat") ;
+  cfg.numblocks = SLOWBLOCKS ;
+  cfg.blocksize = BLOCKSIZE ;
+  cfg.seek_min_us = 2000 ;
+  cfg.seek_max_us = 20000 ;
+  cfg.jitter_us = 2000 ;
+  cfg.xfer_rate = 640000 ;
+  if (disk_dev_config (0, &cfg) < 0 || disk_dev_mgr_init (0, &numblocks, &blocksize) < 0)
+  {
+    printf ("Erro na abertura do disco lento\n") ;
+    exit (1) ;
+  }
+  disk_config_init (&cfg) ;
+  disk_config_profile (&cfg, DISK_PROFILE_SSD) ;
+  strcpy (cfg.image, "disk-tier1.dat") ;
+  cfg.numblocks = FASTBLOCKS ;
+  cfg.blocksize = BLOCKSIZE ;
+  if (disk_dev_config (1, &cfg) < 0 || disk_dev_mgr_init (1, &numblocks, &blocksize) < 0)
+  {
+    printf ("Erro na abertura do disco rapido\n") ;
+    exit (1) ;
+  }
+
+  // conteudo inicial do disco lento, em acessos de varios blocos
+  area = malloc (DISK_VEC_MAX * BLOCKSIZE) ;
+  for (b = 0; b < SLOWBLOCKS; b += DISK_VEC_MAX)
+  {
+    for (i = 0; i < DISK_VEC_MAX; i++)
+    {
+      buffers[i] = area + i * BLOCKSIZE ;
+      fill (buffers[i], b + i) ;
+    }
+    if (disk_dev_block_writev (0, b, DISK_VEC_MAX, buffers))
+      errors++ ;
+  }
+  free (area) ;
+
+  // distribuicao acumulada de Zipf: soma de 1/k
+  for (i = 1; i <= SLOWBLOCKS; i++)
+    zipf[i] = zipf[i - 1] + 1.0 / i ;
+
+  if (tier_format (1, 0) || tier_mount (&tier, 1, 0, TIER_WRITE_THROUGH))
+  {
+    printf ("Erro na criacao da cache\n") ;
+    exit (1) ;
+  }
+  printf ("cache de %d posicoes para %d blocos\n", tier.slots, tier.numBlocks) ;
+
+  run ("leitura Zipf, disco lento", 1, 0) ;
+  run ("leitura Zipf, escrita direta (1)", 0, 0) ;
+  run ("leitura Zipf, escrita direta (2)", 0, 0) ;
+  run ("leitura Zipf, escrita direta (3)", 0, 0) ;
+
+  // carga mista com escrita adiada
+  if (tier_umount (&tier) || tier_mount (&tier, 1, 0, TIER_WRITE_BACK))
+    errors++ ;
+  run ("mista, escrita adiada (1)", 0, WRITEPCT) ;
+  run ("mista, escrita adiada (2)", 0, WRITEPCT) ;
+
+  // simula a perda da memoria: remonta sem copiar os blocos alterados
+  if (tier_mount (&tier, 1, 0, TIER_WRITE_BACK))
+  {
+    printf ("Erro na remontagem da cache\n") ;
+    exit (1) ;
+  }
+  run ("mista, depois de remontar", 0, WRITEPCT) ;
+  check (0, "pela camada") ;
+
+  if (tier_umount (&tier))
+    errors++ ;
+  check (1, "no disco lento, depois de desmontar") ;
+
+  unlink ("disk-tier0.dat") ;
+  unlink ("disk-tier1.dat") ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
@@ -0,0 +1,102 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste das operações vetoriais de disco: compara a vazão da leitura e
+// escrita de uma faixa contígua de blocos, bloco a bloco (uma operação por
+// bloco) e com disk_block_readv/disk_block_writev (uma operação por faixa).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ppos.h"
+#include "ppos_disk.h"
+
+#define NUMBLOCKS 128		// tamanho da faixa transferida
+
+int numblocks ;			// numero de blocos no disco
+int blocksize ;			// tamanho de cada bloco (bytes)
+
+// imprime a vazao de uma transferencia
+void report (char *name, int blocks, unsigned int ms)
+{
+  if (ms == 0)
+    ms = 1 ;
+  printf ("%-16s %4d blocos em %6d ms: %8.1f blocos/s, %9.1f bytes/s\n",
+          name, blocks, ms, blocks * 1000.0 / ms,
+          (double) blocks * blocksize * 1000.0 / ms) ;
+}
+
+int main (int argc, char *argv[])
+{
+  int i, n, errors = 0 ;
+  unsigned int start ;
+  char *area, *copy ;
+  void *buffers[NUMBLOCKS] ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // inicializa o gerente de disco
+  if (disk_mgr_init (&numblocks, &blocksize) < 0)
+  {
+    printf ("Erro na abertura do disco\n") ;
+    exit (1) ;
+  }
+  printf ("Disco contem %d blocos de %d bytes cada\n", numblocks, blocksize) ;
+
+  n = (numblocks < NUMBLOCKS) ? numblocks : NUMBLOCKS ;
+
+  // buffers de leitura, espalhados em ordem inversa na area (scatter)
+  area = malloc (n * blocksize) ;
+  copy = malloc (n * blocksize) ;
+  if (!area || !copy)
+  {
+    perror ("malloc") ;
+    exit (1) ;
+  }
+  for (i = 0; i < n; i++)
+    buffers[i] = area + (n - 1 - i) * blocksize ;
+
+  // leitura bloco a bloco
+  start = systime () ;
+  for (i = 0; i < n; i++)
+    if (disk_block_read (i, copy + i * blocksize))
+      errors++ ;
+  report ("read (bloco)", n, systime () - start) ;
+
+  // leitura vetorial
+  start = systime () ;
+  if (disk_block_readv (0, n, buffers))
+    errors++ ;
+  report ("readv", n, systime () - start) ;
+
+  // confere se as duas leituras trouxeram o mesmo conteudo
+  for (i = 0; i < n; i++)
+    if (memcmp (buffers[i], copy + i * blocksize, blocksize))
+      errors++ ;
+
+  // escrita bloco a bloco (reescreve o mesmo conteudo)
+  start = systime () ;
+  for (i = 0; i < n; i++)
+    if (disk_block_write (i, copy + i * blocksize))
+      errors++ ;
+  report ("write (bloco)", n, systime () - start) ;
+
+  // escrita vetorial (reescreve o mesmo conteudo)
+  start = systime () ;
+  if (disk_block_writev (0, n, buffers))
+    errors++ ;
+  report ("writev", n, systime () - start) ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+
+  free (area) ;
+  free (copy) ;
+
+  task_exit (0) ;
+
+  exit (0) ;
+}
@@ -0,0 +1,203 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste da camada de compressao de blocos (ppos_zip.h): grava um conjunto
+// de dados textual de DATA blocos diretamente no disco 0 e pelo volume
+// comprimido no disco 1, e compara a vazao de escrita, de leitura
+// sequencial e de leitura aleatoria, alem da taxa de compressao. Depois,
+// grava blocos aleatorios (incompressiveis), remonta o volume e confere
+// todo o conteudo.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_zip.h"
+
+#define DISKBLOCKS 4096		// blocos de cada disco
+#define BLOCKSIZE  512		// tamanho dos blocos
+#define DATA       1024		// blocos do conjunto de dados
+#define RANDOM     512		// leituras aleatorias
+#define NOISE      64		// blocos aleatorios (incompressiveis)
+
+char *words[] = { "o", "sistema", "operacional", "tarefa", "disco", "bloco",
+  "processo", "memoria", "de", "que", "escalonador", "semaforo", "fila", "a",
+  "para", "com", "um", "uma", "leitura", "escrita", "arquivo", "dados",
+  "nucleo", "contexto", "prioridade", "interrupcao", "tempo", "em", "se",
+  "nao", "mais", "como" } ;
+
+zip_t zip ;
+char *dataset ;			// conteudo esperado de cada bloco
+int errors = 0 ;
+
+// gera texto com palavras aleatorias, frases e linhas
+void text (char *buf, int size)
+{
+  int n = 0, len ;
+  char *w ;
+
+  while (n < size)
+  {
+    w = words[random () % (sizeof (words) / sizeof (char *))] ;
+    len = strlen (w) ;
+    if (n + len + 1 > size)
+      len = size - n - 1 ;
+    if (len > 0)
+      memcpy (buf + n, w, len) ;
+    n += len ;
+    if (n < size)
+      buf[n++] = (random () % 12) ? ' ' : ((random () % 4) ? '.' : '\n') ;
+  }
+}
+
+// mostra a vazao de uma fase
+void report (char *phase, int blocks, unsigned int elapsed)
+{
+  printf ("%-28s %4d blocos em %5d ms: %7.1f KB/s\n", phase, blocks, elapsed,
+          blocks * BLOCKSIZE * 1000.0 / 1024 / (elapsed ? elapsed : 1)) ;
+}
+
+// confere os blocos [first, first + count) do volume
+void check (int first, int count, char *name)
+{
+  char buffer[BLOCKSIZE] ;
+  int b, bad = 0 ;
+
+  for (b = first; b < first + count; b++)
+    if (zip_block_read (&zip, b, buffer) || memcmp (buffer, dataset + b * BLOCKSIZE, BLOCKSIZE))
+      bad++ ;
+  printf ("%s: %d blocos conferidos, %d incorretos\n", name, count, bad) ;
+  errors += bad ;
+}
+
+int main (int argc, char *argv[])
+{
+  disk_config_t cfg ;
+  zip_stats_t stats ;
+  char buffer[BLOCKSIZE] ;
+  unsigned int start ;
+  int i, b, dev, numblocks, blocksize, order[RANDOM] ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // cria e inicializa os discos, com tempos de acesso reduzidos
+  for (i = 0; i < 2; i++)
+  {
+    disk_config_init (&cfg) ;
+    sprintf (cfg.image, "disk-zip%d.dat", i) ;
+    cfg.numblocks = DISKBLOCKS ;
+    cfg.blocksize = BLOCKSIZE ;
+    cfg.seek_min_us = 2000 ;
+    cfg.seek_max_us = 20000 ;
+    cfg.jitter_us = 2000 ;
+    cfg.xfer_rate = 640000 ;
+    if (disk_dev_config (i, &cfg) < 0 ||
+        disk_dev_mgr_init (i, &numblocks, &blocksize) < 0)
+    {
+      printf ("Erro na abertura do disco %d\n", i) ;
+      exit (1) ;
+    }
+  }
+
+  if (zip_format (1) || zip_mount (&zip, 1))
+  {
+    printf ("Erro na criacao do volume comprimido\n") ;
+    exit (1) ;
+  }
+
+  dataset = malloc ((DATA + NOISE) * BLOCKSIZE) ;
+  text (dataset, DATA * BLOCKSIZE) ;
+  for (i = 0; i < NOISE * BLOCKSIZE; i++)
+    dataset[DATA * BLOCKSIZE + i] = random () ;
+  for (i = 0; i < RANDOM; i++)
+    order[i] = random () % DATA ;
+
+  for (dev = 0; dev < 2; dev++)
+  {
+    printf ("%s:\n", dev ? "volume comprimido" : "disco direto") ;
+
+    // escrita sequencial (no volume, ate a gravacao das unidades e do mapa)
+    start = systime () ;
+    for (b = 0; b < DATA; b++)
+      if (dev ? zip_block_write (&zip, b, dataset + b * BLOCKSIZE)
+              : disk_dev_block_write (0, b, dataset + b * BLOCKSIZE))
+        errors++ ;
+    if (dev && zip_sync (&zip))
+      errors++ ;
+    report ("  escrita sequencial", DATA, systime () - start) ;
+    if (dev)
+    {
+      zip_stats (&zip, &stats) ;
+      printf ("  compressao: %lu bytes em %lu (taxa %.2f), %u unidades gravadas "
+              "em %u blocos, %u sem compressao\n", stats.bytesIn, stats.bytesOut,
+              (double) stats.bytesIn / stats.bytesOut, stats.chunks,
+              stats.physwrites, stats.raw) ;
+    }
+
+    // leitura sequencial com a cache vazia
+    if (dev && (zip_umount (&zip) || zip_mount (&zip, 1)))
+      errors++ ;
+    start = systime () ;
+    for (b = 0; b < DATA; b++)
+      if ((dev ? zip_block_read (&zip, b, buffer) : disk_dev_block_read (0, b, buffer)) ||
+          memcmp (buffer, dataset + b * BLOCKSIZE, BLOCKSIZE))
+        errors++ ;
+    report ("  leitura sequencial", DATA, systime () - start) ;
+
+    // leitura aleatoria
+    start = systime () ;
+    for (i = 0; i < RANDOM; i++)
+      if ((dev ? zip_block_read (&zip, order[i], buffer)
+               : disk_dev_block_read (0, order[i], buffer)) ||
+          memcmp (buffer, dataset + order[i] * BLOCKSIZE, BLOCKSIZE))
+        errors++ ;
+    report ("  leitura aleatoria", RANDOM, systime () - start) ;
+  }
+
+  zip_stats (&zip, &stats) ;
+  printf ("cache: %u acertos, %u unidades carregadas (%u blocos fisicos lidos)\n",
+          stats.hits, stats.misses, stats.physreads) ;
+
+  // blocos incompressiveis e regravacao de parte do texto
+  for (b = DATA; b < DATA + NOISE; b++)
+    if (zip_block_write (&zip, b, dataset + b * BLOCKSIZE))
+      errors++ ;
+  text (dataset, 32 * BLOCKSIZE) ;
+  for (b = 0; b < 32; b++)
+    if (zip_block_write (&zip, b, dataset + b * BLOCKSIZE))
+      errors++ ;
+
+  if (zip_umount (&zip) || zip_mount (&zip, 1))
+  {
+    printf ("Erro na remontagem do volume comprimido\n") ;
+    exit (1) ;
+  }
+  check (0, DATA + NOISE, "depois de remontar") ;
+  if (zip_block_read (&zip, DATA + NOISE, buffer))
+    errors++ ;
+  for (i = 0; i < BLOCKSIZE; i++)
+    if (buffer[i])
+      break ;
+  if (i < BLOCKSIZE)
+  {
+    printf ("bloco nunca escrito nao esta zerado\n") ;
+    errors++ ;
+  }
+
+  if (zip_umount (&zip))
+    errors++ ;
+  free (dataset) ;
+
+  unlink ("disk-zip0.dat") ;
+  unlink ("disk-zip1.dat") ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
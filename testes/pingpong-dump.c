@@ -0,0 +1,191 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste dos retratos do nucleo (ppos_dump.h): tres tarefas ficam suspensas
+// em um semaforo, uma remetente fica suspensa em uma fila de mensagens
+// cheia, duas tarefas dormem e uma leitora usa o disco. O processo envia
+// SIGUSR2 a si mesmo e confere que a tarefa de servico gravou o retrato em
+// texto, e que um retrato em JSON mostra os mesmos estados.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_disk.h"
+#include "ppos_dump.h"
+
+#define WAITERS  3		// tarefas suspensas no semaforo
+#define SLEEPERS 2		// tarefas dorminhocas
+#define MSGMAX   2		// capacidade da fila de mensagens
+#define DUMPFILE "ppos.dump"	// arquivo dos retratos
+
+task_t waiter[WAITERS], sleeper[SLEEPERS], sender, reader ;
+semaphore_t s ;
+mqueue_t mq ;
+int errors = 0 ;
+
+void waitBody (void *arg)
+{
+  sem_down (&s) ;
+  task_exit (0) ;
+}
+
+void sleepBody (void *arg)
+{
+  task_sleep (500) ;
+  task_exit (0) ;
+}
+
+// envia uma mensagem a mais que a capacidade da fila
+void sendBody (void *arg)
+{
+  int i ;
+
+  for (i = 0; i <= MSGMAX; i++)
+    mqueue_send (&mq, &i) ;
+  task_exit (0) ;
+}
+
+void readBody (void *arg)
+{
+  char buffer[64] ;
+  int i ;
+
+  for (i = 0; i < 4; i++)
+    if (disk_block_read (i, buffer))
+      errors++ ;
+  task_exit (0) ;
+}
+
+// confere se o texto contem s
+void expect (char *text, char *s)
+{
+  if (!strstr (text, s))
+  {
+    printf ("retrato sem \"%s\"\n", s) ;
+    errors++ ;
+  }
+}
+
+// bytes de pilha da tarefa id no retrato JSON
+long stack (char *json, int id)
+{
+  char key[32], *p ;
+
+  sprintf (key, "{\"id\":%d,", id) ;
+  if (!(p = strstr (json, key)) || !(p = strstr (p, "\"stack\":")))
+    return -1 ;
+  return atol (p + 8) ;
+}
+
+int main (int argc, char *argv[])
+{
+  char *text, key[64] ;
+  size_t size ;
+  FILE *f ;
+  int i, numblocks, blocksize ;
+
+  printf ("main: inicio\n") ;
+
+  ppos_init () ;
+  unlink (DUMPFILE) ;
+
+  if (disk_mgr_init (&numblocks, &blocksize) < 0)
+  {
+    printf ("Erro na abertura do disco\n") ;
+    exit (1) ;
+  }
+  sem_create (&s, 0) ;
+  mqueue_create (&mq, MSGMAX, sizeof (int)) ;
+
+  if (dump_start (NULL, DUMP_TEXT) != -1 || dump_start (DUMPFILE, 7) != -1)
+    errors++ ;
+  if (dump_start (DUMPFILE, DUMP_TEXT) || dump_start (DUMPFILE, DUMP_TEXT) != -1)
+    errors++ ;
+
+  for (i = 0; i < WAITERS; i++)
+    task_create (&waiter[i], waitBody, NULL) ;
+  for (i = 0; i < SLEEPERS; i++)
+    task_create (&sleeper[i], sleepBody, NULL) ;
+  task_create (&sender, sendBody, NULL) ;
+  task_create (&reader, readBody, NULL) ;
+
+  // todas as tarefas chegam aos pontos de espera
+  task_sleep (20) ;
+
+  // pedido de retrato pelo sinal, atendido pela tarefa de servico
+  kill (getpid (), SIGUSR2) ;
+  for (i = 0; i < 100 && !dump_count (); i++)
+    task_sleep (10) ;
+  if (dump_count () != 1)
+    errors++ ;
+
+  text = calloc (1, 65536) ;
+  if ((f = fopen (DUMPFILE, "r")))
+  {
+    fread (text, 1, 65535, f) ;
+    fclose (f) ;
+  }
+  printf ("%s", text) ;
+  expect (text, "=== PPOS dump") ;
+  expect (text, "): contador -3, 3 suspensas:") ;
+  expect (text, "(vagas da fila") ;
+  expect (text, "2/2 mensagens de 4 bytes, 0 receptores e 1 remetentes") ;
+  expect (text, "dormindo") ;
+  expect (text, "disco 0: fila") ;
+  sprintf (key, "semaforo %p (semaforo)", (void *) &s) ;
+  expect (text, key) ;
+  free (text) ;
+
+  // retrato em JSON na tarefa corrente
+  f = open_memstream (&text, &size) ;
+  if (dump_write (f, DUMP_JSON) || dump_write (NULL, DUMP_JSON) != -1)
+    errors++ ;
+  fclose (f) ;
+  printf ("%s", text) ;
+  expect (text, "\"role\":\"vagas\"") ;
+  expect (text, "\"state\":\"semaforo\"") ;
+  expect (text, "\"state\":\"executando\"") ;
+  sprintf (key, "\"waiters\":[%d,%d,%d]", waiter[0].id, waiter[1].id, waiter[2].id) ;
+  if (!strstr (text, key))
+  {
+    // o registro de tarefas lista as mais novas primeiro
+    sprintf (key, "\"waiters\":[%d,%d,%d]", waiter[2].id, waiter[1].id, waiter[0].id) ;
+    expect (text, key) ;
+  }
+  for (i = 0; i < WAITERS; i++)
+    if (stack (text, waiter[i].id) <= 0 || stack (text, waiter[i].id) >= 64 * 1024)
+    {
+      printf ("pilha da tarefa %d: %ld\n", waiter[i].id, stack (text, waiter[i].id)) ;
+      errors++ ;
+    }
+  if (text[strlen (text) - 1] != '\n' || strchr (text, '\n') != text + strlen (text) - 1)
+    errors++ ;
+  free (text) ;
+
+  // libera as tarefas
+  for (i = 0; i < WAITERS; i++)
+    sem_up (&s) ;
+  for (i = 0; i <= MSGMAX; i++)
+    mqueue_recv (&mq, &numblocks) ;
+  for (i = 0; i < WAITERS; i++)
+    task_join (&waiter[i]) ;
+  for (i = 0; i < SLEEPERS; i++)
+    task_join (&sleeper[i]) ;
+  task_join (&sender) ;
+  task_join (&reader) ;
+
+  if (dump_stop () || dump_stop () != -1)
+    errors++ ;
+  mqueue_destroy (&mq) ;
+  sem_destroy (&s) ;
+  unlink (DUMPFILE) ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
@@ -0,0 +1,189 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste dos histogramas de latencia de escalonamento (ppos_lat.h): confere
+// a precisao dos percentis com valores conhecidos e depois roda duas
+// tarefas de CPU junto com pares de tarefas que trocam a vez por semaforos
+// (prioridade alta e baixa), uma tarefa que dorme e uma que le o disco.
+// Mostra os percentis de cada latencia e confere as amostras de cada causa.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_disk.h"
+#include "ppos_lat.h"
+
+#define CPUTIME    200		// tempo de CPU de cada tarefa de CPU (ms)
+#define ROUNDS     200		// trocas de cada par
+#define SLEEPS     50		// cochilos da tarefa dorminhoca
+#define READS      50		// leituras da tarefa leitora
+#define DISKBLOCKS 1024		// blocos do disco
+#define BLOCKSIZE  512		// tamanho dos blocos
+
+task_t cpu[2], high[2], low[2], sleeper, reader ;
+semaphore_t sHigh[2], sLow[2] ;
+lat_hist_t local ;
+int errors = 0 ;
+
+// consome CPU ate a tarefa acumular CPUTIME ms de execucao
+void cpuBody (void *arg)
+{
+  task_stats_t st ;
+
+  do
+    task_stats (NULL, &st) ;
+  while (st.run_ns < CPUTIME * 1000000ULL) ;
+  task_exit (0) ;
+}
+
+// troca a vez com o par por ROUNDS vezes (arg = semaforos do par, e qual
+// dos dois eh esta tarefa)
+void pairBody (void *arg)
+{
+  semaphore_t *s = (semaphore_t *) ((long) arg & ~1L) ;
+  int me = (long) arg & 1, i ;
+
+  for (i = 0; i < ROUNDS; i++)
+  {
+    sem_down (&s[me]) ;
+    sem_up (&s[!me]) ;
+  }
+  task_exit (0) ;
+}
+
+// dorme SLEEPS vezes por 2 ms
+void sleepBody (void *arg)
+{
+  int i ;
+
+  for (i = 0; i < SLEEPS; i++)
+    task_sleep (2) ;
+  task_exit (0) ;
+}
+
+// le READS blocos aleatorios do disco
+void readBody (void *arg)
+{
+  char buffer[BLOCKSIZE] ;
+  int i ;
+
+  for (i = 0; i < READS; i++)
+    if (disk_dev_block_read (0, random () % DISKBLOCKS, buffer))
+      errors++ ;
+  task_exit (0) ;
+}
+
+// confere um percentil do histograma local (valores 1..100000) com erro de
+// ate 1/LAT_SUB
+void check (double pct)
+{
+  unsigned long long p = lat_percentile (&local, pct), exact = pct * 1000 ;
+
+  printf ("p%-5g: %6llu ns (exato %6llu)\n", pct, p, exact) ;
+  if (p < exact || p > exact + exact / LAT_SUB + 1)
+    errors++ ;
+}
+
+// confere o numero minimo de amostras e a ordem dos percentis
+void expect (int kind, int cls, unsigned long long min)
+{
+  lat_hist_t *h = malloc (sizeof (lat_hist_t)) ;
+
+  lat_get (kind, cls, h) ;
+  if (h->count < min || lat_percentile (h, 50) > lat_percentile (h, 99) ||
+      lat_percentile (h, 99) > h->max || h->min > lat_percentile (h, 50))
+  {
+    printf ("latencia %d, classe %d: %llu amostras (minimo %llu)\n", kind, cls, h->count, min) ;
+    errors++ ;
+  }
+  free (h) ;
+}
+
+int main (int argc, char *argv[])
+{
+  disk_config_t cfg ;
+  lat_hist_t *h ;
+  int i, numblocks, blocksize ;
+
+  printf ("main: inicio\n") ;
+
+  ppos_init () ;
+
+  // precisao dos percentis
+  for (i = 1; i <= 100000; i++)
+    lat_record (&local, i) ;
+  check (50) ;
+  check (90) ;
+  check (99) ;
+  check (99.9) ;
+  if (local.min != 1 || local.max != 100000 || lat_percentile (&local, 100) != 100000)
+    errors++ ;
+
+  // disco com tempos de acesso reduzidos
+  disk_config_init (&cfg) ;
+  strcpy (cfg.image, "disk-lat.dat") ;
+  cfg.numblocks = DISKBLOCKS ;
+  cfg.blocksize = BLOCKSIZE ;
+  cfg.seek_min_us = 200 ;
+  cfg.seek_max_us = 2000 ;
+  cfg.jitter_us = 200 ;
+  cfg.xfer_rate = 6400000 ;
+  if (disk_dev_config (0, &cfg) < 0 || disk_dev_mgr_init (0, &numblocks, &blocksize) < 0)
+  {
+    printf ("Erro na abertura do disco\n") ;
+    exit (1) ;
+  }
+
+  lat_reset () ;
+  for (i = 0; i < 2; i++)
+  {
+    sem_create (&sHigh[i], !i) ;
+    sem_create (&sLow[i], !i) ;
+  }
+  for (i = 0; i < 2; i++)
+  {
+    task_create (&cpu[i], cpuBody, NULL) ;
+    task_create (&high[i], pairBody, (void *) ((long) sHigh | i)) ;
+    task_setprio (&high[i], -5) ;
+    task_create (&low[i], pairBody, (void *) ((long) sLow | i)) ;
+    task_setprio (&low[i], 5) ;
+  }
+  task_create (&sleeper, sleepBody, NULL) ;
+  task_create (&reader, readBody, NULL) ;
+
+  for (i = 0; i < 2; i++)
+  {
+    task_join (&cpu[i]) ;
+    task_join (&high[i]) ;
+    task_join (&low[i]) ;
+  }
+  task_join (&sleeper) ;
+  task_join (&reader) ;
+
+  lat_report (stdout) ;
+
+  // cada troca do par acorda a outra tarefa por semaforo (exceto a primeira
+  // e a ultima)
+  expect (LAT_READY, LAT_CLASS_ALL, 1) ;
+  expect (LAT_SEM, LAT_CLASS_HIGH, 2 * ROUNDS - 2) ;
+  expect (LAT_SEM, LAT_CLASS_LOW, 2 * ROUNDS - 2) ;
+  expect (LAT_WAKEUP, LAT_CLASS_NORMAL, SLEEPS) ;
+  expect (LAT_DISK, LAT_CLASS_NORMAL, READS) ;
+
+  // os histogramas zerados nao tem amostras
+  lat_reset () ;
+  h = malloc (sizeof (lat_hist_t)) ;
+  if (lat_get (LAT_READY, LAT_CLASS_ALL, h) || h->count || lat_get (LAT_KINDS, 0, h) != -1)
+    errors++ ;
+  free (h) ;
+
+  unlink ("disk-lat.dat") ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
@@ -0,0 +1,147 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste do registro assincrono (ppos_log.h): TASKS tarefas preemptadas
+// escrevem LINES linhas cada, com printf e ppos_log, com a saida padrao
+// desviada para um arquivo. Confere que nenhuma linha se perdeu ou foi
+// partida, que as linhas de cada tarefa estao em ordem, que as mensagens
+// abaixo do nivel minimo foram descartadas e que as linhas foram gravadas
+// em lotes. Um processo filho escreve e sofre uma falha de segmentacao: a
+// saida dele deve chegar inteira ao processo pai.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_log.h"
+
+#define TASKS   5		// tarefas escritoras
+#define LINES   400		// linhas de cada tarefa
+#define LOGFILE "ppos.log"	// arquivo que recebe a saida padrao
+
+task_t task[TASKS] ;
+int errors = 0 ;
+volatile long sink ;
+
+// escreve LINES linhas, alternando printf e ppos_log
+void Body (void *arg)
+{
+  long i, j ;
+
+  for (i = 0; i < LINES; i++)
+  {
+    if (i % 2)
+      printf ("tarefa %d linha %ld\n", task_id (), i) ;
+    else
+      ppos_log (LOG_LEVEL_INFO, "tarefa %d linha %ld\n", task_id (), i) ;
+    ppos_log (LOG_LEVEL_DEBUG, "descartada %d %ld\n", task_id (), i) ;
+    for (j = 0; j < 20000; j++)
+      sink += j ;
+  }
+  task_exit (0) ;
+}
+
+// processo filho: escreve e falha, sem gravar o anel explicitamente
+void crash ()
+{
+  ppos_init () ;
+  printf ("filho: antes da falha\n") ;
+  ppos_log (LOG_LEVEL_WARN, "filho: aviso\n") ;
+  *(volatile int *) 0 = 1 ;
+  exit (0) ;
+}
+
+int main (int argc, char *argv[])
+{
+  char cmd[1024], line[256], out[4096] ;
+  int i, id, n, fd, saved, next[TASKS + 4], lines = 0, mark = 0 ;
+  log_stats_t st ;
+  size_t size ;
+  FILE *f ;
+
+  if (argc > 1)
+    crash () ;
+
+  printf ("main: inicio\n") ;
+
+  // a saida do filho chega inteira apesar da falha
+  snprintf (cmd, sizeof (cmd), "exec %s falha", argv[0]) ;
+  f = popen (cmd, "r") ;
+  size = f ? fread (out, 1, sizeof (out) - 1, f) : 0 ;
+  out[size] = 0 ;
+  if (!f || !pclose (f) || !strstr (out, "filho: antes da falha\nfilho: aviso\n"))
+  {
+    printf ("saida do filho:\n%s", out) ;
+    errors++ ;
+  }
+
+  ppos_init () ;
+
+  if (log_start () != -1 || log_level (7) != -1 || ppos_log (9, "x\n") != -1)
+    errors++ ;
+  if (log_level (LOG_LEVEL_INFO) != LOG_LEVEL_DEBUG)
+    errors++ ;
+
+  // desvia a saida padrao para o arquivo
+  fd = open (LOGFILE, O_CREAT | O_TRUNC | O_WRONLY, 0644) ;
+  saved = dup (1) ;
+  dup2 (fd, 1) ;
+  close (fd) ;
+
+  for (i = 0; i < TASKS; i++)
+    task_create (&task[i], Body, NULL) ;
+  for (i = 0; i < TASKS; i++)
+    task_join (&task[i]) ;
+  printf ("marca\n") ;
+
+  log_flush () ;
+  dup2 (saved, 1) ;
+  close (saved) ;
+
+  // linhas completas, em ordem em cada tarefa, antes da marca
+  memset (next, 0, sizeof (next)) ;
+  f = fopen (LOGFILE, "r") ;
+  while (f && fgets (line, sizeof (line), f))
+  {
+    if (sscanf (line, "tarefa %d linha %d\n", &id, &n) == 2 && id >= 2 && id < TASKS + 2)
+    {
+      if (n != next[id] || mark)
+      {
+        printf ("fora de ordem: %s", line) ;
+        errors++ ;
+      }
+      next[id] = n + 1 ;
+      lines++ ;
+    }
+    else if (!strcmp (line, "marca\n"))
+      mark = 1 ;
+    else if (strncmp (line, "Task ", 5))
+    {
+      printf ("linha inesperada: %s", line) ;
+      errors++ ;
+    }
+  }
+  if (f)
+    fclose (f) ;
+  unlink (LOGFILE) ;
+
+  log_stats (&st) ;
+  printf ("%d linhas, %u registros, %llu bytes, %u gravacoes, %u write(), %u descartadas\n",
+          lines, st.records, st.bytes, st.flushes, st.writes, st.dropped) ;
+  if (lines != TASKS * LINES || !mark)
+    errors++ ;
+  if (st.dropped < TASKS * LINES || st.records < TASKS * LINES || st.writes * 10 > st.records)
+    errors++ ;
+
+  // de volta a saida sem buffer
+  if (log_stop () || log_stop () != -1 || log_flush ())
+    errors++ ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
@@ -0,0 +1,177 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste da medicao de pilhas (ppos_stack.h): tarefas rasas e tarefas que
+// usam cerca de DEPTH KB de pilha. Confere que sem a medicao ligada as
+// pilhas nao sao pintadas, os picos agregados por funcao de entrada, a
+// medicao sob demanda de uma tarefa viva e, com o
+// dimensionamento automatico, que as novas tarefas recebem pilhas menores
+// que STACKSIZE sem estourar. Deve ser ligado com -rdynamic, para que as
+// funcoes tenham nome.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_stack.h"
+
+#define TASKS    3		// tarefas de cada tipo
+#define DEPTH    20		// KB de pilha das tarefas fundas
+#define SAVEFILE "pilhas.txt"	// tamanhos aprendidos
+
+task_t shallowTask[TASKS], deepTask[TASKS], holder ;
+semaphore_t s ;
+int errors = 0 ;
+
+// usa n KB de pilha
+int recurse (int n)
+{
+  volatile char buffer[1024] ;
+
+  buffer[0] = n ;
+  if (n > 0)
+    return recurse (n - 1) + buffer[0] ;
+  return buffer[0] ;
+}
+
+void shallow (void *arg)
+{
+  task_exit (0) ;
+}
+
+void deep (void *arg)
+{
+  recurse (DEPTH) ;
+  task_exit (0) ;
+}
+
+// usa metade da pilha das fundas e fica suspensa
+void hold (void *arg)
+{
+  recurse (DEPTH / 2) ;
+  sem_down (&s) ;
+  task_exit (0) ;
+}
+
+// procura a funcao name na tabela
+stack_entry_t *entry (stack_entry_t *table, int n, char *name)
+{
+  int i ;
+
+  for (i = 0; i < n; i++)
+    if (!strcmp (table[i].name, name))
+      return &table[i] ;
+  printf ("funcao %s nao encontrada\n", name) ;
+  errors++ ;
+  return &table[n] ;
+}
+
+// cria e espera TASKS tarefas rasas e TASKS fundas
+void run ()
+{
+  int i ;
+
+  for (i = 0; i < TASKS; i++)
+  {
+    task_create (&shallowTask[i], shallow, NULL) ;
+    task_create (&deepTask[i], deep, NULL) ;
+  }
+  for (i = 0; i < TASKS; i++)
+  {
+    task_join (&shallowTask[i]) ;
+    task_join (&deepTask[i]) ;
+  }
+}
+
+int main (int argc, char *argv[])
+{
+  stack_entry_t table[STACK_ENTRIES + 1], *e ;
+  char line[256] ;
+  long used ;
+  int n ;
+  FILE *f ;
+
+  printf ("main: inicio\n") ;
+
+  ppos_init () ;
+  sem_create (&s, 0) ;
+
+  // medicao desligada: a pilha nao eh pintada nem medida
+  task_create (&shallowTask[0], shallow, NULL) ;
+  if (stack_used (&shallowTask[0]) != -1)
+    errors++ ;
+  task_join (&shallowTask[0]) ;
+  if (stack_used (&shallowTask[0]) != -1 || stack_stats (table, STACK_ENTRIES) != 0)
+    errors++ ;
+  if (stack_measure (2) != -1 || stack_measure (1))
+    errors++ ;
+
+  // tarefa viva, medida sob demanda
+  task_create (&holder, hold, NULL) ;
+  task_yield () ;
+  used = stack_used (&holder) ;
+  printf ("tarefa viva: pico %ld bytes\n", used) ;
+  if (used < DEPTH / 2 * 1024 || used >= STACKSIZE)
+    errors++ ;
+  if (stack_used (NULL) != -1 || stack_used (&holder) != used)
+    errors++ ;
+
+  // picos por funcao de entrada, com a pilha padrao
+  run () ;
+  stack_report (stdout) ;
+  n = stack_stats (table, STACK_ENTRIES) ;
+  e = entry (table, n, "deep") ;
+  if (e->tasks != TASKS || e->max < DEPTH * 1024 || e->max >= STACKSIZE / 2 || e->overflows)
+    errors++ ;
+  if (deepTask[0].context.uc_stack.ss_size || stack_used (&deepTask[0]) != deepTask[0].stack_max ||
+      stack_used (&deepTask[0]) > e->max || stack_used (&deepTask[0]) < DEPTH * 1024)
+    errors++ ;
+  e = entry (table, n, "shallow") ;
+  if (e->tasks != TASKS || !e->max || e->max > 8 * 1024)
+    errors++ ;
+
+  // dimensionamento automatico: as novas tarefas usam os picos aprendidos
+  if (stack_autosize (2) != -1 || stack_autosize (1))
+    errors++ ;
+  task_create (&shallowTask[0], shallow, NULL) ;
+  task_create (&deepTask[0], deep, NULL) ;
+  printf ("pilhas automaticas: rasa %zu, funda %zu bytes\n",
+          shallowTask[0].context.uc_stack.ss_size, deepTask[0].context.uc_stack.ss_size) ;
+  if (shallowTask[0].context.uc_stack.ss_size != STACK_MIN)
+    errors++ ;
+  if (deepTask[0].context.uc_stack.ss_size < 2 * DEPTH * 1024 ||
+      deepTask[0].context.uc_stack.ss_size >= STACKSIZE)
+    errors++ ;
+  task_join (&shallowTask[0]) ;
+  task_join (&deepTask[0]) ;
+  run () ;
+  n = stack_stats (table, STACK_ENTRIES) ;
+  if (entry (table, n, "deep")->overflows || entry (table, n, "shallow")->overflows)
+    errors++ ;
+  stack_report (stdout) ;
+
+  // tamanhos gravados pelo nome da funcao
+  if (stack_save (SAVEFILE) || stack_load ("/nao/existe") != -1)
+    errors++ ;
+  n = 0 ;
+  f = fopen (SAVEFILE, "r") ;
+  while (f && fgets (line, sizeof (line), f))
+    if (!strncmp (line, "deep ", 5) || !strncmp (line, "shallow 16384 ", 14))
+      n++ ;
+  if (f)
+    fclose (f) ;
+  if (n != 2 || stack_load (SAVEFILE))
+    errors++ ;
+  unlink (SAVEFILE) ;
+
+  sem_up (&s) ;
+  task_join (&holder) ;
+  sem_destroy (&s) ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
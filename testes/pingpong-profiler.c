@@ -0,0 +1,147 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste do perfilador por amostragem (ppos_prof.h): a tarefa A gasta
+// CPUTIME ms de CPU em hotA() e a tarefa B metade disso em hotB(), chamada
+// por outerB(). Confere que as amostras sao atribuidas as tarefas na
+// proporcao do tempo de CPU e que as pilhas "folded" mostram as funcoes de
+// cada tarefa. Deve ser ligado com -rdynamic, para que as funcoes tenham
+// nome.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_prof.h"
+
+#define CPUTIME 300		// tempo de CPU da tarefa A (ms)
+#define FOLDED  "prof.folded"	// arquivo com as pilhas
+
+task_t taskA, taskB ;
+volatile long sink ;
+int errors = 0 ;
+
+// laco quente da tarefa A
+void hotA ()
+{
+  long i ;
+
+  for (i = 0; i < 20000; i++)
+    sink += i * i ;
+}
+
+// laco quente da tarefa B
+void hotB ()
+{
+  long i ;
+
+  for (i = 0; i < 20000; i++)
+    sink += i ^ (i << 3) ;
+}
+
+// chama hotB, para aparecer na pilha
+void outerB ()
+{
+  hotB () ;
+}
+
+// consome ms milissegundos de CPU chamando f
+void burn (void (*f) (), int ms)
+{
+  task_stats_t st ;
+
+  do
+  {
+    f () ;
+    task_stats (NULL, &st) ;
+  }
+  while (st.run_ns < ms * 1000000ULL) ;
+}
+
+void bodyA (void *arg)
+{
+  burn (hotA, CPUTIME) ;
+  task_exit (0) ;
+}
+
+void bodyB (void *arg)
+{
+  burn (outerB, CPUTIME / 2) ;
+  task_exit (0) ;
+}
+
+// soma as amostras das pilhas da tarefa id que contem a sequencia seq
+unsigned long long folded (char *file, int id, char *seq)
+{
+  char line[4096], prefix[32], *count ;
+  unsigned long long n = 0 ;
+  FILE *f = fopen (file, "r") ;
+
+  if (!f)
+    return 0 ;
+  sprintf (prefix, "task%d;", id) ;
+  while (fgets (line, sizeof (line), f))
+    if (!strncmp (line, prefix, strlen (prefix)) && strstr (line, seq) &&
+        (count = strrchr (line, ' ')))
+      n += atoll (count + 1) ;
+  fclose (f) ;
+  return n ;
+}
+
+int main (int argc, char *argv[])
+{
+  prof_stats_t st ;
+  unsigned long long a, b ;
+  FILE *f ;
+
+  printf ("main: inicio\n") ;
+
+  ppos_init () ;
+
+  if (prof_start (-1) != -1 || prof_start (1000))
+    errors++ ;
+
+  task_create (&taskA, bodyA, NULL) ;
+  task_create (&taskB, bodyB, NULL) ;
+  task_join (&taskA) ;
+  task_join (&taskB) ;
+
+  prof_stop () ;
+  prof_report (stdout) ;
+  prof_stats (&st) ;
+
+  // A gastou o dobro de CPU de B (o ITIMER_PROF pode ter resolucao de
+  // varios ms, dai o minimo baixo de amostras)
+  a = prof_samples (taskA.id) ;
+  b = prof_samples (taskB.id) ;
+  printf ("amostras: A %llu, B %llu, total %llu, perdidas %u\n", a, b, st.samples, st.lost) ;
+  if (st.samples < CPUTIME / 10 || st.lost || st.hz != 1000 || a + b > st.samples)
+    errors++ ;
+  if (!b || a < b * 1.3 || a > b * 3)
+    errors++ ;
+
+  // as pilhas mostram as funcoes de cada tarefa
+  f = fopen (FOLDED, "w") ;
+  if (prof_folded (f))
+    errors++ ;
+  fclose (f) ;
+  printf ("folded: A/hotA %llu, B/outerB;hotB %llu\n", folded (FOLDED, taskA.id, ";hotA"),
+          folded (FOLDED, taskB.id, ";outerB;hotB")) ;
+  if (folded (FOLDED, taskA.id, ";bodyA;burn;hotA") < a / 2 ||
+      folded (FOLDED, taskB.id, ";bodyB;burn;outerB;hotB") < b / 2 ||
+      folded (FOLDED, taskA.id, "hotB") || folded (FOLDED, taskB.id, "hotA"))
+    errors++ ;
+  unlink (FOLDED) ;
+
+  // amostras descartadas
+  prof_clear () ;
+  if (prof_samples (-1) || prof_samples (taskA.id))
+    errors++ ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
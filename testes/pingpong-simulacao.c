@@ -0,0 +1,191 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste do modo de simulacao em tempo virtual (ppos_sim): a carga usa o
+// disco com os tempos de acesso padrao (30 a 300 ms por operacao), tarefas
+// dorminhocas e tarefas de CPU que consultam o relogio. Ela eh executada
+// por processos filhos: duas vezes com a mesma semente, que devem produzir
+// exatamente a mesma saida, e uma vez com outra semente. Cada filho confere
+// que o tempo virtual avancou muito mais que o tempo real, que os cochilos
+// duram exatamente o pedido e que as tarefas de CPU foram preemptadas.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_disk.h"
+
+#define READERS    4		// tarefas leitoras
+#define READS      25		// leituras de cada leitora
+#define SLEEPERS   3		// tarefas dorminhocas
+#define SLEEPS     20		// cochilos de cada dorminhoca
+#define CPUTIME    100		// tempo de CPU de cada tarefa de CPU (ms)
+#define DISKBLOCKS 256		// blocos do disco
+#define OUTSIZE    65536	// saida de um filho
+
+task_t reader[READERS], sleeper[SLEEPERS], cpu[2] ;
+int errors = 0 ;
+
+// le READS blocos aleatorios, registrando o instante de cada conclusao
+void readBody (void *arg)
+{
+  char buffer[64] ;
+  int i, block ;
+
+  for (i = 0; i < READS; i++)
+  {
+    block = random () % DISKBLOCKS ;
+    if (disk_block_read (block, buffer))
+      errors++ ;
+    printf ("%5d: leitora %d, bloco %3d\n", systime (), task_id (), block) ;
+  }
+  task_exit (0) ;
+}
+
+// cochila SLEEPS vezes, conferindo a duracao de cada cochilo
+void sleepBody (void *arg)
+{
+  int i, t = (long) arg, start ;
+
+  for (i = 0; i < SLEEPS; i++)
+  {
+    start = systime () ;
+    task_sleep (t) ;
+    if (systime () - start != t)
+    {
+      printf ("dorminhoca %d: cochilo de %d ms durou %d ms\n", task_id (), t,
+              systime () - start) ;
+      errors++ ;
+    }
+  }
+  task_exit (0) ;
+}
+
+// consome CPU ate a tarefa acumular CPUTIME ms de execucao
+void cpuBody (void *arg)
+{
+  task_stats_t st ;
+
+  do
+    task_stats (NULL, &st) ;
+  while (st.run_ns < CPUTIME * 1000000ULL) ;
+  task_exit (0) ;
+}
+
+// executa a carga com a semente seed (processo filho)
+void child (int seed)
+{
+  disk_config_t cfg ;
+  ppos_stats_t sys ;
+  task_stats_t st ;
+  struct timespec t0, t1 ;
+  double real ;
+  int i, numblocks, blocksize ;
+
+  clock_gettime (CLOCK_MONOTONIC, &t0) ;
+  if (ppos_sim (seed))
+    errors++ ;
+  ppos_init () ;
+  if (ppos_sim (seed) != -1)
+    errors++ ;
+
+  disk_config_init (&cfg) ;
+  strcpy (cfg.image, "disk-sim.dat") ;
+  cfg.numblocks = DISKBLOCKS ;
+  if (disk_config (&cfg) < 0 || disk_mgr_init (&numblocks, &blocksize) < 0)
+  {
+    printf ("Erro na abertura do disco\n") ;
+    exit (1) ;
+  }
+
+  for (i = 0; i < READERS; i++)
+    task_create (&reader[i], readBody, NULL) ;
+  for (i = 0; i < SLEEPERS; i++)
+    task_create (&sleeper[i], sleepBody, (void *) (long) (7 + 10 * i)) ;
+  // as tarefas de CPU so comecam depois dos cochilos, que seriam atrasados
+  // pelos quanta delas
+  for (i = 0; i < SLEEPERS; i++)
+    task_join (&sleeper[i]) ;
+  for (i = 0; i < 2; i++)
+    task_create (&cpu[i], cpuBody, NULL) ;
+  for (i = 0; i < 2; i++)
+  {
+    task_join (&cpu[i]) ;
+    task_stats (&cpu[i], &st) ;
+    if (st.run_ns < CPUTIME * 1000000ULL || !st.invol_switches)
+      errors++ ;
+  }
+  for (i = 0; i < READERS; i++)
+    task_join (&reader[i]) ;
+
+  // todas as leituras juntas levam segundos de tempo virtual
+  clock_gettime (CLOCK_MONOTONIC, &t1) ;
+  real = (t1.tv_sec - t0.tv_sec) * 1000.0 + (t1.tv_nsec - t0.tv_nsec) / 1e6 ;
+  ppos_stats (&sys, NULL, 0) ;
+  printf ("tempo virtual %u ms, %llu preempcoes\n", systime (), sys.preemptions) ;
+  if (systime () < READERS * READS * 30 || real * 10 > systime ())
+  {
+    printf ("tempo virtual %u ms em %.0f ms reais\n", systime (), real) ;
+    errors++ ;
+  }
+  if (!sys.preemptions)
+    errors++ ;
+
+  unlink ("disk-sim.dat") ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
+
+// executa um filho com a semente seed e guarda sua saida em out
+void run (char *prog, int seed, char *out)
+{
+  char cmd[1024] ;
+  FILE *in ;
+  size_t n ;
+
+  snprintf (cmd, sizeof (cmd), "%s %d", prog, seed) ;
+  in = popen (cmd, "r") ;
+  n = in ? fread (out, 1, OUTSIZE - 1, in) : 0 ;
+  out[n] = 0 ;
+  if (!in || pclose (in) || !strstr (out, "main: fim (0 erros)"))
+  {
+    printf ("semente %d:\n%s", seed, out) ;
+    errors++ ;
+  }
+}
+
+int main (int argc, char *argv[])
+{
+  char *out[3] ;
+  int i ;
+
+  if (argc > 1)
+    child (atoi (argv[1])) ;
+
+  printf ("main: inicio\n") ;
+
+  for (i = 0; i < 3; i++)
+    out[i] = malloc (OUTSIZE) ;
+  run (argv[0], 42, out[0]) ;
+  run (argv[0], 42, out[1]) ;
+  run (argv[0], 7, out[2]) ;
+
+  // a mesma semente reproduz a execucao; outra semente muda os sorteios
+  printf ("%s", out[0]) ;
+  if (strcmp (out[0], out[1]))
+  {
+    printf ("execucoes com a mesma semente diferem:\n%s", out[1]) ;
+    errors++ ;
+  }
+  if (!strcmp (out[0], out[2]))
+    errors++ ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  exit (0) ;
+}
@@ -0,0 +1,261 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Teste do rastreamento de eventos (ppos_trace.h): NTASKS tarefas disputam
+// um semaforo e enviam mensagens a uma consumidora, enquanto READERS tarefas
+// leem blocos do disco. A carga roda com o rastreamento desligado e ligado,
+// para medir o custo por evento; o anel eh gravado, relido e convertido
+// para JSON do Chrome, conferindo a quantidade de eventos de cada tipo. Por
+// fim, um anel pequeno deve sobrescrever os eventos mais antigos. As
+// conclusoes de disco chegam (SIGUSR1) durante as operacoes das produtoras
+// sobre as filas do nucleo: uma falha aqui pode vir do disco, nao do
+// rastreamento, por isso cada carga confere tambem os pedidos do gerente.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ppos.h"
+#include "ppos_disk.h"
+#include "ppos_trace.h"
+
+#define NTASKS     1000		// tarefas produtoras
+#define ROUNDS     10		// mensagens por produtora
+#define READERS    4		// tarefas leitoras do disco
+#define READS      50		// leituras por leitora
+#define DISKBLOCKS 1024		// blocos do disco
+#define BLOCKSIZE  512		// tamanho dos blocos
+#define RING       (1 << 19)	// eventos do anel
+
+task_t prod[NTASKS], readers[READERS], cons ;
+semaphore_t mutex ;
+mqueue_t mq ;
+int shared, received ;
+int errors = 0 ;
+
+// produtora: incrementa o contador compartilhado e envia mensagens
+void prodBody (void *arg)
+{
+  int i, msg ;
+
+  for (i = 0; i < ROUNDS; i++)
+  {
+    sem_down (&mutex) ;
+    shared++ ;
+    sem_up (&mutex) ;
+    msg = i ;
+    mqueue_send (&mq, &msg) ;
+  }
+  task_exit (0) ;
+}
+
+// consumidora: recebe todas as mensagens
+void consBody (void *arg)
+{
+  int i, msg ;
+
+  for (i = 0; i < NTASKS * ROUNDS; i++)
+    if (mqueue_recv (&mq, &msg) == 0)
+      received++ ;
+  task_exit (0) ;
+}
+
+// leitora: le blocos aleatorios do disco
+void readerBody (void *arg)
+{
+  char buffer[BLOCKSIZE] ;
+  int i ;
+
+  for (i = 0; i < READS; i++)
+    if (disk_dev_block_read (0, random () % DISKBLOCKS, buffer))
+      errors++ ;
+  task_exit (0) ;
+}
+
+// executa a carga completa e retorna sua duracao (ms)
+unsigned int run ()
+{
+  unsigned int start = systime () ;
+  disk_stats_t before, after ;
+  int i ;
+
+  disk_dev_mgr_stats (0, &before) ;
+  shared = received = 0 ;
+  sem_create (&mutex, 1) ;
+  mqueue_create (&mq, 16, sizeof (int)) ;
+
+  task_create (&cons, consBody, NULL) ;
+  for (i = 0; i < READERS; i++)
+    task_create (&readers[i], readerBody, NULL) ;
+  for (i = 0; i < NTASKS; i++)
+    task_create (&prod[i], prodBody, NULL) ;
+
+  for (i = 0; i < NTASKS; i++)
+    task_join (&prod[i]) ;
+  for (i = 0; i < READERS; i++)
+    task_join (&readers[i]) ;
+  task_join (&cons) ;
+
+  mqueue_destroy (&mq) ;
+  sem_destroy (&mutex) ;
+
+  disk_dev_mgr_stats (0, &after) ;
+  if (after.requests - before.requests != READERS * READS)
+  {
+    printf ("disco: %u pedidos, esperados %d\n", after.requests - before.requests,
+            READERS * READS) ;
+    errors++ ;
+  }
+
+  if (shared != NTASKS * ROUNDS || received != NTASKS * ROUNDS)
+  {
+    printf ("carga incorreta: contador %d, %d mensagens\n", shared, received) ;
+    errors++ ;
+  }
+  return systime () - start ;
+}
+
+// le o arquivo binario e conta os eventos de cada tipo; retorna os eventos
+int readback (char *file, int *types, trace_header_t *header)
+{
+  trace_event_t e ;
+  FILE *f ;
+  int n = 0 ;
+
+  memset (types, 0, TRACE_TYPES * sizeof (int)) ;
+  if (!(f = fopen (file, "r")) || fread (header, sizeof (*header), 1, f) != 1 ||
+      header->magic != TRACE_MAGIC)
+  {
+    printf ("arquivo de rastreamento invalido\n") ;
+    errors++ ;
+    if (f)
+      fclose (f) ;
+    return 0 ;
+  }
+  while (fread (&e, sizeof (e), 1, f) == 1)
+  {
+    n++ ;
+    if (e.type > 0 && e.type < TRACE_TYPES)
+      types[e.type]++ ;
+    else
+      errors++ ;
+  }
+  fclose (f) ;
+  return n ;
+}
+
+// confere se o arquivo JSON comeca com a lista de eventos
+int json_ok (char *file)
+{
+  char line[32] ;
+  FILE *f = fopen (file, "r") ;
+  int ok ;
+
+  if (!f)
+    return 0 ;
+  ok = fgets (line, sizeof (line), f) && !strncmp (line, "{\"traceEvents\":[", 16) ;
+  fclose (f) ;
+  return ok ;
+}
+
+int main (int argc, char *argv[])
+{
+  disk_config_t cfg ;
+  trace_stats_t stats ;
+  trace_header_t header ;
+  int types[TRACE_TYPES] ;
+  unsigned int off, on ;
+  int numblocks, blocksize, n, json ;
+
+  printf ("main: inicio\n") ;
+
+  // inicializa o sistema operacional
+  ppos_init () ;
+
+  // disco com tempos de acesso reduzidos
+  disk_config_init (&cfg) ;
+  strcpy (cfg.image, "disk-trace.dat") ;
+  cfg.numblocks = DISKBLOCKS ;
+  cfg.blocksize = BLOCKSIZE ;
+  cfg.seek_min_us = 200 ;
+  cfg.seek_max_us = 2000 ;
+  cfg.jitter_us = 200 ;
+  cfg.xfer_rate = 6400000 ;
+  if (disk_dev_config (0, &cfg) < 0 || disk_dev_mgr_init (0, &numblocks, &blocksize) < 0)
+  {
+    printf ("Erro na abertura do disco\n") ;
+    exit (1) ;
+  }
+
+  // carga sem rastreamento
+  off = run () ;
+
+  // mesma carga com rastreamento
+  if (trace_start (RING))
+  {
+    printf ("Erro ao ligar o rastreamento\n") ;
+    exit (1) ;
+  }
+  on = run () ;
+  trace_stop () ;
+  trace_stats (&stats) ;
+
+  printf ("carga sem rastreamento: %u ms\n", off) ;
+  printf ("carga com rastreamento: %u ms, %llu eventos (%+.0f ns por evento)\n", on,
+          stats.events, ((double) on - off) * 1000000.0 / stats.events) ;
+  if (stats.lost)
+  {
+    printf ("anel pequeno demais: %u eventos perdidos\n", stats.lost) ;
+    errors++ ;
+  }
+
+  // grava, rele e converte o rastreamento
+  if (trace_dump ("trace.bin"))
+    errors++ ;
+  n = readback ("trace.bin", types, &header) ;
+  printf ("arquivo: %d eventos, %d trocas de contexto, %d despertares, %d sem_down, "
+          "%d sem_up\n", n, types[TRACE_SWITCH], types[TRACE_WAKEUP], types[TRACE_SEM_DOWN],
+          types[TRACE_SEM_UP]) ;
+  printf ("arquivo: %d criacoes, %d fins, %d mqueue_send, %d mqueue_recv, %d pedidos de disco "
+          "(%d concluidos), %d ticks\n", types[TRACE_CREATE], types[TRACE_EXIT],
+          types[TRACE_MQ_SEND], types[TRACE_MQ_RECV], types[TRACE_DISK_SUBMIT],
+          types[TRACE_DISK_DONE], types[TRACE_TICK]) ;
+  if (n != (int) stats.kept || header.count != stats.kept)
+    errors++ ;
+  if (types[TRACE_CREATE] != NTASKS + READERS + 1 || types[TRACE_EXIT] != NTASKS + READERS + 1)
+    errors++ ;
+  if (types[TRACE_MQ_SEND] != NTASKS * ROUNDS || types[TRACE_MQ_RECV] != NTASKS * ROUNDS)
+    errors++ ;
+  if (types[TRACE_DISK_SUBMIT] != READERS * READS || types[TRACE_DISK_DONE] != READERS * READS)
+    errors++ ;
+  if (types[TRACE_SWITCH] < NTASKS || types[TRACE_SEM_DOWN] < types[TRACE_SEM_UP] ||
+      types[TRACE_WAKEUP] < 1)
+    errors++ ;
+
+  json = trace_convert ("trace.bin", "trace.json") ;
+  printf ("JSON: %d eventos\n", json) ;
+  if (json <= 0 || !json_ok ("trace.json"))
+    errors++ ;
+
+  // anel pequeno: apenas os eventos mais recentes sao mantidos
+  trace_start (1024) ;
+  run () ;
+  trace_stop () ;
+  trace_stats (&stats) ;
+  printf ("anel de %u eventos: %llu registrados, %u mantidos, %u sobrescritos\n", stats.size,
+          stats.events, stats.kept, stats.lost) ;
+  if (stats.kept != 1024 || stats.lost != stats.events - 1024 || trace_dump ("trace.bin") ||
+      readback ("trace.bin", types, &header) != 1024 || header.lost != stats.lost ||
+      trace_convert ("trace.bin", "trace.json") <= 0)
+    errors++ ;
+
+  unlink ("trace.bin") ;
+  unlink ("trace.json") ;
+  unlink ("disk-trace.dat") ;
+
+  printf ("main: fim (%d erros)\n", errors) ;
+  task_exit (0) ;
+
+  exit (0) ;
+}
@@ -0,0 +1,29 @@
+// PingPongOS - PingPong Operating System
+// GRR20190374 - Tiago Henrique Conte, DINF UFPR
+// Outubro de 2026
+
+// Converte um arquivo de rastreamento (gravado com trace_dump() ou pela
+// variavel PPOS_TRACE) para o formato JSON do Chrome/Perfetto.
+// Uso: trace2json rastreamento.bin rastreamento.json
+
+#include <stdio.h>
+#include "ppos_trace.h"
+
+int main (int argc, char *argv[]) {
+  int n;
+
+  if ( argc != 3 ) {
+    fprintf(stderr, "uso: %s rastreamento.bin rastreamento.json\n", argv[0]);
+    return(1);
+  }
+
+  n = trace_convert(argv[1], argv[2]);
+  if ( n < 0 ) {
+    fprintf(stderr, "[PPOS error] trace2json: fail to convert %s\n", argv[1]);
+    return(1);
+  }
+
+  printf("%d eventos gravados em %s\n", n, argv[2]);
+
+  return(0);
+}